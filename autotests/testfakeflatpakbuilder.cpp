@@ -0,0 +1,228 @@
+/**
+ * @file testfakeflatpakbuilder.cpp
+ * @brief Testy potoku wyjścia budowania uruchamianego na atrapie flatpak-builder
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ *
+ * Atrapa (tools/fakeflatpakbuilder) generuje syntetyczny log z seriami
+ * ostrzeżeń i błędów kompilatora. Test uruchamia ją tak jak FlatpakBuilderJob:
+ * polecenie z FlatpakBuildCommand, proces w FlatpakProcessSource, czytnik
+ * w osobnym wątku i agregacja problemów w wątku głównym.
+ */
+
+#include "flatpakbuildcommand.h"
+#include "flatpakoutputreader.h"
+#include "flatpakoutputsource.h"
+#include "flatpakproblemaggregator.h"
+#include "flatpakprocess.h"
+
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+    // Syntetyczny log: 2 moduły, co 50 linii seria 7 ostrzeżeń (linie 10-14,
+    // więc dwa powtórzenia) i jeden błąd - razem 6 serii
+    const int LogLines = 400;
+    const int ErrorEvery = 50;
+    const int ErrorBurst = 7;
+
+    const int BuildTimeoutMs = 30000;
+
+    struct BuildResult {
+        QVector<FlatpakProblem> problems;
+        int duplicates = 0;
+        QSet<QString> modules;
+        bool finished = false;
+        int exitCode = -1;
+        QProcess::ExitStatus exitStatus = QProcess::CrashExit;
+        QString failure;
+    };
+}
+
+class TestFakeFlatpakBuilder : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void testBuild_data();
+    void testBuild();
+
+private:
+    BuildResult runBuild(const FlatpakBuildCommand& command, int exitCode);
+
+    QTemporaryDir m_dir;
+};
+
+void TestFakeFlatpakBuilder::initTestCase()
+{
+    QVERIFY(QFile::exists(QStringLiteral(FAKE_FLATPAK_BUILDER)));
+    QVERIFY(m_dir.isValid());
+
+    // module0 to zależność ze źródłem "dir", module1 to sama aplikacja
+    QJsonObject dependency;
+    dependency.insert("name", "module0");
+    dependency.insert("sources", QJsonArray{QJsonObject{{"type", "dir"}, {"path", "deps/module0"}}});
+
+    QJsonObject manifest;
+    manifest.insert("id", "org.example.Fake");
+    manifest.insert("modules", QJsonArray{dependency, QJsonObject{{"name", "module1"}}});
+
+    QFile file(m_dir.filePath("org.example.Fake.json"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QJsonDocument(manifest).toJson());
+}
+
+void TestFakeFlatpakBuilder::testBuild_data()
+{
+    QTest::addColumn<int>("exitCode");
+
+    QTest::newRow("success") << 0;
+    QTest::newRow("failure") << 1;
+}
+
+void TestFakeFlatpakBuilder::testBuild()
+{
+    QFETCH(int, exitCode);
+
+    FlatpakBuildCommand command;
+    command.setManifestPath(m_dir.filePath("org.example.Fake.json"));
+    command.setBuildDir(m_dir.filePath(QStringLiteral("build-%1").arg(exitCode)));
+    command.setStateDir(m_dir.filePath(".flatpak-builder"));
+
+    const BuildResult result = runBuild(command, exitCode);
+    QVERIFY2(result.failure.isEmpty(), qPrintable(result.failure));
+    QVERIFY(result.finished);
+    QCOMPARE(result.exitStatus, QProcess::NormalExit);
+    QCOMPARE(result.exitCode, exitCode);
+    QCOMPARE(result.modules, QSet<QString>({"module0", "module1"}));
+    QVERIFY(QFile::exists(QDir(m_dir.filePath(QStringLiteral("build-%1").arg(exitCode))).filePath("metadata")));
+
+    // 6 serii po 5 różnych ostrzeżeń i 1 błędzie; nieudane budowanie dodaje
+    // komunikat flatpak-builder bez położenia
+    const int expectedProblems = 6 * 6 + (exitCode != 0 ? 1 : 0);
+    QCOMPARE(result.problems.size(), expectedProblems);
+    QCOMPARE(result.duplicates, 6 * 2);
+
+    int errors = 0;
+    for (const FlatpakProblem& problem : result.problems) {
+        if (problem.severity == FlatpakOutputLine::Error) {
+            ++errors;
+        }
+    }
+    QCOMPARE(errors, 6 + (exitCode != 0 ? 1 : 0));
+
+    // Pierwsze ostrzeżenie: module0 przemapowany na katalog źródła "dir"
+    const FlatpakProblem& first = result.problems.first();
+    QCOMPARE(first.severity, FlatpakOutputLine::Warning);
+    QCOMPARE(first.file, m_dir.filePath("deps/module0/src/file50.cpp"));
+    QCOMPARE(first.line, 10);
+    QCOMPARE(first.column, 7);
+    QCOMPARE(first.message, QStringLiteral("unused variable 'x' [-Wunused-variable]"));
+    QCOMPARE(first.count, 2);
+
+    // Błąd w module aplikacji: przemapowany na katalog projektu
+    const FlatpakProblem& appError = result.problems.at(6 * 3 + 5);
+    QCOMPARE(appError.severity, FlatpakOutputLine::Error);
+    QCOMPARE(appError.file, m_dir.filePath("app/src/file50.cpp"));
+    QCOMPARE(appError.line, 42);
+    QCOMPARE(appError.column, 13);
+    QCOMPARE(appError.message, QStringLiteral("'foo' was not declared in this scope"));
+    QCOMPARE(appError.count, 1);
+
+    if (exitCode != 0) {
+        const FlatpakProblem& last = result.problems.last();
+        QCOMPARE(last.severity, FlatpakOutputLine::Error);
+        QVERIFY(last.file.isEmpty());
+        QCOMPARE(last.message, QStringLiteral("Build failed (simulated exit code %1)").arg(exitCode));
+    }
+}
+
+BuildResult TestFakeFlatpakBuilder::runBuild(const FlatpakBuildCommand& command, int exitCode)
+{
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.remove("FAKE_FLATPAK_LOG");
+    environment.remove("FAKE_FLATPAK_RATE");
+    environment.insert("FAKE_FLATPAK_LINES", QString::number(LogLines));
+    environment.insert("FAKE_FLATPAK_MODULES", "2");
+    environment.insert("FAKE_FLATPAK_ERROR_EVERY", QString::number(ErrorEvery));
+    environment.insert("FAKE_FLATPAK_ERROR_BURST", QString::number(ErrorBurst));
+    environment.insert("FAKE_FLATPAK_EXIT_CODE", QString::number(exitCode));
+
+    auto* process = new FlatpakProcess();
+    process->setProgram(QStringLiteral(FAKE_FLATPAK_BUILDER));
+    process->setArguments(command.arguments());
+    process->setWorkingDirectory(m_dir.path());
+    process->setProcessEnvironment(environment);
+
+    FlatpakProblemAggregator aggregator;
+    aggregator.setPathPrefixes(command.sandboxPathPrefixes("module1", m_dir.filePath("app")));
+
+    BuildResult result;
+    QEventLoop loop;
+
+    // Ten sam układ wątków co w FlatpakBuilderJob::startReader()
+    auto* reader = new FlatpakOutputReader(new FlatpakProcessSource(process));
+    auto* thread = new QThread();
+    reader->moveToThread(thread);
+    connect(thread, &QThread::finished, reader, &QObject::deleteLater);
+
+    auto drain = [reader, &aggregator, &result]() {
+        reader->acknowledge();
+        FlatpakOutputBatch batch;
+        while (reader->takeBatch(batch)) {
+            for (const FlatpakOutputLine& line : qAsConst(batch)) {
+                if (!line.module.isEmpty()) {
+                    result.modules.insert(line.module);
+                }
+                aggregator.add(line);
+            }
+        }
+    };
+
+    connect(reader, &FlatpakOutputReader::batchesAvailable, &loop, drain, Qt::QueuedConnection);
+    connect(reader, &FlatpakOutputReader::finished, &loop,
+            [&loop, &result, drain](int code, QProcess::ExitStatus status) {
+        drain();
+        result.finished = true;
+        result.exitCode = code;
+        result.exitStatus = status;
+        loop.quit();
+    }, Qt::QueuedConnection);
+    connect(reader, &FlatpakOutputReader::failedToStart, &loop, [&loop, &result](const QString& error) {
+        result.failure = error;
+        loop.quit();
+    }, Qt::QueuedConnection);
+    QTimer::singleShot(BuildTimeoutMs, &loop, [&loop, &result]() {
+        result.failure = QStringLiteral("The fake builder did not finish in time");
+        loop.quit();
+    });
+
+    thread->start();
+    QMetaObject::invokeMethod(reader, "start", Qt::QueuedConnection);
+    loop.exec();
+
+    if (!result.finished) {
+        reader->terminate();
+    }
+    thread->quit();
+    thread->wait();
+    delete thread;
+
+    result.problems = aggregator.problems();
+    result.duplicates = aggregator.duplicateCount();
+    return result;
+}
+
+QTEST_GUILESS_MAIN(TestFakeFlatpakBuilder)
+
+#include "testfakeflatpakbuilder.moc"
@@ -0,0 +1,227 @@
+/**
+ * @file flatpakclibuild.cpp
+ * @brief Implementacja budowania manifestu z linii poleceń
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakclibuild.h"
+#include "flatpakoutputreader.h"
+#include "flatpakoutputsource.h"
+#include "flatpakprocess.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QThread>
+
+FlatpakCliBuild::FlatpakCliBuild(const QString& builderPath, const FlatpakBuildCommand& command,
+                                 const FlatpakResourceLimits::Settings& limits, QObject* parent)
+    : QObject(parent)
+    , m_builderPath(builderPath)
+    , m_command(command)
+    , m_limits(limits)
+    , m_readerThread(nullptr)
+    , m_reader(nullptr)
+    , m_reportProgress(false)
+    , m_moduleCount(0)
+    , m_lastProgress(-1)
+{
+    qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
+}
+
+FlatpakCliBuild::~FlatpakCliBuild()
+{
+    if (m_reader) {
+        m_reader->detach();
+    }
+}
+
+void FlatpakCliBuild::setLogFile(const QString& path)
+{
+    m_logFile.setFileName(path);
+}
+
+void FlatpakCliBuild::setReportProgress(bool enabled)
+{
+    m_reportProgress = enabled;
+}
+
+void FlatpakCliBuild::start()
+{
+    // Ścieżki z piaskownicy wskazują na katalog manifestu, jak w IDE na katalog projektu
+    const QDir manifestDir = QFileInfo(m_command.manifestPath()).absoluteDir();
+    m_problems.setPathPrefixes(m_command.sandboxPathPrefixes(manifestDir.dirName(), manifestDir.absolutePath()));
+    m_problems.setModuleBuildDirs(m_command.sandboxBuildDirs());
+
+    if (!m_logFile.fileName().isEmpty()) {
+        m_logFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+    auto* process = new FlatpakProcess();
+    process->setProgram(m_builderPath);
+    process->setArguments(m_command.arguments());
+    process->setWorkingDirectory(QDir::currentPath());
+
+    FlatpakResourceLimits limits(m_limits);
+    if (limits.method() != FlatpakResourceLimits::NoLimits) {
+        QString unitName = QString("kdev-flatpak-cli-%1-%2")
+            .arg(QFileInfo(m_command.manifestPath()).completeBaseName())
+            .arg(QDateTime::currentMSecsSinceEpoch());
+        unitName.replace(QRegularExpression("[^A-Za-z0-9:_.\\-]"), "_");
+        limits.apply(process, unitName);
+    }
+
+    QJsonObject started = makeEvent("build-started");
+    started.insert("buildDir", m_command.buildDir());
+    started.insert("command", QJsonArray::fromStringList(QStringList(process->program()) + process->arguments()));
+    emit event(started);
+
+    m_buildTimer.start();
+    m_moduleTimer.start();
+
+    m_reader = new FlatpakOutputReader(new FlatpakProcessSource(process));
+    m_readerThread = new QThread();
+    m_reader->moveToThread(m_readerThread);
+
+    connect(m_readerThread, &QThread::finished, m_reader, &QObject::deleteLater);
+    connect(m_readerThread, &QThread::finished, m_readerThread, &QObject::deleteLater);
+    connect(m_reader, &FlatpakOutputReader::batchesAvailable,
+            this, &FlatpakCliBuild::drainOutput, Qt::QueuedConnection);
+    connect(m_reader, &FlatpakOutputReader::finished,
+            this, &FlatpakCliBuild::readerFinished, Qt::QueuedConnection);
+    connect(m_reader, &FlatpakOutputReader::failedToStart,
+            this, &FlatpakCliBuild::readerFailedToStart, Qt::QueuedConnection);
+
+    m_readerThread->start();
+    QMetaObject::invokeMethod(m_reader, "start", Qt::QueuedConnection);
+}
+
+void FlatpakCliBuild::terminate()
+{
+    if (m_reader) {
+        m_reader->terminate();
+    }
+}
+
+void FlatpakCliBuild::drainOutput()
+{
+    if (!m_reader) {
+        return;
+    }
+
+    m_reader->acknowledge();
+
+    FlatpakOutputBatch batch;
+    while (m_reader->takeBatch(batch)) {
+        for (const FlatpakOutputLine& line : qAsConst(batch)) {
+            if (line.kind == FlatpakOutputLine::Progress && m_reportProgress
+                && line.progressCurrent != m_lastProgress) {
+                m_lastProgress = line.progressCurrent;
+                QJsonObject progress = makeEvent("progress");
+                progress.insert("module", m_currentModule);
+                progress.insert("current", line.progressCurrent);
+                progress.insert("total", line.progressTotal);
+                emit event(progress);
+            }
+
+            if (line.transient) {
+                continue;
+            }
+
+            if (!line.module.isEmpty()) {
+                finishModule();
+                m_currentModule = line.module;
+                m_moduleTimer.restart();
+            }
+
+            // Linie modułów też - wyznaczają katalog dla ścieżek względnych
+            m_problems.add(line);
+
+            if (m_logFile.isOpen()) {
+                m_logFile.write(line.text.toUtf8() + '\n');
+            }
+        }
+    }
+}
+
+void FlatpakCliBuild::readerFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    drainOutput();
+    finishModule();
+
+    m_reader = nullptr;
+    m_readerThread->quit();
+    m_logFile.close();
+
+    // Problemy są wypisywane na końcu, już zdeduplikowane i z liczbą wystąpień
+    int errors = 0;
+    int warnings = 0;
+    for (const FlatpakProblem& problem : m_problems.problems()) {
+        const bool isError = problem.severity == FlatpakOutputLine::Error;
+        isError ? ++errors : ++warnings;
+
+        QJsonObject event = makeEvent("problem");
+        event.insert("severity", isError ? "error" : "warning");
+        event.insert("message", problem.message);
+        event.insert("count", problem.count);
+        if (!problem.file.isEmpty()) {
+            event.insert("file", problem.file);
+            event.insert("line", problem.line);
+            event.insert("column", problem.column);
+        }
+        emit this->event(event);
+    }
+
+    const int result = exitStatus == QProcess::CrashExit && exitCode == 0 ? -1 : exitCode;
+
+    QJsonObject done = makeEvent("build-finished");
+    done.insert("exitCode", result);
+    done.insert("seconds", m_buildTimer.elapsed() / 1000.0);
+    done.insert("modules", m_moduleCount);
+    done.insert("errors", errors);
+    done.insert("warnings", warnings);
+    done.insert("duplicates", m_problems.duplicateCount());
+    emit event(done);
+
+    emit finished(result);
+}
+
+void FlatpakCliBuild::readerFailedToStart(const QString& errorString)
+{
+    m_reader = nullptr;
+    m_readerThread->quit();
+
+    QJsonObject done = makeEvent("build-finished");
+    done.insert("exitCode", -1);
+    done.insert("error", errorString);
+    emit event(done);
+
+    emit finished(-1);
+}
+
+void FlatpakCliBuild::finishModule()
+{
+    if (m_currentModule.isEmpty()) {
+        return;
+    }
+
+    ++m_moduleCount;
+
+    QJsonObject module = makeEvent("module");
+    module.insert("name", m_currentModule);
+    module.insert("seconds", m_moduleTimer.elapsed() / 1000.0);
+    emit event(module);
+
+    m_currentModule.clear();
+}
+
+QJsonObject FlatpakCliBuild::makeEvent(const QString& type) const
+{
+    QJsonObject event;
+    event.insert("event", type);
+    event.insert("manifest", m_command.manifestPath());
+    return event;
+}
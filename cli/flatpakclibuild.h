@@ -0,0 +1,112 @@
+/**
+ * @file flatpakclibuild.h
+ * @brief Pojedyncze budowanie manifestu uruchomione z linii poleceń
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKCLIBUILD_H
+#define FLATPAKCLIBUILD_H
+
+#include "flatpakbuildcommand.h"
+#include "flatpakproblemaggregator.h"
+#include "flatpakresourcelimits.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QObject>
+#include <QProcess>
+
+class FlatpakOutputReader;
+class QThread;
+
+/**
+ * @class FlatpakCliBuild
+ * @brief Budowanie jednego manifestu bez KDevelop
+ *
+ * Korzysta z tego samego potoku co FlatpakBuilderJob: proces we własnej
+ * grupie, czytnik w osobnym wątku, klasyfikacja linii i agregacja problemów.
+ * Zamiast widoku wyjścia wynik trafia do zdarzeń JSON.
+ */
+class FlatpakCliBuild : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param builderPath Ścieżka do flatpak-builder
+     * @param command Polecenie budowania
+     * @param limits Ograniczenia zasobów procesu
+     * @param parent Obiekt rodzica
+     */
+    FlatpakCliBuild(const QString& builderPath, const FlatpakBuildCommand& command,
+                    const FlatpakResourceLimits::Settings& limits, QObject* parent = nullptr);
+
+    /**
+     * Destruktor
+     */
+    ~FlatpakCliBuild() override;
+
+    /**
+     * @brief Zapisuje surowy log budowania do pliku
+     * @param path Ścieżka do pliku logu
+     */
+    void setLogFile(const QString& path);
+
+    /**
+     * @brief Włącza zdarzenia "progress" dla każdej zmiany postępu
+     * @param enabled Nowa wartość
+     */
+    void setReportProgress(bool enabled);
+
+    /**
+     * @brief Uruchamia budowanie
+     */
+    void start();
+
+    /**
+     * @brief Przerywa budowanie
+     */
+    void terminate();
+
+Q_SIGNALS:
+    /**
+     * @brief Zdarzenie do wypisania jako linia JSON
+     * @param event Treść zdarzenia
+     */
+    void event(const QJsonObject& event);
+
+    /**
+     * @brief Budowanie się zakończyło
+     * @param exitCode Kod wyjścia flatpak-builder
+     */
+    void finished(int exitCode);
+
+private Q_SLOTS:
+    void drainOutput();
+    void readerFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void readerFailedToStart(const QString& errorString);
+
+private:
+    void finishModule();
+    QJsonObject makeEvent(const QString& type) const;
+
+    QString m_builderPath;
+    FlatpakBuildCommand m_command;
+    FlatpakResourceLimits::Settings m_limits;
+    FlatpakProblemAggregator m_problems;
+    QThread* m_readerThread;
+    FlatpakOutputReader* m_reader;
+    QFile m_logFile;
+    bool m_reportProgress;
+    QElapsedTimer m_buildTimer;
+    QElapsedTimer m_moduleTimer;
+    QString m_currentModule;
+    int m_moduleCount;
+    int m_lastProgress;
+};
+
+#endif // FLATPAKCLIBUILD_H
@@ -0,0 +1,209 @@
+/**
+ * @file main.cpp
+ * @brief Punkt wejścia sterownika budowania kdev-flatpak-cli
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ *
+ * Buduje jeden lub więcej manifestów tym samym potokiem co wtyczka
+ * (klasyfikacja linii, agregacja problemów, ograniczenia zasobów) i wypisuje
+ * zdarzenia jako linie JSON na standardowe wyjście. Manifesty są budowane
+ * równolegle do limitu --jobs; wszystkie korzystają z tego samego katalogu
+ * stanu, więc pobrane źródła i cache modułów są współdzielone.
+ */
+
+#include "flatpakclibuild.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QQueue>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include <csignal>
+#include <cstdio>
+#include <functional>
+
+namespace {
+    volatile std::sig_atomic_t interrupted = 0;
+
+    void handleInterrupt(int)
+    {
+        interrupted = 1;
+    }
+
+    /**
+     * Nazwa katalogu budowania i logu: nazwa manifestu i skrót jego ścieżki,
+     * więc manifesty o tej samej nazwie z różnych katalogów się nie nadpisują,
+     * a ponowne uruchomienie (--resume) trafia do tego samego katalogu
+     */
+    QString buildName(const QFileInfo& manifest)
+    {
+        const QByteArray hash = QCryptographicHash::hash(manifest.canonicalFilePath().toUtf8(), QCryptographicHash::Sha1);
+        return manifest.completeBaseName() + '-' + QString::fromLatin1(hash.toHex().left(8));
+    }
+
+    void writeEvent(const QJsonObject& event)
+    {
+        const QByteArray line = QJsonDocument(event).toJson(QJsonDocument::Compact) + '\n';
+        std::fwrite(line.constData(), 1, line.size(), stdout);
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("kdev-flatpak-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Builds Flatpak manifests with the KDevelop Flatpak builder pipeline and reports JSON events");
+    parser.addHelpOption();
+    parser.addPositionalArgument("manifest", "Flatpak manifests to build.", "manifest...");
+
+    QCommandLineOption jobsOption(QStringList{"j", "jobs"}, "Number of manifests built in parallel.", "count", "2");
+    QCommandLineOption stateDirOption("state-dir", "Shared flatpak-builder state directory.", "path", ".flatpak-builder");
+    QCommandLineOption buildRootOption("build-root", "Directory holding one build directory per manifest.", "path", "build-dir");
+    QCommandLineOption builderOption("flatpak-builder", "Path to the flatpak-builder executable.", "path");
+    QCommandLineOption resumeOption("resume", "Reuse cached modules without updating sources.");
+    QCommandLineOption noCleanOption("no-force-clean", "Do not pass --force-clean to flatpak-builder.");
+    QCommandLineOption extraOption("option", "Additional flatpak-builder option (repeatable).", "option");
+    QCommandLineOption cpuWeightOption("cpu-weight", "CPU weight of the build (1-10000).", "weight");
+    QCommandLineOption ioWeightOption("io-weight", "IO weight of the build (1-10000).", "weight");
+    QCommandLineOption memoryHighOption("memory-high", "Memory throttling threshold in MiB.", "mib");
+    QCommandLineOption memoryMaxOption("memory-max", "Hard memory limit in MiB.", "mib");
+    QCommandLineOption progressOption("progress", "Report progress events.");
+    QCommandLineOption logDirOption("log-dir", "Directory for raw build logs.", "path");
+
+    parser.addOptions({jobsOption, stateDirOption, buildRootOption, builderOption, resumeOption,
+                       noCleanOption, extraOption, cpuWeightOption, ioWeightOption,
+                       memoryHighOption, memoryMaxOption, progressOption, logDirOption});
+    parser.process(app);
+
+    const QStringList manifests = parser.positionalArguments();
+    if (manifests.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    const QString builderPath = parser.isSet(builderOption)
+        ? parser.value(builderOption)
+        : QStandardPaths::findExecutable("flatpak-builder");
+    if (builderPath.isEmpty()) {
+        std::fprintf(stderr, "kdev-flatpak-cli: flatpak-builder not found\n");
+        return 1;
+    }
+
+    // Podanie dowolnego limitu włącza ograniczenia, pozostałe mają wartości domyślne
+    FlatpakResourceLimits::Settings limits;
+    limits.enabled = parser.isSet(cpuWeightOption) || parser.isSet(ioWeightOption)
+        || parser.isSet(memoryHighOption) || parser.isSet(memoryMaxOption);
+    if (parser.isSet(cpuWeightOption)) {
+        limits.cpuWeight = qBound(1, parser.value(cpuWeightOption).toInt(), 10000);
+    }
+    if (parser.isSet(ioWeightOption)) {
+        limits.ioWeight = qBound(1, parser.value(ioWeightOption).toInt(), 10000);
+    }
+    limits.memoryHighMiB = qMax(0, parser.value(memoryHighOption).toInt());
+    limits.memoryMaxMiB = qMax(0, parser.value(memoryMaxOption).toInt());
+
+    const QString logDir = parser.value(logDirOption);
+    if (!logDir.isEmpty()) {
+        QDir().mkpath(logDir);
+    }
+
+    QQueue<FlatpakCliBuild*> pending;
+    QSet<QString> names;
+    for (const QString& manifest : manifests) {
+        const QFileInfo info(manifest);
+        if (!info.isFile()) {
+            std::fprintf(stderr, "kdev-flatpak-cli: %s: no such manifest\n", qPrintable(manifest));
+            return 1;
+        }
+
+        // Dwa równoległe budowania w jednym katalogu niszczyłyby się nawzajem
+        const QString name = buildName(info);
+        if (names.contains(name)) {
+            std::fprintf(stderr, "kdev-flatpak-cli: %s: manifest listed more than once\n", qPrintable(manifest));
+            return 1;
+        }
+        names.insert(name);
+
+        FlatpakBuildCommand command;
+        command.setManifestPath(info.absoluteFilePath());
+        command.setBuildDir(QDir(parser.value(buildRootOption)).filePath(name));
+        command.setStateDir(parser.value(stateDirOption));
+        command.setAdditionalOptions(parser.values(extraOption));
+        command.setForceClean(!parser.isSet(noCleanOption));
+        command.setResume(parser.isSet(resumeOption));
+
+        auto* build = new FlatpakCliBuild(builderPath, command, limits, &app);
+        build->setReportProgress(parser.isSet(progressOption));
+        if (!logDir.isEmpty()) {
+            build->setLogFile(QDir(logDir).filePath(name + ".log"));
+        }
+        QObject::connect(build, &FlatpakCliBuild::event, &writeEvent);
+        pending.enqueue(build);
+    }
+
+    const int maxJobs = qMax(1, parser.value(jobsOption).toInt());
+    QList<FlatpakCliBuild*> running;
+    int failed = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    std::function<void()> schedule = [&]() {
+        while (!pending.isEmpty() && running.size() < maxJobs && !interrupted) {
+            FlatpakCliBuild* build = pending.dequeue();
+            running.append(build);
+
+            QObject::connect(build, &FlatpakCliBuild::finished, &app, [&, build](int exitCode) {
+                running.removeOne(build);
+                build->deleteLater();
+                if (exitCode != 0) {
+                    ++failed;
+                }
+
+                if (running.isEmpty() && (pending.isEmpty() || interrupted)) {
+                    failed += pending.size();
+                    qDeleteAll(pending);
+                    pending.clear();
+
+                    QJsonObject summary;
+                    summary.insert("event", "summary");
+                    summary.insert("builds", manifests.size());
+                    summary.insert("failed", failed);
+                    summary.insert("seconds", timer.elapsed() / 1000.0);
+                    writeEvent(summary);
+
+                    app.exit(failed > 0 ? 1 : 0);
+                } else {
+                    schedule();
+                }
+            });
+
+            build->start();
+        }
+    };
+
+    // Przerwanie z terminala lub CI kończy bieżące budowania całymi drzewami procesów
+    std::signal(SIGINT, handleInterrupt);
+    std::signal(SIGTERM, handleInterrupt);
+    QTimer interruptTimer;
+    QObject::connect(&interruptTimer, &QTimer::timeout, &app, [&]() {
+        if (interrupted) {
+            interruptTimer.stop();
+            for (FlatpakCliBuild* build : qAsConst(running)) {
+                build->terminate();
+            }
+        }
+    });
+    interruptTimer.start(200);
+
+    schedule();
+    return app.exec();
+}
@@ -0,0 +1,490 @@
+/**
+ * @file flatpakbuilddaemon.cpp
+ * @brief Implementacja demona prowadzącego budowania Flatpak
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakbuilddaemon.h"
+#include "flatpakdaemonprotocol.h"
+#include "flatpakprocess.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include <signal.h>
+
+namespace {
+    // Powiadomienia o nowym wyjściu są łączone, żeby nie zalewać klientów
+    const int OutputNotifyIntervalMs = 20;
+
+    // Czas bezczynności, po którym demon się kończy
+    const int IdleTimeoutMs = 10 * 60 * 1000;
+
+    // Czas na posprzątanie po SIGTERM, zanim drzewo procesów dostanie SIGKILL
+    const int KillGracePeriodMs = 3000;
+
+    // Logi starsze niż tyle dni są usuwane przy starcie demona
+    const int LogRetentionDays = 7;
+}
+
+FlatpakBuildDaemon::FlatpakBuildDaemon(int maxConcurrentBuilds, QObject* parent)
+    : QObject(parent)
+    , m_server(new QLocalServer(this))
+    , m_outputTimer(new QTimer(this))
+    , m_idleTimer(new QTimer(this))
+    , m_logDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/kdev-flatpak-daemon/logs")
+    , m_maxConcurrentBuilds(qMax(1, maxConcurrentBuilds))
+    , m_nextId(1)
+{
+    m_logDir.mkpath(".");
+
+    m_outputTimer->setSingleShot(true);
+    m_outputTimer->setInterval(OutputNotifyIntervalMs);
+    connect(m_outputTimer, &QTimer::timeout, this, &FlatpakBuildDaemon::notifyOutput);
+
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(IdleTimeoutMs);
+    connect(m_idleTimer, &QTimer::timeout, this, [this]() {
+        if (isIdle()) {
+            QCoreApplication::quit();
+        }
+    });
+
+    connect(m_server, &QLocalServer::newConnection, this, &FlatpakBuildDaemon::newConnection);
+
+    removeOldLogs();
+}
+
+FlatpakBuildDaemon::~FlatpakBuildDaemon()
+{
+    for (Build* build : qAsConst(m_builds)) {
+        if (build->process && build->process->state() != QProcess::NotRunning) {
+            build->process->signalTree(SIGKILL);
+            build->process->waitForFinished(1000);
+        }
+        FlatpakProcess::signalProcesses(build->signalled, SIGKILL);
+    }
+    qDeleteAll(m_builds);
+}
+
+bool FlatpakBuildDaemon::listen()
+{
+    const QString path = FlatpakDaemonProtocol::socketPath();
+
+    // Gniazdo może zostać po poprzednim demonie, który nie zakończył się czysto
+    QLocalSocket probe;
+    probe.connectToServer(path);
+    if (probe.waitForConnected(500)) {
+        return false;
+    }
+    QLocalServer::removeServer(path);
+
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    if (!m_server->listen(path)) {
+        return false;
+    }
+
+    m_idleTimer->start();
+    return true;
+}
+
+void FlatpakBuildDaemon::newConnection()
+{
+    while (QLocalSocket* client = m_server->nextPendingConnection()) {
+        m_clients.insert(client);
+        connect(client, &QLocalSocket::readyRead, this, [this, client]() {
+            readClient(client);
+        });
+        connect(client, &QLocalSocket::disconnected, this, [this, client]() {
+            clientDisconnected(client);
+        });
+    }
+
+    m_idleTimer->stop();
+}
+
+void FlatpakBuildDaemon::readClient(QLocalSocket* client)
+{
+    while (client->canReadLine()) {
+        const QJsonDocument document = QJsonDocument::fromJson(client->readLine());
+        if (document.isObject()) {
+            handleMessage(client, document.object());
+        }
+    }
+}
+
+void FlatpakBuildDaemon::clientDisconnected(QLocalSocket* client)
+{
+    // Rozłączenie klienta nie przerywa budowania
+    m_clients.remove(client);
+    for (Build* build : qAsConst(m_builds)) {
+        build->subscribers.remove(client);
+    }
+    client->deleteLater();
+
+    checkIdle();
+}
+
+void FlatpakBuildDaemon::handleMessage(QLocalSocket* client, const QJsonObject& message)
+{
+    const QString command = message.value("cmd").toString();
+
+    if (command == QLatin1String("start")) {
+        startBuild(client, message);
+    } else if (command == QLatin1String("attach")) {
+        Build* build = message.contains("id")
+            ? findBuild(message.value("id").toInt())
+            : latestBuild(message.value("key").toString());
+        if (build) {
+            attach(client, build);
+        } else {
+            QJsonObject error;
+            error.insert("event", "error");
+            error.insert("message", QStringLiteral("No such build"));
+            send(client, error);
+        }
+    } else if (command == QLatin1String("list")) {
+        QJsonArray builds;
+        for (const Build* build : qAsConst(m_builds)) {
+            builds.append(describe(build));
+        }
+        QJsonObject reply;
+        reply.insert("event", "list");
+        reply.insert("builds", builds);
+        send(client, reply);
+    } else if (command == QLatin1String("cancel")) {
+        if (Build* build = findBuild(message.value("id").toInt())) {
+            cancel(build);
+        }
+    }
+}
+
+void FlatpakBuildDaemon::startBuild(QLocalSocket* client, const QJsonObject& message)
+{
+    // Pusty program (np. flatpak-builder spoza PATH) zakończyłby się błędem
+    // uruchomienia jeszcze wewnątrz QProcess::start()
+    if (message.value("program").toString().isEmpty()) {
+        QJsonObject error;
+        error.insert("event", "error");
+        error.insert("message", QStringLiteral("No program to run"));
+        send(client, error);
+        return;
+    }
+
+    auto* build = new Build;
+    build->id = m_nextId++;
+    build->key = message.value("key").toString();
+    build->program = message.value("program").toString();
+    build->workingDirectory = message.value("workingDirectory").toString();
+    for (const QJsonValue& argument : message.value("arguments").toArray()) {
+        build->arguments << argument.toString();
+    }
+
+    const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss");
+    build->log.reset(new QFile(m_logDir.absoluteFilePath(QString("%1-%2.log").arg(stamp).arg(build->id))));
+    if (!build->log->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QJsonObject error;
+        error.insert("event", "error");
+        error.insert("message", QStringLiteral("Could not create build log ") + build->log->fileName());
+        send(client, error);
+        delete build;
+        return;
+    }
+
+    m_builds.append(build);
+    attach(client, build);
+    scheduleBuilds();
+}
+
+void FlatpakBuildDaemon::attach(QLocalSocket* client, Build* build)
+{
+    build->subscribers.insert(client);
+
+    QJsonObject reply = describe(build);
+    reply.insert("event", "attached");
+    send(client, reply);
+
+    // Klient przeczyta cały log z pliku; zakończone budowanie nie wyśle już nic więcej
+    if (build->state == Build::Finished) {
+        QJsonObject finished;
+        finished.insert("event", "finished");
+        finished.insert("id", build->id);
+        finished.insert("exitCode", build->exitCode);
+        finished.insert("crashed", build->crashed);
+        send(client, finished);
+    }
+}
+
+void FlatpakBuildDaemon::cancel(Build* build)
+{
+    if (build->state == Build::Queued) {
+        appendOutput(build, FlatpakDaemonProtocol::StandardErrorRecord, "Build cancelled before it started\n");
+        buildFinished(build, -1, true);
+        return;
+    }
+
+    if (build->state != Build::Running || build->cancelling) {
+        return;
+    }
+
+    build->cancelling = true;
+    build->signalled = build->process->signalTree(SIGTERM);
+
+    const int id = build->id;
+    QTimer::singleShot(KillGracePeriodMs, this, [this, id]() {
+        Build* build = findBuild(id);
+        if (!build) {
+            return;
+        }
+
+        // Procesy, które uciekły z drzewa, dostają SIGKILL także po zakończeniu
+        // flatpak-builder; czas startu chroni przed ponownie użytymi identyfikatorami
+        if (build->process && build->process->state() != QProcess::NotRunning) {
+            build->process->signalTree(SIGKILL);
+        }
+        FlatpakProcess::signalProcesses(build->signalled, SIGKILL);
+        build->signalled.clear();
+    });
+}
+
+void FlatpakBuildDaemon::scheduleBuilds()
+{
+    int running = 0;
+    QSet<QString> busyDirectories;
+    for (const Build* build : qAsConst(m_builds)) {
+        if (build->state == Build::Running) {
+            ++running;
+            busyDirectories.insert(build->workingDirectory);
+        }
+    }
+
+    // Kolejność zgłoszeń jest zachowana; budowanie czeka, jeśli ktoś inny
+    // używa już tego samego katalogu stanu flatpak-builder
+    for (Build* build : qAsConst(m_builds)) {
+        if (running >= m_maxConcurrentBuilds) {
+            break;
+        }
+        if (build->state != Build::Queued || busyDirectories.contains(build->workingDirectory)) {
+            continue;
+        }
+
+        launch(build);
+        if (build->state == Build::Running) {
+            ++running;
+            busyDirectories.insert(build->workingDirectory);
+        }
+    }
+}
+
+void FlatpakBuildDaemon::launch(Build* build)
+{
+    build->process = new FlatpakProcess(this);
+    build->process->setProgram(build->program);
+    build->process->setArguments(build->arguments);
+    build->process->setWorkingDirectory(build->workingDirectory);
+
+    const int id = build->id;
+    connect(build->process, &QProcess::readyReadStandardOutput, this, [this, id]() {
+        if (Build* build = findBuild(id)) {
+            appendOutput(build, FlatpakDaemonProtocol::StandardOutputRecord, build->process->readAllStandardOutput());
+        }
+    });
+    connect(build->process, &QProcess::readyReadStandardError, this, [this, id]() {
+        if (Build* build = findBuild(id)) {
+            appendOutput(build, FlatpakDaemonProtocol::StandardErrorRecord, build->process->readAllStandardError());
+        }
+    });
+    connect(build->process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, id](int exitCode, QProcess::ExitStatus exitStatus) {
+        if (Build* build = findBuild(id)) {
+            appendOutput(build, FlatpakDaemonProtocol::StandardOutputRecord, build->process->readAllStandardOutput());
+            appendOutput(build, FlatpakDaemonProtocol::StandardErrorRecord, build->process->readAllStandardError());
+            buildFinished(build, exitCode, exitStatus == QProcess::CrashExit);
+        }
+    });
+    connect(build->process, &QProcess::errorOccurred, this, [this, id](QProcess::ProcessError error) {
+        Build* build = findBuild(id);
+        if (build && error == QProcess::FailedToStart) {
+            appendOutput(build, FlatpakDaemonProtocol::StandardErrorRecord,
+                         "Could not start process: " + build->process->errorString().toUtf8() + '\n');
+            buildFinished(build, -1, true);
+        }
+    });
+
+    build->state = Build::Running;
+    build->process->start();
+
+    // Błąd uruchomienia jest zgłaszany synchronicznie i buildFinished() zwalnia już proces
+    if (build->state != Build::Running || !build->process || !build->process->waitForStarted()) {
+        return;
+    }
+
+    build->pid = build->process->processId();
+
+    QJsonObject started;
+    started.insert("event", "started");
+    started.insert("id", build->id);
+    started.insert("pid", build->pid);
+    broadcast(build, started);
+}
+
+void FlatpakBuildDaemon::appendOutput(Build* build, char channel, const QByteArray& data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+
+    // Rekord jest zapisywany w całości i od razu opróżniany, żeby klienci
+    // czytający plik nigdy nie widzieli danych, o których nie dostali powiadomienia
+    build->log->write(FlatpakDaemonProtocol::encodeRecord(channel, data));
+    build->log->flush();
+
+    build->outputPending = true;
+    if (!m_outputTimer->isActive()) {
+        m_outputTimer->start();
+    }
+}
+
+void FlatpakBuildDaemon::buildFinished(Build* build, int exitCode, bool crashed)
+{
+    if (build->state == Build::Finished) {
+        return;
+    }
+
+    build->state = Build::Finished;
+    build->exitCode = exitCode;
+    build->crashed = crashed;
+    build->log->close();
+
+    if (build->process) {
+        build->process->deleteLater();
+        build->process = nullptr;
+    }
+
+    QJsonObject finished;
+    finished.insert("event", "finished");
+    finished.insert("id", build->id);
+    finished.insert("exitCode", exitCode);
+    finished.insert("crashed", crashed);
+    broadcast(build, finished);
+
+    // Kolejne budowanie ruszy po powrocie do pętli zdarzeń, nie w trakcie
+    // obsługi sygnałów zakończonego procesu
+    QTimer::singleShot(0, this, [this]() {
+        scheduleBuilds();
+        checkIdle();
+    });
+}
+
+void FlatpakBuildDaemon::notifyOutput()
+{
+    for (Build* build : qAsConst(m_builds)) {
+        if (!build->outputPending) {
+            continue;
+        }
+        build->outputPending = false;
+
+        QJsonObject output;
+        output.insert("event", "output");
+        output.insert("id", build->id);
+        output.insert("size", build->log->isOpen() ? build->log->size() : QFileInfo(build->log->fileName()).size());
+        broadcast(build, output);
+    }
+}
+
+void FlatpakBuildDaemon::checkIdle()
+{
+    if (!isIdle()) {
+        m_idleTimer->stop();
+    } else if (!m_idleTimer->isActive()) {
+        m_idleTimer->start();
+    }
+}
+
+bool FlatpakBuildDaemon::isIdle() const
+{
+    if (!m_clients.isEmpty()) {
+        return false;
+    }
+
+    for (const Build* build : m_builds) {
+        if (build->state != Build::Finished) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FlatpakBuildDaemon::broadcast(Build* build, const QJsonObject& message)
+{
+    for (QLocalSocket* client : qAsConst(build->subscribers)) {
+        send(client, message);
+    }
+}
+
+void FlatpakBuildDaemon::send(QLocalSocket* client, const QJsonObject& message)
+{
+    client->write(FlatpakDaemonProtocol::encodeMessage(message));
+}
+
+void FlatpakBuildDaemon::removeOldLogs()
+{
+    const QDateTime limit = QDateTime::currentDateTime().addDays(-LogRetentionDays);
+    const QFileInfoList logs = m_logDir.entryInfoList({"*.log"}, QDir::Files);
+    for (const QFileInfo& log : logs) {
+        if (log.lastModified() < limit) {
+            QFile::remove(log.absoluteFilePath());
+        }
+    }
+}
+
+FlatpakBuildDaemon::Build* FlatpakBuildDaemon::findBuild(int id) const
+{
+    for (Build* build : m_builds) {
+        if (build->id == id) {
+            return build;
+        }
+    }
+    return nullptr;
+}
+
+FlatpakBuildDaemon::Build* FlatpakBuildDaemon::latestBuild(const QString& key) const
+{
+    for (auto it = m_builds.crbegin(); it != m_builds.crend(); ++it) {
+        if ((*it)->key == key) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+QJsonObject FlatpakBuildDaemon::describe(const Build* build) const
+{
+    QJsonObject description;
+    description.insert("id", build->id);
+    description.insert("key", build->key);
+    switch (build->state) {
+        case Build::Queued:
+            description.insert("state", "queued");
+            break;
+        case Build::Running:
+            description.insert("state", "running");
+            break;
+        case Build::Finished:
+            description.insert("state", "finished");
+            break;
+    }
+    description.insert("log", build->log->fileName());
+    description.insert("pid", build->pid);
+    description.insert("workingDirectory", build->workingDirectory);
+    return description;
+}
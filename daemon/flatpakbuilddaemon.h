@@ -0,0 +1,127 @@
+/**
+ * @file flatpakbuilddaemon.h
+ * @brief Demon prowadzący budowania Flatpak niezależnie od KDevelop
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKBUILDDAEMON_H
+#define FLATPAKBUILDDAEMON_H
+
+#include <QDir>
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+#include <memory>
+
+#include "flatpakprocess.h"
+
+class QLocalServer;
+class QLocalSocket;
+class QTimer;
+
+/**
+ * @class FlatpakBuildDaemon
+ * @brief Serwer kolejki budowania obsługujący wiele sesji KDevelop
+ *
+ * Demon jest właścicielem procesów flatpak-builder i ich logów. Budowania
+ * korzystające z tego samego katalogu roboczego (a więc wspólnego katalogu
+ * stanu .flatpak-builder z cache modułów) są wykonywane kolejno, pozostałe
+ * równolegle do ustalonego limitu. Klienci mogą się rozłączać i podłączać
+ * ponownie w dowolnym momencie - budowanie trwa dalej.
+ *
+ * Gdy nie ma żadnych budowań ani klientów, demon kończy działanie po okresie
+ * bezczynności.
+ */
+class FlatpakBuildDaemon : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param maxConcurrentBuilds Maksymalna liczba równoległych budowań
+     * @param parent Obiekt rodzica
+     */
+    explicit FlatpakBuildDaemon(int maxConcurrentBuilds, QObject* parent = nullptr);
+
+    /**
+     * Destruktor
+     */
+    ~FlatpakBuildDaemon() override;
+
+    /**
+     * @brief Zaczyna nasłuchiwać na gnieździe
+     * @return false jeśli inny demon już działa albo gniazda nie da się utworzyć
+     */
+    bool listen();
+
+private Q_SLOTS:
+    void newConnection();
+    void readClient(QLocalSocket* client);
+    void clientDisconnected(QLocalSocket* client);
+    void notifyOutput();
+    void checkIdle();
+
+private:
+    /**
+     * Pojedyncze budowanie w kolejce demona
+     */
+    struct Build {
+        enum State {
+            Queued,
+            Running,
+            Finished
+        };
+
+        int id = 0;
+        QString key;
+        QString program;
+        QStringList arguments;
+        QString workingDirectory;
+        State state = Queued;
+        FlatpakProcess* process = nullptr;
+        std::unique_ptr<QFile> log;
+        qint64 pid = 0;
+        int exitCode = 0;
+        bool crashed = false;
+        bool outputPending = false;
+        QVector<FlatpakProcess::ProcessId> signalled;
+        bool cancelling = false;
+        QSet<QLocalSocket*> subscribers;
+    };
+
+    void handleMessage(QLocalSocket* client, const QJsonObject& message);
+    void startBuild(QLocalSocket* client, const QJsonObject& message);
+    void attach(QLocalSocket* client, Build* build);
+    void cancel(Build* build);
+    void scheduleBuilds();
+    void launch(Build* build);
+    void appendOutput(Build* build, char channel, const QByteArray& data);
+    void buildFinished(Build* build, int exitCode, bool crashed);
+    void broadcast(Build* build, const QJsonObject& message);
+    void send(QLocalSocket* client, const QJsonObject& message);
+    void removeOldLogs();
+    bool isIdle() const;
+    Build* findBuild(int id) const;
+    Build* latestBuild(const QString& key) const;
+    QJsonObject describe(const Build* build) const;
+
+    QLocalServer* m_server;
+    QTimer* m_outputTimer;
+    QTimer* m_idleTimer;
+    QDir m_logDir;
+    QList<Build*> m_builds;
+    QSet<QLocalSocket*> m_clients;
+    int m_maxConcurrentBuilds;
+    int m_nextId;
+};
+
+#endif // FLATPAKBUILDDAEMON_H
@@ -0,0 +1,42 @@
+/**
+ * @file main.cpp
+ * @brief Punkt wejścia demona budowania kdev-flatpak-daemon
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ *
+ * Demon jest uruchamiany przez wtyczkę przy pierwszym budowaniu w trybie
+ * demona i kończy się sam po okresie bezczynności. Opcja --max-jobs określa
+ * liczbę budowań wykonywanych równolegle (dla różnych katalogów roboczych).
+ */
+
+#include "flatpakbuilddaemon.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include <cstdio>
+#include <unistd.h>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("kdev-flatpak-daemon");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs Flatpak builds for KDevelop independently of the IDE");
+    parser.addHelpOption();
+    QCommandLineOption maxJobsOption("max-jobs", "Number of builds run in parallel.", "count", "2");
+    parser.addOption(maxJobsOption);
+    parser.process(app);
+
+    // Własna sesja - zamknięcie terminala ani IDE nie przerwie budowania
+    ::setsid();
+
+    FlatpakBuildDaemon daemon(parser.value(maxJobsOption).toInt());
+    if (!daemon.listen()) {
+        std::fprintf(stderr, "kdev-flatpak-daemon: another instance is running or the socket cannot be created\n");
+        return 1;
+    }
+
+    return app.exec();
+}
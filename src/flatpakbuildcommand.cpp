@@ -0,0 +1,202 @@
+/**
+ * @file flatpakbuildcommand.cpp
+ * @brief Implementacja składania linii poleceń flatpak-builder
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakbuildcommand.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+    void collectModulePrefixes(const QJsonArray& modules, const QDir& manifestDir,
+                               QVector<QPair<QString, QString>>& prefixes)
+    {
+        for (const QJsonValue& value : modules) {
+            // Moduły mogą być też ścieżkami do osobnych plików - te pomijamy
+            const QJsonObject module = value.toObject();
+            const QString name = module.value("name").toString();
+            if (name.isEmpty()) {
+                continue;
+            }
+
+            const QJsonArray sources = module.value("sources").toArray();
+            for (const QJsonValue& sourceValue : sources) {
+                const QJsonObject source = sourceValue.toObject();
+                if (source.value("type").toString() != QLatin1String("dir")) {
+                    continue;
+                }
+
+                QString sandboxPrefix = "/run/build/" + name + '/';
+                const QString dest = source.value("dest").toString();
+                if (!dest.isEmpty()) {
+                    sandboxPrefix += dest + '/';
+                }
+
+                const QString localPath = manifestDir.absoluteFilePath(source.value("path").toString());
+                prefixes.append(qMakePair(sandboxPrefix, QDir::cleanPath(localPath) + '/'));
+            }
+
+            collectModulePrefixes(module.value("modules").toArray(), manifestDir, prefixes);
+        }
+    }
+
+    void collectBuildDirs(const QJsonArray& modules, QHash<QString, QString>& buildDirs)
+    {
+        for (const QJsonValue& value : modules) {
+            const QJsonObject module = value.toObject();
+            const QString name = module.value("name").toString();
+            if (name.isEmpty()) {
+                continue;
+            }
+
+            const QString moduleDir = "/run/build/" + name;
+            QString buildDir = moduleDir;
+            const QString subdir = module.value("subdir").toString();
+            if (!subdir.isEmpty()) {
+                buildDir += '/' + subdir;
+            }
+            if (module.value("builddir").toBool() || module.value("buildsystem").toString() == QLatin1String("meson")) {
+                buildDir += QLatin1String("/_flatpak_build");
+            }
+            if (buildDir != moduleDir) {
+                buildDirs.insert(name, QDir::cleanPath(buildDir));
+            }
+
+            collectBuildDirs(module.value("modules").toArray(), buildDirs);
+        }
+    }
+}
+
+FlatpakBuildCommand::FlatpakBuildCommand()
+    : m_forceClean(true)
+    , m_resume(false)
+    , m_disableUpdates(false)
+{
+}
+
+void FlatpakBuildCommand::setManifestPath(const QString& path)
+{
+    m_manifestPath = path;
+}
+
+QString FlatpakBuildCommand::manifestPath() const
+{
+    return m_manifestPath;
+}
+
+void FlatpakBuildCommand::setBuildDir(const QString& path)
+{
+    m_buildDir = path;
+}
+
+QString FlatpakBuildCommand::buildDir() const
+{
+    return m_buildDir;
+}
+
+void FlatpakBuildCommand::setStateDir(const QString& path)
+{
+    m_stateDir = path;
+}
+
+QString FlatpakBuildCommand::stateDir() const
+{
+    return m_stateDir;
+}
+
+void FlatpakBuildCommand::setAdditionalOptions(const QStringList& options)
+{
+    m_additionalOptions = options;
+}
+
+void FlatpakBuildCommand::setForceClean(bool forceClean)
+{
+    m_forceClean = forceClean;
+}
+
+void FlatpakBuildCommand::setResume(bool resume)
+{
+    m_resume = resume;
+}
+
+void FlatpakBuildCommand::setStopAt(const QString& module)
+{
+    m_stopAt = module;
+}
+
+void FlatpakBuildCommand::setDisableUpdates(bool disable)
+{
+    m_disableUpdates = disable;
+}
+
+QStringList FlatpakBuildCommand::arguments() const
+{
+    QStringList args;
+
+    if (m_forceClean) {
+        args << "--force-clean";
+    }
+
+    // Katalog wyjściowy jest czyszczony, ale ukończone moduły flatpak-builder
+    // odtwarza ze swojego cache. Aktualizacja źródeł git unieważniłaby cache,
+    // więc przy wznawianiu budujemy z już pobranych wersji
+    if (m_resume || m_disableUpdates) {
+        args << "--disable-updates";
+    }
+
+    if (!m_stateDir.isEmpty()) {
+        args << "--state-dir=" + m_stateDir;
+    }
+
+    if (!m_stopAt.isEmpty()) {
+        args << "--stop-at=" + m_stopAt;
+    }
+
+    args << m_buildDir;
+    args << m_manifestPath;
+    args << m_additionalOptions;
+
+    return args;
+}
+
+QVector<QPair<QString, QString>> FlatpakBuildCommand::sandboxPathPrefixes(const QString& appModule, const QString& appDir) const
+{
+    QVector<QPair<QString, QString>> prefixes;
+
+    QFile manifest(m_manifestPath);
+    if (manifest.open(QIODevice::ReadOnly)) {
+        // Manifesty YAML nie są tu parsowane; dla nich zostaje sam prefiks aplikacji
+        const QJsonDocument document = QJsonDocument::fromJson(manifest.readAll());
+        if (document.isObject()) {
+            collectModulePrefixes(document.object().value("modules").toArray(),
+                                  QFileInfo(m_manifestPath).absoluteDir(), prefixes);
+        }
+    }
+
+    // Moduł nazwany jak projekt to zwykle sama aplikacja
+    prefixes.append(qMakePair("/run/build/" + appModule + '/', QDir::cleanPath(appDir) + '/'));
+
+    return prefixes;
+}
+
+QHash<QString, QString> FlatpakBuildCommand::sandboxBuildDirs() const
+{
+    QHash<QString, QString> buildDirs;
+
+    QFile manifest(m_manifestPath);
+    if (manifest.open(QIODevice::ReadOnly)) {
+        const QJsonDocument document = QJsonDocument::fromJson(manifest.readAll());
+        if (document.isObject()) {
+            collectBuildDirs(document.object().value("modules").toArray(), buildDirs);
+        }
+    }
+
+    return buildDirs;
+}
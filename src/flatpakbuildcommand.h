@@ -0,0 +1,140 @@
+/**
+ * @file flatpakbuildcommand.h
+ * @brief Linia poleceń flatpak-builder wspólna dla wtyczki i narzędzi
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKBUILDCOMMAND_H
+#define FLATPAKBUILDCOMMAND_H
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @class FlatpakBuildCommand
+ * @brief Składa argumenty flatpak-builder z opcji budowania
+ *
+ * Klasa nie zależy od KDevelop, więc IDE i kdev-flatpak-cli uruchamiają
+ * budowanie z dokładnie tymi samymi opcjami cache i wznawiania.
+ */
+class FlatpakBuildCommand
+{
+public:
+    FlatpakBuildCommand();
+
+    /**
+     * @brief Ustawia ścieżkę do pliku manifestu
+     * @param path Ścieżka do manifestu
+     */
+    void setManifestPath(const QString& path);
+
+    /**
+     * @brief Zwraca ścieżkę do pliku manifestu
+     */
+    QString manifestPath() const;
+
+    /**
+     * @brief Ustawia katalog wyjściowy budowania
+     * @param path Ścieżka do katalogu
+     */
+    void setBuildDir(const QString& path);
+
+    /**
+     * @brief Zwraca katalog wyjściowy budowania
+     */
+    QString buildDir() const;
+
+    /**
+     * @brief Ustawia katalog stanu (cache modułów, pobrane źródła, ccache)
+     *
+     * Wspólny katalog stanu pozwala kilku budowaniom korzystać z tego samego
+     * cache. Pusty oznacza domyślny .flatpak-builder w katalogu roboczym.
+     *
+     * @param path Ścieżka do katalogu stanu
+     */
+    void setStateDir(const QString& path);
+
+    /**
+     * @brief Zwraca katalog stanu (pusty dla domyślnego)
+     */
+    QString stateDir() const;
+
+    /**
+     * @brief Ustawia dodatkowe opcje przekazywane na końcu linii poleceń
+     * @param options Lista opcji
+     */
+    void setAdditionalOptions(const QStringList& options);
+
+    /**
+     * @brief Czy katalog wyjściowy ma być czyszczony przed budowaniem (domyślnie tak)
+     * @param forceClean Nowa wartość
+     */
+    void setForceClean(bool forceClean);
+
+    /**
+     * @brief Włącza wznawianie z cache bez aktualizacji źródeł
+     * @param resume Nowa wartość
+     */
+    void setResume(bool resume);
+
+    /**
+     * @brief Zatrzymuje budowanie przed podanym modułem (--stop-at)
+     * @param module Nazwa modułu (pusty oznacza budowanie całości)
+     */
+    void setStopAt(const QString& module);
+
+    /**
+     * @brief Wyłącza aktualizację źródeł (git, archiwa) przed budowaniem
+     *
+     * Zachowuje sumy kontrolne modułów z poprzedniego przebiegu, dzięki
+     * czemu cache pozostaje ważny.
+     *
+     * @param disable Nowa wartość
+     */
+    void setDisableUpdates(bool disable);
+
+    /**
+     * @brief Zwraca pełną listę argumentów flatpak-builder
+     */
+    QStringList arguments() const;
+
+    /**
+     * @brief Buduje tablicę przemapowań ścieżek z piaskownicy na ścieżki lokalne
+     *
+     * Moduły manifestu ze źródłem typu "dir" są budowane w /run/build/<moduł>,
+     * więc ich prefiksy wskazują na odpowiednie katalogi lokalne.
+     *
+     * @param appModule Nazwa modułu aplikacji (zwykle nazwa projektu)
+     * @param appDir Katalog źródeł aplikacji
+     * @return Lista par (prefiks w piaskownicy, prefiks lokalny)
+     */
+    QVector<QPair<QString, QString>> sandboxPathPrefixes(const QString& appModule, const QString& appDir) const;
+
+    /**
+     * @brief Zwraca katalogi w piaskownicy, w których kompilowane są moduły
+     *
+     * Dotyczy tylko modułów, które nie kompilują się w /run/build/<moduł>:
+     * z "subdir" albo z osobnym katalogiem budowania ("builddir": true lub
+     * meson, który zawsze używa _flatpak_build). Ścieżki względne
+     * w diagnostykach kompilatora odnoszą się właśnie do tych katalogów.
+     *
+     * @return Nazwa modułu -> katalog budowania w piaskownicy
+     */
+    QHash<QString, QString> sandboxBuildDirs() const;
+
+private:
+    QString m_manifestPath;
+    QString m_buildDir;
+    QString m_stateDir;
+    QString m_stopAt;
+    QStringList m_additionalOptions;
+    bool m_forceClean;
+    bool m_resume;
+    bool m_disableUpdates;
+};
+
+#endif // FLATPAKBUILDCOMMAND_H
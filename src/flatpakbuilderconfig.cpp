@@ -16,6 +16,22 @@ FlatpakBuilderConfig::FlatpakBuilderConfig(QObject* parent)
     , m_flatpakBuilderPath(QStandardPaths::findExecutable("flatpak-builder"))
     , m_flatpakPath(QStandardPaths::findExecutable("flatpak"))
     , m_defaultBuildDir(QDir::homePath() + "/.cache/flatpak-builder")
+    , m_useBuildDaemon(false)
+    , m_matrixParallelBuilds(2)
+    , m_useDependencyLayer(false)
+    , m_dependencyLayerDir(QDir::homePath() + "/.cache/kdev-flatpak/layers")
+    , m_manifestLto(false)
+    , m_maintainExportRepo(true)
+    , m_exportRetention(5)
+    , m_exportDeltaDepth(3)
+    , m_buildSnapshots(3)
+    , m_finishedLogs(10)
+    , m_finishedLogMemory(64)
+    , m_limitResources(false)
+    , m_cpuWeight(20)
+    , m_ioWeight(20)
+    , m_memoryHighMiB(0)
+    , m_memoryMaxMiB(0)
     , m_config(KSharedConfig::openConfig()->group("FlatpakBuilder"))
 {
     load();
@@ -56,11 +72,209 @@ void FlatpakBuilderConfig::setDefaultBuildDir(const QString& dir)
     m_defaultBuildDir = dir;
 }
 
+bool FlatpakBuilderConfig::useBuildDaemon() const
+{
+    return m_useBuildDaemon;
+}
+
+void FlatpakBuilderConfig::setUseBuildDaemon(bool use)
+{
+    m_useBuildDaemon = use;
+}
+
+int FlatpakBuilderConfig::matrixParallelBuilds() const
+{
+    return m_matrixParallelBuilds;
+}
+
+void FlatpakBuilderConfig::setMatrixParallelBuilds(int count)
+{
+    m_matrixParallelBuilds = qBound(1, count, 16);
+}
+
+bool FlatpakBuilderConfig::useDependencyLayer() const
+{
+    return m_useDependencyLayer;
+}
+
+void FlatpakBuilderConfig::setUseDependencyLayer(bool use)
+{
+    m_useDependencyLayer = use;
+}
+
+QString FlatpakBuilderConfig::dependencyLayerDir() const
+{
+    return m_dependencyLayerDir;
+}
+
+void FlatpakBuilderConfig::setDependencyLayerDir(const QString& dir)
+{
+    m_dependencyLayerDir = dir;
+}
+
+bool FlatpakBuilderConfig::manifestLto() const
+{
+    return m_manifestLto;
+}
+
+void FlatpakBuilderConfig::setManifestLto(bool lto)
+{
+    m_manifestLto = lto;
+}
+
+bool FlatpakBuilderConfig::maintainExportRepo() const
+{
+    return m_maintainExportRepo;
+}
+
+void FlatpakBuilderConfig::setMaintainExportRepo(bool maintain)
+{
+    m_maintainExportRepo = maintain;
+}
+
+int FlatpakBuilderConfig::exportRetention() const
+{
+    return m_exportRetention;
+}
+
+void FlatpakBuilderConfig::setExportRetention(int count)
+{
+    m_exportRetention = qBound(1, count, 100);
+}
+
+int FlatpakBuilderConfig::exportDeltaDepth() const
+{
+    return m_exportDeltaDepth;
+}
+
+void FlatpakBuilderConfig::setExportDeltaDepth(int depth)
+{
+    m_exportDeltaDepth = qBound(1, depth, 10);
+}
+
+int FlatpakBuilderConfig::buildSnapshots() const
+{
+    return m_buildSnapshots;
+}
+
+void FlatpakBuilderConfig::setBuildSnapshots(int count)
+{
+    m_buildSnapshots = qBound(0, count, 20);
+}
+
+QString FlatpakBuilderConfig::sourceMirrorDir() const
+{
+    return m_sourceMirrorDir;
+}
+
+void FlatpakBuilderConfig::setSourceMirrorDir(const QString& dir)
+{
+    m_sourceMirrorDir = dir;
+}
+
+int FlatpakBuilderConfig::finishedLogs() const
+{
+    return m_finishedLogs;
+}
+
+void FlatpakBuilderConfig::setFinishedLogs(int count)
+{
+    m_finishedLogs = qBound(0, count, 100);
+}
+
+int FlatpakBuilderConfig::finishedLogMemory() const
+{
+    return m_finishedLogMemory;
+}
+
+void FlatpakBuilderConfig::setFinishedLogMemory(int mebibytes)
+{
+    m_finishedLogMemory = qBound(0, mebibytes, 4096);
+}
+
+bool FlatpakBuilderConfig::limitResources() const
+{
+    return m_limitResources;
+}
+
+void FlatpakBuilderConfig::setLimitResources(bool limit)
+{
+    m_limitResources = limit;
+}
+
+int FlatpakBuilderConfig::cpuWeight() const
+{
+    return m_cpuWeight;
+}
+
+void FlatpakBuilderConfig::setCpuWeight(int weight)
+{
+    m_cpuWeight = qBound(1, weight, 10000);
+}
+
+int FlatpakBuilderConfig::ioWeight() const
+{
+    return m_ioWeight;
+}
+
+void FlatpakBuilderConfig::setIoWeight(int weight)
+{
+    m_ioWeight = qBound(1, weight, 10000);
+}
+
+int FlatpakBuilderConfig::memoryHighMiB() const
+{
+    return m_memoryHighMiB;
+}
+
+void FlatpakBuilderConfig::setMemoryHighMiB(int mib)
+{
+    m_memoryHighMiB = qMax(0, mib);
+}
+
+int FlatpakBuilderConfig::memoryMaxMiB() const
+{
+    return m_memoryMaxMiB;
+}
+
+void FlatpakBuilderConfig::setMemoryMaxMiB(int mib)
+{
+    m_memoryMaxMiB = qMax(0, mib);
+}
+
+FlatpakResourceLimits::Settings FlatpakBuilderConfig::resourceLimits() const
+{
+    FlatpakResourceLimits::Settings settings;
+    settings.enabled = m_limitResources;
+    settings.cpuWeight = m_cpuWeight;
+    settings.ioWeight = m_ioWeight;
+    settings.memoryHighMiB = m_memoryHighMiB;
+    settings.memoryMaxMiB = m_memoryMaxMiB;
+    return settings;
+}
+
 void FlatpakBuilderConfig::load()
 {
     m_flatpakBuilderPath = m_config.readEntry("FlatpakBuilderPath", m_flatpakBuilderPath);
     m_flatpakPath = m_config.readEntry("FlatpakPath", m_flatpakPath);
     m_defaultBuildDir = m_config.readEntry("DefaultBuildDir", m_defaultBuildDir);
+    m_useBuildDaemon = m_config.readEntry("UseBuildDaemon", m_useBuildDaemon);
+    setMatrixParallelBuilds(m_config.readEntry("MatrixParallelBuilds", m_matrixParallelBuilds));
+    m_useDependencyLayer = m_config.readEntry("UseDependencyLayer", m_useDependencyLayer);
+    m_dependencyLayerDir = m_config.readEntry("DependencyLayerDir", m_dependencyLayerDir);
+    m_manifestLto = m_config.readEntry("ManifestLto", m_manifestLto);
+    m_maintainExportRepo = m_config.readEntry("MaintainExportRepo", m_maintainExportRepo);
+    setExportRetention(m_config.readEntry("ExportRetention", m_exportRetention));
+    setExportDeltaDepth(m_config.readEntry("ExportDeltaDepth", m_exportDeltaDepth));
+    setBuildSnapshots(m_config.readEntry("BuildSnapshots", m_buildSnapshots));
+    m_sourceMirrorDir = m_config.readEntry("SourceMirrorDir", m_sourceMirrorDir);
+    setFinishedLogs(m_config.readEntry("FinishedLogs", m_finishedLogs));
+    setFinishedLogMemory(m_config.readEntry("FinishedLogMemory", m_finishedLogMemory));
+    m_limitResources = m_config.readEntry("LimitResources", m_limitResources);
+    setCpuWeight(m_config.readEntry("CpuWeight", m_cpuWeight));
+    setIoWeight(m_config.readEntry("IoWeight", m_ioWeight));
+    setMemoryHighMiB(m_config.readEntry("MemoryHighMiB", m_memoryHighMiB));
+    setMemoryMaxMiB(m_config.readEntry("MemoryMaxMiB", m_memoryMaxMiB));
 }
 
 void FlatpakBuilderConfig::save()
@@ -68,6 +282,23 @@ void FlatpakBuilderConfig::save()
     m_config.writeEntry("FlatpakBuilderPath", m_flatpakBuilderPath);
     m_config.writeEntry("FlatpakPath", m_flatpakPath);
     m_config.writeEntry("DefaultBuildDir", m_defaultBuildDir);
+    m_config.writeEntry("UseBuildDaemon", m_useBuildDaemon);
+    m_config.writeEntry("MatrixParallelBuilds", m_matrixParallelBuilds);
+    m_config.writeEntry("UseDependencyLayer", m_useDependencyLayer);
+    m_config.writeEntry("DependencyLayerDir", m_dependencyLayerDir);
+    m_config.writeEntry("ManifestLto", m_manifestLto);
+    m_config.writeEntry("MaintainExportRepo", m_maintainExportRepo);
+    m_config.writeEntry("ExportRetention", m_exportRetention);
+    m_config.writeEntry("ExportDeltaDepth", m_exportDeltaDepth);
+    m_config.writeEntry("BuildSnapshots", m_buildSnapshots);
+    m_config.writeEntry("SourceMirrorDir", m_sourceMirrorDir);
+    m_config.writeEntry("FinishedLogs", m_finishedLogs);
+    m_config.writeEntry("FinishedLogMemory", m_finishedLogMemory);
+    m_config.writeEntry("LimitResources", m_limitResources);
+    m_config.writeEntry("CpuWeight", m_cpuWeight);
+    m_config.writeEntry("IoWeight", m_ioWeight);
+    m_config.writeEntry("MemoryHighMiB", m_memoryHighMiB);
+    m_config.writeEntry("MemoryMaxMiB", m_memoryMaxMiB);
     m_config.sync();
 }
 
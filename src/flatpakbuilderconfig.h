@@ -8,6 +8,8 @@
 #ifndef FLATPAKBUILDERCONFIG_H
 #define FLATPAKBUILDERCONFIG_H
 
+#include "flatpakresourcelimits.h"
+
 #include <QObject>
 #include <QString>
 #include <KConfigGroup>
@@ -72,6 +74,216 @@ public:
      */
     void setDefaultBuildDir(const QString& dir);
     
+    /**
+     * @brief Czy budowania mają być prowadzone przez demona kdev-flatpak-daemon
+     * @return true jeśli budowanie przetrwa restart IDE
+     */
+    bool useBuildDaemon() const;
+    
+    /**
+     * @brief Włącza lub wyłącza budowanie przez demona
+     * @param use Nowa wartość
+     */
+    void setUseBuildDaemon(bool use);
+    
+    /**
+     * @brief Zwraca liczbę wariantów budowanych równolegle w macierzy
+     * @return Limit równoległych budowań
+     */
+    int matrixParallelBuilds() const;
+    
+    /**
+     * @brief Ustawia liczbę wariantów budowanych równolegle w macierzy
+     * @param count Limit równoległych budowań
+     */
+    void setMatrixParallelBuilds(int count);
+    
+    /**
+     * @brief Czy zależności mają być budowane jako osobna, współdzielona warstwa
+     * @return true jeśli tryb warstwy zależności jest włączony
+     */
+    bool useDependencyLayer() const;
+    
+    /**
+     * @brief Włącza lub wyłącza tryb warstwy zależności
+     * @param use Nowa wartość
+     */
+    void setUseDependencyLayer(bool use);
+    
+    /**
+     * @brief Zwraca katalog przechowujący warstwy zależności
+     * @return Ścieżka do katalogu warstw
+     */
+    QString dependencyLayerDir() const;
+    
+    /**
+     * @brief Ustawia katalog warstw (może być współdzielony przez zespół)
+     * @param dir Ścieżka do katalogu warstw
+     */
+    void setDependencyLayerDir(const QString& dir);
+    
+    /**
+     * @brief Czy generowane manifesty mają włączać LTO
+     * @return true jeśli LTO ma być włączone
+     */
+    bool manifestLto() const;
+    
+    /**
+     * @brief Włącza lub wyłącza LTO w generowanych manifestach
+     * @param lto Nowa wartość
+     */
+    void setManifestLto(bool lto);
+    
+    /**
+     * @brief Czy repozytorium eksportu ma być utrzymywane po każdym eksporcie
+     * @return true jeśli przycinanie i delty statyczne są włączone
+     */
+    bool maintainExportRepo() const;
+    
+    /**
+     * @brief Włącza lub wyłącza utrzymanie repozytorium eksportu
+     * @param maintain Nowa wartość
+     */
+    void setMaintainExportRepo(bool maintain);
+    
+    /**
+     * @brief Zwraca liczbę commitów każdej gałęzi zachowywanych w repozytorium
+     * @return Limit historii
+     */
+    int exportRetention() const;
+    
+    /**
+     * @brief Ustawia liczbę zachowywanych commitów
+     * @param count Limit historii
+     */
+    void setExportRetention(int count);
+    
+    /**
+     * @brief Zwraca liczbę poprzednich commitów, od których generowane są delty
+     * @return Głębokość delt
+     */
+    int exportDeltaDepth() const;
+    
+    /**
+     * @brief Ustawia liczbę poprzednich commitów, od których generowane są delty
+     * @param depth Głębokość delt
+     */
+    void setExportDeltaDepth(int depth);
+    
+    /**
+     * @brief Zwraca liczbę zachowywanych migawek katalogu budowania
+     * @return Liczba migawek (0 wyłącza migawki)
+     */
+    int buildSnapshots() const;
+    
+    /**
+     * @brief Ustawia liczbę zachowywanych migawek katalogu budowania
+     * @param count Liczba migawek (0 wyłącza migawki)
+     */
+    void setBuildSnapshots(int count);
+    
+    /**
+     * @brief Zwraca lokalny katalog z kopiami źródeł manifestów
+     * @return Ścieżka do katalogu albo pusty napis, jeśli nie ustawiono
+     */
+    QString sourceMirrorDir() const;
+    
+    /**
+     * @brief Ustawia lokalny katalog z kopiami źródeł (pliki pod nazwą z adresu URL)
+     * @param dir Ścieżka do katalogu (pusty wyłącza)
+     */
+    void setSourceMirrorDir(const QString& dir);
+    
+    /**
+     * @brief Zwraca liczbę zachowywanych logów zakończonych zadań
+     * @return Liczba logów (0 - bez limitu)
+     */
+    int finishedLogs() const;
+    
+    /**
+     * @brief Ustawia liczbę zachowywanych logów zakończonych zadań
+     * @param count Liczba logów (0 - bez limitu); starsze są zwalniane
+     */
+    void setFinishedLogs(int count);
+    
+    /**
+     * @brief Zwraca limit pamięci zajmowanej przez logi zakończonych zadań
+     * @return Limit w MiB (0 - bez limitu)
+     */
+    int finishedLogMemory() const;
+    
+    /**
+     * @brief Ustawia limit pamięci zajmowanej przez logi zakończonych zadań
+     * @param mebibytes Limit w MiB (0 - bez limitu)
+     */
+    void setFinishedLogMemory(int mebibytes);
+    
+    /**
+     * @brief Czy budowanie ma działać z ograniczonymi zasobami
+     * @return true jeśli ograniczenia są włączone
+     */
+    bool limitResources() const;
+    
+    /**
+     * @brief Włącza lub wyłącza ograniczanie zasobów budowania
+     * @param limit Nowa wartość
+     */
+    void setLimitResources(bool limit);
+    
+    /**
+     * @brief Zwraca wagę CPU budowania (1-10000, IDE ma wagę 100)
+     * @return Waga CPU
+     */
+    int cpuWeight() const;
+    
+    /**
+     * @brief Ustawia wagę CPU budowania
+     * @param weight Waga CPU
+     */
+    void setCpuWeight(int weight);
+    
+    /**
+     * @brief Zwraca wagę IO budowania (1-10000, IDE ma wagę 100)
+     * @return Waga IO
+     */
+    int ioWeight() const;
+    
+    /**
+     * @brief Ustawia wagę IO budowania
+     * @param weight Waga IO
+     */
+    void setIoWeight(int weight);
+    
+    /**
+     * @brief Zwraca miękki limit pamięci w MiB (0 oznacza brak limitu)
+     * @return Limit pamięci
+     */
+    int memoryHighMiB() const;
+    
+    /**
+     * @brief Ustawia miękki limit pamięci, powyżej którego pamięć jest odzyskiwana
+     * @param mib Limit w MiB
+     */
+    void setMemoryHighMiB(int mib);
+    
+    /**
+     * @brief Zwraca twardy limit pamięci w MiB (0 oznacza brak limitu)
+     * @return Limit pamięci
+     */
+    int memoryMaxMiB() const;
+    
+    /**
+     * @brief Ustawia twardy limit pamięci
+     * @param mib Limit w MiB
+     */
+    void setMemoryMaxMiB(int mib);
+    
+    /**
+     * @brief Zwraca wszystkie ustawienia ograniczeń zasobów naraz
+     * @return Ustawienia dla FlatpakResourceLimits
+     */
+    FlatpakResourceLimits::Settings resourceLimits() const;
+    
     /**
      * @brief Odczytuje konfigurację z pliku
      */
@@ -92,6 +304,23 @@ private:
     QString m_flatpakBuilderPath;
     QString m_flatpakPath;
     QString m_defaultBuildDir;
+    bool m_useBuildDaemon;
+    int m_matrixParallelBuilds;
+    bool m_useDependencyLayer;
+    QString m_dependencyLayerDir;
+    bool m_manifestLto;
+    bool m_maintainExportRepo;
+    int m_exportRetention;
+    int m_exportDeltaDepth;
+    int m_buildSnapshots;
+    QString m_sourceMirrorDir;
+    int m_finishedLogs;
+    int m_finishedLogMemory;
+    bool m_limitResources;
+    int m_cpuWeight;
+    int m_ioWeight;
+    int m_memoryHighMiB;
+    int m_memoryMaxMiB;
     KConfigGroup m_config;
 };
 
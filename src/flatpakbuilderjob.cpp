@@ -6,22 +6,60 @@
  */
 
 #include "flatpakbuilderjob.h"
+#include "flatpakbuildcommand.h"
 #include "flatpakbuilderplugin.h"
 #include "flatpakbuilderconfig.h"
+#include "flatpakbuilderdebug.h"
 #include "flatpakmanifestmanager.h"
 #include "flatpakbuildoutputparser.h"
+#include "flatpaklogmodel.h"
+#include "flatpakdaemonsource.h"
+#include "flatpakdependencylayer.h"
+#include "flatpakjobstats.h"
+#include "flatpakoutputreader.h"
+#include "flatpakoutputsource.h"
+#include "flatpakprocess.h"
+#include "flatpakresourcelimits.h"
 
 #include <interfaces/icore.h>
 #include <interfaces/iproject.h>
 #include <interfaces/iruncontroller.h>
-#include <outputview/outputmodel.h>
+#include <shell/problemmodel.h>
 
 #include <KLocalizedString>
 #include <KMessageBox>
 
+#include <QDateTime>
 #include <QDir>
-#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QJsonDocument>
+#include <QRegularExpression>
 #include <QStandardPaths>
+#include <QThread>
+#include <QTimer>
+#include <QtConcurrent>
+
+namespace {
+    // Czas, jaki wątek GUI może jednorazowo poświęcić na dopisywanie linii
+    const qint64 DrainBudgetMs = 8;
+    
+    // Jak często odświeżany jest widok "Problemy" podczas budowania
+    const int ProblemsPublishIntervalMs = 250;
+    
+    // Jak często odświeżane jest zużycie zasobów w statusie zadania
+    const int ResourceReportIntervalMs = 2000;
+    
+    // Ile ostatnio używanych warstw zależności zostaje w katalogu warstw
+    const int KeptDependencyLayers = 3;
+    
+    // Wynik pomiaru zasobów z wątku roboczego
+    struct ResourceUsage {
+        QString text;
+        double cpuPercent = 0.0;
+        qint64 memoryBytes = 0;
+    };
+}
 
 FlatpakBuilderJob::FlatpakBuilderJob(FlatpakBuilderPlugin* parent, KDevelop::IProject* project, OperationType type)
     : KDevelop::OutputExecuteJob(parent)
@@ -29,7 +67,19 @@ FlatpakBuilderJob::FlatpakBuilderJob(FlatpakBuilderPlugin* parent, KDevelop::IPr
     , m_plugin(parent)
     , m_project(project)
     , m_buildDir("")
+    , m_buildingLayer(false)
+    , m_resume(false)
+    , m_attachBuildId(-1)
+    , m_parser(new FlatpakBuildOutputParser(this))
+    , m_readerThread(nullptr)
+    , m_reader(nullptr)
+    , m_problemsTimer(new QTimer(this))
+    , m_resourceTimer(new QTimer(this))
+    , m_resourceSampling(false)
+    , m_stats(std::make_shared<FlatpakJobStats>())
 {
+    qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
+    
     // Ustaw tytuł zadania w zależności od operacji
     switch (m_operationType) {
         case BuildOperation:
@@ -47,10 +97,23 @@ FlatpakBuilderJob::FlatpakBuilderJob(FlatpakBuilderPlugin* parent, KDevelop::IPr
     setWorkingDirectory(project->path().toLocalFile());
     
     // Ustaw domyślny katalog wyjściowy (jeśli nie zostanie nadpisany)
-    m_buildDir = QDir::tempPath() + "/flatpak-build-" + project->name();
+    m_buildDir = defaultBuildDir(project);
     
     // Ustaw parser wyjścia
-    setToolViewFactory(new FlatpakBuildOutputParser(this));
+    setToolViewFactory(m_parser);
+    
+    // Problemy są publikowane porcjami, a nie po każdej linii
+    m_problemsTimer->setSingleShot(true);
+    m_problemsTimer->setInterval(ProblemsPublishIntervalMs);
+    connect(m_problemsTimer, &QTimer::timeout, this, &FlatpakBuilderJob::slotPublishProblems);
+    connect(m_parser, &FlatpakBuildOutputParser::problemsChanged, m_problemsTimer, [this]() {
+        if (!m_problemsTimer->isActive()) {
+            m_problemsTimer->start();
+        }
+    });
+    
+    m_resourceTimer->setInterval(ResourceReportIntervalMs);
+    connect(m_resourceTimer, &QTimer::timeout, this, &FlatpakBuilderJob::slotReportResources);
     
     // Umożliw zatrzymanie zadania przez użytkownika
     setProperties(KDevelop::OutputExecuteJob::JobProperty::Killable);
@@ -61,6 +124,12 @@ FlatpakBuilderJob::FlatpakBuilderJob(FlatpakBuilderPlugin* parent, KDevelop::IPr
 
 FlatpakBuilderJob::~FlatpakBuilderJob()
 {
+    // Nie czekamy na zakończenie drzewa procesów - czytnik sam zamknie
+    // swój wątek, gdy flatpak-builder się zakończy. Budowanie w demonie
+    // trwa dalej i można się do niego podłączyć po ponownym otwarciu projektu
+    if (m_reader) {
+        m_reader->detach();
+    }
 }
 
 void FlatpakBuilderJob::setManifestPath(const QString& path)
@@ -73,11 +142,43 @@ void FlatpakBuilderJob::setBuildDir(const QString& path)
     m_buildDir = path;
 }
 
+QString FlatpakBuilderJob::buildDir() const
+{
+    return m_buildDir;
+}
+
+QString FlatpakBuilderJob::defaultBuildDir(KDevelop::IProject* project)
+{
+    return QDir::tempPath() + "/flatpak-build-" + project->name();
+}
+
+void FlatpakBuilderJob::setStateDir(const QString& path)
+{
+    m_stateDir = path;
+}
+
+void FlatpakBuilderJob::setVariantName(const QString& name)
+{
+    m_variantName = name;
+    m_buildDir += '-' + name;
+    setJobName(i18n("Flatpak Build: %1 (%2)", m_project->name(), name));
+}
+
 void FlatpakBuilderJob::setAdditionalOptions(const QStringList& options)
 {
     m_additionalOptions = options;
 }
 
+void FlatpakBuilderJob::setResume(bool resume)
+{
+    m_resume = resume;
+}
+
+void FlatpakBuilderJob::setAttachBuild(int buildId)
+{
+    m_attachBuildId = buildId;
+}
+
 int FlatpakBuilderJob::prepare()
 {
     // Sprawdź, czy ścieżka do manifestu jest poprawna
@@ -118,10 +219,341 @@ int FlatpakBuilderJob::prepare()
     return 0;
 }
 
+void FlatpakBuilderJob::start()
+{
+    if (prepare() != 0) {
+        emitResult();
+        return;
+    }
+    
+    // Log jest dzielony na sekcje modułów; zakończone moduły są kompresowane,
+    // a po zakończeniu zadania - cały log, gdy jego widok straci fokus
+    m_logModel = new FlatpakLogModel();
+    setModel(m_logModel);
+    m_plugin->setActiveLogModel(m_logModel);
+    connect(this, &KJob::finished, this, [this]() {
+        if (m_logModel) {
+            m_plugin->archiveLog(m_logModel);
+        }
+    });
+    m_plugin->setActiveJobStats(objectName(), m_stats);
+    startOutput();
+    
+    m_parser->problems().clear();
+    m_parser->problems().setPathPrefixes(buildCommand().sandboxPathPrefixes(m_project->name(),
+                                                                            m_project->path().toLocalFile()));
+    m_parser->problems().setModuleBuildDirs(buildCommand().sandboxBuildDirs());
+    if (m_variantName.isEmpty()) {
+        m_plugin->publishProblems({});
+    }
+    
+    if (m_resume) {
+        m_logModel->appendLine(i18n("Resuming after module %1; completed modules are restored from the flatpak-builder cache.",
+                                    m_plugin->resumePoint(m_project)));
+    }
+    
+    if (m_operationType == InstallOperation || m_operationType == ExportOperation) {
+        scanOutputTree();
+        return;
+    }
+    
+    if (m_attachBuildId < 0) {
+        // Migawka poprzedniego budowania wciąż może kopiować ten katalog
+        m_plugin->cancelSnapshot(m_buildDir);
+        prepareDependencyLayer();
+    }
+    
+    startReader();
+}
+
+void FlatpakBuilderJob::scanOutputTree()
+{
+    // Niezmienione pliki zachowują skrót z ostatniego spisu, pozostałe są
+    // haszowane równolegle - wątek GUI tylko czeka na wynik
+    const QString buildDir = m_buildDir;
+    const QString treePath = treeManifestPath("tree");
+    
+    auto* watcher = new QFutureWatcher<FlatpakTreeManifest>(this);
+    connect(watcher, &QFutureWatcher<FlatpakTreeManifest>::finished, this, &FlatpakBuilderJob::slotTreeScanned);
+    watcher->setFuture(QtConcurrent::run([buildDir, treePath]() {
+        return FlatpakTreeManifest::scan(buildDir, FlatpakTreeManifest::load(treePath));
+    }));
+}
+
+void FlatpakBuilderJob::slotTreeScanned()
+{
+    auto* watcher = static_cast<QFutureWatcher<FlatpakTreeManifest>*>(sender());
+    m_tree = watcher->result();
+    watcher->deleteLater();
+    
+    if (!m_logModel) {
+        return;
+    }
+    
+    m_tree.save(treeManifestPath("tree"));
+    
+    const bool exporting = m_operationType == ExportOperation;
+    const FlatpakTreeManifest delivered = FlatpakTreeManifest::load(
+        treeManifestPath(exporting ? "exported.tree" : "installed.tree"));
+    
+    // Pusty spis oznacza brak wyniku budowania - decyzję zostawiamy flatpak
+    if (!m_tree.isEmpty() && !delivered.isEmpty()) {
+        const FlatpakTreeDiff diff = m_tree.diff(delivered);
+        const bool repoExists = !exporting || QDir(m_buildDir + "-repo").exists();
+        
+        if (diff.isEmpty() && repoExists) {
+            m_logModel->appendLine(exporting
+                ? i18n("Build output is identical to the last export (%1 files); skipping flatpak build-export.", m_tree.fileCount())
+                : i18n("Build output is identical to the last installation (%1 files); skipping reinstall.", m_tree.fileCount()));
+            m_logModel->finish(true);
+            KDevelop::OutputExecuteJob::childProcessExited(0);
+            return;
+        }
+        
+        m_logModel->appendLine(exporting
+            ? i18n("Changes since the last export:")
+            : i18n("Changes since the last installation:"));
+        for (const QString& line : diff.summary()) {
+            m_logModel->appendLine("    " + line);
+        }
+    }
+    
+    startReader();
+}
+
+QString FlatpakBuilderJob::treeManifestPath(const QString& kind) const
+{
+    // Spisy leżą obok katalogu budowania, bo flatpak-builder czyści jego zawartość
+    return m_buildDir + '.' + kind;
+}
+
+void FlatpakBuilderJob::prepareDependencyLayer()
+{
+    // Jawny katalog stanu (macierz wariantów) ma pierwszeństwo przed warstwą
+    FlatpakBuilderConfig* config = m_plugin->config();
+    if (m_operationType != BuildOperation || !config->useDependencyLayer() || !m_stateDir.isEmpty()) {
+        return;
+    }
+    
+    m_layer.reset(new FlatpakDependencyLayer(m_manifestPath, config->dependencyLayerDir()));
+    if (!m_layer->isValid()) {
+        m_logModel->appendLine(i18n("The manifest cannot be split into dependencies and an app module; building without a dependency layer."));
+        m_layer.reset();
+        return;
+    }
+    
+    QDir().mkpath(m_layer->stateDir());
+    
+    if (m_layer->isReady()) {
+        m_logModel->appendLine(i18n("Reusing dependency layer %1; only %2 is built.",
+                                    m_layer->hash(), m_layer->appModule()));
+    } else {
+        m_buildingLayer = true;
+        m_logModel->appendLine(i18n("Building dependency layer %1 (all modules before %2).",
+                                    m_layer->hash(), m_layer->appModule()));
+    }
+}
+
+void FlatpakBuilderJob::startReader()
+{
+    // Źródło wyjścia razem z czytnikiem trafia do wątku roboczego przed
+    // uruchomieniem, więc wszystkie potoki są obsługiwane poza wątkiem GUI
+    FlatpakOutputSource* source = nullptr;
+    if (m_attachBuildId >= 0) {
+        m_logModel->appendLine(i18n("Attached to a build running in the build daemon."));
+        source = new FlatpakDaemonSource(m_attachBuildId);
+    } else if (m_plugin->config()->useBuildDaemon()) {
+        // Demon uruchomi dokładnie to samo polecenie, łącznie z limitami zasobów
+        std::unique_ptr<QProcess> process(createProcess());
+        source = new FlatpakDaemonSource(m_project->path().toLocalFile(), process->program(),
+                                         process->arguments(), process->workingDirectory());
+    } else {
+        source = new FlatpakProcessSource(static_cast<FlatpakProcess*>(createProcess()));
+    }
+    
+    qCDebug(KDEV_FLATPAKBUILDER) << "starting output reader for" << objectName();
+    m_reader = new FlatpakOutputReader(source);
+    m_reader->setStats(m_stats);
+    m_readerThread = new QThread();
+    m_reader->moveToThread(m_readerThread);
+    
+    // Wątek może przeżyć zadanie, jeśli zostało usunięte w trakcie budowania
+    connect(m_readerThread, &QThread::finished, m_reader, &QObject::deleteLater);
+    connect(m_readerThread, &QThread::finished, m_readerThread, &QObject::deleteLater);
+    connect(m_reader, &FlatpakOutputReader::started,
+            this, &FlatpakBuilderJob::slotProcessStarted, Qt::QueuedConnection);
+    connect(m_reader, &FlatpakOutputReader::batchesAvailable,
+            this, &FlatpakBuilderJob::slotBatchesAvailable, Qt::QueuedConnection);
+    connect(m_reader, &FlatpakOutputReader::finished,
+            this, &FlatpakBuilderJob::slotReaderFinished, Qt::QueuedConnection);
+    connect(m_reader, &FlatpakOutputReader::failedToStart,
+            this, &FlatpakBuilderJob::slotFailedToStart, Qt::QueuedConnection);
+    
+    m_readerThread->start();
+    QMetaObject::invokeMethod(m_reader, "start", Qt::QueuedConnection);
+}
+
+bool FlatpakBuilderJob::doKill()
+{
+    if (m_reader) {
+        // SIGTERM dla całej grupy procesów, a po chwili SIGKILL dla tych,
+        // które zignorowały sygnał lub uciekły do własnej sesji
+        m_reader->terminate();
+    }
+    
+    recordResumePoint(false);
+    
+    return true;
+}
+
+void FlatpakBuilderJob::slotProcessStarted(qint64 pid)
+{
+    m_resourceMonitor = std::make_shared<FlatpakResourceMonitor>(pid);
+    slotReportResources();
+    m_resourceTimer->start();
+}
+
+void FlatpakBuilderJob::slotReportResources()
+{
+    if (!m_resourceMonitor || m_resourceSampling) {
+        return;
+    }
+    
+    // Przejście po /proc dla setek kompilatorów nie może blokować GUI; monitor
+    // jest współdzielony, bo zadanie może zakończyć się w trakcie pomiaru
+    std::shared_ptr<FlatpakResourceMonitor> monitor = m_resourceMonitor;
+    auto* watcher = new QFutureWatcher<ResourceUsage>(this);
+    connect(watcher, &QFutureWatcher<ResourceUsage>::finished, this, [this, watcher, monitor]() {
+        watcher->deleteLater();
+        m_resourceSampling = false;
+        
+        const ResourceUsage usage = watcher->result();
+        if (m_resourceMonitor == monitor && !usage.text.isEmpty()) {
+            m_stats->setProcessUsage(usage.cpuPercent, usage.memoryBytes);
+            emit infoMessage(this, usage.text);
+        }
+    });
+    
+    m_resourceSampling = true;
+    watcher->setFuture(QtConcurrent::run([monitor]() {
+        ResourceUsage usage;
+        usage.text = monitor->describe(&usage.cpuPercent, &usage.memoryBytes);
+        return usage;
+    }));
+}
+
+void FlatpakBuilderJob::slotBatchesAvailable()
+{
+    if (m_reader) {
+        drainOutput(false);
+    }
+}
+
+void FlatpakBuilderJob::slotReaderFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    // Wszystko, co proces wypisał, jest już w kolejce
+    drainOutput(true);
+    m_problemsTimer->stop();
+    m_resourceTimer->stop();
+    m_resourceMonitor.reset();
+    slotPublishProblems();
+    
+    // Czytnik zostanie usunięty razem z zakończeniem wątku
+    m_reader = nullptr;
+    m_readerThread->quit();
+    
+    // Warstwa gotowa - drugi przebieg odtwarza ją z cache i buduje aplikację
+    if (m_buildingLayer && exitCode == 0 && exitStatus == QProcess::NormalExit && m_logModel) {
+        m_buildingLayer = false;
+        m_layer->markReady();
+        FlatpakDependencyLayer::prune(m_plugin->config()->dependencyLayerDir(), KeptDependencyLayers, m_layer->hash());
+        m_logModel->appendLine(i18n("Dependency layer %1 is ready; building %2.", m_layer->hash(), m_layer->appModule()));
+        startReader();
+        return;
+    }
+    
+    // Ponowne użycie odświeża warstwę, by nie została usunięta jako nieużywana
+    if (m_layer && !m_buildingLayer && exitCode == 0) {
+        m_layer->markReady();
+    }
+    
+    m_stats->markFinished();
+    qCDebug(KDEV_FLATPAKBUILDER) << objectName() << "finished:"
+                                 << QJsonDocument(m_stats->snapshot().toJson()).toJson(QJsonDocument::Compact);
+    
+    childProcessExited(exitStatus == QProcess::CrashExit && exitCode == 0 ? -1 : exitCode);
+}
+
+void FlatpakBuilderJob::slotFailedToStart(const QString& errorString)
+{
+    m_reader = nullptr;
+    m_readerThread->quit();
+    m_stats->markFinished();
+    
+    setError(5);
+    setErrorText(i18n("Could not start process: %1", errorString));
+    emitResult();
+}
+
+void FlatpakBuilderJob::slotPublishProblems()
+{
+    // W macierzy widok "Problemy" pokazuje połączone wyniki wszystkich wariantów
+    m_stats->setProblems(m_parser->problems().problems().size());
+    
+    if (m_variantName.isEmpty()) {
+        m_plugin->publishProblems(m_parser->problems().problems());
+    }
+}
+
+const QVector<FlatpakProblem>& FlatpakBuilderJob::problems() const
+{
+    return m_parser->problems().problems();
+}
+
+std::shared_ptr<FlatpakJobStats> FlatpakBuilderJob::stats() const
+{
+    return m_stats;
+}
+
+void FlatpakBuilderJob::drainOutput(bool untilEmpty)
+{
+    QElapsedTimer timer;
+    timer.start();
+    
+    m_reader->acknowledge();
+    
+    FlatpakOutputBatch batch;
+    QStringList lines;
+    QElapsedTimer stageTimer;
+    while (m_reader->takeBatch(batch)) {
+        // Pomiar raz na porcję - koszt nie zależy od liczby linii
+        stageTimer.start();
+        lines.reserve(batch.size());
+        for (const FlatpakOutputLine& line : qAsConst(batch)) {
+            lines << m_parser->processClassifiedLine(line);
+        }
+        m_stats->addParse(stageTimer.nsecsElapsed(), batch.size());
+        
+        if (m_logModel) {
+            stageTimer.restart();
+            m_logModel->appendBatch(batch, lines);
+            m_stats->addAppend(stageTimer.nsecsElapsed());
+        }
+        lines.clear();
+        m_stats->setQueueDepth(m_reader->pendingBatches());
+        
+        // Nie blokuj edytora: resztę kolejki przetworzymy w kolejnym przebiegu pętli zdarzeń
+        if (!untilEmpty && timer.elapsed() >= DrainBudgetMs) {
+            QTimer::singleShot(0, this, &FlatpakBuilderJob::slotBatchesAvailable);
+            return;
+        }
+    }
+}
+
 QProcess* FlatpakBuilderJob::createProcess()
 {
-    // Utwórz nowy proces
-    QProcess* process = new QProcess();
+    // Proces we własnej grupie, by przerwanie objęło też kompilatory
+    QProcess* process = new FlatpakProcess();
     
     // Ustaw katalog roboczy
     process->setWorkingDirectory(workingDirectory());
@@ -132,7 +564,7 @@ QProcess* FlatpakBuilderJob::createProcess()
     switch (m_operationType) {
         case BuildOperation:
             process->setProgram(config->flatpakBuilderPath());
-            process->setArguments(prepareArguments());
+            process->setArguments(buildCommand().arguments());
             break;
             
         case InstallOperation:
@@ -142,29 +574,75 @@ QProcess* FlatpakBuilderJob::createProcess()
             break;
     }
     
+    // Budowanie nie może zagłodzić edytora, parsera ani clangd
+    FlatpakResourceLimits limits(config->resourceLimits());
+    if (limits.method() != FlatpakResourceLimits::NoLimits) {
+        QString unitName = QString("kdev-flatpak-%1-%2").arg(m_project->name()).arg(QDateTime::currentMSecsSinceEpoch());
+        unitName.replace(QRegularExpression("[^A-Za-z0-9:_.\\-]"), "_");
+        limits.apply(process, unitName);
+    }
+    
     return process;
 }
 
 void FlatpakBuilderJob::childProcessExited(int exitCode)
 {
+    // Widok mógł zostać zamknięty razem z modelem
+    if (!m_logModel) {
+        KDevelop::OutputExecuteJob::childProcessExited(exitCode);
+        return;
+    }
+    
+    // Zwiń udane moduły; moduł z błędami zostaje rozwinięty
+    m_logModel->finish(exitCode == 0);
+    
+    recordResumePoint(exitCode == 0);
+    
+    // Spis drzewa zapamiętuje, co zostało dostarczone; po budowaniu jest
+    // odświeżany w tle, by eksport haszował tylko zmienione pliki
+    if (exitCode == 0) {
+        switch (m_operationType) {
+            case BuildOperation: {
+                const QString buildDir = m_buildDir;
+                const QString treePath = treeManifestPath("tree");
+                QtConcurrent::run([buildDir, treePath]() {
+                    FlatpakTreeManifest::scan(buildDir, FlatpakTreeManifest::load(treePath)).save(treePath);
+                });
+                
+                // Migawka tylko czyta katalog, więc może działać obok spisu;
+                // warianty macierzy i PGO to katalogi pośrednie
+                if (m_variantName.isEmpty()) {
+                    m_plugin->snapshotBuildDir(buildDir, m_manifestPath);
+                }
+                break;
+            }
+                
+            case InstallOperation:
+                m_tree.save(treeManifestPath("installed.tree"));
+                break;
+                
+            case ExportOperation:
+                m_tree.save(treeManifestPath("exported.tree"));
+                m_plugin->maintainExportRepo(m_buildDir + "-repo");
+                break;
+        }
+    }
+    
     // Obsługa zakończenia procesu
     if (exitCode != 0) {
-        KDevelop::OutputModel* model = qobject_cast<KDevelop::OutputModel*>(outputModel());
-        if (model) {
-            model->appendLine(i18n("Process exited with code %1", exitCode));
-        }
+        m_logModel->appendLine(i18n("Process exited with code %1", exitCode));
     } else {
         switch (m_operationType) {
             case BuildOperation:
-                outputModel()->appendLine(i18n("Flatpak successfully built."));
+                m_logModel->appendLine(i18n("Flatpak successfully built."));
                 break;
                 
             case InstallOperation:
-                outputModel()->appendLine(i18n("Flatpak successfully installed."));
+                m_logModel->appendLine(i18n("Flatpak successfully installed."));
                 break;
                 
             case ExportOperation:
-                outputModel()->appendLine(i18n("Flatpak successfully exported to bundle."));
+                m_logModel->appendLine(i18n("Flatpak successfully exported to bundle."));
                 break;
         }
     }
@@ -173,23 +651,43 @@ void FlatpakBuilderJob::childProcessExited(int exitCode)
     KDevelop::OutputExecuteJob::childProcessExited(exitCode);
 }
 
-QStringList FlatpakBuilderJob::prepareArguments() const
+void FlatpakBuilderJob::recordResumePoint(bool success)
 {
-    QStringList args;
-    
-    // Dodaj domyślne opcje
-    args << "--force-clean";
-    
-    // Dodaj ścieżkę do katalogu wyjściowego
-    args << m_buildDir;
+    // Punkt wznowienia dotyczy głównego manifestu, nie wariantów macierzy
+    if (m_operationType != BuildOperation || !m_logModel || !m_variantName.isEmpty()) {
+        return;
+    }
     
-    // Dodaj ścieżkę do manifestu
-    args << m_manifestPath;
+    if (success) {
+        m_plugin->setResumePoint(m_project, QString());
+        return;
+    }
     
-    // Dodaj dodatkowe opcje
-    args << m_additionalOptions;
+    // Przy wznawianiu bez nowych ukończonych modułów zostaje poprzedni punkt
+    const QStringList completed = m_logModel->completedModules();
+    if (!completed.isEmpty()) {
+        m_plugin->setResumePoint(m_project, completed.last());
+    }
+}
+
+FlatpakBuildCommand FlatpakBuilderJob::buildCommand() const
+{
+    FlatpakBuildCommand command;
+    command.setManifestPath(m_manifestPath);
+    command.setBuildDir(m_buildDir);
+    command.setStateDir(m_stateDir);
+    command.setAdditionalOptions(m_additionalOptions);
+    command.setResume(m_resume);
     
-    return args;
+    if (m_layer) {
+        // Bez aktualizacji źródeł sumy kontrolne zależności pasują do cache warstwy
+        command.setStateDir(m_layer->stateDir());
+        command.setDisableUpdates(!m_buildingLayer);
+        if (m_buildingLayer) {
+            command.setStopAt(m_layer->appModule());
+        }
+    }
+    return command;
 }
 
 QStringList FlatpakBuilderJob::prepareFlatpakArguments() const
@@ -209,6 +707,11 @@ QStringList FlatpakBuilderJob::prepareFlatpakArguments() const
             
         case ExportOperation:
             args << "build-export";
+            
+            // Podsumowanie odświeży utrzymanie repozytorium po przycięciu i deltach
+            if (m_plugin->config()->maintainExportRepo()) {
+                args << "--no-update-summary";
+            }
             args << m_buildDir + "-repo";  // Repozytorium
             args << m_buildDir;           // Katalog budowania
             break;
@@ -8,10 +8,26 @@
 #ifndef FLATPAKBUILDERJOB_H
 #define FLATPAKBUILDERJOB_H
 
+#include "flatpaktreemanifest.h"
+
 #include <outputview/outputexecutejob.h>
+#include <QPointer>
 #include <QProcess>
+#include <QVector>
+
+#include <memory>
 
+class FlatpakBuildCommand;
 class FlatpakBuilderPlugin;
+class FlatpakBuildOutputParser;
+class FlatpakDependencyLayer;
+class FlatpakJobStats;
+class FlatpakLogModel;
+class FlatpakOutputReader;
+class FlatpakResourceMonitor;
+struct FlatpakProblem;
+class QThread;
+class QTimer;
 
 namespace KDevelop {
     class IProject;
@@ -64,11 +80,86 @@ public:
      */
     void setBuildDir(const QString& path);
     
+    /**
+     * @brief Zwraca katalog wyjściowy
+     * @return Ścieżka do katalogu wyjściowego (z sufiksem wariantu)
+     */
+    QString buildDir() const;
+    
+    /**
+     * @brief Zwraca domyślny katalog wyjściowy projektu
+     * @param project Projekt
+     * @return Ścieżka używana, gdy katalog nie zostanie ustawiony
+     */
+    static QString defaultBuildDir(KDevelop::IProject* project);
+    
+    /**
+     * @brief Ustawia katalog stanu flatpak-builder (cache, pobrane źródła)
+     *
+     * Warianty budowane w macierzy dzielą jeden katalog stanu, więc moduły
+     * wspólne dla kilku manifestów trafiają do cache tylko raz.
+     *
+     * @param path Ścieżka do katalogu stanu (pusty oznacza domyślny)
+     */
+    void setStateDir(const QString& path);
+    
+    /**
+     * @brief Oznacza zadanie jako jeden wariant budowania macierzowego
+     *
+     * Nazwa wariantu trafia do tytułu zadania i katalogu wyjściowego, a
+     * problemy nie są publikowane osobno - zbiera je zadanie macierzy.
+     *
+     * @param name Nazwa wariantu
+     */
+    void setVariantName(const QString& name);
+    
     /**
      * @brief Ustawia dodatkowe opcje dla flatpak-builder
      * @param options Lista dodatkowych opcji
      */
     void setAdditionalOptions(const QStringList& options);
+    
+    /**
+     * @brief Włącza wznawianie przerwanego budowania
+     *
+     * Moduły ukończone w poprzednim przebiegu są odtwarzane z cache
+     * flatpak-builder zamiast budowania od nowa.
+     *
+     * @param resume Czy wznowić budowanie
+     */
+    void setResume(bool resume);
+    
+    /**
+     * @brief Podłącza zadanie do budowania prowadzonego już przez demona
+     *
+     * Zamiast uruchamiać proces, zadanie odtwarza log budowania od początku
+     * i śledzi je do zakończenia.
+     *
+     * @param buildId Identyfikator budowania w demonie
+     */
+    void setAttachBuild(int buildId);
+
+    /**
+     * @brief Uruchamia zadanie
+     *
+     * Proces i jego potoki obsługuje FlatpakOutputReader w osobnym wątku;
+     * wątek GUI dostaje jedynie gotowe, sklasyfikowane porcje linii.
+     * W trybie demona proces uruchamia kdev-flatpak-daemon, a czytnik
+     * śledzi jego plik logu.
+     */
+    void start() override;
+
+    /**
+     * @brief Zwraca problemy zebrane podczas budowania
+     * @return Zdeduplikowane błędy i ostrzeżenia
+     */
+    const QVector<FlatpakProblem>& problems() const;
+
+    /**
+     * @brief Zwraca liczniki potoku wyjścia tego zadania
+     * @return Liczniki współdzielone z wątkiem czytającym
+     */
+    std::shared_ptr<FlatpakJobStats> stats() const;
 
 protected:
     /**
@@ -89,19 +180,120 @@ protected:
      */
     void childProcessExited(int exitCode) override;
 
+    /**
+     * @brief Przerywa działający proces
+     * @return true jeśli zadanie zostało przerwane
+     */
+    bool doKill() override;
+
+private Q_SLOTS:
+    /**
+     * @brief Slot wywoływany po uruchomieniu procesu
+     * @param pid Identyfikator procesu
+     */
+    void slotProcessStarted(qint64 pid);
+
+    /**
+     * @brief Pokazuje w statusie zadania bieżące zużycie zasobów
+     */
+    void slotReportResources();
+
+    /**
+     * @brief Slot wywoływany, gdy wątek czytający ma gotowe porcje linii
+     */
+    void slotBatchesAvailable();
+
+    /**
+     * @brief Slot wywoływany po zakończeniu procesu i odczytaniu całego wyjścia
+     * @param exitCode Kod wyjścia procesu
+     * @param exitStatus Sposób zakończenia procesu
+     */
+    void slotReaderFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    /**
+     * @brief Slot wywoływany, gdy proces nie mógł zostać uruchomiony
+     * @param errorString Opis błędu
+     */
+    void slotFailedToStart(const QString& errorString);
+
+    /**
+     * @brief Przekazuje zebrane problemy do widoku "Problemy"
+     */
+    void slotPublishProblems();
+
+    /**
+     * @brief Porównuje przeskanowany katalog budowania z ostatnio dostarczonym
+     *
+     * Identyczne drzewo kończy eksport lub instalację bez uruchamiania
+     * flatpak; w przeciwnym razie do logu trafia podsumowanie zmian.
+     */
+    void slotTreeScanned();
+
 private:
     OperationType m_operationType;
     FlatpakBuilderPlugin* m_plugin;
     KDevelop::IProject* m_project;
     QString m_manifestPath;
     QString m_buildDir;
+    QString m_stateDir;
+    QString m_variantName;
     QStringList m_additionalOptions;
+    std::unique_ptr<FlatpakDependencyLayer> m_layer;
+    bool m_buildingLayer;
+    FlatpakTreeManifest m_tree;
+    bool m_resume;
+    int m_attachBuildId;
+    FlatpakBuildOutputParser* m_parser;
+    QThread* m_readerThread;
+    FlatpakOutputReader* m_reader;
+    QPointer<FlatpakLogModel> m_logModel;
+    QTimer* m_problemsTimer;
+    QTimer* m_resourceTimer;
+    std::shared_ptr<FlatpakResourceMonitor> m_resourceMonitor;
+    bool m_resourceSampling;
+    std::shared_ptr<FlatpakJobStats> m_stats;
     
     /**
-     * @brief Przygotowuje argumenty dla procesu flatpak-builder
-     * @return Lista argumentów
+     * @brief Tworzy źródło wyjścia i uruchamia czytnik w wątku roboczym
+     */
+    void startReader();
+    
+    /**
+     * @brief Skanuje katalog budowania w puli wątków przed eksportem lub instalacją
+     */
+    void scanOutputTree();
+    
+    /**
+     * @brief Zwraca ścieżkę spisu drzewa dla katalogu budowania
+     * @param kind Rodzaj spisu: "tree", "exported.tree" albo "installed.tree"
+     */
+    QString treeManifestPath(const QString& kind) const;
+    
+    /**
+     * @brief Przygotowuje warstwę zależności, jeśli tryb warstwy jest włączony
+     *
+     * Gdy warstwa nie jest jeszcze zbudowana, pierwszy przebieg kończy się
+     * przed modułem aplikacji, a drugi buduje aplikację na gotowym cache.
+     */
+    void prepareDependencyLayer();
+    
+    /**
+     * @brief Przekazuje porcje linii z kolejki do modelu wyjścia
+     * @param untilEmpty Opróżnij kolejkę całkowicie, ignorując limit czasu
+     */
+    void drainOutput(bool untilEmpty);
+    
+    /**
+     * @brief Zapamiętuje ostatni ukończony moduł jako punkt wznowienia
+     * @param success Czy budowanie zakończyło się powodzeniem (usuwa punkt)
+     */
+    void recordResumePoint(bool success);
+    
+    /**
+     * @brief Składa linię poleceń flatpak-builder z opcji zadania
+     * @return Polecenie budowania
      */
-    QStringList prepareArguments() const;
+    FlatpakBuildCommand buildCommand() const;
     
     /**
      * @brief Przygotowuje argumenty dla procesu flatpak (install/export)
@@ -9,40 +9,175 @@
 #include "flatpakbuilderconfig.h"
 #include "flatpakmanifestmanager.h"
 #include "flatpakbuilderjob.h"
+#include "flatpakbundleanalyzer.h"
+#include "flatpakchecksumjob.h"
+#include "flatpakdaemonsource.h"
+#include "flatpakjobstats.h"
+#include "flatpaklogarchive.h"
+#include "flatpaklogmodel.h"
+#include "flatpakmanifestgenerator.h"
+#include "flatpakmanifestmodel.h"
+#include "flatpakmanifestscanner.h"
+#include "flatpakmanifestsupport.h"
+#include "flatpakmatrixjob.h"
+#include "flatpakpgojob.h"
+#include "flatpakrepomaintenancejob.h"
+#include "flatpaksnapshotjob.h"
+#include "ui/flatpakstatsview.h"
+#include "ui/flatpakvariantdialog.h"
 
 #include <interfaces/icore.h>
 #include <interfaces/iuicontroller.h>
 #include <interfaces/iproject.h>
 #include <interfaces/iprojectcontroller.h>
+#include <interfaces/idocument.h>
 #include <interfaces/idocumentcontroller.h>
+#include <interfaces/ilanguagecontroller.h>
+#include <interfaces/iplugincontroller.h>
+#include <interfaces/iruncontroller.h>
+#include <language/editor/documentrange.h>
 #include <project/projectmodel.h>
+#include <serialization/indexedstring.h>
+#include <shell/problem.h>
+#include <shell/problemmodel.h>
+#include <shell/problemmodelset.h>
 
 #include <KPluginFactory>
 #include <KLocalizedString>
 #include <KActionCollection>
+#include <KConfigGroup>
 #include <KMessageBox>
+#include <KParts/MainWindow>
+#include <KPluginMetaData>
+#include <KTextEditor/Document>
 
 #include <QAction>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QInputDialog>
+#include <QLineEdit>
+#include <QLocale>
+#include <QSaveFile>
+#include <QSignalBlocker>
+#include <QStatusBar>
+#include <QTimer>
 #include <QUrl>
+#include <QtConcurrent>
 
 K_PLUGIN_FACTORY_WITH_JSON(FlatpakBuilderFactory, "kdevflatpakbuilder.json", registerPlugin<FlatpakBuilderPlugin>();)
 
+namespace {
+    const QString ProblemModelId = QStringLiteral("FlatpakBuilder");
+    
+    // Grupa w konfiguracji projektu z punktem wznowienia budowania
+    const QString ProjectConfigGroup = QStringLiteral("Flatpak Builder");
+    
+    // Menedżery projektów KDevelop i odpowiadające im systemy budowania
+    FlatpakManifestGenerator::BuildSystem projectBuildSystem(KDevelop::IProject* project)
+    {
+        if (!project->managerPlugin()) {
+            return FlatpakManifestGenerator::UnknownBuildSystem;
+        }
+        
+        const QString pluginId = KDevelop::ICore::self()->pluginController()->pluginInfo(project->managerPlugin()).pluginId();
+        if (pluginId == QLatin1String("KDevCMakeManager")) {
+            return FlatpakManifestGenerator::CMake;
+        } else if (pluginId == QLatin1String("KDevMesonManager")) {
+            return FlatpakManifestGenerator::Meson;
+        } else if (pluginId == QLatin1String("KDevQMakeManager")) {
+            return FlatpakManifestGenerator::QMake;
+        } else if (pluginId == QLatin1String("KDevAutotoolsImporter")) {
+            return FlatpakManifestGenerator::Autotools;
+        }
+        return FlatpakManifestGenerator::UnknownBuildSystem;
+    }
+}
+
 FlatpakBuilderPlugin::FlatpakBuilderPlugin(QObject* parent, const QVariantList& args)
     : KDevelop::IPlugin("kdevflatpakbuilder", parent)
-    , m_config(new FlatpakBuilderConfig(this))
-    , m_manifestManager(new FlatpakManifestManager(this))
+    , m_config(nullptr)
+    , m_manifestManager(nullptr)
+    , m_problemModel(nullptr)
+    , m_manifestSupport(nullptr)
+    , m_statsViewFactory(nullptr)
+    , m_watchMode(nullptr)
+    , m_logArchive(nullptr)
 {
     Q_UNUSED(args);
     
+    // Wtyczka jest ładowana w każdej sesji, także bez projektów Flatpak, więc
+    // konfiguracja, menedżer manifestów i model problemów powstają dopiero
+    // przy pierwszym użyciu - konstruktor tylko rejestruje akcje
     setXMLFile("kdevflatpakbuilder.rc");
-    
     setupActions();
+    
+    // Budowanie prowadzone przez demona mogło przetrwać restart IDE; projekty
+    // otwarte przed załadowaniem wtyczki są sprawdzane po powrocie do pętli zdarzeń
+    connect(core()->projectController(), &KDevelop::IProjectController::projectOpened,
+            this, &FlatpakBuilderPlugin::slotProjectOpened);
+    QTimer::singleShot(0, this, [this]() {
+        const auto projects = core()->projectController()->projects();
+        for (KDevelop::IProject* project : projects) {
+            slotProjectOpened(project);
+        }
+    });
+    
+    // Zamknięcie obserwowanego projektu wyłącza tryb obserwacji
+    connect(core()->projectController(), &KDevelop::IProjectController::projectClosing,
+            this, [this](KDevelop::IProject* project) {
+        if (m_watchMode && m_watchMode->project() == project) {
+            m_watchAction->setChecked(false);
+        }
+    });
 }
 
 FlatpakBuilderPlugin::~FlatpakBuilderPlugin()
 {
 }
 
+void FlatpakBuilderPlugin::unload()
+{
+    if (m_problemModel) {
+        core()->languageController()->problemModelSet()->removeModel(ProblemModelId);
+    }
+    
+    delete m_manifestSupport;
+    m_manifestSupport = nullptr;
+    
+    delete m_watchMode;
+    m_watchMode = nullptr;
+    
+    if (m_statsViewFactory) {
+        core()->uiController()->removeToolView(m_statsViewFactory);
+        m_statsViewFactory = nullptr;
+    }
+}
+
+void FlatpakBuilderPlugin::enableFlatpakSupport()
+{
+    if (m_statsViewFactory) {
+        return;
+    }
+    
+    // Widżet panelu powstaje dopiero przy pierwszym otwarciu
+    m_statsViewFactory = new FlatpakStatsViewFactory(this);
+    core()->uiController()->addToolView(i18n("Flatpak Build Stats"), m_statsViewFactory);
+    
+    // Podpowiedzi i diagnostyka manifestów; dokumenty otwarte wcześniej
+    // są sprawdzane po powrocie do pętli zdarzeń
+    connect(core()->documentController(), &KDevelop::IDocumentController::textDocumentCreated,
+            this, &FlatpakBuilderPlugin::slotDocumentCreated);
+    QTimer::singleShot(0, this, [this]() {
+        const auto documents = core()->documentController()->openDocuments();
+        for (KDevelop::IDocument* document : documents) {
+            slotDocumentCreated(document);
+        }
+    });
+}
+
 QString FlatpakBuilderPlugin::name() const
 {
     return i18n("Flatpak Builder");
@@ -55,6 +190,59 @@ void FlatpakBuilderPlugin::setupActions()
     connect(m_buildAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotBuildFlatpak);
     actionCollection()->addAction("flatpak_build", m_buildAction);
     
+    // Akcja Watch and Rebuild; ikona i podpowiedź pokazują stan obserwacji
+    m_watchAction = new QAction(this);
+    m_watchAction->setCheckable(true);
+    connect(m_watchAction, &QAction::toggled, this, &FlatpakBuilderPlugin::slotToggleWatchMode);
+    actionCollection()->addAction("flatpak_watch", m_watchAction);
+    updateWatchAction(FlatpakWatchMode::Idle);
+    
+    // Akcja Resume Flatpak Build
+    m_resumeBuildAction = new QAction(QIcon::fromTheme("media-playback-start"), i18n("Resume Flatpak Build"), this);
+    m_resumeBuildAction->setToolTip(i18n("Continue an interrupted build, reusing modules that already finished"));
+    connect(m_resumeBuildAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotResumeBuild);
+    actionCollection()->addAction("flatpak_resume_build", m_resumeBuildAction);
+    
+    // Akcja Build Flatpak Variants
+    m_buildVariantsAction = new QAction(QIcon::fromTheme("view-list-details"), i18n("Build Flatpak Variants..."), this);
+    m_buildVariantsAction->setToolTip(i18n("Build several manifests of the project in parallel, sharing the flatpak-builder cache"));
+    connect(m_buildVariantsAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotBuildVariants);
+    actionCollection()->addAction("flatpak_build_variants", m_buildVariantsAction);
+    
+    // Akcja Build with PGO
+    m_buildPgoAction = new QAction(QIcon::fromTheme("speedometer"), i18n("Build with PGO..."), this);
+    m_buildPgoAction->setToolTip(i18n("Build with profile-guided optimization trained on a workload run inside the sandbox"));
+    connect(m_buildPgoAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotBuildPgo);
+    actionCollection()->addAction("flatpak_build_pgo", m_buildPgoAction);
+    
+    // Akcja Analyze Bundle Size
+    m_analyzeBundleAction = new QAction(QIcon::fromTheme("office-chart-pie"), i18n("Analyze Bundle Size"), this);
+    m_analyzeBundleAction->setToolTip(i18n("Find what takes space in the build output and suggest cleanup entries for the manifest"));
+    connect(m_analyzeBundleAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotAnalyzeBundle);
+    actionCollection()->addAction("flatpak_analyze_bundle", m_analyzeBundleAction);
+    
+    // Akcja Restore Build Snapshot
+    m_restoreSnapshotAction = new QAction(QIcon::fromTheme("edit-undo"), i18n("Restore Build Snapshot..."), this);
+    m_restoreSnapshotAction->setToolTip(i18n("Roll the build directory back to the state after one of the last successful builds"));
+    connect(m_restoreSnapshotAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotRestoreSnapshot);
+    actionCollection()->addAction("flatpak_restore_snapshot", m_restoreSnapshotAction);
+    
+    // Akcje profilowania w piaskownicy
+    m_profilePerfAction = new QAction(QIcon::fromTheme("office-chart-line"), i18n("Run under perf"), this);
+    m_profilePerfAction->setToolTip(i18n("Profile CPU usage of the installed Flatpak inside its sandbox"));
+    connect(m_profilePerfAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotProfilePerf);
+    actionCollection()->addAction("flatpak_profile_perf", m_profilePerfAction);
+    
+    m_profileHeaptrackAction = new QAction(QIcon::fromTheme("office-chart-area"), i18n("Run under heaptrack"), this);
+    m_profileHeaptrackAction->setToolTip(i18n("Profile memory allocations of the installed Flatpak inside its sandbox"));
+    connect(m_profileHeaptrackAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotProfileHeaptrack);
+    actionCollection()->addAction("flatpak_profile_heaptrack", m_profileHeaptrackAction);
+    
+    m_profileMassifAction = new QAction(QIcon::fromTheme("office-chart-area-stacked"), i18n("Run under Valgrind Massif"), this);
+    m_profileMassifAction->setToolTip(i18n("Profile heap usage over time of the installed Flatpak inside its sandbox"));
+    connect(m_profileMassifAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotProfileMassif);
+    actionCollection()->addAction("flatpak_profile_massif", m_profileMassifAction);
+    
     // Akcja Install Flatpak
     m_installAction = new QAction(QIcon::fromTheme("flatpak-install"), i18n("Install Flatpak"), this);
     connect(m_installAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotInstallFlatpak);
@@ -74,21 +262,73 @@ void FlatpakBuilderPlugin::setupActions()
     m_editManifestAction = new QAction(QIcon::fromTheme("document-edit"), i18n("Edit Manifest"), this);
     connect(m_editManifestAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotEditManifest);
     actionCollection()->addAction("flatpak_edit_manifest", m_editManifestAction);
+    
+    // Akcja Update Source Checksums
+    m_updateChecksumsAction = new QAction(QIcon::fromTheme("security-high"), i18n("Update Source Checksums"), this);
+    m_updateChecksumsAction->setToolTip(i18n("Download and hash archive and file sources, then write their checksums into the manifest"));
+    connect(m_updateChecksumsAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotUpdateChecksums);
+    actionCollection()->addAction("flatpak_update_checksums", m_updateChecksumsAction);
+    
+    // Akcja Search Build Log
+    m_searchLogAction = new QAction(QIcon::fromTheme("edit-find"), i18n("Search Build Log..."), this);
+    m_searchLogAction->setToolTip(i18n("Search the last build log; enclose the query in slashes to use a regular expression"));
+    connect(m_searchLogAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotSearchLog);
+    actionCollection()->addAction("flatpak_search_log", m_searchLogAction);
+    
+    // Akcja Clear Log Search
+    m_clearLogSearchAction = new QAction(QIcon::fromTheme("edit-clear"), i18n("Clear Log Search"), this);
+    connect(m_clearLogSearchAction, &QAction::triggered, this, &FlatpakBuilderPlugin::slotClearLogSearch);
+    actionCollection()->addAction("flatpak_clear_log_search", m_clearLogSearchAction);
 }
 
 bool FlatpakBuilderPlugin::hasManifest(KDevelop::IProject* project) const
 {
-    return m_manifestManager->hasManifest(project);
+    return manifestManager()->hasManifest(project);
 }
 
 void FlatpakBuilderPlugin::createManifest(KDevelop::IProject* project)
 {
-    m_manifestManager->createManifest(project);
+    const QString projectDir = project->path().toLocalFile();
+    
+    // Menedżer projektu KDevelop ma pierwszeństwo przed wykrywaniem po plikach
+    FlatpakManifestGenerator generator(projectDir, project->name());
+    generator.setBuildSystem(projectBuildSystem(project));
+    generator.setLto(config()->manifestLto());
+    generator.setInstalledRuntimes(FlatpakManifestGenerator::installedRuntimes(config()->flatpakPath()));
+    
+    const QString manifestPath = QDir(projectDir).filePath(generator.appId() + ".json");
+    if (QFile::exists(manifestPath)) {
+        const int response = KMessageBox::warningContinueCancel(
+            core()->uiController()->activeMainWindow(),
+            i18n("The manifest %1 already exists. Do you want to overwrite it?", manifestPath),
+            i18n("Flatpak Builder"), KStandardGuiItem::overwrite());
+        if (response != KMessageBox::Continue) {
+            return;
+        }
+    }
+    
+    QSaveFile file(manifestPath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(generator.toJson()) < 0 || !file.commit()) {
+        KMessageBox::error(core()->uiController()->activeMainWindow(),
+                           i18n("Could not write the Flatpak manifest %1: %2", manifestPath, file.errorString()),
+                           i18n("Flatpak Builder"));
+        return;
+    }
+    
+    enableFlatpakSupport();
+    core()->documentController()->openDocument(QUrl::fromLocalFile(manifestPath));
+    
+    if (!generator.isSdkInstalled()) {
+        KMessageBox::information(core()->uiController()->activeMainWindow(),
+                                 i18n("The runtime used by the manifest is not installed. Install it before building with:\n\n"
+                                      "flatpak install flathub %1", generator.runtimeRefs().join(' ')),
+                                 i18n("Flatpak Builder"));
+    }
 }
 
 void FlatpakBuilderPlugin::editManifest(KDevelop::IProject* project)
 {
-    QUrl manifestUrl = m_manifestManager->manifestUrl(project);
+    QUrl manifestUrl = manifestManager()->manifestUrl(project);
     if (manifestUrl.isValid()) {
         core()->documentController()->openDocument(manifestUrl);
     } else {
@@ -117,7 +357,7 @@ KJob* FlatpakBuilderPlugin::build(KDevelop::ProjectBaseItem* item)
         }
     }
     
-    QString manifestPath = m_manifestManager->manifestUrl(project).toLocalFile();
+    QString manifestPath = manifestManager()->manifestUrl(project).toLocalFile();
     
     FlatpakBuilderJob* job = new FlatpakBuilderJob(this, project, FlatpakBuilderJob::BuildOperation);
     job->setManifestPath(manifestPath);
@@ -138,7 +378,7 @@ KJob* FlatpakBuilderPlugin::install(KDevelop::ProjectBaseItem* item)
         return nullptr;
     }
     
-    QString manifestPath = m_manifestManager->manifestUrl(project).toLocalFile();
+    QString manifestPath = manifestManager()->manifestUrl(project).toLocalFile();
     
     FlatpakBuilderJob* job = new FlatpakBuilderJob(this, project, FlatpakBuilderJob::InstallOperation);
     job->setManifestPath(manifestPath);
@@ -157,7 +397,7 @@ KJob* FlatpakBuilderPlugin::exportBundle(KDevelop::IProject* project)
         return nullptr;
     }
     
-    QString manifestPath = m_manifestManager->manifestUrl(project).toLocalFile();
+    QString manifestPath = manifestManager()->manifestUrl(project).toLocalFile();
     
     FlatpakBuilderJob* job = new FlatpakBuilderJob(this, project, FlatpakBuilderJob::ExportOperation);
     job->setManifestPath(manifestPath);
@@ -167,9 +407,242 @@ KJob* FlatpakBuilderPlugin::exportBundle(KDevelop::IProject* project)
 
 FlatpakBuilderConfig* FlatpakBuilderPlugin::config() const
 {
+    // Konstruktor konfiguracji szuka programów w PATH i czyta KConfig
+    if (!m_config) {
+        m_config = new FlatpakBuilderConfig(const_cast<FlatpakBuilderPlugin*>(this));
+    }
     return m_config;
 }
 
+KDevelop::ProblemModel* FlatpakBuilderPlugin::problemModel() const
+{
+    // Zakładka w widoku "Problemy" pojawia się dopiero przy pierwszym budowaniu
+    if (!m_problemModel) {
+        m_problemModel = new KDevelop::ProblemModel(const_cast<FlatpakBuilderPlugin*>(this));
+        m_problemModel->setFeatures(KDevelop::ProblemModel::SeverityFilter | KDevelop::ProblemModel::Grouping);
+        core()->languageController()->problemModelSet()->addModel(ProblemModelId, i18n("Flatpak Builder"), m_problemModel);
+    }
+    return m_problemModel;
+}
+
+FlatpakManifestManager* FlatpakBuilderPlugin::manifestManager() const
+{
+    if (!m_manifestManager) {
+        m_manifestManager = new FlatpakManifestManager(const_cast<FlatpakBuilderPlugin*>(this));
+    }
+    return m_manifestManager;
+}
+
+FlatpakManifestSupport* FlatpakBuilderPlugin::manifestSupport()
+{
+    if (!m_manifestSupport) {
+        m_manifestSupport = new FlatpakManifestSupport(this);
+    }
+    return m_manifestSupport;
+}
+
+void FlatpakBuilderPlugin::slotDocumentCreated(KDevelop::IDocument* document)
+{
+    // Większość otwieranych plików to źródła - odrzucamy je po samym adresie
+    if (!FlatpakManifestSupport::isManifestUrl(document->url())) {
+        return;
+    }
+    
+    KTextEditor::Document* textDocument = document->textDocument();
+    if (textDocument && FlatpakManifestSupport::isManifest(textDocument)) {
+        manifestSupport()->addDocument(textDocument);
+    }
+}
+
+void FlatpakBuilderPlugin::publishProblems(const QVector<FlatpakProblem>& problems)
+{
+    QVector<KDevelop::IProblem::Ptr> converted;
+    converted.reserve(problems.size());
+    
+    for (const FlatpakProblem& collectedProblem : problems) {
+        auto* problem = new KDevelop::DetectedProblem(i18n("Flatpak Builder"));
+        problem->setSeverity(collectedProblem.severity == FlatpakOutputLine::Error
+                             ? KDevelop::IProblem::Error : KDevelop::IProblem::Warning);
+        problem->setDescription(collectedProblem.count > 1
+                                ? i18n("%1 (%2 occurrences)", collectedProblem.message, collectedProblem.count)
+                                : collectedProblem.message);
+        
+        if (!collectedProblem.file.isEmpty()) {
+            // Kompilator numeruje od 1, edytor od 0
+            const int line = qMax(0, collectedProblem.line - 1);
+            const int column = qMax(0, collectedProblem.column - 1);
+            problem->setFinalLocation(KDevelop::DocumentRange(KDevelop::IndexedString(collectedProblem.file),
+                                                              KTextEditor::Range(line, column, line, column)));
+        }
+        
+        converted.append(KDevelop::IProblem::Ptr(problem));
+    }
+    
+    problemModel()->setProblems(converted);
+}
+
+void FlatpakBuilderPlugin::setActiveLogModel(FlatpakLogModel* model)
+{
+    m_activeLogModel = model;
+    
+    // Wyszukiwanie kończy się w tle; trafienia przegląda się akcjami
+    // "następny/poprzedni" widoku wyjścia
+    connect(model, &FlatpakLogModel::searchFinished, this, [this, model](int hits) {
+        if (model != m_activeLogModel) {
+            return;
+        }
+        core()->uiController()->activeMainWindow()->statusBar()->showMessage(
+            i18np("%1 match found in %2 ms", "%1 matches found in %2 ms", hits, m_searchTimer.elapsed()), 5000);
+    });
+}
+
+void FlatpakBuilderPlugin::archiveLog(FlatpakLogModel* model)
+{
+    // Tworzone przy pierwszym zakończonym zadaniu
+    if (!m_logArchive) {
+        m_logArchive = new FlatpakLogArchive(this);
+    }
+    m_logArchive->add(model);
+}
+
+void FlatpakBuilderPlugin::setActiveJobStats(const QString& jobName, const std::shared_ptr<FlatpakJobStats>& stats)
+{
+    enableFlatpakSupport();
+    
+    m_activeJobName = jobName;
+    m_activeJobStats = stats;
+}
+
+std::shared_ptr<FlatpakJobStats> FlatpakBuilderPlugin::activeJobStats() const
+{
+    return m_activeJobStats;
+}
+
+QString FlatpakBuilderPlugin::activeJobName() const
+{
+    return m_activeJobName;
+}
+
+QString FlatpakBuilderPlugin::resumePoint(KDevelop::IProject* project) const
+{
+    return project->projectConfiguration()->group(ProjectConfigGroup).readEntry("ResumeModule", QString());
+}
+
+void FlatpakBuilderPlugin::setResumePoint(KDevelop::IProject* project, const QString& module)
+{
+    KConfigGroup group = project->projectConfiguration()->group(ProjectConfigGroup);
+    if (module.isEmpty()) {
+        group.deleteEntry("ResumeModule");
+    } else {
+        group.writeEntry("ResumeModule", module);
+    }
+    group.sync();
+}
+
+QStringList FlatpakBuilderPlugin::matrixVariants(KDevelop::IProject* project) const
+{
+    // Ścieżki są zapisywane względem projektu, by konfiguracja była przenośna
+    const QDir projectDir(project->path().toLocalFile());
+    const QStringList relative = project->projectConfiguration()->group(ProjectConfigGroup)
+        .readEntry("MatrixVariants", QStringList());
+    
+    QStringList manifests;
+    for (const QString& path : relative) {
+        manifests << QDir::cleanPath(projectDir.absoluteFilePath(path));
+    }
+    return manifests;
+}
+
+void FlatpakBuilderPlugin::setMatrixVariants(KDevelop::IProject* project, const QStringList& manifests)
+{
+    const QDir projectDir(project->path().toLocalFile());
+    QStringList relative;
+    for (const QString& path : manifests) {
+        relative << projectDir.relativeFilePath(path);
+    }
+    
+    KConfigGroup group = project->projectConfiguration()->group(ProjectConfigGroup);
+    group.writeEntry("MatrixVariants", relative);
+    group.sync();
+}
+
+void FlatpakBuilderPlugin::maintainExportRepo(const QString& repoPath)
+{
+    if (!config()->maintainExportRepo()) {
+        return;
+    }
+    
+    if (m_repoMaintenanceJob) {
+        m_pendingRepoMaintenance = repoPath;
+        return;
+    }
+    
+    auto* job = new FlatpakRepoMaintenanceJob(this, repoPath);
+    m_repoMaintenanceJob = job;
+    connect(job, &KJob::result, this, [this, job]() {
+        if (job->error() == 0) {
+            core()->uiController()->activeMainWindow()->statusBar()->showMessage(job->summary());
+        } else if (job->error() != KJob::KilledJobError) {
+            core()->uiController()->showErrorMessage(job->errorText());
+        }
+        
+        m_repoMaintenanceJob = nullptr;
+        const QString pending = m_pendingRepoMaintenance;
+        m_pendingRepoMaintenance.clear();
+        if (!pending.isEmpty()) {
+            maintainExportRepo(pending);
+        }
+    });
+    
+    core()->runController()->registerJob(job);
+    job->start();
+}
+
+void FlatpakBuilderPlugin::snapshotBuildDir(const QString& buildDir, const QString& manifestPath)
+{
+    const int keep = config()->buildSnapshots();
+    if (keep <= 0) {
+        return;
+    }
+    
+    if (m_snapshotJob) {
+        m_pendingSnapshot = qMakePair(buildDir, manifestPath);
+        return;
+    }
+    
+    auto* job = new FlatpakSnapshotJob(this, buildDir, manifestPath, keep);
+    m_snapshotJob = job;
+    connect(job, &KJob::result, this, [this, job]() {
+        if (job->error() == 0) {
+            core()->uiController()->activeMainWindow()->statusBar()->showMessage(job->summary(), 5000);
+        } else if (job->error() != KJob::KilledJobError) {
+            core()->uiController()->showErrorMessage(job->errorText());
+        }
+        
+        m_snapshotJob = nullptr;
+        const QPair<QString, QString> pending = m_pendingSnapshot;
+        m_pendingSnapshot = {};
+        if (!pending.first.isEmpty()) {
+            snapshotBuildDir(pending.first, pending.second);
+        }
+    });
+    
+    core()->runController()->registerJob(job);
+    job->start();
+}
+
+void FlatpakBuilderPlugin::cancelSnapshot(const QString& buildDir)
+{
+    const QString cleanDir = QDir::cleanPath(buildDir);
+    if (!m_pendingSnapshot.first.isEmpty() && QDir::cleanPath(m_pendingSnapshot.first) == cleanDir) {
+        m_pendingSnapshot = {};
+    }
+    
+    if (m_snapshotJob && QDir::cleanPath(m_snapshotJob->buildDir()) == cleanDir) {
+        m_snapshotJob->kill(KJob::EmitResult);
+    }
+}
+
 void FlatpakBuilderPlugin::slotBuildFlatpak()
 {
     KDevelop::IProject* project = core()->projectController()->activeProject();
@@ -183,6 +656,326 @@ void FlatpakBuilderPlugin::slotBuildFlatpak()
     }
 }
 
+void FlatpakBuilderPlugin::slotResumeBuild()
+{
+    KDevelop::IProject* project = core()->projectController()->activeProject();
+    if (!project) {
+        return;
+    }
+    
+    if (resumePoint(project).isEmpty()) {
+        KMessageBox::information(core()->uiController()->activeMainWindow(),
+                                 i18n("There is no interrupted Flatpak build to resume for this project."),
+                                 i18n("Flatpak Builder"));
+        return;
+    }
+    
+    auto job = qobject_cast<FlatpakBuilderJob*>(build(project->projectItem()));
+    if (job) {
+        job->setResume(true);
+        job->start();
+    }
+}
+
+void FlatpakBuilderPlugin::slotBuildVariants()
+{
+    KDevelop::IProject* project = core()->projectController()->activeProject();
+    if (!project) {
+        return;
+    }
+    
+    const QStringList manifests = FlatpakManifestScanner::findManifests(project->path().toLocalFile());
+    if (manifests.isEmpty()) {
+        KMessageBox::information(core()->uiController()->activeMainWindow(),
+                                 i18n("No Flatpak manifests were found in this project."),
+                                 i18n("Flatpak Builder"));
+        return;
+    }
+    
+    FlatpakVariantDialog dialog(manifests, core()->uiController()->activeMainWindow());
+    dialog.setSelectedManifests(matrixVariants(project));
+    dialog.setMaxParallel(config()->matrixParallelBuilds());
+    if (dialog.exec() != QDialog::Accepted || dialog.selectedManifests().isEmpty()) {
+        return;
+    }
+    
+    setMatrixVariants(project, dialog.selectedManifests());
+    config()->setMatrixParallelBuilds(dialog.maxParallel());
+    
+    auto* job = new FlatpakMatrixJob(this, project, dialog.selectedManifests());
+    job->setMaxParallel(config()->matrixParallelBuilds());
+    
+    // Podsumowanie wszystkich wariantów w jednej tabeli
+    connect(job, &KJob::result, this, [this, job]() {
+        const QString text = job->error() == 0
+            ? i18n("All Flatpak variants were built.")
+            : job->errorText();
+        KMessageBox::information(core()->uiController()->activeMainWindow(),
+                                 "<p>" + text + "</p>" + job->summaryTable(),
+                                 i18n("Flatpak Variant Builds"));
+    });
+    
+    core()->runController()->registerJob(job);
+    job->start();
+}
+
+void FlatpakBuilderPlugin::slotBuildPgo()
+{
+    KDevelop::IProject* project = core()->projectController()->activeProject();
+    if (!project || !hasManifest(project)) {
+        return;
+    }
+    
+    const QString manifestPath = manifestManager()->manifestUrl(project).toLocalFile();
+    KConfigGroup group = project->projectConfiguration()->group(ProjectConfigGroup);
+    
+    // Domyślnym treningiem jest samo uruchomienie aplikacji
+    QString workload = group.readEntry("PgoWorkload", FlatpakManifestScanner::topLevelValue(manifestPath, "command"));
+    bool ok = false;
+    workload = QInputDialog::getText(core()->uiController()->activeMainWindow(),
+                                     i18n("Build with PGO"),
+                                     i18n("Training workload (shell command run inside the sandbox):"),
+                                     QLineEdit::Normal, workload, &ok);
+    if (!ok || workload.trimmed().isEmpty()) {
+        return;
+    }
+    group.writeEntry("PgoWorkload", workload);
+    group.sync();
+    
+    auto* job = new FlatpakPgoJob(this, project, manifestPath, workload);
+    connect(job, &KJob::result, this, [this, job]() {
+        const QString summary = job->summary();
+        if (job->error() != 0 && job->error() != KJob::KilledJobError) {
+            KMessageBox::detailedError(core()->uiController()->activeMainWindow(),
+                                       job->errorText(), summary, i18n("Flatpak PGO Build"));
+        } else if (job->error() == 0) {
+            KMessageBox::information(core()->uiController()->activeMainWindow(),
+                                     i18n("The optimized Flatpak is ready to install or export.") + "\n\n" + summary,
+                                     i18n("Flatpak PGO Build"));
+        }
+    });
+    
+    core()->runController()->registerJob(job);
+    job->start();
+}
+
+void FlatpakBuilderPlugin::slotAnalyzeBundle()
+{
+    KDevelop::IProject* project = core()->projectController()->activeProject();
+    if (!project || !hasManifest(project)) {
+        return;
+    }
+    
+    const QString buildDir = FlatpakBuilderJob::defaultBuildDir(project);
+    if (!QFile::exists(QDir(buildDir).filePath("files"))) {
+        KMessageBox::information(core()->uiController()->activeMainWindow(),
+                                 i18n("Build the Flatpak first - there is no build output to analyze in %1.", buildDir),
+                                 i18n("Flatpak Builder"));
+        return;
+    }
+    
+    // Skanowanie i haszowanie drzewa odbywa się poza wątkiem GUI
+    const QString manifestPath = manifestManager()->manifestUrl(project).toLocalFile();
+    auto* watcher = new QFutureWatcher<FlatpakBundleAnalyzer::Report>(this);
+    connect(watcher, &QFutureWatcher<FlatpakBundleAnalyzer::Report>::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        m_analyzeBundleAction->setEnabled(true);
+        core()->uiController()->activeMainWindow()->statusBar()->clearMessage();
+        core()->documentController()->openDocumentFromText(watcher->result().toText());
+    });
+    
+    m_analyzeBundleAction->setEnabled(false);
+    core()->uiController()->activeMainWindow()->statusBar()->showMessage(i18n("Analyzing Flatpak build output..."));
+    watcher->setFuture(QtConcurrent::run(&FlatpakBundleAnalyzer::analyze, buildDir, manifestPath, buildDir + ".tree"));
+}
+
+void FlatpakBuilderPlugin::slotRestoreSnapshot()
+{
+    KDevelop::IProject* project = core()->projectController()->activeProject();
+    if (!project || !hasManifest(project)) {
+        return;
+    }
+    
+    QWidget* window = core()->uiController()->activeMainWindow();
+    const QString buildDir = FlatpakBuilderJob::defaultBuildDir(project);
+    const QVector<FlatpakBuildSnapshots::Snapshot> snapshots = FlatpakBuildSnapshots(buildDir).snapshots();
+    if (snapshots.isEmpty()) {
+        KMessageBox::information(window,
+                                 config()->buildSnapshots() > 0
+                                     ? i18n("There are no build snapshots yet. A snapshot is saved after each successful build.")
+                                     : i18n("Build snapshots are turned off. Enable them in the Flatpak Builder settings."),
+                                 i18n("Flatpak Builder"));
+        return;
+    }
+    
+    // Przywracanie podmienia katalog, którego używa budowanie i migawka
+    bool busy = m_snapshotJob != nullptr;
+    const auto jobs = core()->runController()->currentJobs();
+    for (KJob* running : jobs) {
+        auto* build = qobject_cast<FlatpakBuilderJob*>(running);
+        busy = busy || (build && build->buildDir() == buildDir);
+    }
+    if (busy) {
+        KMessageBox::sorry(window, i18n("Wait for the running Flatpak build or snapshot to finish."),
+                           i18n("Flatpak Builder"));
+        return;
+    }
+    
+    const QLocale locale;
+    QStringList items;
+    for (const FlatpakBuildSnapshots::Snapshot& snapshot : snapshots) {
+        items << i18n("%1 - %2 (%3)", locale.toString(snapshot.created, QLocale::ShortFormat),
+                      QFileInfo(snapshot.manifest).fileName(), FlatpakBuildSnapshots::methodName(snapshot.method));
+    }
+    
+    bool ok = false;
+    const QString choice = QInputDialog::getItem(window, i18n("Restore Build Snapshot"),
+                                                 i18n("Replace the build directory with the state after the build of:"),
+                                                 items, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    auto* job = new FlatpakSnapshotJob(this, buildDir, snapshots.at(items.indexOf(choice)));
+    m_snapshotJob = job;
+    connect(job, &KJob::result, this, [this, job]() {
+        if (job->error() == 0) {
+            core()->uiController()->activeMainWindow()->statusBar()->showMessage(job->summary(), 5000);
+        } else if (job->error() != KJob::KilledJobError) {
+            KMessageBox::error(core()->uiController()->activeMainWindow(), job->errorText(),
+                               i18n("Restore Build Snapshot"));
+        }
+        
+        // Budowanie ukończone w trakcie przywracania czeka na swoją migawkę
+        m_snapshotJob = nullptr;
+        const QPair<QString, QString> pending = m_pendingSnapshot;
+        m_pendingSnapshot = {};
+        if (!pending.first.isEmpty()) {
+            snapshotBuildDir(pending.first, pending.second);
+        }
+    });
+    
+    core()->runController()->registerJob(job);
+    job->start();
+}
+
+void FlatpakBuilderPlugin::slotToggleWatchMode(bool enabled)
+{
+    // Budowanie uruchomione przez tryb obserwacji kończy się normalnie
+    delete m_watchMode;
+    m_watchMode = nullptr;
+    
+    if (enabled) {
+        KDevelop::IProject* project = core()->projectController()->activeProject();
+        if (!project || !hasManifest(project)) {
+            KMessageBox::information(core()->uiController()->activeMainWindow(),
+                                     i18n("Open a project with a Flatpak manifest to watch it."),
+                                     i18n("Flatpak Builder"));
+            QSignalBlocker blocker(m_watchAction);
+            m_watchAction->setChecked(false);
+        } else {
+            m_watchMode = new FlatpakWatchMode(this, project, manifestManager()->manifestUrl(project).toLocalFile());
+            connect(m_watchMode, &FlatpakWatchMode::stateChanged, this, &FlatpakBuilderPlugin::updateWatchAction);
+        }
+    }
+    
+    updateWatchAction(FlatpakWatchMode::Idle);
+}
+
+void FlatpakBuilderPlugin::updateWatchAction(FlatpakWatchMode::State state)
+{
+    if (!m_watchMode) {
+        m_watchAction->setText(i18n("Watch and Rebuild"));
+        m_watchAction->setIcon(QIcon::fromTheme("view-refresh"));
+        m_watchAction->setToolTip(i18n("Rebuild the Flatpak automatically when project files or the manifest are saved"));
+        return;
+    }
+    
+    const QString project = m_watchMode->project()->name();
+    switch (state) {
+        case FlatpakWatchMode::Idle:
+            m_watchAction->setIcon(QIcon::fromTheme("view-refresh"));
+            m_watchAction->setToolTip(i18n("Watching %1: the Flatpak is up to date", project));
+            break;
+            
+        case FlatpakWatchMode::Pending:
+            m_watchAction->setIcon(QIcon::fromTheme("chronometer"));
+            m_watchAction->setToolTip(i18n("Watching %1: rebuilding when the edits settle", project));
+            break;
+            
+        case FlatpakWatchMode::Building:
+            m_watchAction->setIcon(QIcon::fromTheme("run-build"));
+            m_watchAction->setToolTip(i18n("Watching %1: building", project));
+            break;
+            
+        case FlatpakWatchMode::Failed:
+            m_watchAction->setIcon(QIcon::fromTheme("dialog-warning"));
+            m_watchAction->setToolTip(i18n("Watching %1: the last build failed", project));
+            break;
+    }
+}
+
+void FlatpakBuilderPlugin::slotProfilePerf()
+{
+    profile(FlatpakProfileJob::Perf);
+}
+
+void FlatpakBuilderPlugin::slotProfileHeaptrack()
+{
+    profile(FlatpakProfileJob::Heaptrack);
+}
+
+void FlatpakBuilderPlugin::slotProfileMassif()
+{
+    profile(FlatpakProfileJob::Massif);
+}
+
+void FlatpakBuilderPlugin::profile(FlatpakProfileJob::Profiler profiler)
+{
+    KDevelop::IProject* project = core()->projectController()->activeProject();
+    if (!project) {
+        return;
+    }
+    
+    if (!hasManifest(project)) {
+        KMessageBox::error(core()->uiController()->activeMainWindow(),
+                           i18n("No Flatpak manifest found for this project. Build and install the project first."),
+                           i18n("Flatpak Builder"));
+        return;
+    }
+    
+    auto* job = new FlatpakProfileJob(this, project, manifestManager()->manifestUrl(project).toLocalFile(), profiler);
+    core()->runController()->registerJob(job);
+    job->start();
+}
+
+void FlatpakBuilderPlugin::slotProjectOpened(KDevelop::IProject* project)
+{
+    // Projekty bez manifestu nie tworzą konfiguracji ani menedżera manifestów
+    if (FlatpakManifestScanner::findManifests(project->path().toLocalFile()).isEmpty()) {
+        return;
+    }
+    
+    enableFlatpakSupport();
+    
+    if (!config()->useBuildDaemon() || !hasManifest(project)) {
+        return;
+    }
+    
+    // Odpowiedź demona może przyjść po zamknięciu projektu
+    QPointer<KDevelop::IProject> guard(project);
+    FlatpakDaemonSource::queryRunningBuild(project->path().toLocalFile(), this, [this, guard](int buildId) {
+        if (buildId < 0 || !guard) {
+            return;
+        }
+        
+        FlatpakBuilderJob* job = new FlatpakBuilderJob(this, guard, FlatpakBuilderJob::BuildOperation);
+        job->setManifestPath(manifestManager()->manifestUrl(guard).toLocalFile());
+        job->setAttachBuild(buildId);
+        job->start();
+    });
+}
+
 void FlatpakBuilderPlugin::slotInstallFlatpak()
 {
     KDevelop::IProject* project = core()->projectController()->activeProject();
@@ -225,4 +1018,99 @@ void FlatpakBuilderPlugin::slotEditManifest()
     }
 }
 
+void FlatpakBuilderPlugin::slotUpdateChecksums()
+{
+    KDevelop::IProject* project = core()->projectController()->activeProject();
+    if (!project || !hasManifest(project) || m_checksumJob) {
+        return;
+    }
+    
+    // Otwarty manifest może zawierać niezapisane zmiany - liczy się jego treść
+    const QString manifestPath = manifestManager()->manifestUrl(project).toLocalFile();
+    QString text;
+    KDevelop::IDocument* document = core()->documentController()->documentForUrl(QUrl::fromLocalFile(manifestPath));
+    if (document && document->textDocument()) {
+        text = document->textDocument()->text();
+    } else {
+        QFile file(manifestPath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            KMessageBox::error(core()->uiController()->activeMainWindow(),
+                               i18n("Could not read the Flatpak manifest %1: %2", manifestPath, file.errorString()),
+                               i18n("Flatpak Builder"));
+            return;
+        }
+        text = QString::fromUtf8(file.readAll());
+    }
+    
+    FlatpakManifestModel model(FlatpakManifestModel::formatForPath(manifestPath), QFileInfo(manifestPath).absolutePath());
+    model.setText(text);
+    
+    const QString stateDir = QDir(project->path().toLocalFile()).filePath(".flatpak-builder");
+    auto* job = new FlatpakChecksumJob(this, manifestPath, model.modules(), stateDir);
+    m_checksumJob = job;
+    m_updateChecksumsAction->setEnabled(false);
+    connect(job, &KJob::result, this, [this, job]() {
+        m_updateChecksumsAction->setEnabled(true);
+        if (job->error() == KJob::KilledJobError) {
+            return;
+        }
+        
+        QWidget* window = core()->uiController()->activeMainWindow();
+        if (job->failures().isEmpty()) {
+            KMessageBox::information(window, job->summary(), i18n("Update Source Checksums"));
+        } else {
+            KMessageBox::detailedError(window, job->summary(), job->failures().join('\n'),
+                                       i18n("Update Source Checksums"));
+        }
+    });
+    
+    core()->runController()->registerJob(job);
+    job->start();
+}
+
+void FlatpakBuilderPlugin::slotSearchLog()
+{
+    if (!m_activeLogModel) {
+        KMessageBox::information(core()->uiController()->activeMainWindow(),
+                                 i18n("There is no Flatpak build log to search."),
+                                 i18n("Flatpak Builder"));
+        return;
+    }
+    
+    bool ok = false;
+    QString query = QInputDialog::getText(core()->uiController()->activeMainWindow(),
+                                          i18n("Search Build Log"),
+                                          i18n("Text or /regular expression/:"),
+                                          QLineEdit::Normal, QString(), &ok);
+    if (!ok || query.isEmpty()) {
+        return;
+    }
+    
+    // Zapytanie w ukośnikach traktujemy jako wyrażenie regularne
+    const bool isRegex = query.size() > 2 && query.startsWith('/') && query.endsWith('/');
+    if (isRegex) {
+        query = query.mid(1, query.size() - 2);
+    }
+    
+    // Wynik przychodzi sygnałem searchFinished() (zob. setActiveLogModel())
+    core()->uiController()->activeMainWindow()->statusBar()->showMessage(i18n("Searching the build log..."));
+    m_searchTimer.start();
+    if (!m_activeLogModel->search(query, isRegex)) {
+        core()->uiController()->activeMainWindow()->statusBar()->clearMessage();
+        KMessageBox::error(core()->uiController()->activeMainWindow(),
+                           i18n("Invalid regular expression: %1", query),
+                           i18n("Flatpak Builder"));
+    }
+}
+
+void FlatpakBuilderPlugin::slotClearLogSearch()
+{
+    if (m_activeLogModel) {
+        if (m_activeLogModel->isSearching()) {
+            core()->uiController()->activeMainWindow()->statusBar()->clearMessage();
+        }
+        m_activeLogModel->clearSearch();
+    }
+}
+
 #include "flatpakbuilderplugin.moc"
\ No newline at end of file
@@ -8,12 +8,35 @@
 #ifndef FLATPAKBUILDERPLUGIN_H
 #define FLATPAKBUILDERPLUGIN_H
 
+#include "flatpakprofilejob.h"
+#include "flatpakwatchmode.h"
+
 #include <interfaces/iplugin.h>
 #include <project/interfaces/iprojectbuilder.h>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QPointer>
 #include <QVariantList>
+#include <QVector>
+
+#include <memory>
 
 class FlatpakBuilderConfig;
+class FlatpakChecksumJob;
+class FlatpakJobStats;
+class FlatpakStatsViewFactory;
 class FlatpakManifestManager;
+class FlatpakManifestSupport;
+class FlatpakLogArchive;
+class FlatpakLogModel;
+class FlatpakRepoMaintenanceJob;
+class FlatpakSnapshotJob;
+struct FlatpakProblem;
+
+namespace KDevelop {
+    class IDocument;
+    class ProblemModel;
+}
 
 /**
  * @class FlatpakBuilderPlugin
@@ -41,6 +64,11 @@ public:
      */
     ~FlatpakBuilderPlugin() override;
 
+    /**
+     * @brief Wyrejestrowuje model problemów przed wyładowaniem wtyczki
+     */
+    void unload() override;
+
     /**
      * @brief Zwraca nazwę wtyczki
      * @return Nazwa wtyczki
@@ -87,17 +115,183 @@ public:
     KJob* exportBundle(KDevelop::IProject* project);
 
     /**
-     * @brief Zwraca konfigurację dla wtyczki
+     * @brief Zwraca konfigurację dla wtyczki, tworząc ją przy pierwszym użyciu
      * @return Obiekt konfiguracji
      */
     FlatpakBuilderConfig* config() const;
 
+    /**
+     * @brief Zwraca model problemów wyświetlany w widoku "Problemy"
+     *
+     * Model jest rejestrowany w widoku przy pierwszym użyciu.
+     *
+     * @return Model problemów z ostatniego budowania
+     */
+    KDevelop::ProblemModel* problemModel() const;
+
+    /**
+     * @brief Zastępuje zawartość widoku "Problemy" podanymi problemami
+     * @param problems Zdeduplikowane błędy i ostrzeżenia
+     */
+    void publishProblems(const QVector<FlatpakProblem>& problems);
+
+    /**
+     * @brief Ustawia log, w którym działają akcje wyszukiwania
+     * @param model Model logu ostatnio uruchomionego zadania
+     */
+    void setActiveLogModel(FlatpakLogModel* model);
+
+    /**
+     * @brief Przekazuje log zakończonego zadania do kompaktowania
+     *
+     * Log jest kompresowany, gdy jego widok nie ma fokusu; treść najstarszych
+     * logów ponad limity z konfiguracji jest zwalniana.
+     *
+     * @param model Model logu zakończonego zadania
+     */
+    void archiveLog(FlatpakLogModel* model);
+
+    /**
+     * @brief Ustawia liczniki pokazywane w panelu statystyk
+     * @param jobName Nazwa zadania
+     * @param stats Liczniki ostatnio uruchomionego zadania
+     */
+    void setActiveJobStats(const QString& jobName, const std::shared_ptr<FlatpakJobStats>& stats);
+
+    /**
+     * @brief Zwraca liczniki ostatnio uruchomionego zadania albo nullptr
+     */
+    std::shared_ptr<FlatpakJobStats> activeJobStats() const;
+
+    /**
+     * @brief Zwraca nazwę zadania, którego liczniki są aktywne
+     */
+    QString activeJobName() const;
+
+    /**
+     * @brief Zwraca moduł, po którym przerwano ostatnie budowanie projektu
+     * @param project Projekt
+     * @return Nazwa modułu albo pusty napis, jeśli nie ma czego wznawiać
+     */
+    QString resumePoint(KDevelop::IProject* project) const;
+
+    /**
+     * @brief Zapisuje w konfiguracji projektu punkt wznowienia budowania
+     * @param project Projekt
+     * @param module Ostatni ukończony moduł (pusty usuwa punkt wznowienia)
+     */
+    void setResumePoint(KDevelop::IProject* project, const QString& module);
+
+    /**
+     * @brief Zwraca warianty ostatnio wybrane do budowania macierzowego
+     * @param project Projekt
+     * @return Bezwzględne ścieżki manifestów
+     */
+    QStringList matrixVariants(KDevelop::IProject* project) const;
+
+    /**
+     * @brief Zapamiętuje w konfiguracji projektu wybrane warianty
+     * @param project Projekt
+     * @param manifests Bezwzględne ścieżki manifestów
+     */
+    void setMatrixVariants(KDevelop::IProject* project, const QStringList& manifests);
+
+    /**
+     * @brief Przycina repozytorium eksportu i generuje delty w tle
+     *
+     * Eksport w trakcie utrzymania powoduje jedno ponowne uruchomienie po
+     * jego zakończeniu, zamiast równoległych zadań na tym samym repozytorium.
+     *
+     * @param repoPath Repozytorium utworzone przez "flatpak build-export"
+     */
+    void maintainExportRepo(const QString& repoPath);
+
+    /**
+     * @brief Zapisuje migawkę katalogu budowania w tle
+     *
+     * Działa jedna migawka naraz; kolejne żądanie w tym czasie zastępuje
+     * poprzednie oczekujące, bo liczy się tylko najnowszy stan katalogu.
+     *
+     * @param buildDir Katalog budowania po udanym budowaniu
+     * @param manifestPath Manifest, z którego zbudowano katalog
+     */
+    void snapshotBuildDir(const QString& buildDir, const QString& manifestPath);
+
+    /**
+     * @brief Przerywa migawkę katalogu budowania, zanim zacznie się w nim nowe budowanie
+     *
+     * Kopia zrobiona pod --force-clean mieszałaby stare i nowe pliki. Przerwana
+     * migawka usuwa swój niepełny katalog docelowy, a oczekujące żądanie dla
+     * tego katalogu jest porzucane.
+     *
+     * @param buildDir Katalog budowania
+     */
+    void cancelSnapshot(const QString& buildDir);
+
 public Q_SLOTS:
     /**
      * @brief Slot wywoływany po kliknięciu akcji "Build Flatpak"
      */
     void slotBuildFlatpak();
 
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Resume Flatpak Build"
+     */
+    void slotResumeBuild();
+
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Build Flatpak Variants"
+     */
+    void slotBuildVariants();
+
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Build with PGO"
+     */
+    void slotBuildPgo();
+
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Analyze Bundle Size"
+     */
+    void slotAnalyzeBundle();
+
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Restore Build Snapshot"
+     */
+    void slotRestoreSnapshot();
+
+    /**
+     * @brief Slot wywoływany po przełączeniu akcji "Watch and Rebuild"
+     * @param enabled Czy obserwować aktywny projekt
+     */
+    void slotToggleWatchMode(bool enabled);
+
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Run under perf"
+     */
+    void slotProfilePerf();
+
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Run under heaptrack"
+     */
+    void slotProfileHeaptrack();
+
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Run under Valgrind Massif"
+     */
+    void slotProfileMassif();
+
+    /**
+     * @brief Podłącza się do budowania projektu, które trwa w demonie
+     * @param project Otwarty projekt
+     */
+    void slotProjectOpened(KDevelop::IProject* project);
+
+    /**
+     * @brief Włącza podpowiedzi i diagnostykę w otwartym manifeście
+     * @param document Otwarty dokument
+     */
+    void slotDocumentCreated(KDevelop::IDocument* document);
+
     /**
      * @brief Slot wywoływany po kliknięciu akcji "Install Flatpak"
      */
@@ -118,19 +312,91 @@ public Q_SLOTS:
      */
     void slotEditManifest();
 
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Update Source Checksums"
+     */
+    void slotUpdateChecksums();
+
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Search Build Log"
+     */
+    void slotSearchLog();
+
+    /**
+     * @brief Slot wywoływany po kliknięciu akcji "Clear Log Search"
+     */
+    void slotClearLogSearch();
+
 private:
-    FlatpakBuilderConfig* m_config;
-    FlatpakManifestManager* m_manifestManager;
+    /**
+     * @brief Uruchamia zainstalowaną aplikację projektu pod profilerem
+     * @param profiler Profiler
+     */
+    void profile(FlatpakProfileJob::Profiler profiler);
+
+    /**
+     * @brief Pokazuje stan trybu obserwacji na akcji w pasku narzędzi
+     * @param state Stan trybu obserwacji
+     */
+    void updateWatchAction(FlatpakWatchMode::State state);
+
+    /**
+     * @brief Zwraca menedżer manifestów, tworząc go przy pierwszym użyciu
+     */
+    FlatpakManifestManager* manifestManager() const;
+
+    /**
+     * @brief Zwraca obsługę manifestów w edytorze, tworząc ją przy pierwszym manifeście
+     */
+    FlatpakManifestSupport* manifestSupport();
+
+    // Tworzone leniwie przez config(), manifestManager() i problemModel()
+    mutable FlatpakBuilderConfig* m_config;
+    mutable FlatpakManifestManager* m_manifestManager;
+    mutable KDevelop::ProblemModel* m_problemModel;
+    FlatpakManifestSupport* m_manifestSupport;
     QAction* m_buildAction;
+    QAction* m_resumeBuildAction;
+    QAction* m_buildVariantsAction;
+    QAction* m_buildPgoAction;
+    QAction* m_analyzeBundleAction;
+    QAction* m_restoreSnapshotAction;
+    QAction* m_watchAction;
+    QAction* m_profilePerfAction;
+    QAction* m_profileHeaptrackAction;
+    QAction* m_profileMassifAction;
     QAction* m_installAction;
     QAction* m_exportBundleAction;
     QAction* m_createManifestAction;
     QAction* m_editManifestAction;
+    QAction* m_updateChecksumsAction;
+    QAction* m_searchLogAction;
+    QAction* m_clearLogSearchAction;
+    QPointer<FlatpakLogModel> m_activeLogModel;
+    QElapsedTimer m_searchTimer;                    ///< Czas wyszukiwania w logu (do komunikatu)
+    std::shared_ptr<FlatpakJobStats> m_activeJobStats;
+    QString m_activeJobName;
+    FlatpakStatsViewFactory* m_statsViewFactory;    ///< Tworzony przez enableFlatpakSupport()
+    FlatpakWatchMode* m_watchMode;
+    FlatpakLogArchive* m_logArchive;
+    QPointer<FlatpakRepoMaintenanceJob> m_repoMaintenanceJob;
+    QString m_pendingRepoMaintenance;
+    QPointer<FlatpakSnapshotJob> m_snapshotJob;
+    QPair<QString, QString> m_pendingSnapshot;
+    QPointer<FlatpakChecksumJob> m_checksumJob;
 
     /**
      * @brief Inicjuje akcje wtyczki
      */
     void setupActions();
+
+    /**
+     * @brief Rejestruje panel statystyk i obsługę manifestów w edytorze
+     *
+     * Wywoływane przy pierwszym projekcie z manifestem, pierwszym zadaniu
+     * Flatpak albo po utworzeniu manifestu; kolejne wywołania nic nie robią.
+     */
+    void enableFlatpakSupport();
 };
 
 #endif // FLATPAKBUILDERPLUGIN_H
\ No newline at end of file
@@ -12,15 +12,9 @@
 #include <project/projectmodel.h>
 #include <util/path.h>
 
-#include <QRegularExpressionMatch>
-
 FlatpakBuildOutputParser::FlatpakBuildOutputParser(QObject* parent)
     : KDevelop::OutputExecuteJobExecutor::StandardToolView(parent)
 {
-    // Wyrażenia regularne do wykrywania błędów i ostrzeżeń
-    m_errorRegex = QRegularExpression("(error|ERROR|Error):(.*)");
-    m_warningRegex = QRegularExpression("(warning|WARNING|Warning):(.*)");
-    m_progressRegex = QRegularExpression("(\\d+)/(\\d+):.(.*)");
 }
 
 FlatpakBuildOutputParser::~FlatpakBuildOutputParser()
@@ -29,62 +23,89 @@ FlatpakBuildOutputParser::~FlatpakBuildOutputParser()
 
 QString FlatpakBuildOutputParser::processLine(const QString& line)
 {
+    return processClassifiedLine(m_classifier.classify(line));
+}
+
+QString FlatpakBuildOutputParser::processClassifiedLine(const FlatpakOutputLine& line)
+{
+    // Linie nadpisane znakiem \r aktualizują tylko pasek postępu
+    if (line.transient) {
+        parseProgress(line);
+        return QString();
+    }
+    
     // Sprawdź czy linia zawiera błąd
     if (parseError(line)) {
-        return QString("<span style=\"color:red; font-weight:bold;\">%1</span>").arg(line);
+        return QString("<span style=\"color:red; font-weight:bold;\">%1</span>").arg(line.text);
     }
     
     // Sprawdź czy linia zawiera ostrzeżenie
     if (parseWarning(line)) {
-        return QString("<span style=\"color:orange; font-weight:bold;\">%1</span>").arg(line);
+        return QString("<span style=\"color:orange; font-weight:bold;\">%1</span>").arg(line.text);
     }
     
     // Sprawdź czy linia zawiera informacje o postępie
     if (parseProgress(line)) {
-        return QString("<span style=\"color:blue;\">%1</span>").arg(line);
+        return QString("<span style=\"color:blue;\">%1</span>").arg(line.text);
     }
     
-    // Linie informacyjne o budowaniu
-    if (line.contains("Building") || line.contains("Downloading") || 
-        line.contains("Installing") || line.contains("Exporting")) {
-        return QString("<span style=\"color:green; font-weight:bold;\">%1</span>").arg(line);
+    // Linie informacyjne o budowaniu; początek modułu wyznacza katalog
+    // dla ścieżek względnych w kolejnych diagnostykach
+    if (line.kind == FlatpakOutputLine::Status) {
+        if (!line.module.isEmpty()) {
+            m_problems.add(line);
+        }
+        return QString("<span style=\"color:green; font-weight:bold;\">%1</span>").arg(line.text);
     }
     
     // Domyślne formatowanie
-    return line;
+    return line.text;
+}
+
+FlatpakProblemAggregator& FlatpakBuildOutputParser::problems()
+{
+    return m_problems;
 }
 
-bool FlatpakBuildOutputParser::parseError(const QString& line)
+bool FlatpakBuildOutputParser::parseError(const FlatpakOutputLine& line)
 {
-    QRegularExpressionMatch match = m_errorRegex.match(line);
-    if (match.hasMatch()) {
-        emit problemFound(KDevelop::IProblem::Error, match.captured(2).trimmed(), 
-                          -1, -1, "flatpak-builder");
+    if (line.kind == FlatpakOutputLine::Error) {
+        // Powtórzenia tylko zwiększają licznik, nie generują nowego problemu
+        bool isNew = false;
+        const int index = m_problems.add(line, &isNew);
+        if (isNew) {
+            const FlatpakProblem& problem = m_problems.problems().at(index);
+            emit problemFound(KDevelop::IProblem::Error, problem.message, 
+                              problem.line, problem.column, "flatpak-builder");
+        }
+        emit problemsChanged();
         return true;
     }
     
     return false;
 }
 
-bool FlatpakBuildOutputParser::parseWarning(const QString& line)
+bool FlatpakBuildOutputParser::parseWarning(const FlatpakOutputLine& line)
 {
-    QRegularExpressionMatch match = m_warningRegex.match(line);
-    if (match.hasMatch()) {
-        emit problemFound(KDevelop::IProblem::Warning, match.captured(2).trimmed(), 
-                          -1, -1, "flatpak-builder");
+    if (line.kind == FlatpakOutputLine::Warning) {
+        bool isNew = false;
+        const int index = m_problems.add(line, &isNew);
+        if (isNew) {
+            const FlatpakProblem& problem = m_problems.problems().at(index);
+            emit problemFound(KDevelop::IProblem::Warning, problem.message, 
+                              problem.line, problem.column, "flatpak-builder");
+        }
+        emit problemsChanged();
         return true;
     }
     
     return false;
 }
 
-bool FlatpakBuildOutputParser::parseProgress(const QString& line)
+bool FlatpakBuildOutputParser::parseProgress(const FlatpakOutputLine& line)
 {
-    QRegularExpressionMatch match = m_progressRegex.match(line);
-    if (match.hasMatch()) {
-        int current = match.captured(1).toInt();
-        int total = match.captured(2).toInt();
-        int percentage = (current * 100) / total;
+    if (line.kind == FlatpakOutputLine::Progress) {
+        int percentage = (line.progressCurrent * 100) / line.progressTotal;
         
         emit progress(percentage, 100);
         return true;
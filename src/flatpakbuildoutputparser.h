@@ -8,8 +8,10 @@
 #ifndef FLATPAKBUILDOUTPUTPARSER_H
 #define FLATPAKBUILDOUTPUTPARSER_H
 
+#include "flatpaklineclassifier.h"
+#include "flatpakproblemaggregator.h"
+
 #include <outputview/outputexecutejob.h>
-#include <QRegularExpression>
 
 /**
  * @class FlatpakBuildOutputParser
@@ -36,6 +38,29 @@ public:
      */
     ~FlatpakBuildOutputParser() override;
 
+    /**
+     * @brief Przetwarza linię sklasyfikowaną już w wątku czytającym
+     *
+     * Emituje sygnały o problemach i postępie oraz zwraca tekst do wyświetlenia.
+     * Dla linii przejściowych (nadpisanych znakiem \r) zwraca pusty QString.
+     *
+     * @param line Sklasyfikowana linia
+     * @return Sformatowana linia
+     */
+    QString processClassifiedLine(const FlatpakOutputLine& line);
+
+    /**
+     * @brief Zwraca agregator problemów znalezionych w wyjściu
+     * @return Agregator problemów
+     */
+    FlatpakProblemAggregator& problems();
+
+Q_SIGNALS:
+    /**
+     * @brief Zbiór problemów zmienił się (nowy problem albo kolejne wystąpienie)
+     */
+    void problemsChanged();
+
 protected:
     /**
      * @brief Przetwarzanie linii wyjścia
@@ -46,29 +71,28 @@ protected:
     
     /**
      * @brief Wyciąga informacje o błędzie z linii wyjścia
-     * @param line Linia do analizy
+     * @param line Sklasyfikowana linia
      * @return true jeśli linia zawiera błąd
      */
-    bool parseError(const QString& line);
+    bool parseError(const FlatpakOutputLine& line);
     
     /**
      * @brief Wyciąga informacje o ostrzeżeniu z linii wyjścia
-     * @param line Linia do analizy
+     * @param line Sklasyfikowana linia
      * @return true jeśli linia zawiera ostrzeżenie
      */
-    bool parseWarning(const QString& line);
+    bool parseWarning(const FlatpakOutputLine& line);
     
     /**
      * @brief Wyciąga informacje o postępie z linii wyjścia
-     * @param line Linia do analizy
+     * @param line Sklasyfikowana linia
      * @return true jeśli linia zawiera informacje o postępie
      */
-    bool parseProgress(const QString& line);
+    bool parseProgress(const FlatpakOutputLine& line);
 
 private:
-    QRegularExpression m_errorRegex;
-    QRegularExpression m_warningRegex;
-    QRegularExpression m_progressRegex;
+    FlatpakLineClassifier m_classifier;
+    FlatpakProblemAggregator m_problems;
 };
 
 #endif // FLATPAKBUILDOUTPUTPARSER_H
\ No newline at end of file
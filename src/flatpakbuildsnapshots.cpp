@@ -0,0 +1,199 @@
+/**
+ * @file flatpakbuildsnapshots.cpp
+ * @brief Implementacja migawek katalogu budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakbuildsnapshots.h"
+
+#include <KLocalizedString>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <algorithm>
+
+#include <sys/stat.h>
+#include <sys/vfs.h>
+
+namespace {
+    // statfs(2): BTRFS_SUPER_MAGIC
+    const long BtrfsMagic = 0x9123683E;
+
+    // Korzeń każdego podwoluminu btrfs ma ten numer i-węzła
+    const ino_t BtrfsSubvolumeInode = 256;
+
+    const QString TrashPrefix = QStringLiteral(".trash-");
+
+    QString methodKey(FlatpakBuildSnapshots::Method method)
+    {
+        switch (method) {
+            case FlatpakBuildSnapshots::Subvolume:
+                return QStringLiteral("subvolume");
+            case FlatpakBuildSnapshots::Reflink:
+                return QStringLiteral("reflink");
+            case FlatpakBuildSnapshots::Hardlink:
+                break;
+        }
+        return QStringLiteral("hardlink");
+    }
+}
+
+FlatpakBuildSnapshots::FlatpakBuildSnapshots(const QString& buildDir)
+    : m_buildDir(QDir::cleanPath(buildDir))
+    , m_storePath(m_buildDir + ".snapshots")
+{
+}
+
+QString FlatpakBuildSnapshots::storePath() const
+{
+    return m_storePath;
+}
+
+QVector<FlatpakBuildSnapshots::Snapshot> FlatpakBuildSnapshots::snapshots() const
+{
+    QVector<Snapshot> result;
+
+    const QDir store(m_storePath);
+    const QStringList files = store.entryList({"*.json"}, QDir::Files);
+    for (const QString& fileName : files) {
+        QFile file(store.absoluteFilePath(fileName));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+
+        // Opis bez katalogu to ślad po przerwanym tworzeniu migawki
+        const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+        Snapshot snapshot;
+        snapshot.id = fileName.left(fileName.size() - 5);
+        snapshot.path = store.absoluteFilePath(snapshot.id);
+        if (!QFileInfo(snapshot.path).isDir()) {
+            continue;
+        }
+        snapshot.created = QDateTime::fromString(json["created"].toString(), Qt::ISODate);
+        snapshot.manifest = json["manifest"].toString();
+        const QString method = json["method"].toString();
+        snapshot.method = method == QLatin1String("subvolume") ? Subvolume
+                        : method == QLatin1String("reflink") ? Reflink : Hardlink;
+        result.append(snapshot);
+    }
+
+    std::sort(result.begin(), result.end(), [](const Snapshot& a, const Snapshot& b) {
+        return a.created > b.created;
+    });
+    return result;
+}
+
+QVector<FlatpakBuildSnapshots::Snapshot> FlatpakBuildSnapshots::expired(int keep) const
+{
+    QVector<Snapshot> all = snapshots();
+    if (all.size() <= keep) {
+        return {};
+    }
+
+    QVector<Snapshot> result = all.mid(qMax(0, keep));
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+FlatpakBuildSnapshots::Snapshot FlatpakBuildSnapshots::prepare(const QString& manifest) const
+{
+    Snapshot snapshot;
+    snapshot.created = QDateTime::currentDateTime();
+    snapshot.id = snapshot.created.toString("yyyyMMdd-HHmmss-zzz");
+    snapshot.path = m_storePath + '/' + snapshot.id;
+    snapshot.manifest = manifest;
+    return snapshot;
+}
+
+bool FlatpakBuildSnapshots::writeMetadata(const Snapshot& snapshot) const
+{
+    QJsonObject json;
+    json["created"] = snapshot.created.toString(Qt::ISODate);
+    json["method"] = methodKey(snapshot.method);
+    json["manifest"] = snapshot.manifest;
+
+    QSaveFile file(m_storePath + '/' + snapshot.id + ".json");
+    return file.open(QIODevice::WriteOnly)
+        && file.write(QJsonDocument(json).toJson()) >= 0
+        && file.commit();
+}
+
+void FlatpakBuildSnapshots::removeMetadata(const Snapshot& snapshot) const
+{
+    QFile::remove(m_storePath + '/' + snapshot.id + ".json");
+}
+
+QString FlatpakBuildSnapshots::trashPath() const
+{
+    return m_storePath + '/' + TrashPrefix + QString::number(QDateTime::currentMSecsSinceEpoch());
+}
+
+QStringList FlatpakBuildSnapshots::staleTrash() const
+{
+    QStringList result;
+    const QDir store(m_storePath);
+    const QStringList entries = store.entryList({TrashPrefix + '*'}, QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        result << store.absoluteFilePath(entry);
+    }
+    return result;
+}
+
+QVector<FlatpakBuildSnapshots::Method> FlatpakBuildSnapshots::methodsFor(const QString& source)
+{
+    // Reflink kończy się błędem tam, gdzie system plików go nie obsługuje,
+    // więc nie trzeba zgadywać - kolejny sposób jest próbowany po porażce
+    if (isSubvolume(source)) {
+        return {Subvolume, Reflink, Hardlink};
+    }
+    return {Reflink, Hardlink};
+}
+
+bool FlatpakBuildSnapshots::isSubvolume(const QString& path)
+{
+    const QByteArray localPath = QFile::encodeName(path);
+
+    struct statfs fs;
+    struct stat st;
+    if (statfs(localPath.constData(), &fs) != 0 || stat(localPath.constData(), &st) != 0) {
+        return false;
+    }
+    return static_cast<long>(fs.f_type) == BtrfsMagic && st.st_ino == BtrfsSubvolumeInode;
+}
+
+QStringList FlatpakBuildSnapshots::copyCommand(Method method, const QString& source, const QString& target)
+{
+    switch (method) {
+        case Subvolume:
+            return {QStringLiteral("btrfs"), "subvolume", "snapshot", source, target};
+        case Reflink:
+            return {QStringLiteral("cp"), "-a", "--reflink=always", source, target};
+        case Hardlink:
+            break;
+    }
+    return {QStringLiteral("cp"), "-al", source, target};
+}
+
+QStringList FlatpakBuildSnapshots::deleteSubvolumeCommand(const QString& path)
+{
+    return {QStringLiteral("btrfs"), "subvolume", "delete", path};
+}
+
+QString FlatpakBuildSnapshots::methodName(Method method)
+{
+    switch (method) {
+        case Subvolume:
+            return i18n("btrfs snapshot");
+        case Reflink:
+            return i18n("reflink copy");
+        case Hardlink:
+            break;
+    }
+    return i18n("hard links");
+}
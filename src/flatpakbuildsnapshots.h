@@ -0,0 +1,143 @@
+/**
+ * @file flatpakbuildsnapshots.h
+ * @brief Migawki katalogu budowania z kopiowaniem przy zapisie
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKBUILDSNAPSHOTS_H
+#define FLATPAKBUILDSNAPSHOTS_H
+
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @class FlatpakBuildSnapshots
+ * @brief Magazyn migawek katalogu budowania obok samego katalogu
+ *
+ * Migawki leżą w "<katalog budowania>.snapshots/<id>", a ich opis w
+ * "<id>.json" obok. Sposób tworzenia zależy od systemu plików:
+ *
+ * 1. podwolumin btrfs, jeśli katalog budowania sam jest podwoluminem
+ *    ("btrfs subvolume snapshot" - natychmiast, niezależnie od rozmiaru);
+ * 2. kopia reflink ("cp --reflink=always") na btrfs, XFS i bcachefs -
+ *    dane są współdzielone do pierwszego zapisu;
+ * 3. drzewo twardych dowiązań ("cp -al") w pozostałych przypadkach.
+ *
+ * Twarde dowiązania są bezpieczne, bo flatpak-builder z --force-clean
+ * usuwa i tworzy katalog budowania od nowa zamiast nadpisywać pliki.
+ * Magazyn leży w tym samym katalogu nadrzędnym, więc jest na tym samym
+ * systemie plików, a odsunięcie bieżącego katalogu przy przywracaniu to
+ * zwykła zmiana nazwy.
+ */
+class FlatpakBuildSnapshots
+{
+public:
+    /**
+     * Sposób utworzenia migawki
+     */
+    enum Method {
+        Subvolume,
+        Reflink,
+        Hardlink
+    };
+
+    /**
+     * Zapisana migawka
+     */
+    struct Snapshot {
+        QString id;
+        QString path;
+        QDateTime created;
+        Method method = Hardlink;
+        QString manifest;       ///< Manifest, z którego zbudowano katalog
+    };
+
+    /**
+     * Konstruktor
+     *
+     * @param buildDir Katalog budowania
+     */
+    explicit FlatpakBuildSnapshots(const QString& buildDir);
+
+    /**
+     * @brief Zwraca katalog magazynu migawek
+     */
+    QString storePath() const;
+
+    /**
+     * @brief Zwraca migawki od najnowszej
+     */
+    QVector<Snapshot> snapshots() const;
+
+    /**
+     * @brief Zwraca migawki ponad limit, od najstarszej
+     * @param keep Liczba zachowywanych migawek
+     */
+    QVector<Snapshot> expired(int keep) const;
+
+    /**
+     * @brief Przygotowuje opis nowej migawki (katalog jeszcze nie istnieje)
+     * @param manifest Manifest, z którego zbudowano katalog
+     */
+    Snapshot prepare(const QString& manifest) const;
+
+    /**
+     * @brief Zapisuje opis utworzonej migawki
+     * @return false jeśli zapis się nie powiódł
+     */
+    bool writeMetadata(const Snapshot& snapshot) const;
+
+    /**
+     * @brief Usuwa opis migawki (sam katalog usuwa wywołujący)
+     */
+    void removeMetadata(const Snapshot& snapshot) const;
+
+    /**
+     * @brief Zwraca nieużywaną ścieżkę w magazynie na odsunięty katalog budowania
+     */
+    QString trashPath() const;
+
+    /**
+     * @brief Zwraca pozostałości po przerwanym przywracaniu
+     */
+    QStringList staleTrash() const;
+
+    /**
+     * @brief Zwraca sposoby kopiowania do wypróbowania, od najszybszego
+     * @param source Kopiowany katalog
+     */
+    static QVector<Method> methodsFor(const QString& source);
+
+    /**
+     * @brief Czy katalog jest podwoluminem btrfs
+     */
+    static bool isSubvolume(const QString& path);
+
+    /**
+     * @brief Zwraca program i argumenty kopiujące source do nieistniejącego target
+     * @param method Sposób kopiowania
+     * @param source Katalog źródłowy
+     * @param target Katalog docelowy
+     * @return Program (pierwszy element) i jego argumenty
+     */
+    static QStringList copyCommand(Method method, const QString& source, const QString& target);
+
+    /**
+     * @brief Zwraca polecenie usuwające podwolumin btrfs
+     */
+    static QStringList deleteSubvolumeCommand(const QString& path);
+
+    /**
+     * @brief Zwraca nazwę sposobu do komunikatów
+     */
+    static QString methodName(Method method);
+
+private:
+    QString m_buildDir;
+    QString m_storePath;
+};
+
+#endif // FLATPAKBUILDSNAPSHOTS_H
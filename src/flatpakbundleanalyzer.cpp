@@ -0,0 +1,492 @@
+/**
+ * @file flatpakbundleanalyzer.cpp
+ * @brief Implementacja analizy rozmiaru wyniku budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakbundleanalyzer.h"
+#include "flatpaktreemanifest.h"
+
+#include <KLocalizedString>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QRegularExpression>
+#include <QSet>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <algorithm>
+
+namespace {
+    // Tyle pozycji trafia do każdej listy w raporcie
+    const int MaxListed = 20;
+
+    // Małe pliki (np. dowiązania) nie są warte wykazywania jako duplikaty
+    const qint64 MinDuplicateSize = 4096;
+
+    // Najmniejszy plik, który może zawierać nagłówek ELF z tablicą sekcji
+    const qint64 MinElfSize = 64;
+
+    // Typ sekcji bez treści w pliku (.bss, .tbss)
+    const quint32 SectionNoBits = 8;
+
+    // Wydzielone informacje debugowania trafiają do rozszerzenia .Debug, nie do pakietu
+    const QString DebugInfoPrefix = QStringLiteral("files/lib/debug/");
+
+    struct AnalyzedFile {
+        QString relativePath;
+        qint64 size = 0;
+        quint64 inode = 0;
+        QByteArray hash;
+        qint64 strippable = 0;
+        QString module;
+    };
+
+    template<typename T>
+    T readValue(const uchar* data, bool bigEndian)
+    {
+        return bigEndian ? qFromBigEndian<T>(data) : qFromLittleEndian<T>(data);
+    }
+
+    QByteArray readFile(const QString& path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QByteArray();
+        }
+        return file.readAll();
+    }
+
+    /**
+     * Sprowadza nazwę pliku, katalogu lub modułu do postaci porównywalnej:
+     * bez prefiksu "lib", rozszerzeń i numeru wersji (libfoo-2.so.1 -> foo)
+     */
+    QString normalizedName(QString name, bool stripExtension)
+    {
+        static const QRegularExpression versionSuffix("[-_.]?[0-9][0-9.]*$");
+
+        name = name.toLower();
+        if (stripExtension) {
+            const int dot = name.indexOf('.');
+            if (dot > 0) {
+                name.truncate(dot);
+            }
+        }
+        if (name.startsWith("lib") && name.size() > 3) {
+            name.remove(0, 3);
+        }
+        name.remove(versionSuffix);
+        return name;
+    }
+
+    void collectModules(const QJsonArray& modules, const QDir& baseDir, QHash<QString, QString>& names)
+    {
+        for (const QJsonValue& value : modules) {
+            // Moduł zapisany w osobnym pliku JSON
+            if (value.isString()) {
+                const QString path = baseDir.absoluteFilePath(value.toString());
+                const QJsonDocument document = QJsonDocument::fromJson(readFile(path));
+                if (document.isObject()) {
+                    collectModules(QJsonArray{document.object()}, QFileInfo(path).absoluteDir(), names);
+                }
+                continue;
+            }
+
+            const QJsonObject module = value.toObject();
+            const QString name = module.value("name").toString();
+            const QString key = normalizedName(name, false);
+            if (!key.isEmpty() && !names.contains(key)) {
+                names.insert(key, name);
+            }
+            collectModules(module.value("modules").toArray(), baseDir, names);
+        }
+    }
+
+    /**
+     * Zgaduje moduł, który zainstalował plik: pierwszy od końca składnik
+     * ścieżki, którego nazwa odpowiada nazwie modułu manifestu
+     */
+    QString moduleForPath(const QString& relativePath, const QHash<QString, QString>& modules)
+    {
+        const QStringList components = relativePath.split('/', QString::SkipEmptyParts);
+        for (int i = components.size() - 1; i > 0; --i) {
+            const auto it = modules.constFind(normalizedName(components.at(i), true));
+            if (it != modules.constEnd()) {
+                return *it;
+            }
+        }
+        return QString();
+    }
+
+    /**
+     * Przypisuje plik do kategorii i zwraca wzorzec cleanup, który go usuwa.
+     * Ścieżka jest względna wobec files/, czyli prefiksu /app.
+     */
+    bool classify(const QString& appPath, FlatpakBundleAnalyzer::Category& category, QString& pattern)
+    {
+        if (appPath.endsWith(".a") || appPath.endsWith(".la")) {
+            category = FlatpakBundleAnalyzer::StaticLibrary;
+            pattern = appPath.endsWith(".a") ? QStringLiteral("*.a") : QStringLiteral("*.la");
+            return true;
+        }
+
+        const QStringList components = appPath.split('/', QString::SkipEmptyParts);
+        const bool underLibOrShare = !components.isEmpty()
+            && (components.first().startsWith("lib") || components.first() == "share");
+
+        // Wzorcem jest katalog aż do znalezionego składnika, np. /lib/x86_64-linux-gnu/pkgconfig
+        auto prefixUpTo = [&components](int index) {
+            return '/' + QStringList(components.mid(0, index + 1)).join('/');
+        };
+
+        for (int i = 0; i < components.size() - 1; ++i) {
+            const QString& component = components.at(i);
+            const QString parent = i > 0 ? components.at(i - 1) : QString();
+
+            if (component == "include") {
+                category = FlatpakBundleAnalyzer::Header;
+            } else if (component == "pkgconfig" && underLibOrShare) {
+                category = FlatpakBundleAnalyzer::PkgConfig;
+            } else if (component == "cmake" && i > 0 && underLibOrShare) {
+                category = FlatpakBundleAnalyzer::CMakeConfig;
+            } else if (parent == "share" && (component == "man" || component == "doc"
+                                             || component == "info" || component == "gtk-doc")) {
+                category = FlatpakBundleAnalyzer::Documentation;
+            } else {
+                continue;
+            }
+            pattern = prefixUpTo(i);
+            return true;
+        }
+        return false;
+    }
+
+    QString formatSize(qint64 bytes)
+    {
+        return QLocale().formattedDataSize(bytes);
+    }
+}
+
+qint64 FlatpakBundleAnalyzer::strippableSize(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < MinElfSize) {
+        return 0;
+    }
+
+    const QByteArray ident = file.peek(6);
+    if (!ident.startsWith("\x7f" "ELF") || ident.size() < 6) {
+        return 0;
+    }
+
+    const bool is64 = ident.at(4) == 2;
+    const bool bigEndian = ident.at(5) == 2;
+
+    const uchar* data = file.map(0, file.size());
+    if (!data) {
+        return 0;
+    }
+
+    // Położenia pól nagłówka i nagłówków sekcji według specyfikacji ELF
+    const quint64 sectionsOffset = is64 ? readValue<quint64>(data + 0x28, bigEndian)
+                                        : readValue<quint32>(data + 0x20, bigEndian);
+    const quint16 entrySize = readValue<quint16>(data + (is64 ? 0x3a : 0x2e), bigEndian);
+    const quint16 sectionCount = readValue<quint16>(data + (is64 ? 0x3c : 0x30), bigEndian);
+    const quint16 namesIndex = readValue<quint16>(data + (is64 ? 0x3e : 0x32), bigEndian);
+
+    // Porównania przez odejmowanie - pola z uszkodzonego pliku mogą przepełnić sumę
+    const quint64 fileSize = quint64(file.size());
+    if (entrySize < (is64 ? 64 : 40) || namesIndex >= sectionCount
+        || sectionsOffset > fileSize || sectionCount > (fileSize - sectionsOffset) / entrySize) {
+        return 0;
+    }
+
+    struct Section {
+        quint32 name;
+        quint32 type;
+        quint64 offset;
+        quint64 size;
+    };
+    auto section = [&](int index) {
+        const uchar* header = data + sectionsOffset + quint64(entrySize) * index;
+        Section result;
+        result.name = readValue<quint32>(header, bigEndian);
+        result.type = readValue<quint32>(header + 4, bigEndian);
+        result.offset = is64 ? readValue<quint64>(header + 0x18, bigEndian) : readValue<quint32>(header + 0x10, bigEndian);
+        result.size = is64 ? readValue<quint64>(header + 0x20, bigEndian) : readValue<quint32>(header + 0x14, bigEndian);
+        return result;
+    };
+
+    const Section names = section(namesIndex);
+    if (names.offset > fileSize || names.size > fileSize - names.offset) {
+        return 0;
+    }
+    const char* nameTable = reinterpret_cast<const char*>(data + names.offset);
+
+    qint64 strippable = 0;
+    for (int i = 0; i < sectionCount; ++i) {
+        const Section current = section(i);
+        if (current.name >= names.size || current.type == SectionNoBits) {
+            continue;
+        }
+
+        const QLatin1String name(nameTable + current.name, qstrnlen(nameTable + current.name, names.size - current.name));
+        if (name == QLatin1String(".symtab") || name == QLatin1String(".strtab")
+            || name.startsWith(QLatin1String(".debug_")) || name.startsWith(QLatin1String(".zdebug_"))) {
+            strippable += qint64(current.size);
+        }
+    }
+    return strippable;
+}
+
+QString FlatpakBundleAnalyzer::categoryName(Category category)
+{
+    switch (category) {
+        case StaticLibrary:
+            return i18n("Static libraries");
+        case Header:
+            return i18n("Headers");
+        case PkgConfig:
+            return i18n("pkg-config files");
+        case CMakeConfig:
+            return i18n("CMake package files");
+        case Documentation:
+            return i18n("Documentation");
+        case UnstrippedBinary:
+            return i18n("Unstripped binaries");
+        case CategoryCount:
+            break;
+    }
+    return QString();
+}
+
+FlatpakBundleAnalyzer::Report FlatpakBundleAnalyzer::analyze(const QString& buildDir, const QString& manifestPath,
+                                                             const QString& treeManifestPath)
+{
+    Report report;
+    report.buildDir = buildDir;
+
+    // Niezmienione pliki biorą skrót z poprzedniego spisu, reszta jest haszowana równolegle
+    const FlatpakTreeManifest tree = FlatpakTreeManifest::scan(buildDir, FlatpakTreeManifest::load(treeManifestPath));
+
+    QHash<QString, QString> modules;
+    collectModules(QJsonDocument::fromJson(readFile(manifestPath)).object().value("modules").toArray(),
+                   QFileInfo(manifestPath).absoluteDir(), modules);
+
+    QVector<AnalyzedFile> files;
+    files.reserve(tree.fileCount());
+    const auto& entries = tree.entries();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        if (!it.key().startsWith("files/")) {
+            continue;
+        }
+        if (it.key().startsWith(DebugInfoPrefix)) {
+            ++report.debugInfoFiles;
+            report.debugInfoSize += it->size;
+            continue;
+        }
+        AnalyzedFile file;
+        file.relativePath = it.key();
+        file.size = it->size;
+        file.inode = it->inode;
+        file.hash = it->hash;
+        files.append(file);
+    }
+
+    // Sprawdzanie ELF i przypisanie do modułów rozkłada się na globalną pulę wątków
+    const QDir root(buildDir);
+    QtConcurrent::blockingMap(files, [&root, &modules](AnalyzedFile& file) {
+        const QString absolutePath = root.filePath(file.relativePath);
+        if (file.size >= MinElfSize && !QFileInfo(absolutePath).isSymLink()) {
+            file.strippable = strippableSize(absolutePath);
+        }
+        file.module = moduleForPath(file.relativePath, modules);
+    });
+
+    std::sort(files.begin(), files.end(), [](const AnalyzedFile& a, const AnalyzedFile& b) {
+        return a.size > b.size || (a.size == b.size && a.relativePath < b.relativePath);
+    });
+
+    QHash<QString, qint64> dirSizes;
+    QHash<QByteArray, QVector<int>> byHash;
+    QHash<QPair<QString, QString>, qint64> cleanupSavings;
+    QHash<QString, qint64> stripSavings;
+
+    for (int i = 0; i < files.size(); ++i) {
+        const AnalyzedFile& file = files.at(i);
+        report.totalSize += file.size;
+
+        if (report.largestFiles.size() < MaxListed) {
+            report.largestFiles.append({file.relativePath, file.size, file.module});
+        }
+
+        for (int slash = file.relativePath.lastIndexOf('/'); slash > 0; slash = file.relativePath.lastIndexOf('/', slash - 1)) {
+            dirSizes[file.relativePath.left(slash)] += file.size;
+        }
+
+        if (file.size >= MinDuplicateSize && !file.hash.isEmpty()) {
+            byHash[file.hash].append(i);
+        }
+
+        if (file.strippable > 0) {
+            report.findings[UnstrippedBinary].append({file.relativePath, file.strippable, file.module});
+            stripSavings[file.module] += file.strippable;
+        }
+
+        Category category = StaticLibrary;
+        QString pattern;
+        if (classify(file.relativePath.mid(int(qstrlen("files"))), category, pattern)) {
+            report.findings[category].append({file.relativePath, file.size, file.module});
+            cleanupSavings[qMakePair(file.module, pattern)] += file.size;
+        }
+    }
+    report.fileCount = files.size();
+
+    dirSizes.remove("files");
+    for (auto it = dirSizes.constBegin(); it != dirSizes.constEnd(); ++it) {
+        report.largestDirs.append({it.key(), it.value(), moduleForPath(it.key(), modules)});
+    }
+    std::sort(report.largestDirs.begin(), report.largestDirs.end(), [](const SizedPath& a, const SizedPath& b) {
+        return a.size > b.size || (a.size == b.size && a.path < b.path);
+    });
+    if (report.largestDirs.size() > MaxListed) {
+        report.largestDirs.resize(MaxListed);
+    }
+
+    // Twarde dowiązania do tego samego i-węzła nie zajmują dodatkowego miejsca
+    for (auto it = byHash.constBegin(); it != byHash.constEnd(); ++it) {
+        if (it->size() < 2) {
+            continue;
+        }
+        Duplicate duplicate;
+        QSet<quint64> inodes;
+        for (int index : *it) {
+            if (!inodes.contains(files.at(index).inode)) {
+                inodes.insert(files.at(index).inode);
+                duplicate.paths << files.at(index).relativePath;
+            }
+        }
+        if (duplicate.paths.size() > 1) {
+            duplicate.size = files.at(it->first()).size;
+            duplicate.paths.sort();
+            report.duplicates.append(duplicate);
+        }
+    }
+    std::sort(report.duplicates.begin(), report.duplicates.end(), [](const Duplicate& a, const Duplicate& b) {
+        return a.size * (a.paths.size() - 1) > b.size * (b.paths.size() - 1);
+    });
+
+    // Propozycje są grupowane per moduł; pliki bez modułu trafiają do cleanup manifestu
+    QHash<QString, Suggestion> suggestions;
+    for (auto it = cleanupSavings.constBegin(); it != cleanupSavings.constEnd(); ++it) {
+        Suggestion& suggestion = suggestions[it.key().first];
+        suggestion.module = it.key().first;
+        suggestion.cleanup << it.key().second;
+        suggestion.savings += it.value();
+    }
+    for (Suggestion suggestion : qAsConst(suggestions)) {
+        suggestion.cleanup.sort();
+        report.suggestions.append(suggestion);
+    }
+    for (auto it = stripSavings.constBegin(); it != stripSavings.constEnd(); ++it) {
+        Suggestion suggestion;
+        suggestion.module = it.key();
+        suggestion.strip = true;
+        suggestion.savings = it.value();
+        report.suggestions.append(suggestion);
+    }
+    std::sort(report.suggestions.begin(), report.suggestions.end(), [](const Suggestion& a, const Suggestion& b) {
+        return a.savings > b.savings;
+    });
+
+    return report;
+}
+
+QString FlatpakBundleAnalyzer::Report::toText() const
+{
+    QStringList lines;
+    lines << i18n("Bundle size analysis of %1", buildDir);
+    lines << i18np("%1 file, %2 in total", "%1 files, %2 in total", fileCount, formatSize(totalSize));
+    if (debugInfoFiles > 0) {
+        lines << i18np("Not counted: %1 file of split debug information (%2) in files/lib/debug, "
+                       "exported to the .Debug extension",
+                       "Not counted: %1 files of split debug information (%2) in files/lib/debug, "
+                       "exported to the .Debug extension",
+                       debugInfoFiles, formatSize(debugInfoSize));
+    }
+
+    auto appendPaths = [&lines](const QString& title, const QVector<SizedPath>& paths) {
+        if (paths.isEmpty()) {
+            return;
+        }
+        qint64 total = 0;
+        for (const SizedPath& path : paths) {
+            total += path.size;
+        }
+
+        lines << QString() << i18n("%1 (%2)", title, formatSize(total));
+        for (int i = 0; i < paths.size() && i < MaxListed; ++i) {
+            const SizedPath& path = paths.at(i);
+            QString line = QString("  %1  %2").arg(formatSize(path.size), 10).arg(path.path);
+            if (!path.module.isEmpty()) {
+                line += QString("  [%1]").arg(path.module);
+            }
+            lines << line;
+        }
+        if (paths.size() > MaxListed) {
+            lines << i18np("  ... and %1 more", "  ... and %1 more", paths.size() - MaxListed);
+        }
+    };
+
+    appendPaths(i18n("Largest files"), largestFiles);
+    appendPaths(i18n("Largest directories"), largestDirs);
+    for (int category = 0; category < CategoryCount; ++category) {
+        appendPaths(categoryName(Category(category)), findings[category]);
+    }
+
+    if (!duplicates.isEmpty()) {
+        lines << QString() << i18n("Duplicated contents (ostree stores identical files once, "
+                                   "so these mostly point to redundant install steps)");
+        for (int i = 0; i < duplicates.size() && i < MaxListed; ++i) {
+            const Duplicate& duplicate = duplicates.at(i);
+            lines << i18n("  %1 copies of %2 (%3 redundant)", duplicate.paths.size(), formatSize(duplicate.size),
+                          formatSize(duplicate.size * (duplicate.paths.size() - 1)));
+            for (const QString& path : duplicate.paths) {
+                lines << QString("      %1").arg(path);
+            }
+        }
+        if (duplicates.size() > MaxListed) {
+            lines << i18np("  ... and %1 more", "  ... and %1 more", duplicates.size() - MaxListed);
+        }
+    }
+
+    lines << QString() << i18n("Suggested manifest changes");
+    if (suggestions.isEmpty()) {
+        lines << i18n("  None - the build output contains no development files.");
+    }
+    for (const Suggestion& suggestion : suggestions) {
+        const QString target = suggestion.module.isEmpty() ? i18n("Manifest (top level)")
+                                                           : i18n("Module \"%1\"", suggestion.module);
+        lines << i18n("  %1: saves %2", target, formatSize(suggestion.savings));
+
+        if (suggestion.strip) {
+            lines << QStringLiteral("    \"build-options\": { \"strip\": true }");
+        } else {
+            QStringList quoted;
+            for (const QString& pattern : suggestion.cleanup) {
+                quoted << '"' + pattern + '"';
+            }
+            lines << QString("    \"cleanup\": [ %1 ]").arg(quoted.join(", "));
+        }
+    }
+
+    return lines.join('\n') + '\n';
+}
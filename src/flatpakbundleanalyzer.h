@@ -0,0 +1,119 @@
+/**
+ * @file flatpakbundleanalyzer.h
+ * @brief Analiza rozmiaru wyniku budowania i propozycje wpisów cleanup
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKBUNDLEANALYZER_H
+#define FLATPAKBUNDLEANALYZER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @class FlatpakBundleAnalyzer
+ * @brief Szuka w katalogu budowania plików, które niepotrzebnie powiększają pakiet
+ *
+ * Drzewo files/ jest skanowane tak jak przed eksportem (FlatpakTreeManifest),
+ * więc skróty treści liczone są równolegle i tylko dla zmienionych plików.
+ * Pliki ELF są sprawdzane równolegle pod kątem tablic symboli i sekcji
+ * debugowania. Każde znalezisko jest przypisywane do modułu manifestu na
+ * podstawie nazw w ścieżce, a dla kategorii plików deweloperskich powstają
+ * gotowe wpisy "cleanup" z rozmiarem, który pozwolą odzyskać.
+ *
+ * Katalog files/lib/debug zawiera wydzielone informacje debugowania, które
+ * flatpak-builder przenosi do osobnego rozszerzenia .Debug - nie jest liczony
+ * do rozmiaru pakietu, a raport podaje jego rozmiar w osobnej linii.
+ */
+class FlatpakBundleAnalyzer
+{
+public:
+    /**
+     * Rodzaj znaleziska
+     */
+    enum Category {
+        StaticLibrary,      ///< Biblioteki statyczne i archiwa libtool
+        Header,             ///< Pliki nagłówkowe
+        PkgConfig,          ///< Pliki .pc
+        CMakeConfig,        ///< Pakiety konfiguracyjne CMake
+        Documentation,      ///< Strony man, info i dokumentacja
+        UnstrippedBinary,   ///< Pliki ELF z symbolami lub sekcjami debugowania
+        CategoryCount
+    };
+
+    /**
+     * Pojedynczy plik lub katalog z rozmiarem
+     */
+    struct SizedPath {
+        QString path;
+        qint64 size = 0;
+        QString module;     ///< Moduł manifestu, jeśli udało się go ustalić
+    };
+
+    /**
+     * Grupa plików o identycznej treści
+     */
+    struct Duplicate {
+        QStringList paths;
+        qint64 size = 0;    ///< Rozmiar jednej kopii
+    };
+
+    /**
+     * Propozycja zmiany w manifeście
+     */
+    struct Suggestion {
+        QString module;     ///< Moduł albo pusty dla cleanup całego manifestu
+        QStringList cleanup;
+        bool strip = false; ///< Zamiast cleanup: "build-options": {"strip": true}
+        qint64 savings = 0;
+    };
+
+    /**
+     * Wynik analizy
+     */
+    struct Report {
+        QString buildDir;
+        int fileCount = 0;
+        qint64 totalSize = 0;
+        int debugInfoFiles = 0;     ///< Pliki w files/lib/debug (poza pakietem)
+        qint64 debugInfoSize = 0;
+        QVector<SizedPath> largestFiles;
+        QVector<SizedPath> largestDirs;
+        QVector<SizedPath> findings[CategoryCount];
+        QVector<Duplicate> duplicates;
+        QVector<Suggestion> suggestions;
+
+        /**
+         * @brief Zwraca raport jako tekst do otwarcia w edytorze
+         */
+        QString toText() const;
+    };
+
+    /**
+     * @brief Analizuje katalog budowania
+     *
+     * Wywołanie blokuje; z wątku GUI należy je uruchamiać przez QtConcurrent::run.
+     *
+     * @param buildDir Katalog budowania flatpak-builder
+     * @param manifestPath Manifest, z którego brane są nazwy modułów
+     * @param treeManifestPath Spis drzewa z poprzedniego skanowania (może nie istnieć)
+     * @return Raport
+     */
+    static Report analyze(const QString& buildDir, const QString& manifestPath, const QString& treeManifestPath);
+
+    /**
+     * @brief Sprawdza, czy plik ELF zawiera symbole lub informacje debugowania
+     * @param path Ścieżka do pliku
+     * @return Łączny rozmiar sekcji do usunięcia albo 0 dla plików bez nich i nie-ELF
+     */
+    static qint64 strippableSize(const QString& path);
+
+    /**
+     * @brief Zwraca nazwę kategorii do wyświetlenia
+     */
+    static QString categoryName(Category category);
+};
+
+#endif // FLATPAKBUNDLEANALYZER_H
@@ -0,0 +1,363 @@
+/**
+ * @file flatpakchecksumjob.cpp
+ * @brief Implementacja aktualizacji sum kontrolnych źródeł manifestu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakchecksumjob.h"
+#include "flatpakbuilderconfig.h"
+#include "flatpakbuilderdebug.h"
+#include "flatpakbuilderplugin.h"
+
+#include <interfaces/icore.h>
+#include <interfaces/idocument.h>
+#include <interfaces/idocumentcontroller.h>
+
+#include <KLocalizedString>
+#include <KTextEditor/Document>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QSet>
+#include <QUrl>
+#include <QtConcurrent>
+
+namespace {
+    // Pliki pobierane w tej chwili; usuwane po przerwaniu
+    const QString PartialPrefix = QStringLiteral(".kdev-partial-");
+}
+
+FlatpakChecksumJob::FlatpakChecksumJob(FlatpakBuilderPlugin* plugin, const QString& manifestPath,
+                                       const QVector<FlatpakManifestModel::Module>& modules, const QString& stateDir)
+    : KJob(plugin)
+    , m_plugin(plugin)
+    , m_manifestPath(manifestPath)
+    , m_stateDir(stateDir)
+    , m_mirrorDir(plugin->config()->sourceMirrorDir())
+    , m_entries(FlatpakSourceChecksums::collect(modules, manifestPath))
+    , m_network(nullptr)
+    , m_hashedBytes(0)
+    , m_killed(false)
+{
+    setObjectName(i18n("Update Flatpak Source Checksums"));
+    setCapabilities(KJob::Killable);
+    connect(&m_hashing, &QFutureWatcher<void>::finished, this, &FlatpakChecksumJob::hashingFinished);
+}
+
+void FlatpakChecksumJob::start()
+{
+    m_timer.start();
+
+    if (m_entries.isEmpty()) {
+        m_summary = i18n("The manifest has no archive or file sources to check.");
+        QMetaObject::invokeMethod(this, "emitResult", Qt::QueuedConnection);
+        return;
+    }
+
+    setTotalAmount(KJob::Files, m_entries.size());
+    setProcessedAmount(KJob::Files, 0);
+
+    // Każdy adres jest pobierany raz, nawet jeśli używa go kilka modułów
+    m_index = FlatpakSourceChecksums::loadIndex(m_stateDir);
+    const QString downloadsDir = FlatpakSourceChecksums::downloadsDir(m_stateDir);
+    for (FlatpakSourceChecksums::Entry& entry : m_entries) {
+        entry.localPath = FlatpakSourceChecksums::locate(entry, m_mirrorDir, m_stateDir, m_index);
+        if (!entry.localPath.isEmpty() || entry.url.isEmpty() || m_downloads.contains(entry.url)) {
+            continue;
+        }
+        m_downloads.insert(entry.url, QDir(downloadsDir).filePath(PartialPrefix + QString::number(m_downloads.size())));
+    }
+
+    if (m_downloads.isEmpty()) {
+        startHashing();
+        return;
+    }
+
+    QDir().mkpath(downloadsDir);
+    m_network = new QNetworkAccessManager(this);
+    connect(m_network, &QNetworkAccessManager::finished, this, &FlatpakChecksumJob::downloadFinished);
+
+    for (auto it = m_downloads.constBegin(); it != m_downloads.constEnd(); ++it) {
+        auto* file = new QFile(it.value(), this);
+        if (!file->open(QIODevice::WriteOnly)) {
+            for (FlatpakSourceChecksums::Entry& entry : m_entries) {
+                if (entry.url == it.key()) {
+                    entry.error = i18n("Could not create %1: %2", it.value(), file->errorString());
+                }
+            }
+            delete file;
+            continue;
+        }
+
+        QNetworkRequest request{QUrl(it.key())};
+        request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+        QNetworkReply* reply = m_network->get(request);
+        reply->setProperty("sourceUrl", it.key());
+        file->setParent(reply);
+        m_replies.append(reply);
+
+        // Dane trafiają na dysk na bieżąco, więc duże archiwa nie leżą w pamięci
+        connect(reply, &QNetworkReply::readyRead, file, [reply, file]() {
+            file->write(reply->readAll());
+        });
+    }
+
+    if (m_replies.isEmpty()) {
+        startHashing();
+    }
+}
+
+QString FlatpakChecksumJob::summary() const
+{
+    return m_summary;
+}
+
+QStringList FlatpakChecksumJob::failures() const
+{
+    return m_failures;
+}
+
+bool FlatpakChecksumJob::doKill()
+{
+    m_killed = true;
+
+    for (QNetworkReply* reply : qAsConst(m_replies)) {
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+    }
+    m_replies.clear();
+
+    // Bieżące pliki są haszowane do końca, pozostałe nie startują
+    m_hashing.cancel();
+    m_hashing.waitForFinished();
+
+    removePartialDownloads();
+    return true;
+}
+
+void FlatpakChecksumJob::downloadFinished(QNetworkReply* reply)
+{
+    m_replies.removeOne(reply);
+    reply->deleteLater();
+    if (m_killed) {
+        return;
+    }
+
+    const QString url = reply->property("sourceUrl").toString();
+    auto* file = reply->findChild<QFile*>();
+    if (file) {
+        file->write(reply->readAll());
+        file->close();
+    }
+
+    const QString tempPath = m_downloads.value(url);
+    for (FlatpakSourceChecksums::Entry& entry : m_entries) {
+        if (entry.url != url) {
+            continue;
+        }
+        if (reply->error() != QNetworkReply::NoError || !file) {
+            entry.error = i18n("Download failed: %1", reply->errorString());
+        } else {
+            entry.localPath = tempPath;
+            entry.downloaded = true;
+        }
+    }
+
+    qCDebug(KDEV_FLATPAKBUILDER) << "Downloaded" << url << reply->error();
+    if (m_replies.isEmpty()) {
+        startHashing();
+    }
+}
+
+void FlatpakChecksumJob::startHashing()
+{
+    // Jeden przebieg na plik i algorytm, niezależnie od liczby odwołań
+    QHash<QString, int> taskIndex;
+    for (const FlatpakSourceChecksums::Entry& entry : qAsConst(m_entries)) {
+        if (entry.localPath.isEmpty()) {
+            continue;
+        }
+        const QString key = entry.algorithm + ':' + entry.localPath;
+        if (!taskIndex.contains(key)) {
+            FlatpakSourceChecksums::HashTask task;
+            task.path = entry.localPath;
+            task.algorithm = entry.algorithm;
+            taskIndex.insert(key, m_tasks.size());
+            m_tasks.append(task);
+        }
+    }
+
+    m_hashing.setFuture(QtConcurrent::map(m_tasks, &FlatpakSourceChecksums::hash));
+}
+
+void FlatpakChecksumJob::hashingFinished()
+{
+    if (m_killed) {
+        return;
+    }
+
+    QHash<QString, const FlatpakSourceChecksums::HashTask*> results;
+    for (const FlatpakSourceChecksums::HashTask& task : qAsConst(m_tasks)) {
+        results.insert(task.algorithm + ':' + task.path, &task);
+        m_hashedBytes += task.size;
+    }
+
+    int downloaded = 0;
+    for (FlatpakSourceChecksums::Entry& entry : m_entries) {
+        if (entry.localPath.isEmpty()) {
+            if (entry.error.isEmpty()) {
+                entry.error = entry.url.isEmpty() ? i18n("File %1 does not exist", entry.path)
+                                                  : i18n("Source was not found locally and could not be downloaded");
+            }
+            continue;
+        }
+
+        const FlatpakSourceChecksums::HashTask* task = results.value(entry.algorithm + ':' + entry.localPath);
+        if (!task->error.isEmpty()) {
+            entry.error = task->error;
+            continue;
+        }
+        entry.newChecksum = task->checksum;
+    }
+
+    // Pobrane pliki trafiają tam, gdzie szuka ich flatpak-builder
+    for (auto it = m_downloads.constBegin(); it != m_downloads.constEnd(); ++it) {
+        const FlatpakSourceChecksums::HashTask* task = results.value(QStringLiteral("sha256:") + it.value());
+        if (!task) {
+            task = results.value(QStringLiteral("sha512:") + it.value());
+        }
+        if (task && task->error.isEmpty()
+            && !FlatpakSourceChecksums::store(m_stateDir, it.value(), it.key(), task->checksum, &m_index).isEmpty()) {
+            ++downloaded;
+        }
+    }
+    removePartialDownloads();
+    if (downloaded > 0) {
+        FlatpakSourceChecksums::saveIndex(m_stateDir, m_index);
+    }
+
+    const int updated = applyEdits();
+
+    int unchanged = 0;
+    for (const FlatpakSourceChecksums::Entry& entry : qAsConst(m_entries)) {
+        if (!entry.error.isEmpty()) {
+            m_failures << i18n("%1 (%2): %3", entry.module, entry.url.isEmpty() ? entry.path : entry.url, entry.error);
+        } else if (!entry.changed()) {
+            ++unchanged;
+        }
+    }
+    setProcessedAmount(KJob::Files, m_entries.size());
+
+    const QLocale locale;
+    m_summary = i18n("Checked %1 sources in %2 s (%3 hashed, %4 downloaded): %5 updated, %6 unchanged, %7 failed.",
+                     m_entries.size(), locale.toString(m_timer.elapsed() / 1000.0, 'f', 1),
+                     locale.formattedDataSize(m_hashedBytes), downloaded, updated, unchanged, m_failures.size());
+    emitResult();
+}
+
+int FlatpakChecksumJob::applyEdits()
+{
+    QHash<QString, QVector<FlatpakSourceChecksums::Entry>> byFile;
+    for (const FlatpakSourceChecksums::Entry& entry : qAsConst(m_entries)) {
+        if (entry.changed()) {
+            byFile[entry.file].append(entry);
+        }
+    }
+
+    int updated = 0;
+    for (auto it = byFile.constBegin(); it != byFile.constEnd(); ++it) {
+        const QVector<FlatpakSourceChecksums::Entry>& entries = it.value();
+        KDevelop::IDocument* document = KDevelop::ICore::self()->documentController()->documentForUrl(QUrl::fromLocalFile(it.key()));
+        QSet<int> applied;
+        if (document && document->textDocument()) {
+            applied = applyToDocument(document->textDocument(), it.key(), entries);
+        } else if (!applyToFile(it.key(), entries, &applied)) {
+            continue;
+        }
+        updated += applied.size();
+
+        // Linia zmieniona od parsowania manifestu nie jest nadpisywana
+        for (int i = 0; i < entries.size(); ++i) {
+            if (!applied.contains(i) && !m_skipped.contains(entries.at(i).module)) {
+                m_failures << i18n("%1: the manifest changed during the update; run it again", entries.at(i).module);
+            }
+        }
+    }
+
+    for (const QString& module : qAsConst(m_skipped)) {
+        m_failures << i18n("%1: add the new checksum manually", module);
+    }
+    return updated;
+}
+
+QSet<int> FlatpakChecksumJob::applyToDocument(KTextEditor::Document* document, const QString& file,
+                                              const QVector<FlatpakSourceChecksums::Entry>& entries)
+{
+    const QVector<FlatpakSourceChecksums::LineEdit> edits = FlatpakSourceChecksums::edits(
+        document->textLines(), entries, FlatpakManifestModel::formatForPath(file), &m_skipped);
+
+    // Jedna transakcja - całą aktualizację cofa pojedyncze "Cofnij"
+    QSet<int> applied;
+    KTextEditor::Document::EditingTransaction transaction(document);
+    for (const FlatpakSourceChecksums::LineEdit& edit : edits) {
+        if (edit.line >= document->lines() || document->line(edit.line) != edit.expected) {
+            continue;
+        }
+        if (edit.kind == FlatpakSourceChecksums::LineEdit::InsertAfter) {
+            document->insertLine(edit.line + 1, edit.text);
+        } else {
+            document->replaceText(KTextEditor::Range(edit.line, 0, edit.line, edit.expected.size()), edit.text);
+        }
+        applied.insert(edit.source);
+    }
+    return applied;
+}
+
+bool FlatpakChecksumJob::applyToFile(const QString& file, const QVector<FlatpakSourceChecksums::Entry>& entries,
+                                     QSet<int>* applied)
+{
+    QFile input(file);
+    if (!input.open(QIODevice::ReadOnly)) {
+        m_failures << i18n("Could not read %1: %2", file, input.errorString());
+        return false;
+    }
+    QStringList lines = QString::fromUtf8(input.readAll()).split('\n');
+    input.close();
+
+    const QVector<FlatpakSourceChecksums::LineEdit> edits = FlatpakSourceChecksums::edits(
+        lines, entries, FlatpakManifestModel::formatForPath(file), &m_skipped);
+
+    for (const FlatpakSourceChecksums::LineEdit& edit : edits) {
+        if (FlatpakSourceChecksums::apply(lines, edit)) {
+            applied->insert(edit.source);
+        }
+    }
+    if (applied->isEmpty()) {
+        return true;
+    }
+
+    QSaveFile output(file);
+    if (!output.open(QIODevice::WriteOnly)
+        || output.write(lines.join('\n').toUtf8()) < 0
+        || !output.commit()) {
+        m_failures << i18n("Could not write %1: %2", file, output.errorString());
+        return false;
+    }
+    return true;
+}
+
+void FlatpakChecksumJob::removePartialDownloads()
+{
+    for (const QString& path : qAsConst(m_downloads)) {
+        if (QFileInfo::exists(path)) {
+            QFile::remove(path);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file flatpakchecksumjob.h
+ * @brief Zadanie aktualizacji sum kontrolnych źródeł manifestu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKCHECKSUMJOB_H
+#define FLATPAKCHECKSUMJOB_H
+
+#include "flatpakmanifestmodel.h"
+#include "flatpaksourcechecksums.h"
+
+#include <KJob>
+
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+class FlatpakBuilderPlugin;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+namespace KTextEditor {
+    class Document;
+}
+
+/**
+ * @class FlatpakChecksumJob
+ * @brief Pobiera brakujące źródła, haszuje je równolegle i poprawia manifest
+ *
+ * Pliki, których nie ma lokalnie, są pobierane jednocześnie (limit połączeń
+ * na serwer wyznacza QNetworkAccessManager). Następnie każdy plik jest
+ * haszowany raz, na wszystkich rdzeniach. Zmienione sumy są wpisywane w
+ * miejscu - w otwartym dokumencie jako jedna operacja do cofnięcia, w
+ * pozostałych plikach zapisem atomowym.
+ */
+class FlatpakChecksumJob : public KJob
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param plugin Wtyczka
+     * @param manifestPath Ścieżka głównego manifestu
+     * @param modules Moduły manifestu z FlatpakManifestModel::modules()
+     * @param stateDir Katalog stanu flatpak-builder (pobrane źródła)
+     */
+    FlatpakChecksumJob(FlatpakBuilderPlugin* plugin, const QString& manifestPath,
+                       const QVector<FlatpakManifestModel::Module>& modules, const QString& stateDir);
+
+    /**
+     * @brief Wyszukuje źródła i rozpoczyna pobieranie brakujących
+     */
+    void start() override;
+
+    /**
+     * @brief Zwraca podsumowanie do wyświetlenia
+     */
+    QString summary() const;
+
+    /**
+     * @brief Zwraca opis źródeł, których nie udało się sprawdzić albo zaktualizować
+     */
+    QStringList failures() const;
+
+protected:
+    /**
+     * @brief Przerywa pobieranie i haszowanie
+     */
+    bool doKill() override;
+
+private Q_SLOTS:
+    void downloadFinished(QNetworkReply* reply);
+    void hashingFinished();
+
+private:
+    void startHashing();
+    int applyEdits();
+    QSet<int> applyToDocument(KTextEditor::Document* document, const QString& file,
+                              const QVector<FlatpakSourceChecksums::Entry>& entries);
+    bool applyToFile(const QString& file, const QVector<FlatpakSourceChecksums::Entry>& entries, QSet<int>* applied);
+    void removePartialDownloads();
+
+    FlatpakBuilderPlugin* m_plugin;
+    QString m_manifestPath;
+    QString m_stateDir;
+    QString m_mirrorDir;
+    QVector<FlatpakSourceChecksums::Entry> m_entries;
+    QVector<FlatpakSourceChecksums::HashTask> m_tasks;
+    QHash<QString, QString> m_index;
+    QHash<QString, QString> m_downloads;    ///< Adres -> plik tymczasowy
+    QNetworkAccessManager* m_network;
+    QVector<QNetworkReply*> m_replies;
+    QFutureWatcher<void> m_hashing;
+    QElapsedTimer m_timer;
+    qint64 m_hashedBytes;
+    bool m_killed;
+    QStringList m_skipped;
+    QStringList m_failures;
+    QString m_summary;
+};
+
+#endif // FLATPAKCHECKSUMJOB_H
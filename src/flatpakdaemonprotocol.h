@@ -0,0 +1,102 @@
+/**
+ * @file flatpakdaemonprotocol.h
+ * @brief Wspólne definicje protokołu między wtyczką a demonem budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ *
+ * Demon nasłuchuje na gnieździe lokalnym w katalogu XDG_RUNTIME_DIR.
+ * Komunikaty to obiekty JSON zapisane w jednej linii:
+ *
+ *   klient -> demon:
+ *     {"cmd":"start","key":...,"program":...,"arguments":[...],"workingDirectory":...}
+ *     {"cmd":"attach","id":N} albo {"cmd":"attach","key":...}
+ *     {"cmd":"list"}
+ *     {"cmd":"cancel","id":N}
+ *
+ *   demon -> klient:
+ *     {"event":"attached","id":N,"log":...,"state":...,"pid":N}
+ *     {"event":"started","id":N,"pid":N}
+ *     {"event":"output","id":N,"size":N}
+ *     {"event":"finished","id":N,"exitCode":N,"crashed":bool}
+ *     {"event":"list","builds":[...]}
+ *     {"event":"error","message":...}
+ *
+ * Treść wyjścia nie przechodzi przez gniazdo. Demon dopisuje ją do pliku logu
+ * jako rekordy [kanał:1][długość:4, little endian][dane], a klienci czytają
+ * plik bezpośrednio; zdarzenie "output" mówi jedynie, że plik urósł. Dzięki
+ * temu ponowne podłączenie to odczyt pliku od początku, bez udziału demona.
+ */
+
+#ifndef FLATPAKDAEMONPROTOCOL_H
+#define FLATPAKDAEMONPROTOCOL_H
+
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QString>
+#include <QtEndian>
+
+namespace FlatpakDaemonProtocol {
+
+    /// Kanał wyjścia zapisany w nagłówku rekordu
+    const char StandardOutputRecord = 'o';
+    const char StandardErrorRecord = 'e';
+
+    /// Rozmiar nagłówka rekordu w pliku logu
+    const int RecordHeaderSize = 5;
+
+    /// Nazwa pliku wykonywalnego demona
+    inline QString daemonExecutable()
+    {
+        return QStringLiteral("kdev-flatpak-daemon");
+    }
+
+    /// Ścieżka gniazda demona (wspólna dla wszystkich sesji użytkownika)
+    inline QString socketPath()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation)
+            + QStringLiteral("/kdev-flatpak-daemon");
+    }
+
+    /// Koduje komunikat jako jedną linię JSON
+    inline QByteArray encodeMessage(const QJsonObject& message)
+    {
+        return QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    /// Koduje fragment wyjścia jako rekord pliku logu
+    inline QByteArray encodeRecord(char channel, const QByteArray& data)
+    {
+        QByteArray record(RecordHeaderSize, Qt::Uninitialized);
+        record[0] = channel;
+        qToLittleEndian<quint32>(static_cast<quint32>(data.size()), record.data() + 1);
+        return record + data;
+    }
+
+    /**
+     * @brief Wyjmuje kolejny kompletny rekord z początku bufora
+     * @param buffer Bufor z danymi pliku logu; zużyte bajty są usuwane
+     * @param channel Kanał rekordu
+     * @param data Treść rekordu
+     * @return false jeśli bufor nie zawiera jeszcze pełnego rekordu
+     */
+    inline bool takeRecord(QByteArray& buffer, char* channel, QByteArray* data)
+    {
+        if (buffer.size() < RecordHeaderSize) {
+            return false;
+        }
+
+        const quint32 size = qFromLittleEndian<quint32>(buffer.constData() + 1);
+        if (static_cast<quint32>(buffer.size() - RecordHeaderSize) < size) {
+            return false;
+        }
+
+        *channel = buffer.at(0);
+        *data = buffer.mid(RecordHeaderSize, static_cast<int>(size));
+        buffer.remove(0, RecordHeaderSize + static_cast<int>(size));
+        return true;
+    }
+}
+
+#endif // FLATPAKDAEMONPROTOCOL_H
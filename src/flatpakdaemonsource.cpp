@@ -0,0 +1,259 @@
+/**
+ * @file flatpakdaemonsource.cpp
+ * @brief Implementacja źródła wyjścia budowania prowadzonego przez demona
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakdaemonsource.h"
+#include "flatpakdaemonprotocol.h"
+
+#include <KLocalizedString>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QThread>
+#include <QTimer>
+
+#include <memory>
+
+namespace {
+    // Czas na uruchomienie demona i utworzenie przez niego gniazda
+    const int DaemonStartTimeoutMs = 5000;
+
+    // Fragment logu czytany jednorazowo; duże logi trafiają do czytnika porcjami
+    const qint64 LogChunkSize = 1 << 20;
+
+    // Czas na odpowiedź na zapytanie o trwające budowania
+    const int ListTimeoutMs = 2000;
+}
+
+FlatpakDaemonSource::FlatpakDaemonSource(const QString& key, const QString& program,
+                                         const QStringList& arguments, const QString& workingDirectory)
+    : m_socket(nullptr)
+    , m_buildId(-1)
+    , m_finished(false)
+{
+    m_request.insert("cmd", "start");
+    m_request.insert("key", key);
+    m_request.insert("program", program);
+    m_request.insert("arguments", QJsonArray::fromStringList(arguments));
+    m_request.insert("workingDirectory", workingDirectory);
+}
+
+FlatpakDaemonSource::FlatpakDaemonSource(int buildId)
+    : m_socket(nullptr)
+    , m_buildId(buildId)
+    , m_finished(false)
+{
+    m_request.insert("cmd", "attach");
+    m_request.insert("id", buildId);
+}
+
+FlatpakDaemonSource::~FlatpakDaemonSource()
+{
+}
+
+void FlatpakDaemonSource::start()
+{
+    if (!connectToDaemon()) {
+        m_finished = true;
+        emit failedToStart(i18n("Could not connect to the build daemon (%1).", FlatpakDaemonProtocol::daemonExecutable()));
+        return;
+    }
+
+    send(m_request);
+}
+
+void FlatpakDaemonSource::terminate()
+{
+    if (m_socket && m_buildId >= 0 && !m_finished) {
+        QJsonObject message;
+        message.insert("cmd", "cancel");
+        message.insert("id", m_buildId);
+        send(message);
+    }
+}
+
+void FlatpakDaemonSource::detach()
+{
+    // Budowanie trwa dalej w demonie; zamykamy tylko połączenie
+    m_finished = true;
+    if (m_socket) {
+        m_socket->disconnect(this);
+        m_socket->abort();
+    }
+}
+
+bool FlatpakDaemonSource::isFinished() const
+{
+    return m_finished;
+}
+
+void FlatpakDaemonSource::queryRunningBuild(const QString& key, QObject* context,
+                                            const std::function<void(int)>& callback)
+{
+    // Zapytanie idzie z wątku GUI przy otwieraniu projektu, więc nie czekamy
+    // na gniazdo - odpowiedź, błąd albo przekroczenie czasu kończą je raz
+    auto* socket = new QLocalSocket(context);
+    auto done = std::make_shared<bool>(false);
+    auto finish = [socket, done, callback](int buildId) {
+        if (*done) {
+            return;
+        }
+        *done = true;
+        socket->disconnect();
+        socket->abort();
+        socket->deleteLater();
+        callback(buildId);
+    };
+
+    connect(socket, &QLocalSocket::connected, socket, [socket]() {
+        QJsonObject request;
+        request.insert("cmd", "list");
+        socket->write(FlatpakDaemonProtocol::encodeMessage(request));
+    });
+    connect(socket, &QLocalSocket::readyRead, socket, [socket, key, finish]() {
+        if (!socket->canReadLine()) {
+            return;
+        }
+
+        const QJsonArray builds = QJsonDocument::fromJson(socket->readLine()).object().value("builds").toArray();
+        for (const QJsonValue& value : builds) {
+            const QJsonObject build = value.toObject();
+            const QString state = build.value("state").toString();
+            if (build.value("key").toString() == key && (state == "running" || state == "queued")) {
+                finish(build.value("id").toInt(-1));
+                return;
+            }
+        }
+        finish(-1);
+    });
+    connect(socket, QOverload<QLocalSocket::LocalSocketError>::of(&QLocalSocket::error), socket, [finish]() {
+        finish(-1);
+    });
+    QTimer::singleShot(ListTimeoutMs, socket, [finish]() {
+        finish(-1);
+    });
+
+    socket->connectToServer(FlatpakDaemonProtocol::socketPath());
+}
+
+bool FlatpakDaemonSource::connectToDaemon()
+{
+    m_socket = new QLocalSocket(this);
+    connect(m_socket, &QLocalSocket::readyRead, this, &FlatpakDaemonSource::readMessages);
+    connect(m_socket, &QLocalSocket::disconnected, this, &FlatpakDaemonSource::connectionLost);
+
+    m_socket->connectToServer(FlatpakDaemonProtocol::socketPath());
+    if (m_socket->waitForConnected(500)) {
+        return true;
+    }
+
+    // Demon jeszcze nie działa - uruchamiamy go poza drzewem procesów IDE,
+    // żeby przeżył zamknięcie KDevelop. Czekanie odbywa się w wątku czytającym
+    const QString daemon = QStandardPaths::findExecutable(FlatpakDaemonProtocol::daemonExecutable());
+    if (daemon.isEmpty() || !QProcess::startDetached(daemon, {})) {
+        return false;
+    }
+
+    for (int waited = 0; waited < DaemonStartTimeoutMs; waited += 100) {
+        m_socket->connectToServer(FlatpakDaemonProtocol::socketPath());
+        if (m_socket->waitForConnected(100)) {
+            return true;
+        }
+        QThread::msleep(100);
+    }
+
+    return false;
+}
+
+void FlatpakDaemonSource::readMessages()
+{
+    while (m_socket->canReadLine()) {
+        const QJsonDocument document = QJsonDocument::fromJson(m_socket->readLine());
+        if (document.isObject()) {
+            handleMessage(document.object());
+        }
+    }
+}
+
+void FlatpakDaemonSource::connectionLost()
+{
+    if (m_finished) {
+        return;
+    }
+
+    // Dokończ to, co demon zdążył zapisać
+    readLog();
+    m_finished = true;
+    emit output(i18n("Connection to the build daemon was lost.").toUtf8() + '\n', true);
+    emit finished(-1, QProcess::CrashExit);
+}
+
+void FlatpakDaemonSource::handleMessage(const QJsonObject& message)
+{
+    const QString event = message.value("event").toString();
+
+    if (event == QLatin1String("attached")) {
+        m_buildId = message.value("id").toInt();
+        m_log.setFileName(message.value("log").toString());
+        if (!m_log.open(QIODevice::ReadOnly)) {
+            m_finished = true;
+            emit failedToStart(i18n("Could not open build log %1", m_log.fileName()));
+            return;
+        }
+
+        // Przy ponownym podłączeniu cały dotychczasowy log jest od razu w pliku
+        readLog();
+
+        const qint64 pid = message.value("pid").toVariant().toLongLong();
+        if (pid > 0) {
+            emit started(pid);
+        }
+    } else if (event == QLatin1String("started")) {
+        emit started(message.value("pid").toVariant().toLongLong());
+    } else if (event == QLatin1String("output")) {
+        readLog();
+    } else if (event == QLatin1String("finished")) {
+        readLog();
+        m_finished = true;
+        emit finished(message.value("exitCode").toInt(),
+                      message.value("crashed").toBool() ? QProcess::CrashExit : QProcess::NormalExit);
+        m_socket->disconnect(this);
+        m_socket->disconnectFromServer();
+    } else if (event == QLatin1String("error")) {
+        m_finished = true;
+        emit failedToStart(message.value("message").toString());
+    }
+}
+
+void FlatpakDaemonSource::readLog()
+{
+    if (!m_log.isOpen()) {
+        return;
+    }
+
+    for (;;) {
+        const QByteArray chunk = m_log.read(LogChunkSize);
+        if (chunk.isEmpty()) {
+            break;
+        }
+        m_pending += chunk;
+
+        char channel = 0;
+        QByteArray data;
+        while (FlatpakDaemonProtocol::takeRecord(m_pending, &channel, &data)) {
+            emit output(data, channel == FlatpakDaemonProtocol::StandardErrorRecord);
+        }
+    }
+}
+
+void FlatpakDaemonSource::send(const QJsonObject& message)
+{
+    m_socket->write(FlatpakDaemonProtocol::encodeMessage(message));
+    m_socket->flush();
+}
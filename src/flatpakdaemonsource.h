@@ -0,0 +1,91 @@
+/**
+ * @file flatpakdaemonsource.h
+ * @brief Źródło wyjścia budowania prowadzonego przez demona
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKDAEMONSOURCE_H
+#define FLATPAKDAEMONSOURCE_H
+
+#include "flatpakoutputsource.h"
+
+#include <QFile>
+#include <QJsonObject>
+#include <QStringList>
+
+#include <functional>
+
+class QLocalSocket;
+
+/**
+ * @class FlatpakDaemonSource
+ * @brief Zleca budowanie demonowi albo podłącza się do trwającego budowania
+ *
+ * Demon (kdev-flatpak-daemon) jest uruchamiany w razie potrzeby i żyje
+ * niezależnie od KDevelop, więc budowanie przetrwa restart IDE. Wyjście
+ * jest czytane bezpośrednio z pliku logu prowadzonego przez demona, a przez
+ * gniazdo przychodzą jedynie powiadomienia o nowych danych i zakończeniu.
+ */
+class FlatpakDaemonSource : public FlatpakOutputSource
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Tworzy źródło, które zleci demonowi nowe budowanie
+     * @param key Klucz projektu, po którym można się później podłączyć
+     * @param program Program do uruchomienia
+     * @param arguments Argumenty programu
+     * @param workingDirectory Katalog roboczy
+     */
+    FlatpakDaemonSource(const QString& key, const QString& program,
+                        const QStringList& arguments, const QString& workingDirectory);
+
+    /**
+     * @brief Tworzy źródło podłączające się do budowania o danym identyfikatorze
+     * @param buildId Identyfikator budowania w demonie
+     */
+    explicit FlatpakDaemonSource(int buildId);
+
+    /**
+     * Destruktor
+     */
+    ~FlatpakDaemonSource() override;
+
+    void start() override;
+    void terminate() override;
+    void detach() override;
+    bool isFinished() const override;
+
+    /**
+     * @brief Pyta demona o trwające budowanie projektu
+     *
+     * Zapytanie nie blokuje - odpowiedź przychodzi przez pętlę zdarzeń.
+     * Demon nie jest uruchamiany, jeśli jeszcze nie działa.
+     *
+     * @param key Klucz projektu
+     * @param context Obiekt, którego usunięcie przerywa zapytanie
+     * @param callback Wywoływane dokładnie raz z identyfikatorem budowania albo -1
+     */
+    static void queryRunningBuild(const QString& key, QObject* context, const std::function<void(int)>& callback);
+
+private Q_SLOTS:
+    void readMessages();
+    void connectionLost();
+
+private:
+    bool connectToDaemon();
+    void handleMessage(const QJsonObject& message);
+    void readLog();
+    void send(const QJsonObject& message);
+
+    QJsonObject m_request;
+    QLocalSocket* m_socket;
+    QFile m_log;
+    QByteArray m_pending;
+    int m_buildId;
+    bool m_finished;
+};
+
+#endif // FLATPAKDAEMONSOURCE_H
@@ -0,0 +1,213 @@
+/**
+ * @file flatpakdependencylayer.cpp
+ * @brief Implementacja warstwy zależności
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakdependencylayer.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+namespace {
+    // Znacznik ukończonej warstwy; jego czas modyfikacji służy też do usuwania starych warstw
+    const QString ReadyStamp = QStringLiteral("kdev-layer-ready");
+
+    // Warstwa używana w ostatniej dobie może właśnie być budowana przez kogoś z zespołu
+    const qint64 MinPruneAgeSecs = 24 * 60 * 60;
+
+    // Skrót jest skracany do nazwy katalogu - kolizje przy tej długości są pomijalne
+    const int HashLength = 16;
+
+    QByteArray readFile(const QString& path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QByteArray();
+        }
+        return file.readAll();
+    }
+
+    void addLocalPath(QCryptographicHash& hash, const QDir& baseDir, const QString& path)
+    {
+        const QFileInfo info(baseDir.absoluteFilePath(path));
+        hash.addData(path.toUtf8());
+
+        if (info.isFile()) {
+            hash.addData(readFile(info.absoluteFilePath()));
+            return;
+        }
+
+        // Katalogi źródeł są opisywane listą plików z rozmiarem i czasem zmiany
+        QStringList entries;
+        QDirIterator it(info.absoluteFilePath(), QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot,
+                        QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            const QFileInfo entry = it.fileInfo();
+            entries << QString("%1:%2:%3").arg(entry.absoluteFilePath().mid(info.absoluteFilePath().size()))
+                                          .arg(entry.size())
+                                          .arg(entry.lastModified().toMSecsSinceEpoch());
+        }
+        entries.sort();
+        hash.addData(entries.join('\n').toUtf8());
+    }
+
+    void addModule(QCryptographicHash& hash, const QJsonValue& value, const QDir& baseDir);
+
+    void addSources(QCryptographicHash& hash, const QJsonArray& sources, const QDir& baseDir)
+    {
+        for (const QJsonValue& value : sources) {
+            // Źródła mogą być zapisane w osobnym pliku JSON
+            if (value.isString()) {
+                const QString path = baseDir.absoluteFilePath(value.toString());
+                const QJsonDocument document = QJsonDocument::fromJson(readFile(path));
+                hash.addData(value.toString().toUtf8());
+                if (document.isArray()) {
+                    addSources(hash, document.array(), QFileInfo(path).absoluteDir());
+                } else if (document.isObject()) {
+                    addSources(hash, QJsonArray{document.object()}, QFileInfo(path).absoluteDir());
+                }
+                continue;
+            }
+
+            const QJsonObject source = value.toObject();
+            if (source.contains("path")) {
+                addLocalPath(hash, baseDir, source.value("path").toString());
+            }
+            for (const QJsonValue& path : source.value("paths").toArray()) {
+                addLocalPath(hash, baseDir, path.toString());
+            }
+        }
+    }
+
+    void addModule(QCryptographicHash& hash, const QJsonValue& value, const QDir& baseDir)
+    {
+        // Moduł zapisany w osobnym pliku: liczy się jego treść i pliki względem niego
+        if (value.isString()) {
+            const QString path = baseDir.absoluteFilePath(value.toString());
+            const QByteArray content = readFile(path);
+            hash.addData(value.toString().toUtf8());
+            hash.addData(content);
+
+            const QJsonDocument document = QJsonDocument::fromJson(content);
+            if (document.isObject()) {
+                addModule(hash, document.object(), QFileInfo(path).absoluteDir());
+            }
+            return;
+        }
+
+        const QJsonObject module = value.toObject();
+        hash.addData(QJsonDocument(module).toJson(QJsonDocument::Compact));
+        addSources(hash, module.value("sources").toArray(), baseDir);
+
+        for (const QJsonValue& child : module.value("modules").toArray()) {
+            addModule(hash, child, baseDir);
+        }
+    }
+}
+
+FlatpakDependencyLayer::FlatpakDependencyLayer(const QString& manifestPath, const QString& layersDir)
+    : m_layersDir(layersDir)
+{
+    QJsonObject manifest = QJsonDocument::fromJson(readFile(manifestPath)).object();
+    const QJsonArray modules = manifest.take("modules").toArray();
+    if (modules.size() < 2 || !modules.last().isObject()) {
+        return;
+    }
+
+    m_appModule = modules.last().toObject().value("name").toString();
+    if (m_appModule.isEmpty()) {
+        return;
+    }
+
+    // Runtime, SDK, opcje budowania i rozszerzenia wpływają na każdy moduł;
+    // identyfikator aplikacji i polecenie nie, więc warstwę mogą dzielić warianty
+    manifest.remove("app-id");
+    manifest.remove("id");
+    manifest.remove("command");
+    manifest.remove("finish-args");
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QJsonDocument(manifest).toJson(QJsonDocument::Compact));
+
+    const QDir baseDir = QFileInfo(manifestPath).absoluteDir();
+    for (int i = 0; i < modules.size() - 1; ++i) {
+        addModule(hash, modules.at(i), baseDir);
+    }
+
+    m_hash = QString::fromLatin1(hash.result().toHex().left(HashLength));
+}
+
+bool FlatpakDependencyLayer::isValid() const
+{
+    return !m_hash.isEmpty();
+}
+
+QString FlatpakDependencyLayer::appModule() const
+{
+    return m_appModule;
+}
+
+QString FlatpakDependencyLayer::hash() const
+{
+    return m_hash;
+}
+
+QString FlatpakDependencyLayer::stateDir() const
+{
+    return QDir(m_layersDir).filePath(m_hash);
+}
+
+bool FlatpakDependencyLayer::isReady() const
+{
+    return isValid() && QFileInfo::exists(QDir(stateDir()).filePath(ReadyStamp));
+}
+
+bool FlatpakDependencyLayer::markReady() const
+{
+    if (!isValid() || !QDir().mkpath(stateDir())) {
+        return false;
+    }
+
+    QFile stamp(QDir(stateDir()).filePath(ReadyStamp));
+    if (!stamp.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    stamp.write(QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toUtf8() + '\n');
+    return true;
+}
+
+void FlatpakDependencyLayer::prune(const QString& layersDir, int keep, const QString& exceptHash)
+{
+    QFileInfoList layers = QDir(layersDir).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+
+    // Niedokończone warstwy nie mają znacznika - liczy się wtedy czas katalogu
+    auto lastUsed = [](const QFileInfo& layer) {
+        const QFileInfo stamp(QDir(layer.absoluteFilePath()).filePath(ReadyStamp));
+        return stamp.exists() ? stamp.lastModified() : layer.lastModified();
+    };
+    std::sort(layers.begin(), layers.end(), [&lastUsed](const QFileInfo& a, const QFileInfo& b) {
+        return lastUsed(a) > lastUsed(b);
+    });
+
+    const QDateTime threshold = QDateTime::currentDateTime().addSecs(-MinPruneAgeSecs);
+    int kept = 0;
+    for (const QFileInfo& layer : qAsConst(layers)) {
+        if (layer.fileName() == exceptHash || kept < keep || lastUsed(layer) > threshold) {
+            ++kept;
+            continue;
+        }
+        QDir(layer.absoluteFilePath()).removeRecursively();
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * @file flatpakdependencylayer.h
+ * @brief Warstwa zależności budowana raz i współdzielona między budowaniami
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKDEPENDENCYLAYER_H
+#define FLATPAKDEPENDENCYLAYER_H
+
+#include <QString>
+
+/**
+ * @class FlatpakDependencyLayer
+ * @brief Traktuje wszystkie moduły manifestu poza ostatnim jako jedną warstwę
+ *
+ * Warstwa to katalog stanu flatpak-builder (cache modułów i pobrane źródła)
+ * w katalogu warstw, nazwany skrótem definicji zależności: ustawień
+ * manifestu poza listą modułów, definicji modułów zależności oraz
+ * lokalnych plików, do których się odwołują. Pierwsze budowanie
+ * wypełnia warstwę przebiegiem z --stop-at=<moduł aplikacji>; kolejne
+ * budowania z tą samą definicją odtwarzają zależności z cache i kompilują
+ * tylko aplikację. Katalog warstw może leżeć na dysku współdzielonym przez
+ * zespół, ponieważ skrót nie zależy od położenia projektu.
+ */
+class FlatpakDependencyLayer
+{
+public:
+    /**
+     * Konstruktor
+     *
+     * @param manifestPath Ścieżka do manifestu (obsługiwany jest JSON)
+     * @param layersDir Katalog, w którym przechowywane są warstwy
+     */
+    FlatpakDependencyLayer(const QString& manifestPath, const QString& layersDir);
+
+    /**
+     * @brief Czy manifest da się podzielić na zależności i aplikację
+     *
+     * Wymaga manifestu JSON z co najmniej dwoma modułami, z których ostatni
+     * jest zdefiniowany bezpośrednio w manifeście.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Zwraca nazwę modułu aplikacji (ostatniego w manifeście)
+     */
+    QString appModule() const;
+
+    /**
+     * @brief Zwraca skrót definicji warstwy zależności
+     */
+    QString hash() const;
+
+    /**
+     * @brief Zwraca katalog stanu flatpak-builder dla tej warstwy
+     */
+    QString stateDir() const;
+
+    /**
+     * @brief Czy warstwa została już w całości zbudowana
+     */
+    bool isReady() const;
+
+    /**
+     * @brief Oznacza warstwę jako gotową do ponownego użycia
+     * @return false jeśli nie udało się zapisać znacznika
+     */
+    bool markReady() const;
+
+    /**
+     * @brief Usuwa najdawniej używane warstwy ponad podany limit
+     * @param layersDir Katalog warstw
+     * @param keep Liczba zachowywanych warstw
+     * @param exceptHash Warstwa, która nie może zostać usunięta
+     */
+    static void prune(const QString& layersDir, int keep, const QString& exceptHash);
+
+private:
+    QString m_layersDir;
+    QString m_appModule;
+    QString m_hash;
+};
+
+#endif // FLATPAKDEPENDENCYLAYER_H
@@ -0,0 +1,156 @@
+/**
+ * @file flatpakexportrepo.cpp
+ * @brief Implementacja utrzymania repozytorium eksportu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakexportrepo.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+
+namespace {
+    // ostree zapisuje sumy SHA-256 w base64 bez wypełnienia, z "_" zamiast "/"
+    QString toModifiedBase64(const QString& hex)
+    {
+        return QString::fromLatin1(QByteArray::fromHex(hex.toLatin1()).toBase64(QByteArray::OmitTrailingEquals))
+            .replace('/', '_');
+    }
+
+    QString fromModifiedBase64(QString b64)
+    {
+        b64.replace('_', '/');
+        return QString::fromLatin1(QByteArray::fromBase64(b64.toLatin1()).toHex());
+    }
+
+    qint64 directorySize(const QString& path)
+    {
+        qint64 size = 0;
+        QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::System, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            size += it.fileInfo().size();
+        }
+        return size;
+    }
+}
+
+FlatpakExportRepo::FlatpakExportRepo(const QString& repoPath)
+    : m_path(repoPath)
+{
+}
+
+bool FlatpakExportRepo::isValid() const
+{
+    return QFileInfo::exists(QDir(m_path).filePath("config")) && QFileInfo(QDir(m_path).filePath("objects")).isDir();
+}
+
+QStringList FlatpakExportRepo::refs() const
+{
+    const QDir heads(QDir(m_path).filePath("refs/heads"));
+    QStringList refs;
+    QDirIterator it(heads.path(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        refs << heads.relativeFilePath(it.next());
+    }
+    refs.sort();
+    return refs;
+}
+
+QString FlatpakExportRepo::commit(const QString& ref) const
+{
+    QFile file(QDir(m_path).filePath("refs/heads/" + ref));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromLatin1(file.readAll()).trimmed();
+}
+
+bool FlatpakExportRepo::hasDelta(const QString& from, const QString& to) const
+{
+    return QFileInfo::exists(QDir(m_path).filePath(deltaPath(from, to) + "/superblock"));
+}
+
+QVector<FlatpakExportRepo::Delta> FlatpakExportRepo::deltas() const
+{
+    QVector<Delta> deltas;
+    const QDir deltasDir(QDir(m_path).filePath("deltas"));
+
+    // deltas/<2 znaki>/<reszta>[-<cel>]; delta od zera ma tylko cel
+    for (const QString& prefix : deltasDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        const QDir prefixDir(deltasDir.filePath(prefix));
+        for (const QString& name : prefixDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            Delta delta;
+            const int dash = name.indexOf('-');
+            if (dash < 0) {
+                delta.to = fromModifiedBase64(prefix + name);
+            } else {
+                delta.from = fromModifiedBase64(prefix + name.left(dash));
+                delta.to = fromModifiedBase64(name.mid(dash + 1));
+            }
+            delta.size = directorySize(prefixDir.filePath(name));
+            deltas.append(delta);
+        }
+    }
+    return deltas;
+}
+
+qint64 FlatpakExportRepo::size() const
+{
+    return directorySize(m_path);
+}
+
+QStringList FlatpakExportRepo::pruneArguments(int retention, bool generateDeltas) const
+{
+    QStringList args{"build-update-repo", "--prune", QString("--prune-depth=%1").arg(retention)};
+    if (generateDeltas) {
+        // Jedno zadanie delt - utrzymanie działa w tle i nie powinno zajmować wszystkich rdzeni
+        args << "--generate-static-deltas" << "--static-delta-jobs=1";
+    }
+    args << m_path;
+    return args;
+}
+
+QStringList FlatpakExportRepo::summaryArguments() const
+{
+    return {"build-update-repo", m_path};
+}
+
+QStringList FlatpakExportRepo::logArguments(const QString& ref) const
+{
+    return {"log", "--repo=" + m_path, ref};
+}
+
+QStringList FlatpakExportRepo::parseLog(const QString& output)
+{
+    static const QRegularExpression commitRegex("^commit ([0-9a-f]{64})$", QRegularExpression::MultilineOption);
+
+    QStringList commits;
+    QRegularExpressionMatchIterator it = commitRegex.globalMatch(output);
+    while (it.hasNext()) {
+        commits << it.next().captured(1);
+    }
+    return commits;
+}
+
+QStringList FlatpakExportRepo::deltaArguments(const QString& from, const QString& to) const
+{
+    QStringList args{"static-delta", "generate", "--repo=" + m_path};
+    args << (from.isEmpty() ? QString("--empty") : "--from=" + from);
+    args << "--to=" + to;
+    return args;
+}
+
+QString FlatpakExportRepo::deltaPath(const QString& from, const QString& to)
+{
+    const QString target = toModifiedBase64(to);
+    if (from.isEmpty()) {
+        return QString("deltas/%1/%2").arg(target.left(2), target.mid(2));
+    }
+    const QString source = toModifiedBase64(from);
+    return QString("deltas/%1/%2-%3").arg(source.left(2), source.mid(2), target);
+}
@@ -0,0 +1,122 @@
+/**
+ * @file flatpakexportrepo.h
+ * @brief Utrzymanie repozytorium eksportu: przycinanie historii i delty statyczne
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKEXPORTREPO_H
+#define FLATPAKEXPORTREPO_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @class FlatpakExportRepo
+ * @brief Odczytuje stan repozytorium ostree i składa polecenia jego utrzymania
+ *
+ * "flatpak build-export" zapisuje tylko nowe obiekty, więc sam eksport jest
+ * przyrostowy; repozytorium rośnie jednak o każdy commit, a klienci bez
+ * delt statycznych pobierają pojedyncze obiekty. Utrzymanie przebiega tak:
+ *
+ * 1. "flatpak build-update-repo --prune --prune-depth=N" usuwa commity ponad
+ *    limit historii razem z ich deltami;
+ * 2. "ostree static-delta generate" tworzy brakujące delty do najnowszego
+ *    commitu od kilku poprzednich i od zera, dzięki czemu maszyna testowa
+ *    opóźniona o kilka eksportów też pobiera deltę;
+ * 3. "flatpak build-update-repo" odświeża podsumowanie z indeksem delt.
+ *
+ * Bez ostree zostają delty z "--generate-static-deltas" - tylko od rodzica
+ * i od zera. Nie łączymy obu sposobów, bo flatpak przy generowaniu kasuje
+ * delty, których sam by nie utworzył.
+ *
+ * Nazwy katalogów delt używają zmodyfikowanego base64 z ostree, co pozwala
+ * sprawdzić istnienie delty i przypisać jej rozmiar bez uruchamiania ostree.
+ */
+class FlatpakExportRepo
+{
+public:
+    /**
+     * Delta statyczna zapisana w repozytorium
+     */
+    struct Delta {
+        QString from;       ///< Commit źródłowy (hex) albo pusty dla delty od zera
+        QString to;         ///< Commit docelowy (hex)
+        qint64 size = 0;
+    };
+
+    /**
+     * Konstruktor
+     *
+     * @param repoPath Ścieżka do repozytorium ostree
+     */
+    explicit FlatpakExportRepo(const QString& repoPath);
+
+    /**
+     * @brief Czy ścieżka wskazuje repozytorium ostree
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Zwraca gałęzie repozytorium (np. app/org.example.App/x86_64/master)
+     */
+    QStringList refs() const;
+
+    /**
+     * @brief Zwraca commit wskazywany przez gałąź
+     */
+    QString commit(const QString& ref) const;
+
+    /**
+     * @brief Czy delta z from do to już istnieje
+     */
+    bool hasDelta(const QString& from, const QString& to) const;
+
+    /**
+     * @brief Zwraca wszystkie delty statyczne z rozmiarami
+     */
+    QVector<Delta> deltas() const;
+
+    /**
+     * @brief Zwraca łączny rozmiar repozytorium
+     */
+    qint64 size() const;
+
+    /**
+     * @brief Argumenty "flatpak" przycinające historię
+     * @param retention Liczba zachowywanych commitów każdej gałęzi
+     * @param generateDeltas Czy flatpak ma sam wygenerować delty od rodzica i od zera
+     */
+    QStringList pruneArguments(int retention, bool generateDeltas) const;
+
+    /**
+     * @brief Argumenty "flatpak" odświeżające tylko podsumowanie repozytorium
+     */
+    QStringList summaryArguments() const;
+
+    /**
+     * @brief Argumenty "ostree" wypisujące historię gałęzi
+     */
+    QStringList logArguments(const QString& ref) const;
+
+    /**
+     * @brief Odczytuje listę commitów z wyjścia "ostree log", od najnowszego
+     */
+    static QStringList parseLog(const QString& output);
+
+    /**
+     * @brief Argumenty "ostree" generujące deltę z from do to (pusty from - delta od zera)
+     */
+    QStringList deltaArguments(const QString& from, const QString& to) const;
+
+    /**
+     * @brief Zwraca ścieżkę katalogu delty względem repozytorium, jak w ostree
+     */
+    static QString deltaPath(const QString& from, const QString& to);
+
+private:
+    QString m_path;
+};
+
+#endif // FLATPAKEXPORTREPO_H
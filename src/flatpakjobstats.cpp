@@ -0,0 +1,151 @@
+/**
+ * @file flatpakjobstats.cpp
+ * @brief Implementacja liczników wydajności potoku wyjścia
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakjobstats.h"
+
+namespace {
+    // Liczniki są niezależne - kolejność względem innych zapisów nie ma znaczenia
+    const std::memory_order Relaxed = std::memory_order_relaxed;
+}
+
+double FlatpakJobStats::Snapshot::parseNanosPerLine() const
+{
+    return parsedLines > 0 ? double(parseNanos) / parsedLines : 0.0;
+}
+
+double FlatpakJobStats::Snapshot::appendNanosPerLine() const
+{
+    return parsedLines > 0 ? double(appendNanos) / parsedLines : 0.0;
+}
+
+double FlatpakJobStats::Snapshot::linesPerSecond() const
+{
+    return elapsedMs > 0 ? linesRead * 1000.0 / elapsedMs : 0.0;
+}
+
+QJsonObject FlatpakJobStats::Snapshot::toJson() const
+{
+    QJsonObject json;
+    json["elapsedMs"] = elapsedMs;
+    json["finished"] = finished;
+    json["bytesRead"] = bytesRead;
+    json["linesRead"] = linesRead;
+    json["linesPerSecond"] = linesPerSecond();
+    json["batches"] = batches;
+    json["problemLines"] = problemLines;
+    json["problems"] = problems;
+    json["parsedLines"] = parsedLines;
+    json["parseNanos"] = parseNanos;
+    json["parseNanosPerLine"] = parseNanosPerLine();
+    json["appendNanos"] = appendNanos;
+    json["appendNanosPerLine"] = appendNanosPerLine();
+    json["queueDepth"] = queueDepth;
+    json["maxQueueDepth"] = maxQueueDepth;
+    json["readerStalls"] = stalls;
+    json["processCpuPercent"] = cpuPercent;
+    json["processMemoryBytes"] = memoryBytes;
+    return json;
+}
+
+FlatpakJobStats::FlatpakJobStats()
+    : m_finishedMs(-1)
+    , m_bytesRead(0)
+    , m_linesRead(0)
+    , m_batches(0)
+    , m_problemLines(0)
+    , m_problems(0)
+    , m_parsedLines(0)
+    , m_parseNanos(0)
+    , m_appendNanos(0)
+    , m_queueDepth(0)
+    , m_maxQueueDepth(0)
+    , m_stalls(0)
+    , m_cpuPermille(0)
+    , m_memoryBytes(0)
+{
+    m_timer.start();
+}
+
+void FlatpakJobStats::addRead(qint64 bytes)
+{
+    m_bytesRead.fetch_add(bytes, Relaxed);
+}
+
+void FlatpakJobStats::addBatch(int lines, int problemLines, int queueDepth)
+{
+    m_linesRead.fetch_add(lines, Relaxed);
+    m_batches.fetch_add(1, Relaxed);
+    if (problemLines > 0) {
+        m_problemLines.fetch_add(problemLines, Relaxed);
+    }
+    m_queueDepth.store(queueDepth, Relaxed);
+
+    // Tylko czytnik podnosi maksimum, więc wystarczy zwykłe porównanie
+    if (queueDepth > m_maxQueueDepth.load(Relaxed)) {
+        m_maxQueueDepth.store(queueDepth, Relaxed);
+    }
+}
+
+void FlatpakJobStats::addStall()
+{
+    m_stalls.fetch_add(1, Relaxed);
+}
+
+void FlatpakJobStats::addParse(qint64 nanos, int lines)
+{
+    m_parseNanos.fetch_add(nanos, Relaxed);
+    m_parsedLines.fetch_add(lines, Relaxed);
+}
+
+void FlatpakJobStats::addAppend(qint64 nanos)
+{
+    m_appendNanos.fetch_add(nanos, Relaxed);
+}
+
+void FlatpakJobStats::setQueueDepth(int depth)
+{
+    m_queueDepth.store(depth, Relaxed);
+}
+
+void FlatpakJobStats::setProblems(int count)
+{
+    m_problems.store(count, Relaxed);
+}
+
+void FlatpakJobStats::setProcessUsage(double cpuPercent, qint64 memoryBytes)
+{
+    m_cpuPermille.store(qRound(cpuPercent * 10.0), Relaxed);
+    m_memoryBytes.store(memoryBytes, Relaxed);
+}
+
+void FlatpakJobStats::markFinished()
+{
+    qint64 expected = -1;
+    m_finishedMs.compare_exchange_strong(expected, m_timer.elapsed(), Relaxed);
+}
+
+FlatpakJobStats::Snapshot FlatpakJobStats::snapshot() const
+{
+    Snapshot snapshot;
+    const qint64 finishedMs = m_finishedMs.load(Relaxed);
+    snapshot.finished = finishedMs >= 0;
+    snapshot.elapsedMs = snapshot.finished ? finishedMs : m_timer.elapsed();
+    snapshot.bytesRead = m_bytesRead.load(Relaxed);
+    snapshot.linesRead = m_linesRead.load(Relaxed);
+    snapshot.batches = m_batches.load(Relaxed);
+    snapshot.problemLines = m_problemLines.load(Relaxed);
+    snapshot.problems = m_problems.load(Relaxed);
+    snapshot.parsedLines = m_parsedLines.load(Relaxed);
+    snapshot.parseNanos = m_parseNanos.load(Relaxed);
+    snapshot.appendNanos = m_appendNanos.load(Relaxed);
+    snapshot.queueDepth = m_queueDepth.load(Relaxed);
+    snapshot.maxQueueDepth = m_maxQueueDepth.load(Relaxed);
+    snapshot.stalls = m_stalls.load(Relaxed);
+    snapshot.cpuPercent = m_cpuPermille.load(Relaxed) / 10.0;
+    snapshot.memoryBytes = m_memoryBytes.load(Relaxed);
+    return snapshot;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file flatpakjobstats.h
+ * @brief Liczniki wydajności potoku wyjścia zadania budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKJOBSTATS_H
+#define FLATPAKJOBSTATS_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+
+#include <atomic>
+
+/**
+ * @class FlatpakJobStats
+ * @brief Liczniki i czasy etapów: odczyt, parser, model logu, kolejka, proces
+ *
+ * Liczniki są zawsze włączone. Wątek czytający i wątek GUI aktualizują je
+ * raz na porcję linii (do 1024 linii) operacjami atomowymi bez barier, więc
+ * koszt nie zależy od tego, czy ktoś je odczytuje. Panel statystyk pobiera
+ * migawkę tylko wtedy, gdy jest widoczny.
+ */
+class FlatpakJobStats
+{
+public:
+    /**
+     * Spójna na tyle, na ile pozwalają niezależne liczniki, kopia statystyk
+     */
+    struct Snapshot {
+        qint64 elapsedMs = 0;
+        bool finished = false;
+        qint64 bytesRead = 0;
+        qint64 linesRead = 0;
+        qint64 batches = 0;
+        qint64 problemLines = 0;        ///< Linie sklasyfikowane jako błąd lub ostrzeżenie
+        qint64 problems = 0;            ///< Problemy po deduplikacji
+        qint64 parsedLines = 0;
+        qint64 parseNanos = 0;
+        qint64 appendNanos = 0;
+        int queueDepth = 0;
+        int maxQueueDepth = 0;
+        qint64 stalls = 0;              ///< Ile razy czytnik czekał na miejsce w kolejce
+        double cpuPercent = 0.0;        ///< CPU drzewa procesów (100 = jeden rdzeń)
+        qint64 memoryBytes = 0;
+
+        double parseNanosPerLine() const;
+        double appendNanosPerLine() const;
+        double linesPerSecond() const;
+
+        /**
+         * @brief Zwraca statystyki jako obiekt JSON do eksportu
+         */
+        QJsonObject toJson() const;
+    };
+
+    FlatpakJobStats();
+
+    FlatpakJobStats(const FlatpakJobStats&) = delete;
+    FlatpakJobStats& operator=(const FlatpakJobStats&) = delete;
+
+    /**
+     * @brief Dolicza odczytane z potoku bajty (wątek czytający)
+     */
+    void addRead(qint64 bytes);
+
+    /**
+     * @brief Dolicza porcję linii przekazaną do kolejki (wątek czytający)
+     * @param lines Liczba linii w porcji
+     * @param problemLines Liczba linii z błędami i ostrzeżeniami
+     * @param queueDepth Liczba porcji w kolejce po wstawieniu
+     */
+    void addBatch(int lines, int problemLines, int queueDepth);
+
+    /**
+     * @brief Zapisuje, że czytnik musiał czekać na wątek GUI (wątek czytający)
+     */
+    void addStall();
+
+    /**
+     * @brief Dolicza czas parsera dla porcji linii (wątek GUI)
+     */
+    void addParse(qint64 nanos, int lines);
+
+    /**
+     * @brief Dolicza czas dopisywania porcji do modelu logu (wątek GUI)
+     */
+    void addAppend(qint64 nanos);
+
+    /**
+     * @brief Ustawia bieżącą liczbę porcji w kolejce (wątek GUI)
+     */
+    void setQueueDepth(int depth);
+
+    /**
+     * @brief Ustawia liczbę problemów po deduplikacji
+     */
+    void setProblems(int count);
+
+    /**
+     * @brief Ustawia ostatni pomiar CPU i pamięci procesu budowania
+     */
+    void setProcessUsage(double cpuPercent, qint64 memoryBytes);
+
+    /**
+     * @brief Oznacza zadanie jako zakończone; czas przestaje płynąć
+     */
+    void markFinished();
+
+    /**
+     * @brief Zwraca kopię wszystkich liczników
+     */
+    Snapshot snapshot() const;
+
+private:
+    QElapsedTimer m_timer;
+    std::atomic<qint64> m_finishedMs;
+    std::atomic<qint64> m_bytesRead;
+    std::atomic<qint64> m_linesRead;
+    std::atomic<qint64> m_batches;
+    std::atomic<qint64> m_problemLines;
+    std::atomic<qint64> m_problems;
+    std::atomic<qint64> m_parsedLines;
+    std::atomic<qint64> m_parseNanos;
+    std::atomic<qint64> m_appendNanos;
+    std::atomic<int> m_queueDepth;
+    std::atomic<int> m_maxQueueDepth;
+    std::atomic<qint64> m_stalls;
+    std::atomic<int> m_cpuPermille;
+    std::atomic<qint64> m_memoryBytes;
+};
+
+#endif // FLATPAKJOBSTATS_H
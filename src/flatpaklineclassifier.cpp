@@ -0,0 +1,79 @@
+/**
+ * @file flatpaklineclassifier.cpp
+ * @brief Implementacja klasyfikacji linii wyjścia flatpak-builder
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpaklineclassifier.h"
+
+#include <QRegularExpressionMatch>
+
+FlatpakLineClassifier::FlatpakLineClassifier()
+    : m_errorRegex("(error|ERROR|Error):(.*)")
+    , m_warningRegex("(warning|WARNING|Warning):(.*)")
+    , m_progressRegex("(\\d+)/(\\d+):.(.*)")
+    , m_moduleRegex("^Building module (\\S+)")
+{
+    // Wyrażenia są dopasowywane dla każdej linii, więc kompilujemy je od razu
+    m_errorRegex.optimize();
+    m_warningRegex.optimize();
+    m_progressRegex.optimize();
+    m_moduleRegex.optimize();
+}
+
+FlatpakOutputLine FlatpakLineClassifier::classify(const QString& text) const
+{
+    FlatpakOutputLine line;
+    line.text = text;
+    classify(line);
+    return line;
+}
+
+void FlatpakLineClassifier::classify(FlatpakOutputLine& line) const
+{
+    const QString& text = line.text;
+
+    // Szybki filtr: większość linii nie zawiera dwukropka, a bez niego
+    // żadne z wyrażeń nie może pasować
+    if (text.contains(QLatin1Char(':'))) {
+        QRegularExpressionMatch match = m_errorRegex.match(text);
+        if (match.hasMatch()) {
+            line.kind = FlatpakOutputLine::Error;
+            line.message = match.captured(2).trimmed();
+            return;
+        }
+
+        match = m_warningRegex.match(text);
+        if (match.hasMatch()) {
+            line.kind = FlatpakOutputLine::Warning;
+            line.message = match.captured(2).trimmed();
+            return;
+        }
+
+        match = m_progressRegex.match(text);
+        if (match.hasMatch()) {
+            const int total = match.captured(2).toInt();
+            if (total > 0) {
+                line.kind = FlatpakOutputLine::Progress;
+                line.progressCurrent = match.captured(1).toInt();
+                line.progressTotal = total;
+                return;
+            }
+        }
+    }
+
+    if (text.contains(QLatin1String("Building")) || text.contains(QLatin1String("Downloading")) ||
+        text.contains(QLatin1String("Installing")) || text.contains(QLatin1String("Exporting"))) {
+        line.kind = FlatpakOutputLine::Status;
+        
+        // Początek modułu wyznacza granice sekcji logu i pomiaru czasu
+        const QRegularExpressionMatch match = m_moduleRegex.match(text);
+        if (match.hasMatch()) {
+            line.module = match.captured(1);
+        }
+        return;
+    }
+
+    line.kind = FlatpakOutputLine::Plain;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file flatpaklineclassifier.h
+ * @brief Klasyfikacja linii wyjścia flatpak-builder
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKLINECLASSIFIER_H
+#define FLATPAKLINECLASSIFIER_H
+
+#include <QMetaType>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+/**
+ * @struct FlatpakOutputLine
+ * @brief Zdekodowana i sklasyfikowana linia wyjścia procesu
+ */
+struct FlatpakOutputLine
+{
+    /**
+     * Rodzaj linii
+     */
+    enum Kind {
+        Plain,      ///< Zwykła linia logu
+        Error,      ///< Komunikat o błędzie
+        Warning,    ///< Ostrzeżenie
+        Progress,   ///< Informacja o postępie (n/m)
+        Status      ///< Linia informacyjna (Building, Downloading...)
+    };
+
+    QString text;               ///< Pełny tekst linii
+    QString message;            ///< Treść błędu/ostrzeżenia (bez prefiksu)
+    QString module;             ///< Nazwa modułu dla linii "Building module ..."
+    Kind kind = Plain;
+    int progressCurrent = 0;
+    int progressTotal = 0;
+    bool fromStderr = false;    ///< Linia pochodzi ze standardowego wyjścia błędów
+    bool transient = false;     ///< Stan pośredni nadpisany znakiem \r (tylko postęp, nie jest wyświetlany)
+};
+
+/**
+ * Porcja linii przekazywana między wątkiem czytającym a wątkiem GUI
+ */
+using FlatpakOutputBatch = QVector<FlatpakOutputLine>;
+
+Q_DECLARE_METATYPE(FlatpakOutputLine)
+
+/**
+ * @class FlatpakLineClassifier
+ * @brief Rozpoznaje błędy, ostrzeżenia i postęp w liniach wyjścia
+ *
+ * Klasa nie ma stanu poza skompilowanymi wyrażeniami regularnymi i nie zależy
+ * od GUI, dzięki czemu każdy wątek czytający może mieć własną instancję.
+ */
+class FlatpakLineClassifier
+{
+public:
+    FlatpakLineClassifier();
+
+    /**
+     * @brief Klasyfikuje pojedynczą linię
+     * @param text Tekst linii (bez znaku końca linii)
+     * @return Sklasyfikowana linia
+     */
+    FlatpakOutputLine classify(const QString& text) const;
+
+    /**
+     * @brief Uzupełnia klasyfikację w istniejącej strukturze linii
+     * @param line Linia z ustawionym polem text
+     */
+    void classify(FlatpakOutputLine& line) const;
+
+private:
+    QRegularExpression m_errorRegex;
+    QRegularExpression m_warningRegex;
+    QRegularExpression m_progressRegex;
+    QRegularExpression m_moduleRegex;
+};
+
+#endif // FLATPAKLINECLASSIFIER_H
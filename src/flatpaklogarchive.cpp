@@ -0,0 +1,124 @@
+/**
+ * @file flatpaklogarchive.cpp
+ * @brief Implementacja kompaktowania i zwalniania logów zakończonych zadań
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpaklogarchive.h"
+#include "flatpakbuilderconfig.h"
+#include "flatpakbuilderdebug.h"
+#include "flatpakbuilderplugin.h"
+#include "flatpaklogmodel.h"
+
+#include <QAbstractItemView>
+#include <QAbstractProxyModel>
+#include <QApplication>
+
+#include <algorithm>
+
+FlatpakLogArchive::FlatpakLogArchive(FlatpakBuilderPlugin* plugin)
+    : QObject(plugin)
+    , m_plugin(plugin)
+{
+    connect(qApp, &QApplication::focusChanged, this, &FlatpakLogArchive::slotFocusChanged);
+}
+
+void FlatpakLogArchive::add(FlatpakLogModel* model)
+{
+    if (!model || m_logs.contains(model)) {
+        return;
+    }
+
+    m_logs.append(model);
+    m_pending.append(model);
+    compactPending();
+    enforceLimits();
+}
+
+void FlatpakLogArchive::slotFocusChanged(QWidget* old, QWidget* now)
+{
+    Q_UNUSED(old);
+    Q_UNUSED(now);
+
+    // Zmiany fokusu są częste - limity sprawdzamy tylko po kompaktowaniu
+    if (compactPending()) {
+        enforceLimits();
+    }
+}
+
+bool FlatpakLogArchive::hasFocus(const QAbstractItemModel* model)
+{
+    for (QWidget* widget = QApplication::focusWidget(); widget; widget = widget->parentWidget()) {
+        auto* view = qobject_cast<QAbstractItemView*>(widget);
+        if (!view) {
+            continue;
+        }
+
+        // Widok wyjścia może filtrować log przez model pośredni
+        const QAbstractItemModel* shown = view->model();
+        while (shown) {
+            if (shown == model) {
+                return true;
+            }
+            auto* proxy = qobject_cast<const QAbstractProxyModel*>(shown);
+            shown = proxy ? proxy->sourceModel() : nullptr;
+        }
+    }
+    return false;
+}
+
+bool FlatpakLogArchive::compactPending()
+{
+    bool compacted = false;
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (*it && hasFocus(*it)) {
+            ++it;
+            continue;
+        }
+        if (*it) {
+            (*it)->compact();
+            compacted = true;
+        }
+        it = m_pending.erase(it);
+    }
+    return compacted;
+}
+
+void FlatpakLogArchive::enforceLimits()
+{
+    // Karty zamknięte przez użytkownika usunęły już swoje modele
+    m_logs.erase(std::remove_if(m_logs.begin(), m_logs.end(), [](const QPointer<FlatpakLogModel>& log) {
+        return !log || log->isEvicted();
+    }), m_logs.end());
+
+    const int maxLogs = m_plugin->config()->finishedLogs();
+    const qint64 maxBytes = m_plugin->config()->finishedLogMemory() * qint64(1024 * 1024);
+
+    int count = m_logs.size();
+    qint64 total = 0;
+    for (const QPointer<FlatpakLogModel>& log : qAsConst(m_logs)) {
+        total += log->memoryUsage();
+    }
+
+    // Najpierw najstarsze; log, który użytkownik właśnie czyta, zostaje
+    for (auto it = m_logs.begin(); it != m_logs.end();) {
+        const bool overCount = maxLogs > 0 && count > maxLogs;
+        const bool overMemory = maxBytes > 0 && total > maxBytes;
+        if (!overCount && !overMemory) {
+            break;
+        }
+        if (hasFocus(*it)) {
+            ++it;
+            continue;
+        }
+
+        total -= (*it)->memoryUsage();
+        --count;
+        qCDebug(KDEV_FLATPAKBUILDER) << "Discarding the text of a finished build log;" << count << "logs,"
+                                     << total << "bytes kept";
+        (*it)->evict();
+        m_pending.removeAll(*it);
+        it = m_logs.erase(it);
+    }
+}
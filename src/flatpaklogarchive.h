@@ -0,0 +1,67 @@
+/**
+ * @file flatpaklogarchive.h
+ * @brief Kompaktowanie i zwalnianie logów zakończonych zadań
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKLOGARCHIVE_H
+#define FLATPAKLOGARCHIVE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+class FlatpakBuilderPlugin;
+class FlatpakLogModel;
+class QAbstractItemModel;
+class QWidget;
+
+/**
+ * @class FlatpakLogArchive
+ * @brief Pilnuje pamięci zajmowanej przez logi zakończonych zadań
+ *
+ * Widok wyjścia trzyma model logu, dopóki użytkownik nie zamknie karty, więc
+ * po dniu budowania w pamięci zostaje wiele logów. Log zakończonego zadania
+ * jest kompaktowany, gdy jego widok nie ma fokusu (od razu albo po utracie
+ * fokusu). Gdy logów jest więcej niż ustawiony limit albo zajmują razem
+ * więcej pamięci, treść najstarszych jest zwalniana - zostają nagłówki
+ * modułów z liczbą błędów i ostrzeżeń. Problemy z budowania pozostają
+ * w widoku "Problemy" niezależnie od logu.
+ */
+class FlatpakLogArchive : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param plugin Wtyczka (konfiguracja i rodzic)
+     */
+    explicit FlatpakLogArchive(FlatpakBuilderPlugin* plugin);
+
+    /**
+     * @brief Przyjmuje log zadania, które właśnie się zakończyło
+     * @param model Model logu (należy do widoku wyjścia)
+     */
+    void add(FlatpakLogModel* model);
+
+private Q_SLOTS:
+    void slotFocusChanged(QWidget* old, QWidget* now);
+
+private:
+    /**
+     * @brief Czy model jest pokazywany w widżecie z fokusem
+     */
+    static bool hasFocus(const QAbstractItemModel* model);
+
+    bool compactPending();
+    void enforceLimits();
+
+    FlatpakBuilderPlugin* m_plugin;
+    QVector<QPointer<FlatpakLogModel>> m_pending;   ///< Czekają na utratę fokusu
+    QVector<QPointer<FlatpakLogModel>> m_logs;      ///< Zakończone logi, od najstarszego
+};
+
+#endif // FLATPAKLOGARCHIVE_H
@@ -0,0 +1,333 @@
+/**
+ * @file flatpaklogindex.cpp
+ * @brief Implementacja przyrostowego indeksu trigramowego logu budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpaklogindex.h"
+
+#include <algorithm>
+
+namespace {
+    // Liczba wpisów list w pamięci, po przekroczeniu której indeks trafia na dysk (~16 MB)
+    const qint64 MaxMemoryEntries = 4 * 1024 * 1024;
+
+    // Trigram to trzy 8-bitowe znaki, więc przestrzeń kluczy ma 2^24 elementów
+    const quint32 TrigramSpace = 1u << 24;
+
+    void writeVarint(QByteArray& out, quint32 value)
+    {
+        while (value >= 0x80) {
+            out.append(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.append(static_cast<char>(value));
+    }
+
+    QVector<quint32> intersect(const QVector<quint32>& a, const QVector<quint32>& b)
+    {
+        QVector<quint32> result;
+        std::set_intersection(a.constBegin(), a.constEnd(), b.constBegin(), b.constEnd(),
+                              std::back_inserter(result));
+        return result;
+    }
+}
+
+FlatpakLogIndex::FlatpakLogIndex(const QString& spillPath)
+    : m_blockSeen(TrigramSpace, false)
+    , m_spillFile(spillPath)
+    , m_memoryEntries(0)
+    , m_lineCount(0)
+{
+}
+
+FlatpakLogIndex::~FlatpakLogIndex()
+{
+    if (m_spillFile.isOpen()) {
+        m_spillFile.close();
+    }
+    m_spillFile.remove();
+}
+
+quint32 FlatpakLogIndex::foldChar(QChar ch)
+{
+    // Wyszukiwanie ignoruje wielkość liter; znaki spoza ASCII składamy do 8 bitów,
+    // co może dać fałszywych kandydatów, ale nigdy nie gubi trafień
+    ushort code = ch.unicode();
+    if (code >= 'A' && code <= 'Z') {
+        code += 'a' - 'A';
+    } else if (code > 0x7f) {
+        code = QChar(code).toLower().unicode();
+    }
+    return code & 0xff;
+}
+
+void FlatpakLogIndex::addLine(const QString& text)
+{
+    if (m_blockSeen.empty()) {
+        m_blockSeen.assign(TrigramSpace, false);
+    }
+
+    const int length = text.size();
+    if (length >= 3) {
+        quint32 key = (foldChar(text.at(0)) << 8) | foldChar(text.at(1));
+        for (int i = 2; i < length; ++i) {
+            key = ((key << 8) | foldChar(text.at(i))) & (TrigramSpace - 1);
+            if (!m_blockSeen[key]) {
+                m_blockSeen[key] = true;
+                m_blockTrigrams.append(key);
+            }
+        }
+    }
+
+    ++m_lineCount;
+    if (m_lineCount % BlockSize == 0) {
+        flushBlock();
+    }
+}
+
+void FlatpakLogIndex::seal()
+{
+    flushBlock();
+    if (!m_postings.isEmpty()) {
+        spill();
+    }
+
+    std::vector<bool>().swap(m_blockSeen);
+    m_blockTrigrams = QVector<quint32>();
+}
+
+int FlatpakLogIndex::lineCount() const
+{
+    return m_lineCount;
+}
+
+QVector<quint32> FlatpakLogIndex::candidateBlocks(const QStringList& literals, bool* ok) const
+{
+    QVector<quint32> trigrams;
+    for (const QString& literal : literals) {
+        for (int i = 2; i < literal.size(); ++i) {
+            trigrams.append((foldChar(literal.at(i - 2)) << 16) | (foldChar(literal.at(i - 1)) << 8)
+                            | foldChar(literal.at(i)));
+        }
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    if (trigrams.isEmpty()) {
+        *ok = false;
+        return {};
+    }
+
+    *ok = true;
+
+    QVector<quint32> result;
+    bool first = true;
+    for (quint32 trigram : qAsConst(trigrams)) {
+        const QVector<quint32> blocks = postings(trigram);
+        result = first ? blocks : intersect(result, blocks);
+        first = false;
+        if (result.isEmpty()) {
+            break;
+        }
+    }
+
+    // Blok domknięty przez seal() i uzupełniony później występuje dwukrotnie
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+qint64 FlatpakLogIndex::memoryUsage() const
+{
+    return m_memoryEntries * static_cast<qint64>(sizeof(quint32))
+        + m_postings.size() * static_cast<qint64>(sizeof(QVector<quint32>) + sizeof(quint32))
+        + static_cast<qint64>(m_blockSeen.empty() ? 0 : TrigramSpace / 8);
+}
+
+QStringList FlatpakLogIndex::requiredLiterals(const QString& query, bool isRegex)
+{
+    if (!isRegex) {
+        return {query};
+    }
+
+    // Alternatywa sprawia, że żaden fragment nie jest obowiązkowy
+    if (query.contains(QLatin1Char('|'))) {
+        return {};
+    }
+
+    QStringList literals;
+    QString current;
+    int depth = 0;
+    bool inClass = false;
+
+    auto endLiteral = [&literals, &current]() {
+        if (!current.isEmpty()) {
+            literals.append(current);
+            current.clear();
+        }
+    };
+
+    for (int i = 0; i < query.size(); ++i) {
+        const QChar ch = query.at(i);
+
+        if (inClass) {
+            if (ch == QLatin1Char('\\')) {
+                ++i;
+            } else if (ch == QLatin1Char(']')) {
+                inClass = false;
+            }
+            continue;
+        }
+
+        switch (ch.unicode()) {
+            case '\\': {
+                const QChar next = i + 1 < query.size() ? query.at(i + 1) : QChar();
+                ++i;
+                // \w, \d, \b itd. to klasy albo kotwice, a nie literały
+                if (next.isNull() || next.isLetterOrNumber()) {
+                    endLiteral();
+                } else if (depth == 0) {
+                    current.append(next);
+                }
+                break;
+            }
+            case '[':
+                endLiteral();
+                inClass = true;
+                break;
+            case '(':
+                endLiteral();
+                ++depth;
+                break;
+            case ')':
+                depth = qMax(0, depth - 1);
+                break;
+            case '*':
+            case '?':
+            case '{':
+                // Poprzedni znak jest opcjonalny
+                current.chop(1);
+                endLiteral();
+                if (ch == QLatin1Char('{')) {
+                    while (i < query.size() && query.at(i) != QLatin1Char('}')) {
+                        ++i;
+                    }
+                }
+                break;
+            case '+':
+            case '.':
+            case '^':
+            case '$':
+                endLiteral();
+                break;
+            default:
+                if (depth == 0) {
+                    current.append(ch);
+                } else {
+                    endLiteral();
+                }
+                break;
+        }
+    }
+
+    endLiteral();
+    return literals;
+}
+
+void FlatpakLogIndex::flushBlock()
+{
+    if (m_blockTrigrams.isEmpty()) {
+        return;
+    }
+
+    const quint32 block = static_cast<quint32>((m_lineCount - 1) / BlockSize);
+    for (quint32 key : qAsConst(m_blockTrigrams)) {
+        m_postings[key].append(block);
+        m_blockSeen[key] = false;
+    }
+
+    m_memoryEntries += m_blockTrigrams.size();
+    m_blockTrigrams.clear();
+
+    if (m_memoryEntries > MaxMemoryEntries) {
+        spill();
+    }
+}
+
+void FlatpakLogIndex::spill()
+{
+    if (!m_spillFile.isOpen() && !m_spillFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        // Bez miejsca na dysku indeks po prostu zostaje w pamięci
+        return;
+    }
+
+    Segment segment;
+    segment.entries.reserve(m_postings.size());
+
+    qint64 offset = m_spillFile.size();
+    QByteArray buffer;
+    buffer.reserve(static_cast<int>(m_memoryEntries * 2));
+
+    for (auto it = m_postings.constBegin(); it != m_postings.constEnd(); ++it) {
+        const int start = buffer.size();
+        quint32 previous = 0;
+        for (quint32 block : it.value()) {
+            writeVarint(buffer, block - previous);
+            previous = block;
+        }
+        segment.entries.insert(it.key(), qMakePair(offset + start, static_cast<quint32>(it.value().size())));
+    }
+
+    m_spillFile.seek(offset);
+    if (m_spillFile.write(buffer) != buffer.size()) {
+        return;
+    }
+    m_spillFile.flush();
+
+    m_segments.append(segment);
+    m_postings.clear();
+    m_memoryEntries = 0;
+}
+
+QVector<quint32> FlatpakLogIndex::postings(quint32 trigram) const
+{
+    QVector<quint32> result;
+
+    // Segmenty obejmują rozłączne, rosnące zakresy bloków, więc wystarczy je sklejać
+    for (const Segment& segment : m_segments) {
+        const auto it = segment.entries.constFind(trigram);
+        if (it == segment.entries.constEnd()) {
+            continue;
+        }
+
+        m_spillFile.seek(it.value().first);
+        const QByteArray data = m_spillFile.read(static_cast<qint64>(it.value().second) * 5);
+
+        quint32 previous = 0;
+        int position = 0;
+        for (quint32 n = 0; n < it.value().second && position < data.size(); ++n) {
+            quint32 value = 0;
+            int shift = 0;
+            uchar byte;
+            do {
+                byte = static_cast<uchar>(data.at(position++));
+                value |= static_cast<quint32>(byte & 0x7f) << shift;
+                shift += 7;
+            } while ((byte & 0x80) && position < data.size());
+
+            previous += value;
+            result.append(previous);
+        }
+    }
+
+    result += m_postings.value(trigram);
+
+    // Bieżący, niedomknięty blok
+    if (!m_blockSeen.empty() && m_blockSeen[trigram]) {
+        result.append(static_cast<quint32>(m_lineCount / BlockSize));
+    }
+
+    return result;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file flatpaklogindex.h
+ * @brief Przyrostowy indeks trigramowy logu budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKLOGINDEX_H
+#define FLATPAKLOGINDEX_H
+
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <vector>
+
+/**
+ * @class FlatpakLogIndex
+ * @brief Indeks trigramów budowany na bieżąco z dopisywanych linii
+ *
+ * Linie są grupowane w bloki o stałej wielkości, a indeks przechowuje dla
+ * każdego trigramu (małe litery, trzy kolejne znaki) posortowaną listę bloków,
+ * w których wystąpił. Wyszukiwanie przecina listy dla trigramów zapytania
+ * i zwraca bloki-kandydatów, które trzeba jeszcze zweryfikować na tekście.
+ *
+ * Listy w pamięci mają ograniczony rozmiar - po przekroczeniu limitu są
+ * zrzucane do pliku segmentu obok logu, a w pamięci zostaje tylko słownik
+ * przesunięć segmentu.
+ */
+class FlatpakLogIndex
+{
+public:
+    /**
+     * Liczba linii w jednym bloku indeksu
+     */
+    static const int BlockSize = 64;
+
+    /**
+     * Konstruktor
+     *
+     * @param spillPath Plik, do którego zrzucane są segmenty indeksu
+     */
+    explicit FlatpakLogIndex(const QString& spillPath);
+
+    /**
+     * Destruktor
+     */
+    ~FlatpakLogIndex();
+
+    FlatpakLogIndex(const FlatpakLogIndex&) = delete;
+    FlatpakLogIndex& operator=(const FlatpakLogIndex&) = delete;
+
+    /**
+     * @brief Dodaje kolejną linię do indeksu
+     * @param text Tekst linii (bez formatowania)
+     */
+    void addLine(const QString& text);
+
+    /**
+     * @brief Zamyka indeks zakończonego logu
+     *
+     * Domyka bieżący blok, zrzuca listy na dysk i zwalnia mapę trigramów
+     * bieżącego bloku (2 MiB). Kolejne linie nadal mogą być dodawane.
+     */
+    void seal();
+
+    /**
+     * @brief Zwraca liczbę zaindeksowanych linii
+     */
+    int lineCount() const;
+
+    /**
+     * @brief Zwraca bloki, które mogą zawierać wszystkie podane fragmenty
+     *
+     * @param literals Fragmenty tekstu, które muszą wystąpić w linii
+     * @param ok Ustawiane na false, jeśli indeks nie zawęża wyniku (zbyt krótkie fragmenty)
+     * @return Posortowane numery bloków
+     */
+    QVector<quint32> candidateBlocks(const QStringList& literals, bool* ok) const;
+
+    /**
+     * @brief Zwraca przybliżone zużycie pamięci przez listy w pamięci (w bajtach)
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief Wyciąga z zapytania fragmenty, które muszą wystąpić w trafieniu
+     *
+     * Dla zwykłego tekstu jest to samo zapytanie. Dla wyrażenia regularnego
+     * zwracane są ciągi literałów poza grupami i klasami znaków; wyrażenia
+     * z alternatywą "|" nie dają żadnych fragmentów (potrzebny pełny przegląd).
+     *
+     * @param query Zapytanie
+     * @param isRegex Czy zapytanie jest wyrażeniem regularnym
+     * @return Lista wymaganych fragmentów
+     */
+    static QStringList requiredLiterals(const QString& query, bool isRegex);
+
+private:
+    /**
+     * Słownik jednego segmentu zrzuconego na dysk
+     */
+    struct Segment {
+        QHash<quint32, QPair<qint64, quint32>> entries;  ///< trigram -> (przesunięcie, liczba bloków)
+    };
+
+    static quint32 foldChar(QChar ch);
+    void flushBlock();
+    void spill();
+    QVector<quint32> postings(quint32 trigram) const;
+
+    QHash<quint32, QVector<quint32>> m_postings;
+    QVector<Segment> m_segments;
+    std::vector<bool> m_blockSeen;      ///< Trigramy widziane w bieżącym bloku
+    QVector<quint32> m_blockTrigrams;   ///< Lista do wyczyszczenia m_blockSeen
+    mutable QFile m_spillFile;
+    qint64 m_memoryEntries;
+    int m_lineCount;
+};
+
+#endif // FLATPAKLOGINDEX_H
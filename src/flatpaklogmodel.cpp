@@ -0,0 +1,817 @@
+/**
+ * @file flatpaklogmodel.cpp
+ * @brief Implementacja modelu logu budowania podzielonego na sekcje modułów
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpaklogmodel.h"
+#include "flatpaklogindex.h"
+#include "flatpakbuilderdebug.h"
+
+#include <KLocalizedString>
+
+#include <QDir>
+#include <QRegularExpressionMatch>
+#include <QTemporaryDir>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <climits>
+
+namespace {
+    // Kompresja ma być szybka - log zakończonego modułu zwykle nie jest już czytany
+    const int CompressionLevel = 1;
+
+    // Ile skompresowanych sekcji trzymamy w pamięci, zanim trafią do pliku
+    const qint64 MaxCompressedInMemory = 32 * 1024 * 1024;
+
+    // Linie w jednym fragmencie; numer linii wyznacza fragment bez indeksu
+    const int ChunkLines = 512;
+
+    // Zdekompresowane fragmenty - wystarcza na ekran widoku i przejście między trafieniami
+    const int CachedChunks = 8;
+
+    // Usuwa formatowanie nałożone przez FlatpakBuildOutputParser
+    QString stripMarkup(const QString& text)
+    {
+        if (!text.startsWith(QLatin1String("<span")) || !text.endsWith(QLatin1String("</span>"))) {
+            return text;
+        }
+
+        const int start = text.indexOf(QLatin1Char('>')) + 1;
+        return text.mid(start, text.size() - start - 7);
+    }
+
+    // Rozpakowuje linie skompresowanego fragmentu
+    QStringList decodeChunk(const QByteArray& compressed)
+    {
+        return QString::fromUtf8(qUncompress(compressed)).split(QLatin1Char('\n'));
+    }
+}
+
+FlatpakLogModel::FlatpakLogModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , m_rowCount(0)
+    , m_lineTotal(0)
+    , m_storageDir(new QTemporaryDir(QDir::tempPath() + "/kdevflatpak-log-XXXXXX"))
+    , m_compressedInMemory(0)
+    , m_searchActive(false)
+    , m_compacted(false)
+    , m_evicted(false)
+    , m_chunkCache(CachedChunks)
+{
+    // Indeks i zrzucone sekcje leżą razem w katalogu usuwanym wraz z modelem
+    m_index.reset(new FlatpakLogIndex(m_storageDir->filePath("index.bin")));
+    m_spillFile.setFileName(m_storageDir->filePath("log.bin"));
+
+    connect(&m_searchWatcher, &QFutureWatcher<QVector<int>>::finished, this, &FlatpakLogModel::searchScanned);
+
+    // Linie przed pierwszym modułem (pobieranie źródeł itp.) nie mają nagłówka
+    m_sections.append(Section());
+    m_sectionStarts.append(0);
+}
+
+FlatpakLogModel::~FlatpakLogModel()
+{
+    // Wyszukiwanie w tle pracuje na własnej kopii sekcji, wystarczy je zatrzymać
+    cancelSearch();
+
+    // Indeks musi zamknąć swój plik, zanim katalog zostanie usunięty
+    m_index.reset();
+    m_spillFile.close();
+}
+
+int FlatpakLogModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+QVariant FlatpakLogModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rowCount) {
+        return QVariant();
+    }
+
+    const int sectionIndex = sectionForRow(index.row());
+    const Section& section = m_sections.at(sectionIndex);
+    int line = index.row() - m_sectionStarts.at(sectionIndex);
+
+    if (section.hasHeader()) {
+        if (line == 0) {
+            if (role == Qt::DisplayRole) {
+                return headerText(section);
+            }
+            if (role == Qt::ToolTipRole) {
+                if (m_evicted) {
+                    return QVariant();
+                }
+                return section.expanded ? i18n("Activate to collapse this module")
+                                        : i18n("Activate to expand this module");
+            }
+            return QVariant();
+        }
+        --line;
+    }
+
+    if (role == Qt::DisplayRole) {
+        return lineAt(sectionIndex, line);
+    }
+
+    return QVariant();
+}
+
+void FlatpakLogModel::appendBatch(const FlatpakOutputBatch& batch, const QStringList& texts)
+{
+    // Komunikaty dopisane do skompaktowanego logu dostają nową sekcję
+    if (m_sections.last().state != Section::Running) {
+        beginSection(QString());
+    }
+
+    QStringList pending;
+    pending.reserve(batch.size());
+
+    // Wiersze dopisujemy grupami, żeby widok dostał jedno powiadomienie na porcję
+    auto flush = [this, &pending]() {
+        if (pending.isEmpty()) {
+            return;
+        }
+
+        const int sectionIndex = m_sections.size() - 1;
+        Section& section = m_sections.last();
+        if (section.expanded) {
+            beginInsertRows(QModelIndex(), m_rowCount, m_rowCount + pending.size() - 1);
+        }
+
+        section.lines += pending;
+        section.lineCount += pending.size();
+        m_lineTotal += pending.size();
+
+        if (section.expanded) {
+            m_rowCount += pending.size();
+            endInsertRows();
+        }
+
+        if (section.hasHeader()) {
+            const QModelIndex header = index(m_sectionStarts.at(sectionIndex));
+            emit dataChanged(header, header);
+        }
+
+        pending.clear();
+    };
+
+    for (int i = 0; i < batch.size(); ++i) {
+        const FlatpakOutputLine& line = batch.at(i);
+        if (line.transient) {
+            continue;
+        }
+
+        if (!line.module.isEmpty()) {
+            flush();
+            closeSection(true);
+            beginSection(line.module);
+        }
+
+        Section& section = m_sections.last();
+        if (line.kind == FlatpakOutputLine::Error) {
+            section.errorLines.append(section.lineCount + pending.size());
+        } else if (line.kind == FlatpakOutputLine::Warning) {
+            ++section.warningCount;
+        }
+
+        if (m_index) {
+            m_index->addLine(line.text);
+        }
+        pending.append(texts.value(i));
+    }
+
+    flush();
+}
+
+void FlatpakLogModel::appendLine(const QString& text)
+{
+    FlatpakOutputLine line;
+    line.text = text;
+    appendBatch({line}, {text});
+}
+
+void FlatpakLogModel::finish(bool success)
+{
+    closeSection(success);
+
+    // Komunikaty końcowe zadania nie należą do żadnego modułu
+    beginSection(QString());
+}
+
+void FlatpakLogModel::setSectionExpanded(int sectionIndex, bool expanded)
+{
+    if (sectionIndex < 0 || sectionIndex >= m_sections.size()) {
+        return;
+    }
+
+    Section& section = m_sections[sectionIndex];
+    if (section.expanded == expanded || !section.hasHeader() || (expanded && m_evicted)) {
+        return;
+    }
+
+    const int first = m_sectionStarts.at(sectionIndex) + 1;
+
+    if (expanded) {
+        // Treść jest dekompresowana dopiero przy wyświetlaniu wierszy
+        if (section.lineCount > 0) {
+            beginInsertRows(QModelIndex(), first, first + section.lineCount - 1);
+        }
+        section.expanded = true;
+        m_rowCount += section.lineCount;
+        updateSectionStarts(sectionIndex + 1);
+        if (section.lineCount > 0) {
+            endInsertRows();
+        }
+    } else {
+        if (section.lineCount > 0) {
+            beginRemoveRows(QModelIndex(), first, first + section.lineCount - 1);
+        }
+        section.expanded = false;
+        m_rowCount -= section.lineCount;
+        updateSectionStarts(sectionIndex + 1);
+
+        // Zakończone sekcje trzymamy wyłącznie w postaci skompresowanej
+        if (section.state != Section::Running && !section.chunks.isEmpty()) {
+            section.lines = QStringList();
+        }
+
+        if (section.lineCount > 0) {
+            endRemoveRows();
+        }
+    }
+
+    const QModelIndex header = index(first - 1);
+    emit dataChanged(header, header);
+}
+
+int FlatpakLogModel::sectionCount() const
+{
+    return m_sections.size();
+}
+
+QString FlatpakLogModel::sectionName(int section) const
+{
+    return m_sections.value(section).name;
+}
+
+QStringList FlatpakLogModel::completedModules() const
+{
+    QStringList modules;
+    for (const Section& section : m_sections) {
+        if (section.hasHeader() && section.state == Section::Succeeded) {
+            modules << section.name;
+        }
+    }
+    return modules;
+}
+
+qint64 FlatpakLogModel::compressedSize() const
+{
+    return m_compressedInMemory;
+}
+
+qint64 FlatpakLogModel::memoryUsage() const
+{
+    qint64 bytes = m_compressedInMemory + (m_index ? m_index->memoryUsage() : 0);
+    for (const Section& section : m_sections) {
+        for (const QString& line : section.lines) {
+            bytes += line.size() * static_cast<qint64>(sizeof(QChar));
+        }
+    }
+    return bytes;
+}
+
+void FlatpakLogModel::compact()
+{
+    if (m_compacted || m_evicted) {
+        return;
+    }
+
+    // Zadanie przerwane przed końcem procesu nie domknęło bieżącego modułu
+    const Section& last = m_sections.last();
+    closeSection(!last.hasHeader());
+
+    // Rozwinięte sekcje zostają rozwinięte; ich wiersze czytają z fragmentów
+    const qint64 before = memoryUsage();
+    for (Section& section : m_sections) {
+        compressSection(section);
+        if (!section.chunks.isEmpty()) {
+            section.lines = QStringList();
+        }
+    }
+
+    if (m_compressedInMemory > MaxCompressedInMemory) {
+        spillSections();
+    }
+
+    m_index->seal();
+    m_chunkCache.clear();
+    m_compacted = true;
+
+    qCDebug(KDEV_FLATPAKBUILDER) << "Compacted build log of" << m_lineTotal << "lines from" << before
+                                 << "to" << memoryUsage() << "bytes";
+}
+
+bool FlatpakLogModel::isCompacted() const
+{
+    return m_compacted;
+}
+
+void FlatpakLogModel::evict()
+{
+    if (m_evicted) {
+        return;
+    }
+
+    beginResetModel();
+
+    // Zostają nagłówki z liczbą linii, ostrzeżeń i błędów; linie spoza modułów znikają
+    for (Section& section : m_sections) {
+        section.expanded = false;
+        section.lines = QStringList();
+        section.chunks.clear();
+    }
+
+    Section notice;
+    notice.state = Section::Succeeded;
+    notice.firstLine = m_lineTotal;
+    notice.lines << i18n("The text of this log was discarded to free memory; only module summaries are kept.");
+    notice.lineCount = 1;
+    m_sections.append(notice);
+    m_sectionStarts.append(0);
+    ++m_lineTotal;
+
+    m_sectionStarts[0] = 0;
+    updateSectionStarts(1);
+    m_rowCount = m_sectionStarts.last() + notice.rowCount();
+
+    m_index.reset();
+    m_spillFile.close();
+    m_spillFile.remove();
+    m_compressedInMemory = 0;
+    m_chunkCache.clear();
+    const bool wasSearching = isSearching();
+    cancelSearch();
+    m_searchActive = false;
+    m_searchHits.clear();
+    m_evicted = true;
+
+    endResetModel();
+
+    // Zwolniony log nie ma już czego szukać - przerwane wyszukiwanie kończy się bez trafień
+    if (wasSearching) {
+        emit searchFinished(0);
+    }
+}
+
+bool FlatpakLogModel::isEvicted() const
+{
+    return m_evicted;
+}
+
+bool FlatpakLogModel::search(const QString& query, bool isRegex)
+{
+    cancelSearch();
+    m_searchHits.clear();
+    m_searchActive = false;
+    if (query.isEmpty() || m_evicted) {
+        emit searchFinished(0);
+        return true;
+    }
+
+    if (isRegex && !QRegularExpression(query).isValid()) {
+        return false;
+    }
+
+    // Indeks zwraca bloki-kandydatów; tylko ich linie są sprawdzane dokładnie
+    QVector<QPair<int, int>> ranges;
+    bool narrowed = false;
+    const QVector<quint32> blocks = m_index->candidateBlocks(FlatpakLogIndex::requiredLiterals(query, isRegex),
+                                                              &narrowed);
+    if (narrowed) {
+        for (quint32 block : blocks) {
+            const int first = static_cast<int>(block) * FlatpakLogIndex::BlockSize;
+            const int last = qMin(first + FlatpakLogIndex::BlockSize, m_lineTotal);
+            // Sąsiednie bloki łączymy w jeden zakres
+            if (!ranges.isEmpty() && ranges.last().second == first) {
+                ranges.last().second = last;
+            } else if (first < last) {
+                ranges.append(qMakePair(first, last));
+            }
+        }
+    } else if (m_lineTotal > 0) {
+        ranges.append(qMakePair(0, m_lineTotal));
+    }
+
+    // Sekcje są współdzielone niejawnie - kopia nie kopiuje linii ani fragmentów,
+    // a dopisywanie do logu w trakcie wyszukiwania nie zmienia tej kopii
+    const QVector<Section> sections = m_sections;
+    const QString spillPath = m_spillFile.fileName();
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_searchCancelled = cancelled;
+
+    m_searchWatcher.setFuture(QtConcurrent::run([sections, ranges, query, isRegex, spillPath, cancelled]() {
+        return scanLines(sections, ranges, query, isRegex, spillPath, cancelled);
+    }));
+    return true;
+}
+
+bool FlatpakLogModel::isSearching() const
+{
+    return m_searchCancelled != nullptr;
+}
+
+void FlatpakLogModel::clearSearch()
+{
+    cancelSearch();
+    m_searchActive = false;
+    m_searchHits.clear();
+}
+
+void FlatpakLogModel::cancelSearch()
+{
+    if (m_searchCancelled) {
+        *m_searchCancelled = true;
+        m_searchCancelled.reset();
+    }
+}
+
+void FlatpakLogModel::searchScanned()
+{
+    // Wynik przerwanego wyszukiwania jest niepełny
+    if (!m_searchCancelled) {
+        return;
+    }
+    m_searchCancelled.reset();
+
+    m_searchHits = m_searchWatcher.result();
+    m_searchActive = true;
+    emit searchFinished(m_searchHits.size());
+}
+
+QVector<int> FlatpakLogModel::scanLines(const QVector<Section>& sections, const QVector<QPair<int, int>>& ranges,
+                                        const QString& query, bool isRegex, const QString& spillPath,
+                                        const std::shared_ptr<std::atomic<bool>>& cancelled)
+{
+    QRegularExpression regex;
+    if (isRegex) {
+        regex = QRegularExpression(query, QRegularExpression::CaseInsensitiveOption);
+        regex.optimize();
+    }
+
+    // Wątek puli czyta zrzucone fragmenty przez własny uchwyt pliku
+    QFile spillFile(spillPath);
+
+    QVector<int> hits;
+    int sectionIndex = 0;
+    int decodedSection = -1;
+    int decodedChunk = -1;
+    QStringList decoded;
+
+    for (const QPair<int, int>& range : ranges) {
+        for (int line = range.first; line < range.second; ++line) {
+            if (line % ChunkLines == 0 && *cancelled) {
+                return QVector<int>();
+            }
+
+            // Zakresy są rosnące, więc sekcja przesuwa się tylko do przodu
+            while (sectionIndex + 1 < sections.size() && sections.at(sectionIndex + 1).firstLine <= line) {
+                ++sectionIndex;
+            }
+
+            const Section& section = sections.at(sectionIndex);
+            const int local = line - section.firstLine;
+            QString text;
+            if (!section.lines.isEmpty() || section.chunks.isEmpty()) {
+                text = section.lines.value(local);
+            } else {
+                const int chunkIndex = local / ChunkLines;
+                if (sectionIndex != decodedSection || chunkIndex != decodedChunk) {
+                    const Chunk& chunk = section.chunks.value(chunkIndex);
+                    QByteArray compressed = chunk.compressed;
+                    if (compressed.isEmpty() && chunk.spillOffset >= 0
+                        && (spillFile.isOpen() || spillFile.open(QIODevice::ReadOnly))
+                        && spillFile.seek(chunk.spillOffset)) {
+                        compressed = spillFile.read(chunk.spillSize);
+                    }
+                    decoded = decodeChunk(compressed);
+                    decodedSection = sectionIndex;
+                    decodedChunk = chunkIndex;
+                }
+                text = decoded.value(local % ChunkLines);
+            }
+
+            text = stripMarkup(text);
+            if (isRegex ? regex.match(text).hasMatch() : text.contains(query, Qt::CaseInsensitive)) {
+                hits.append(line);
+            }
+        }
+    }
+
+    return hits;
+}
+
+QString FlatpakLogModel::lineText(int line) const
+{
+    const int sectionIndex = sectionForLine(line);
+    return stripMarkup(lineAt(sectionIndex, line - m_sections.at(sectionIndex).firstLine));
+}
+
+void FlatpakLogModel::activate(const QModelIndex& index)
+{
+    if (!index.isValid()) {
+        return;
+    }
+
+    const int sectionIndex = sectionForRow(index.row());
+    const Section& section = m_sections.at(sectionIndex);
+
+    // Aktywacja nagłówka przełącza widoczność sekcji
+    if (section.hasHeader() && index.row() == m_sectionStarts.at(sectionIndex)) {
+        setSectionExpanded(sectionIndex, !section.expanded);
+    }
+}
+
+QModelIndex FlatpakLogModel::firstHighlightIndex()
+{
+    if (m_searchActive) {
+        return m_searchHits.isEmpty() ? QModelIndex() : index(rowForLine(m_searchHits.first()));
+    }
+
+    const QVector<int> rows = highlightRows();
+    return rows.isEmpty() ? QModelIndex() : index(rows.first());
+}
+
+QModelIndex FlatpakLogModel::nextHighlightIndex(const QModelIndex& current)
+{
+    if (m_searchActive) {
+        const int currentLine = current.isValid() ? lineForRow(current.row()) : -1;
+        const auto it = std::upper_bound(m_searchHits.constBegin(), m_searchHits.constEnd(), currentLine);
+        return it == m_searchHits.constEnd() ? QModelIndex() : index(rowForLine(*it));
+    }
+
+    const QVector<int> rows = highlightRows();
+    const int currentRow = current.isValid() ? current.row() : -1;
+    const auto it = std::upper_bound(rows.constBegin(), rows.constEnd(), currentRow);
+    return it == rows.constEnd() ? QModelIndex() : index(*it);
+}
+
+QModelIndex FlatpakLogModel::previousHighlightIndex(const QModelIndex& current)
+{
+    if (m_searchActive) {
+        const int currentLine = current.isValid() ? lineForRow(current.row()) : INT_MAX;
+        const auto it = std::lower_bound(m_searchHits.constBegin(), m_searchHits.constEnd(), currentLine);
+        return it == m_searchHits.constBegin() ? QModelIndex() : index(rowForLine(*(it - 1)));
+    }
+
+    const QVector<int> rows = highlightRows();
+    const int currentRow = current.isValid() ? current.row() : m_rowCount;
+    const auto it = std::lower_bound(rows.constBegin(), rows.constEnd(), currentRow);
+    return it == rows.constBegin() ? QModelIndex() : index(*(it - 1));
+}
+
+QModelIndex FlatpakLogModel::lastHighlightIndex()
+{
+    if (m_searchActive) {
+        return m_searchHits.isEmpty() ? QModelIndex() : index(rowForLine(m_searchHits.last()));
+    }
+
+    const QVector<int> rows = highlightRows();
+    return rows.isEmpty() ? QModelIndex() : index(rows.last());
+}
+
+void FlatpakLogModel::beginSection(const QString& name)
+{
+    Section section;
+    section.name = name;
+    section.firstLine = m_lineTotal;
+
+    const int headerRows = section.hasHeader() ? 1 : 0;
+    if (headerRows) {
+        beginInsertRows(QModelIndex(), m_rowCount, m_rowCount);
+    }
+
+    m_sections.append(section);
+    m_sectionStarts.append(m_rowCount);
+    m_rowCount += headerRows;
+
+    if (headerRows) {
+        endInsertRows();
+    }
+}
+
+void FlatpakLogModel::closeSection(bool success)
+{
+    const int sectionIndex = m_sections.size() - 1;
+    Section& section = m_sections.last();
+    if (section.state != Section::Running) {
+        return;
+    }
+
+    const bool failed = !success || !section.errorLines.isEmpty();
+    section.state = failed ? Section::Failed : Section::Succeeded;
+
+    if (!section.hasHeader()) {
+        return;
+    }
+
+    compressSection(section);
+
+    if (failed) {
+        // Moduł z błędami musi być widoczny od razu
+        setSectionExpanded(sectionIndex, true);
+        const QModelIndex header = index(m_sectionStarts.at(sectionIndex));
+        emit dataChanged(header, header);
+    } else {
+        setSectionExpanded(sectionIndex, false);
+    }
+
+    if (m_compressedInMemory > MaxCompressedInMemory) {
+        spillSections();
+    }
+}
+
+void FlatpakLogModel::updateSectionStarts(int from)
+{
+    for (int i = qMax(1, from); i < m_sections.size(); ++i) {
+        m_sectionStarts[i] = m_sectionStarts.at(i - 1) + m_sections.at(i - 1).rowCount();
+    }
+}
+
+int FlatpakLogModel::sectionForRow(int row) const
+{
+    // Ostatnia sekcja zaczynająca się nie później niż dany wiersz
+    const auto it = std::upper_bound(m_sectionStarts.constBegin(), m_sectionStarts.constEnd(), row);
+    return qMax(0, static_cast<int>(it - m_sectionStarts.constBegin()) - 1);
+}
+
+int FlatpakLogModel::sectionForLine(int line) const
+{
+    // Sekcje są dopisywane po kolei, więc ich pierwsze linie rosną
+    const auto it = std::upper_bound(m_sections.constBegin(), m_sections.constEnd(), line,
+                                     [](int value, const Section& section) {
+                                         return value < section.firstLine;
+                                     });
+    return qMax(0, static_cast<int>(it - m_sections.constBegin()) - 1);
+}
+
+int FlatpakLogModel::lineForRow(int row) const
+{
+    const int sectionIndex = sectionForRow(row);
+    const Section& section = m_sections.at(sectionIndex);
+    const int local = row - m_sectionStarts.at(sectionIndex) - (section.hasHeader() ? 1 : 0);
+
+    // Nagłówek leży "przed" pierwszą linią swojej sekcji
+    return section.firstLine + local;
+}
+
+int FlatpakLogModel::rowForLine(int line)
+{
+    const int sectionIndex = sectionForLine(line);
+    setSectionExpanded(sectionIndex, true);
+
+    const Section& section = m_sections.at(sectionIndex);
+    return m_sectionStarts.at(sectionIndex) + (section.hasHeader() ? 1 : 0) + (line - section.firstLine);
+}
+
+QString FlatpakLogModel::lineAt(int sectionIndex, int line) const
+{
+    const Section& section = m_sections.at(sectionIndex);
+    if (!section.lines.isEmpty() || section.chunks.isEmpty()) {
+        return section.lines.value(line);
+    }
+
+    return chunkLines(sectionIndex, line / ChunkLines).value(line % ChunkLines);
+}
+
+QStringList FlatpakLogModel::chunkLines(int sectionIndex, int chunkIndex) const
+{
+    const qint64 key = (static_cast<qint64>(sectionIndex) << 32) | chunkIndex;
+    if (const QStringList* cached = m_chunkCache.object(key)) {
+        return *cached;
+    }
+
+    const Section& section = m_sections.at(sectionIndex);
+    if (chunkIndex < 0 || chunkIndex >= section.chunks.size()) {
+        return QStringList();
+    }
+
+    const Chunk& chunk = section.chunks.at(chunkIndex);
+    QByteArray compressed = chunk.compressed;
+    if (compressed.isEmpty() && chunk.spillOffset >= 0) {
+        if (!m_spillFile.isOpen()) {
+            return QStringList();
+        }
+        m_spillFile.seek(chunk.spillOffset);
+        compressed = m_spillFile.read(chunk.spillSize);
+    }
+
+    const QStringList lines = decodeChunk(compressed);
+    m_chunkCache.insert(key, new QStringList(lines));
+    return lines;
+}
+
+void FlatpakLogModel::compressSection(Section& section)
+{
+    if (!section.chunks.isEmpty() || section.lineCount == 0) {
+        return;
+    }
+
+    for (int first = 0; first < section.lines.size(); first += ChunkLines) {
+        Chunk chunk;
+        chunk.compressed = qCompress(section.lines.mid(first, ChunkLines).join(QLatin1Char('\n')).toUtf8(),
+                                     CompressionLevel);
+        m_compressedInMemory += chunk.compressed.size();
+        section.chunks.append(chunk);
+    }
+}
+
+void FlatpakLogModel::spillSections()
+{
+    if (!m_storageDir->isValid()) {
+        return;
+    }
+
+    if (!m_spillFile.isOpen() && !m_spillFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        return;
+    }
+
+    for (Section& section : m_sections) {
+        if (section.state == Section::Running) {
+            continue;
+        }
+
+        for (Chunk& chunk : section.chunks) {
+            if (chunk.compressed.isEmpty()) {
+                continue;
+            }
+
+            const qint64 offset = m_spillFile.size();
+            m_spillFile.seek(offset);
+            if (m_spillFile.write(chunk.compressed) != chunk.compressed.size()) {
+                m_spillFile.flush();
+                return;
+            }
+
+            chunk.spillOffset = offset;
+            chunk.spillSize = chunk.compressed.size();
+            m_compressedInMemory -= chunk.compressed.size();
+            chunk.compressed = QByteArray();
+        }
+    }
+
+    m_spillFile.flush();
+}
+
+QString FlatpakLogModel::headerText(const Section& section) const
+{
+    const QString marker = section.expanded ? QStringLiteral("▾") : QStringLiteral("▸");
+
+    QString summary = i18np("%1 line", "%1 lines", section.lineCount);
+    if (section.warningCount > 0) {
+        summary += ", " + i18np("%1 warning", "%1 warnings", section.warningCount);
+    }
+    if (!section.errorLines.isEmpty()) {
+        summary += ", " + i18np("%1 error", "%1 errors", section.errorLines.size());
+    }
+
+    QString color;
+    switch (section.state) {
+        case Section::Running:
+            color = "blue";
+            break;
+        case Section::Succeeded:
+            color = "green";
+            break;
+        case Section::Failed:
+            color = "red";
+            break;
+    }
+
+    return QString("<span style=\"color:%1; font-weight:bold;\">%2 %3 (%4)</span>")
+        .arg(color, marker, section.name.toHtmlEscaped(), summary);
+}
+
+QVector<int> FlatpakLogModel::highlightRows() const
+{
+    QVector<int> rows;
+
+    for (int i = 0; i < m_sections.size(); ++i) {
+        const Section& section = m_sections.at(i);
+        if (!section.expanded) {
+            continue;
+        }
+
+        const int first = m_sectionStarts.at(i) + (section.hasHeader() ? 1 : 0);
+        for (int line : section.errorLines) {
+            rows.append(first + line);
+        }
+    }
+
+    return rows;
+}
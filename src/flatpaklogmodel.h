@@ -0,0 +1,278 @@
+/**
+ * @file flatpaklogmodel.h
+ * @brief Model logu budowania podzielony na sekcje modułów
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKLOGMODEL_H
+#define FLATPAKLOGMODEL_H
+
+#include "flatpaklineclassifier.h"
+
+#include <outputview/ioutputviewmodel.h>
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+
+class FlatpakLogIndex;
+class QTemporaryDir;
+
+/**
+ * @class FlatpakLogModel
+ * @brief Model widoku wyjścia z sekcjami dla kolejnych modułów manifestu
+ *
+ * Log jest dzielony na sekcje według znaczników "Building module", które
+ * wypisuje flatpak-builder. Sekcja bieżącego modułu jest rozwinięta i trzyma
+ * linie w pamięci. Po udanym zakończeniu modułu jego linie są kompresowane,
+ * a sekcja zwija się do jednego wiersza z podsumowaniem; treść jest
+ * dekompresowana dopiero po rozwinięciu (aktywacji wiersza nagłówka).
+ * Sekcje z błędami pozostają rozwinięte.
+ *
+ * Treść jest kompresowana fragmentami o stałej liczbie linii, więc numer
+ * linii wskazuje fragment bez dodatkowego indeksu. Przewijanie i wyszukiwanie
+ * dekompresują tylko potrzebne fragmenty, trzymane w niewielkiej pamięci
+ * podręcznej.
+ *
+ * Wszystkie linie trafiają też do przyrostowego indeksu trigramowego, który
+ * pozwala szukać tekstu i wyrażeń regularnych bez przeglądania całego logu.
+ * Dokładne sprawdzenie linii-kandydatów (albo całego logu, gdy indeks nie
+ * zawęża zapytania) odbywa się w tle, na kopii sekcji.
+ * Gdy skompresowane sekcje przekroczą limit pamięci, są zrzucane do pliku
+ * w katalogu tymczasowym logu, razem z segmentami indeksu.
+ *
+ * Log zakończonego zadania można skompaktować (compact()) - wtedy także
+ * sekcje z błędami i linie spoza modułów zostają tylko w postaci
+ * skompresowanej, a nagłówki i pozycje błędów pozostają bez zmian.
+ */
+class FlatpakLogModel : public QAbstractListModel, public KDevelop::IOutputViewModel
+{
+    Q_OBJECT
+    Q_INTERFACES(KDevelop::IOutputViewModel)
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param parent Obiekt rodzica
+     */
+    explicit FlatpakLogModel(QObject* parent = nullptr);
+
+    /**
+     * Destruktor
+     */
+    ~FlatpakLogModel() override;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Dopisuje porcję sklasyfikowanych linii
+     * @param batch Linie z wątku czytającego
+     * @param texts Sformatowany tekst każdej linii (puste dla linii przejściowych)
+     */
+    void appendBatch(const FlatpakOutputBatch& batch, const QStringList& texts);
+
+    /**
+     * @brief Dopisuje pojedynczą linię komunikatu do bieżącej sekcji
+     * @param text Tekst linii
+     */
+    void appendLine(const QString& text);
+
+    /**
+     * @brief Zamyka log po zakończeniu procesu
+     *
+     * Ostatnia sekcja jest zwijana, jeśli budowanie się udało i nie zawiera
+     * błędów. Kolejne linie trafiają już poza sekcje modułów.
+     *
+     * @param success Czy proces zakończył się powodzeniem
+     */
+    void finish(bool success);
+
+    /**
+     * @brief Rozwija albo zwija sekcję
+     * @param section Indeks sekcji
+     * @param expanded Docelowy stan sekcji
+     */
+    void setSectionExpanded(int section, bool expanded);
+
+    /**
+     * @brief Zwraca liczbę sekcji
+     */
+    int sectionCount() const;
+
+    /**
+     * @brief Zwraca nazwę modułu sekcji (pusta dla linii spoza modułów)
+     */
+    QString sectionName(int section) const;
+
+    /**
+     * @brief Zwraca nazwy modułów zakończonych powodzeniem, w kolejności budowania
+     */
+    QStringList completedModules() const;
+
+    /**
+     * @brief Zwraca liczbę bajtów trzymanych w postaci skompresowanej
+     */
+    qint64 compressedSize() const;
+
+    /**
+     * @brief Zwraca przybliżone zużycie pamięci przez log i jego indeks (w bajtach)
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief Kompaktuje log zakończonego zadania
+     *
+     * Wszystkie sekcje są kompresowane, a linie w pamięci zwalniane; indeks
+     * wyszukiwania jest domykany i zrzucany na dysk. Widoczne wiersze się nie
+     * zmieniają - ich tekst jest dekompresowany przy wyświetlaniu.
+     */
+    void compact();
+
+    /**
+     * @brief Czy log został skompaktowany
+     */
+    bool isCompacted() const;
+
+    /**
+     * @brief Zwalnia treść logu, zostawiając nagłówki modułów z podsumowaniem
+     *
+     * Po zwolnieniu sekcji nie da się rozwinąć ani przeszukać.
+     */
+    void evict();
+
+    /**
+     * @brief Czy treść logu została zwolniona
+     */
+    bool isEvicted() const;
+
+    /**
+     * @brief Rozpoczyna wyszukiwanie tekstu w całym logu
+     *
+     * Linie są sprawdzane w tle; po zakończeniu model wysyła searchFinished().
+     * Trafienia zastępują wtedy błędy jako elementy nawigacji
+     * "następny/poprzedni" widoku wyjścia; sekcje z trafieniami są rozwijane
+     * przy przejściu do nich. Nowe wyszukiwanie przerywa poprzednie.
+     *
+     * @param query Szukany tekst albo wyrażenie regularne
+     * @param isRegex Czy zapytanie jest wyrażeniem regularnym
+     * @return false dla niepoprawnego wyrażenia
+     */
+    bool search(const QString& query, bool isRegex);
+
+    /**
+     * @brief Czy wyszukiwanie trwa w tle
+     */
+    bool isSearching() const;
+
+    /**
+     * @brief Kończy (albo przerywa) wyszukiwanie i przywraca nawigację po błędach
+     */
+    void clearSearch();
+
+    /**
+     * @brief Zwraca tekst linii bez formatowania
+     * @param line Numer linii w całym logu (od 0)
+     */
+    QString lineText(int line) const;
+
+    // KDevelop::IOutputViewModel
+    void activate(const QModelIndex& index) override;
+    QModelIndex firstHighlightIndex() override;
+    QModelIndex nextHighlightIndex(const QModelIndex& current) override;
+    QModelIndex previousHighlightIndex(const QModelIndex& current) override;
+    QModelIndex lastHighlightIndex() override;
+
+Q_SIGNALS:
+    /**
+     * @brief Wysyłany po zakończeniu wyszukiwania rozpoczętego przez search()
+     * @param hits Liczba trafień
+     */
+    void searchFinished(int hits);
+
+private:
+    /**
+     * Sekcja logu odpowiadająca jednemu modułowi
+     */
+    /**
+     * Skompresowany fragment sekcji (ChunkLines kolejnych linii)
+     */
+    struct Chunk {
+        QByteArray compressed;
+        qint64 spillOffset = -1;    ///< Położenie fragmentu w pliku logu
+        int spillSize = 0;
+    };
+
+    struct Section {
+        enum State {
+            Running,
+            Succeeded,
+            Failed
+        };
+
+        QString name;
+        State state = Running;
+        int firstLine = 0;          ///< Numer pierwszej linii sekcji w całym logu
+        bool expanded = true;
+        QStringList lines;          ///< Linie w pamięci (sekcja bieżąca albo nieskompresowana)
+        QVector<Chunk> chunks;      ///< Skompresowana treść zakończonej sekcji
+        QVector<int> errorLines;    ///< Indeksy linii z błędami w obrębie sekcji
+        int lineCount = 0;
+        int warningCount = 0;
+
+        bool hasHeader() const { return !name.isEmpty(); }
+        int rowCount() const { return (hasHeader() ? 1 : 0) + (expanded ? lineCount : 0); }
+    };
+
+    void beginSection(const QString& name);
+    void closeSection(bool success);
+    void updateSectionStarts(int from);
+    int sectionForRow(int row) const;
+    int sectionForLine(int line) const;
+    int lineForRow(int row) const;
+    int rowForLine(int line);
+    QString lineAt(int section, int line) const;
+    QStringList chunkLines(int section, int chunk) const;
+    void compressSection(Section& section);
+    void spillSections();
+    QString headerText(const Section& section) const;
+    QVector<int> highlightRows() const;
+    void cancelSearch();
+    void searchScanned();
+
+    /**
+     * Sprawdza linie z zakresów [pierwsza, ostatnia); wywoływane w wątku puli
+     */
+    static QVector<int> scanLines(const QVector<Section>& sections, const QVector<QPair<int, int>>& ranges,
+                                  const QString& query, bool isRegex, const QString& spillPath,
+                                  const std::shared_ptr<std::atomic<bool>>& cancelled);
+
+    QVector<Section> m_sections;
+    QVector<int> m_sectionStarts;   ///< Pierwszy wiersz każdej sekcji
+    int m_rowCount;
+    int m_lineTotal;
+
+    std::unique_ptr<QTemporaryDir> m_storageDir;
+    std::unique_ptr<FlatpakLogIndex> m_index;
+    mutable QFile m_spillFile;
+    qint64 m_compressedInMemory;
+
+    QVector<int> m_searchHits;
+    QFutureWatcher<QVector<int>> m_searchWatcher;
+    std::shared_ptr<std::atomic<bool>> m_searchCancelled;   ///< Flaga trwającego wyszukiwania (pusta, gdy nie trwa)
+    bool m_searchActive;
+    bool m_compacted;
+    bool m_evicted;
+    mutable QCache<qint64, QStringList> m_chunkCache;  ///< (sekcja, fragment) -> linie
+};
+
+#endif // FLATPAKLOGMODEL_H
@@ -0,0 +1,134 @@
+/**
+ * @file flatpakmanifestcompletionmodel.cpp
+ * @brief Implementacja podpowiedzi w manifestach Flatpak
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakmanifestcompletionmodel.h"
+#include "flatpakmanifestdocument.h"
+#include "flatpakmanifestsupport.h"
+
+#include <KTextEditor/Document>
+#include <KTextEditor/View>
+
+#include <QRegularExpression>
+
+#include <algorithm>
+
+namespace {
+    // Znaki kluczy i identyfikatorów, np. cmake-ninja, org.kde.Sdk
+    bool isNameChar(QChar c)
+    {
+        return c.isLetterOrNumber() || c == '_' || c == '-' || c == '.';
+    }
+}
+
+FlatpakManifestCompletionModel::FlatpakManifestCompletionModel(FlatpakManifestSupport* support)
+    : KTextEditor::CodeCompletionModel(support)
+    , m_support(support)
+{
+}
+
+void FlatpakManifestCompletionModel::completionInvoked(KTextEditor::View* view, const KTextEditor::Range& range,
+                                                       InvocationType invocationType)
+{
+    Q_UNUSED(invocationType);
+
+    beginResetModel();
+    m_items.clear();
+
+    if (FlatpakManifestDocument* document = m_support->document(view->document())) {
+        const FlatpakManifestModel& model = document->model();
+        const int line = range.start().line();
+        const FlatpakManifestSchema::Context context = model.contextAt(line);
+
+        // Tekst przed podpowiadanym słowem rozstrzyga, czy to klucz, czy wartość
+        static const QRegularExpression valueRegex("[\"']?([\\w.-]+)[\"']?\\s*:\\s*[\"']?$");
+        const QString before = view->document()->line(line).left(range.start().column());
+        const QRegularExpressionMatch match = valueRegex.match(before);
+
+        if (match.hasMatch()) {
+            m_items = valueCompletions(model, context, match.captured(1));
+        } else if (context == FlatpakManifestSchema::ExtensionList) {
+            for (const FlatpakManifestGenerator::InstalledRuntime& runtime : m_support->installedRuntimes()) {
+                if (runtime.id.contains(QLatin1String(".Sdk.Extension."))) {
+                    m_items << runtime.id;
+                }
+            }
+        } else {
+            m_items = FlatpakManifestSchema::keys(context);
+        }
+        m_items.removeDuplicates();
+        m_items.sort();
+    }
+
+    setRowCount(m_items.size());
+    endResetModel();
+}
+
+QStringList FlatpakManifestCompletionModel::valueCompletions(const FlatpakManifestModel& model,
+                                                             FlatpakManifestSchema::Context context,
+                                                             const QString& key) const
+{
+    QStringList values = FlatpakManifestSchema::values(context, key);
+    if (context != FlatpakManifestSchema::TopLevel) {
+        return values;
+    }
+
+    const QVector<FlatpakManifestGenerator::InstalledRuntime> runtimes = m_support->installedRuntimes();
+    if (key == QLatin1String("runtime") || key == QLatin1String("sdk")) {
+        const QString suffix = key == QLatin1String("sdk") ? QStringLiteral(".Sdk") : QStringLiteral(".Platform");
+        for (const FlatpakManifestGenerator::InstalledRuntime& runtime : runtimes) {
+            if (runtime.id.endsWith(suffix)) {
+                values << runtime.id;
+            }
+        }
+    } else if (key == QLatin1String("runtime-version")) {
+        // Gałęzie wybranego runtime'u, a bez niego wszystkie zainstalowane
+        const QString runtimeId = model.topLevelValue("runtime");
+        for (const FlatpakManifestGenerator::InstalledRuntime& runtime : runtimes) {
+            if (runtimeId.isEmpty() || runtime.id == runtimeId) {
+                values << runtime.branch;
+            }
+        }
+    }
+    return values;
+}
+
+QVariant FlatpakManifestCompletionModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_items.size()) {
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole && index.column() == Name) {
+        return m_items.at(index.row());
+    }
+    return QVariant();
+}
+
+KTextEditor::Range FlatpakManifestCompletionModel::completionRange(KTextEditor::View* view, const KTextEditor::Cursor& position)
+{
+    // Domyślny zakres kończy słowo na "-" i ".", a klucze i identyfikatory je zawierają
+    const QString text = view->document()->line(position.line());
+    int start = qMin(position.column(), text.size());
+    while (start > 0 && isNameChar(text.at(start - 1))) {
+        --start;
+    }
+    int end = qMin(position.column(), text.size());
+    while (end < text.size() && isNameChar(text.at(end))) {
+        ++end;
+    }
+    return KTextEditor::Range(position.line(), start, position.line(), end);
+}
+
+bool FlatpakManifestCompletionModel::shouldAbortCompletion(KTextEditor::View* view, const KTextEditor::Range& range,
+                                                           const QString& currentCompletion)
+{
+    const KTextEditor::Cursor cursor = view->cursorPosition();
+    if (!range.isValid() || cursor.line() != range.start().line() || cursor < range.start() || cursor > range.end()) {
+        return true;
+    }
+    return !std::all_of(currentCompletion.cbegin(), currentCompletion.cend(), isNameChar);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file flatpakmanifestcompletionmodel.h
+ * @brief Podpowiedzi kluczy i wartości w manifestach Flatpak
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKMANIFESTCOMPLETIONMODEL_H
+#define FLATPAKMANIFESTCOMPLETIONMODEL_H
+
+#include "flatpakmanifestschema.h"
+
+#include <KTextEditor/CodeCompletionModel>
+#include <KTextEditor/CodeCompletionModelControllerInterface>
+
+#include <QStringList>
+
+class FlatpakManifestModel;
+class FlatpakManifestSupport;
+
+/**
+ * @class FlatpakManifestCompletionModel
+ * @brief Podpowiada klucze ze schematu i wartości z zainstalowanych runtime'ów
+ *
+ * Część manifestu pod kursorem (główny obiekt, moduł, źródło, build-options)
+ * pochodzi z FlatpakManifestModel. Po "klucz:" podpowiadane są wartości:
+ * systemy budowania, typy źródeł, zainstalowane runtime'y, SDK i ich gałęzie,
+ * a w "sdk-extensions" zainstalowane rozszerzenia SDK.
+ */
+class FlatpakManifestCompletionModel : public KTextEditor::CodeCompletionModel,
+                                       public KTextEditor::CodeCompletionModelControllerInterface
+{
+    Q_OBJECT
+    Q_INTERFACES(KTextEditor::CodeCompletionModelControllerInterface)
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param support Obsługa manifestów (rodzic)
+     */
+    explicit FlatpakManifestCompletionModel(FlatpakManifestSupport* support);
+
+    void completionInvoked(KTextEditor::View* view, const KTextEditor::Range& range, InvocationType invocationType) override;
+    QVariant data(const QModelIndex& index, int role) const override;
+
+    KTextEditor::Range completionRange(KTextEditor::View* view, const KTextEditor::Cursor& position) override;
+    bool shouldAbortCompletion(KTextEditor::View* view, const KTextEditor::Range& range, const QString& currentCompletion) override;
+
+private:
+    QStringList valueCompletions(const FlatpakManifestModel& model, FlatpakManifestSchema::Context context,
+                                 const QString& key) const;
+
+    FlatpakManifestSupport* m_support;
+    QStringList m_items;
+};
+
+#endif // FLATPAKMANIFESTCOMPLETIONMODEL_H
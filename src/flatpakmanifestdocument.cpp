@@ -0,0 +1,166 @@
+/**
+ * @file flatpakmanifestdocument.cpp
+ * @brief Implementacja modelu manifestu aktualizowanego przy edycji
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakmanifestdocument.h"
+#include "flatpakmanifestsupport.h"
+
+#include <KTextEditor/Document>
+
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+namespace {
+    // Pełne parsowanie czeka na przerwę w pisaniu
+    const int FullParseDelay = 300;
+}
+
+FlatpakManifestDocument::FlatpakManifestDocument(KTextEditor::Document* document, FlatpakManifestSupport* support)
+    : QObject(support)
+    , m_support(support)
+    , m_document(document)
+    , m_model(FlatpakManifestModel::formatForPath(document->url().toLocalFile()),
+              QFileInfo(document->url().toLocalFile()).absolutePath())
+    , m_firstChanged(-1)
+    , m_unchangedTail(0)
+    , m_revision(0)
+    , m_parsing(false)
+{
+    // Pierwsze parsowanie jest synchroniczne, żeby podpowiedzi działały od razu
+    m_model.setText(document->text());
+
+    m_editTimer.setSingleShot(true);
+    m_editTimer.setInterval(0);
+    connect(&m_editTimer, &QTimer::timeout, this, &FlatpakManifestDocument::applyEdits);
+
+    m_parseTimer.setSingleShot(true);
+    m_parseTimer.setInterval(FullParseDelay);
+    connect(&m_parseTimer, &QTimer::timeout, this, &FlatpakManifestDocument::startFullParse);
+
+    connect(document, &KTextEditor::Document::textInserted, this, &FlatpakManifestDocument::textInserted);
+    connect(document, &KTextEditor::Document::textRemoved, this, &FlatpakManifestDocument::textRemoved);
+    connect(document, &KTextEditor::Document::lineWrapped, this, &FlatpakManifestDocument::lineWrapped);
+    connect(document, &KTextEditor::Document::lineUnwrapped, this, &FlatpakManifestDocument::lineUnwrapped);
+    connect(document, &KTextEditor::Document::reloaded, this, &FlatpakManifestDocument::reloaded);
+}
+
+const FlatpakManifestModel& FlatpakManifestDocument::model()
+{
+    // Podpowiedzi mogą zostać wywołane przed obsłużeniem kolejki zdarzeń
+    applyEdits();
+    return m_model;
+}
+
+void FlatpakManifestDocument::setInstalledRuntimes(const QVector<FlatpakManifestGenerator::InstalledRuntime>& runtimes)
+{
+    m_model.setInstalledRuntimes(runtimes);
+}
+
+void FlatpakManifestDocument::textInserted(KTextEditor::Document* document, const KTextEditor::Cursor& position, const QString& text)
+{
+    Q_UNUSED(document);
+    touchLines(position.line(), position.line() + text.count('\n'));
+}
+
+void FlatpakManifestDocument::textRemoved(KTextEditor::Document* document, const KTextEditor::Range& range, const QString& text)
+{
+    Q_UNUSED(document);
+    Q_UNUSED(text);
+    touchLines(range.start().line(), range.start().line());
+}
+
+void FlatpakManifestDocument::lineWrapped(KTextEditor::Document* document, const KTextEditor::Cursor& position)
+{
+    Q_UNUSED(document);
+    touchLines(position.line(), position.line() + 1);
+}
+
+void FlatpakManifestDocument::lineUnwrapped(KTextEditor::Document* document, int line)
+{
+    Q_UNUSED(document);
+    touchLines(qMax(0, line - 1), qMax(0, line - 1));
+}
+
+void FlatpakManifestDocument::reloaded(KTextEditor::Document* document)
+{
+    Q_UNUSED(document);
+    m_firstChanged = -1;
+    ++m_revision;
+    m_parseTimer.start();
+}
+
+void FlatpakManifestDocument::touchLines(int firstLine, int lastLine)
+{
+    // Linie są podane po zmianie; wszystko za lastLine tylko się przesunęło
+    const int tail = qMax(0, m_document->lines() - 1 - lastLine);
+    if (m_firstChanged < 0) {
+        m_firstChanged = firstLine;
+        m_unchangedTail = tail;
+    } else {
+        m_firstChanged = qMin(m_firstChanged, firstLine);
+        m_unchangedTail = qMin(m_unchangedTail, tail);
+    }
+
+    ++m_revision;
+    m_editTimer.start();
+}
+
+void FlatpakManifestDocument::applyEdits()
+{
+    m_editTimer.stop();
+    if (m_firstChanged < 0) {
+        return;
+    }
+
+    const int oldCount = m_model.lineCount();
+    const int newCount = m_document->lines();
+    const int first = qMin(m_firstChanged, qMin(oldCount, newCount));
+    const int tail = qMin(m_unchangedTail, qMin(oldCount, newCount) - first);
+    m_firstChanged = -1;
+
+    QStringList lines;
+    for (int i = first; i < newCount - tail; ++i) {
+        lines << m_document->line(i);
+    }
+
+    if (m_model.replaceLines(first, oldCount - tail - first, lines) == FlatpakManifestModel::NeedsFullParse) {
+        m_parseTimer.start();
+    }
+    m_support->scheduleProblems();
+}
+
+void FlatpakManifestDocument::startFullParse()
+{
+    if (m_parsing) {
+        // Po zakończeniu bieżącego parsowania wersja nie będzie się zgadzać
+        return;
+    }
+    m_parsing = true;
+
+    const quint64 revision = m_revision;
+    FlatpakManifestModel model = m_model;
+    const QString text = m_document->text();
+
+    auto* watcher = new QFutureWatcher<FlatpakManifestModel>(this);
+    connect(watcher, &QFutureWatcher<FlatpakManifestModel>::finished, this, [this, watcher, revision]() {
+        const FlatpakManifestModel parsed = watcher->result();
+        watcher->deleteLater();
+        m_parsing = false;
+
+        if (revision != m_revision) {
+            m_parseTimer.start();
+            return;
+        }
+        m_model = parsed;
+        m_firstChanged = -1;
+        m_support->scheduleProblems();
+    });
+    watcher->setFuture(QtConcurrent::run([model, text]() mutable {
+        model.setText(text);
+        return model;
+    }));
+}
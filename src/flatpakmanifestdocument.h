@@ -0,0 +1,82 @@
+/**
+ * @file flatpakmanifestdocument.h
+ * @brief Model manifestu aktualizowany przy edycji dokumentu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKMANIFESTDOCUMENT_H
+#define FLATPAKMANIFESTDOCUMENT_H
+
+#include "flatpakmanifestmodel.h"
+
+#include <QObject>
+#include <QTimer>
+
+class FlatpakManifestSupport;
+
+namespace KTextEditor {
+    class Cursor;
+    class Document;
+    class Range;
+}
+
+/**
+ * @class FlatpakManifestDocument
+ * @brief Przekazuje zmiany dokumentu do FlatpakManifestModel
+ *
+ * Sygnały edytora wyznaczają najniższą zmienioną linię i liczbę linii na
+ * końcu dokumentu, których zmiana nie dotknęła. Zmiany z jednego przebiegu
+ * pętli zdarzeń trafiają do modelu jednym wywołaniem replaceLines(), więc
+ * przy pisaniu parsowany jest tylko bieżący moduł.
+ *
+ * Gdy model potrzebuje pełnego parsowania, odbywa się ono w tle po chwili
+ * bez zmian. Wynik jest odrzucany, jeśli dokument zmienił się w międzyczasie.
+ */
+class FlatpakManifestDocument : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param document Dokument manifestu
+     * @param support Obsługa manifestów (rodzic)
+     */
+    FlatpakManifestDocument(KTextEditor::Document* document, FlatpakManifestSupport* support);
+
+    /**
+     * @brief Zwraca model z uwzględnieniem wszystkich zmian dokumentu
+     */
+    const FlatpakManifestModel& model();
+
+    /**
+     * @brief Ustawia runtime'y używane przez diagnostykę
+     */
+    void setInstalledRuntimes(const QVector<FlatpakManifestGenerator::InstalledRuntime>& runtimes);
+
+private Q_SLOTS:
+    void textInserted(KTextEditor::Document* document, const KTextEditor::Cursor& position, const QString& text);
+    void textRemoved(KTextEditor::Document* document, const KTextEditor::Range& range, const QString& text);
+    void lineWrapped(KTextEditor::Document* document, const KTextEditor::Cursor& position);
+    void lineUnwrapped(KTextEditor::Document* document, int line);
+    void reloaded(KTextEditor::Document* document);
+    void applyEdits();
+    void startFullParse();
+
+private:
+    void touchLines(int firstLine, int lastLine);
+
+    FlatpakManifestSupport* m_support;
+    KTextEditor::Document* m_document;
+    FlatpakManifestModel m_model;
+    int m_firstChanged;         ///< Najniższa zmieniona linia albo -1
+    int m_unchangedTail;        ///< Linie na końcu dokumentu bez zmian
+    quint64 m_revision;
+    bool m_parsing;
+    QTimer m_editTimer;
+    QTimer m_parseTimer;
+};
+
+#endif // FLATPAKMANIFESTDOCUMENT_H
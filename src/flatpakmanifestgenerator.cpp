@@ -0,0 +1,424 @@
+/**
+ * @file flatpakmanifestgenerator.cpp
+ * @brief Implementacja generowania manifestu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakmanifestgenerator.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QVersionNumber>
+
+namespace {
+    // Wersje używane, gdy żaden pasujący runtime nie jest zainstalowany
+    const QString DefaultKde6Version = QStringLiteral("6.8");
+    const QString DefaultKde5Version = QStringLiteral("5.15-24.08");
+    const QString DefaultGnomeVersion = QStringLiteral("47");
+    const QString DefaultFreedesktopVersion = QStringLiteral("24.08");
+
+    // Tyle czekamy na "flatpak list", zanim użyjemy wersji domyślnych
+    const int FlatpakListTimeoutMs = 5000;
+
+    // Pliki z identyfikatorem aplikacji rzadko leżą głębiej
+    const int MaxAppIdSearchDepth = 3;
+
+    const QStringList StandardCleanup = {
+        QStringLiteral("/include"),
+        QStringLiteral("/lib/pkgconfig"),
+        QStringLiteral("/share/pkgconfig"),
+        QStringLiteral("/lib/cmake"),
+        QStringLiteral("/share/aclocal"),
+        QStringLiteral("/share/man"),
+        QStringLiteral("/share/doc"),
+        QStringLiteral("/share/info"),
+        QStringLiteral("/share/gtk-doc"),
+        QStringLiteral("*.a"),
+        QStringLiteral("*.la")
+    };
+
+    QString readFile(const QString& path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QString();
+        }
+        return QString::fromUtf8(file.readAll());
+    }
+
+    /**
+     * Klucz do porównywania gałęzi runtime'u; dla "5.15-24.08" liczy się
+     * część po myślniku, bo wersja Qt jest w niej stała
+     */
+    QVersionNumber branchVersion(const QString& branch)
+    {
+        const int dash = branch.lastIndexOf('-');
+        return QVersionNumber::fromString(dash >= 0 ? branch.mid(dash + 1) : branch);
+    }
+
+    bool isBuildDir(const QDir& dir)
+    {
+        return dir.exists("CMakeCache.txt") || dir.exists("build.ninja") || dir.exists("meson-private")
+            || dir.exists("config.status") || dir.exists(".qmake.stash");
+    }
+
+    /**
+     * Szuka plików metainfo i .desktop nazwanych identyfikatorem aplikacji;
+     * pomija katalogi ukryte i katalogi budowania
+     */
+    void findAppIdFiles(const QDir& dir, int depth, QString& metainfoId, QString& desktopId)
+    {
+        static const QRegularExpression idFile("^([A-Za-z][\\w-]*(\\.[A-Za-z_][\\w-]*){2,})"
+                                               "\\.(metainfo\\.xml|appdata\\.xml|desktop)(\\.in)?$");
+
+        for (const QString& name : dir.entryList(QDir::Files, QDir::Name)) {
+            const QRegularExpressionMatch match = idFile.match(name);
+            if (!match.hasMatch()) {
+                continue;
+            }
+            if (match.captured(3) != QLatin1String("desktop")) {
+                metainfoId = match.captured(1);
+                return;
+            }
+            if (desktopId.isEmpty()) {
+                desktopId = match.captured(1);
+            }
+        }
+
+        if (depth >= MaxAppIdSearchDepth) {
+            return;
+        }
+        for (const QString& name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+            const QDir subdir(dir.filePath(name));
+            if (!isBuildDir(subdir)) {
+                findAppIdFiles(subdir, depth + 1, metainfoId, desktopId);
+            }
+            if (!metainfoId.isEmpty()) {
+                return;
+            }
+        }
+    }
+}
+
+FlatpakManifestGenerator::FlatpakManifestGenerator(const QString& projectDir, const QString& projectName)
+    : m_projectName(projectName)
+    , m_buildSystem(detectBuildSystem(projectDir))
+    , m_toolkit(NoToolkit)
+    , m_lto(false)
+{
+    const QDir root(projectDir);
+
+    // Zależności i nazwa programu z głównego pliku budowania
+    QString buildFile;
+    switch (m_buildSystem) {
+        case CMake:
+            buildFile = readFile(root.filePath("CMakeLists.txt"));
+            break;
+        case Meson:
+            buildFile = readFile(root.filePath("meson.build"));
+            break;
+        case QMake: {
+            const QStringList projects = root.entryList({"*.pro"}, QDir::Files);
+            if (!projects.isEmpty()) {
+                buildFile = readFile(root.filePath(projects.first()));
+            }
+            break;
+        }
+        case Autotools:
+            buildFile = readFile(root.filePath("configure.ac"));
+            break;
+        case UnknownBuildSystem:
+            break;
+    }
+
+    static const QRegularExpression qt6Regex("\\b(Qt6|KF6|qt6)\\b");
+    static const QRegularExpression qt5Regex("\\b(Qt5|KF5|qt5)\\b");
+    static const QRegularExpression gtk4Regex("\\b(gtk4|libadwaita-1)\\b");
+    static const QRegularExpression gtk3Regex("gtk\\+-3\\.0|\\bgtk3\\b");
+    static const QRegularExpression qmakeQtRegex("^\\s*QT\\s*\\+?=", QRegularExpression::MultilineOption);
+
+    if (buildFile.contains(qt6Regex)) {
+        m_toolkit = Qt6;
+    } else if (buildFile.contains(qt5Regex)) {
+        m_toolkit = Qt5;
+    } else if (buildFile.contains(gtk4Regex)) {
+        m_toolkit = Gtk4;
+    } else if (buildFile.contains(gtk3Regex)) {
+        m_toolkit = Gtk3;
+    } else if (m_buildSystem == QMake && buildFile.contains(qmakeQtRegex)) {
+        m_toolkit = Qt6;
+    }
+
+    static const QRegularExpression cmakeTarget("add_executable\\s*\\(\\s*([\\w.+-]+)");
+    static const QRegularExpression mesonTarget("executable\\s*\\(\\s*'([^']+)'");
+    static const QRegularExpression qmakeTarget("^\\s*TARGET\\s*=\\s*(\\S+)", QRegularExpression::MultilineOption);
+    const QRegularExpression& targetRegex = m_buildSystem == Meson ? mesonTarget
+                                          : m_buildSystem == QMake ? qmakeTarget : cmakeTarget;
+    const QRegularExpressionMatch target = targetRegex.match(buildFile);
+    m_command = target.hasMatch() && !target.captured(1).contains('$') ? target.captured(1) : projectName.toLower();
+
+    // Identyfikator aplikacji z metainfo albo pliku .desktop w odwrotnej notacji DNS
+    QString desktopId;
+    findAppIdFiles(root, 0, m_appId, desktopId);
+    if (m_appId.isEmpty()) {
+        m_appId = !desktopId.isEmpty() ? desktopId
+                                       : "org.example." + QString(projectName).remove(QRegularExpression("[^\\w]"));
+    }
+
+    // Katalogi budowania w drzewie źródeł tylko spowalniają kopiowanie źródeł
+    m_skippedDirs << ".git" << ".flatpak-builder" << ".flatpak-profile" << ".flatpak-pgo";
+    for (const QString& entry : root.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden)) {
+        if (!m_skippedDirs.contains(entry) && isBuildDir(QDir(root.filePath(entry)))) {
+            m_skippedDirs << entry;
+        }
+    }
+}
+
+void FlatpakManifestGenerator::setBuildSystem(BuildSystem buildSystem)
+{
+    if (buildSystem != UnknownBuildSystem) {
+        m_buildSystem = buildSystem;
+    }
+}
+
+void FlatpakManifestGenerator::setLto(bool lto)
+{
+    m_lto = lto;
+}
+
+void FlatpakManifestGenerator::setInstalledRuntimes(const QVector<InstalledRuntime>& runtimes)
+{
+    m_installed = runtimes;
+}
+
+QVector<FlatpakManifestGenerator::InstalledRuntime> FlatpakManifestGenerator::installedRuntimes(const QString& flatpakPath)
+{
+    QVector<InstalledRuntime> runtimes;
+
+    QProcess process;
+    process.start(flatpakPath, {"list", "--runtime", "--columns=application,branch"});
+    if (!process.waitForFinished(FlatpakListTimeoutMs) || process.exitCode() != 0) {
+        process.kill();
+        return runtimes;
+    }
+
+    const QStringList lines = QString::fromUtf8(process.readAllStandardOutput()).split('\n', QString::SkipEmptyParts);
+    for (const QString& line : lines) {
+        const QStringList columns = line.split('\t');
+        if (columns.size() >= 2) {
+            runtimes.append({columns.at(0).trimmed(), columns.at(1).trimmed()});
+        }
+    }
+    return runtimes;
+}
+
+FlatpakManifestGenerator::BuildSystem FlatpakManifestGenerator::detectBuildSystem(const QString& projectDir)
+{
+    const QDir root(projectDir);
+    if (root.exists("meson.build")) {
+        return Meson;
+    }
+    if (root.exists("CMakeLists.txt")) {
+        return CMake;
+    }
+    if (!root.entryList({"*.pro"}, QDir::Files).isEmpty()) {
+        return QMake;
+    }
+    if (root.exists("configure.ac") || root.exists("configure.in") || root.exists("configure")) {
+        return Autotools;
+    }
+    return UnknownBuildSystem;
+}
+
+FlatpakManifestGenerator::BuildSystem FlatpakManifestGenerator::buildSystem() const
+{
+    return m_buildSystem;
+}
+
+FlatpakManifestGenerator::Toolkit FlatpakManifestGenerator::toolkit() const
+{
+    return m_toolkit;
+}
+
+QString FlatpakManifestGenerator::appId() const
+{
+    return m_appId;
+}
+
+QString FlatpakManifestGenerator::platformId() const
+{
+    switch (m_toolkit) {
+        case Qt5:
+        case Qt6:
+            return QStringLiteral("org.kde.Platform");
+        case Gtk3:
+        case Gtk4:
+            return QStringLiteral("org.gnome.Platform");
+        case NoToolkit:
+            break;
+    }
+    return QStringLiteral("org.freedesktop.Platform");
+}
+
+QString FlatpakManifestGenerator::sdkId() const
+{
+    return QString(platformId()).replace(".Platform", ".Sdk");
+}
+
+QString FlatpakManifestGenerator::runtimeVersion() const
+{
+    // Gałęzie KDE 5 i 6 nie są zamienne - pasować musi główna wersja Qt
+    auto matchesToolkit = [this](const QString& branch) {
+        switch (m_toolkit) {
+            case Qt5:
+                return branch.startsWith("5.");
+            case Qt6:
+                return branch.startsWith("6.");
+            default:
+                return true;
+        }
+    };
+
+    QString best;
+    for (const InstalledRuntime& sdk : m_installed) {
+        if (sdk.id != sdkId() || !matchesToolkit(sdk.branch)) {
+            continue;
+        }
+        if (best.isEmpty() || branchVersion(sdk.branch) > branchVersion(best)) {
+            best = sdk.branch;
+        }
+    }
+    if (!best.isEmpty()) {
+        return best;
+    }
+
+    switch (m_toolkit) {
+        case Qt5:
+            return DefaultKde5Version;
+        case Qt6:
+            return DefaultKde6Version;
+        case Gtk3:
+        case Gtk4:
+            return DefaultGnomeVersion;
+        case NoToolkit:
+            break;
+    }
+    return DefaultFreedesktopVersion;
+}
+
+QStringList FlatpakManifestGenerator::runtimeRefs() const
+{
+    const QString version = runtimeVersion();
+    return {platformId() + "//" + version, sdkId() + "//" + version};
+}
+
+bool FlatpakManifestGenerator::isSdkInstalled() const
+{
+    const QString version = runtimeVersion();
+    for (const InstalledRuntime& sdk : m_installed) {
+        if (sdk.id == sdkId() && sdk.branch == version) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QJsonObject FlatpakManifestGenerator::appModule() const
+{
+    QJsonObject module;
+    module["name"] = m_projectName;
+
+    QJsonArray configOpts;
+    QJsonObject buildOptions;
+    switch (m_buildSystem) {
+        case CMake:
+            module["buildsystem"] = "cmake-ninja";
+            configOpts << "-DCMAKE_BUILD_TYPE=Release" << "-DBUILD_TESTING=OFF";
+            if (m_lto) {
+                configOpts << "-DCMAKE_INTERPROCEDURAL_OPTIMIZATION=ON";
+            }
+            break;
+        case Meson:
+            // Meson zawsze generuje pliki Ninja
+            module["buildsystem"] = "meson";
+            configOpts << "--buildtype=release";
+            if (m_lto) {
+                configOpts << "-Db_lto=true";
+            }
+            break;
+        case QMake:
+            module["buildsystem"] = "qmake";
+            configOpts << "CONFIG+=release";
+            if (m_lto) {
+                configOpts << "CONFIG+=ltcg";
+            }
+            break;
+        case Autotools:
+            module["buildsystem"] = "autotools";
+            configOpts << "--disable-static" << "--disable-dependency-tracking";
+            break;
+        case UnknownBuildSystem:
+            module["buildsystem"] = "simple";
+            module["build-commands"] = QJsonArray{
+                "make -j${FLATPAK_BUILDER_N_JOBS}",
+                "make install PREFIX=${FLATPAK_DEST}"
+            };
+            break;
+    }
+
+    // Flagi LTO dla systemów bez własnej opcji są doklejane do flag SDK
+    if (m_lto && (m_buildSystem == Autotools || m_buildSystem == UnknownBuildSystem)) {
+        buildOptions["cflags"] = "-flto=auto";
+        buildOptions["cxxflags"] = "-flto=auto";
+        buildOptions["ldflags"] = "-flto=auto";
+    }
+
+    if (m_buildSystem != UnknownBuildSystem) {
+        module["builddir"] = true;
+    }
+    if (!configOpts.isEmpty()) {
+        module["config-opts"] = configOpts;
+    }
+    if (!buildOptions.isEmpty()) {
+        module["build-options"] = buildOptions;
+    }
+
+    QJsonObject source;
+    source["type"] = "dir";
+    source["path"] = ".";
+    source["skip"] = QJsonArray::fromStringList(m_skippedDirs);
+    module["sources"] = QJsonArray{source};
+
+    return module;
+}
+
+QJsonObject FlatpakManifestGenerator::manifest() const
+{
+    QJsonObject manifest;
+    manifest["id"] = m_appId;
+    manifest["runtime"] = platformId();
+    manifest["runtime-version"] = runtimeVersion();
+    manifest["sdk"] = sdkId();
+    manifest["command"] = m_command;
+
+    QJsonArray finishArgs{"--share=ipc"};
+    if (m_toolkit != NoToolkit) {
+        finishArgs << "--socket=fallback-x11" << "--socket=wayland" << "--device=dri";
+    }
+    manifest["finish-args"] = finishArgs;
+
+    manifest["cleanup"] = QJsonArray::fromStringList(StandardCleanup);
+    manifest["modules"] = QJsonArray{appModule()};
+    return manifest;
+}
+
+QByteArray FlatpakManifestGenerator::toJson() const
+{
+    return QJsonDocument(manifest()).toJson(QJsonDocument::Indented);
+}
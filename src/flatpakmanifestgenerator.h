@@ -0,0 +1,145 @@
+/**
+ * @file flatpakmanifestgenerator.h
+ * @brief Generowanie manifestu dopasowanego do systemu budowania projektu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKMANIFESTGENERATOR_H
+#define FLATPAKMANIFESTGENERATOR_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @class FlatpakManifestGenerator
+ * @brief Tworzy manifest na podstawie systemu budowania i zależności projektu
+ *
+ * Zamiast ogólnego szablonu generator rozpoznaje CMake, Meson, qmake lub
+ * autotools i ustawia odpowiedni buildsystem z generatorem Ninja, budowanie
+ * poza drzewem źródeł, typ Release (opcjonalnie z LTO) oraz standardowe
+ * reguły cleanup. Zestaw narzędzi (Qt, GTK) wybiera runtime, a wersja jest
+ * przypinana do najnowszej zainstalowanej, żeby pierwsze budowanie nie
+ * zaczynało się od pobierania SDK. Katalogi budowania leżące w projekcie
+ * są pomijane przy kopiowaniu źródeł.
+ */
+class FlatpakManifestGenerator
+{
+public:
+    /**
+     * System budowania projektu
+     */
+    enum BuildSystem {
+        UnknownBuildSystem, ///< Zwykły Makefile lub nierozpoznany system
+        CMake,
+        Meson,
+        QMake,
+        Autotools
+    };
+
+    /**
+     * Zestaw narzędzi, od którego zależy wybór runtime'u
+     */
+    enum Toolkit {
+        NoToolkit,
+        Qt5,
+        Qt6,
+        Gtk3,
+        Gtk4
+    };
+
+    /**
+     * Zainstalowany runtime lub SDK
+     */
+    struct InstalledRuntime {
+        QString id;
+        QString branch;
+    };
+
+    /**
+     * Konstruktor
+     *
+     * Rozpoznaje system budowania, zestaw narzędzi, identyfikator aplikacji
+     * i nazwę programu na podstawie plików projektu.
+     *
+     * @param projectDir Katalog główny projektu
+     * @param projectName Nazwa projektu (nazwa modułu i zapasowa nazwa programu)
+     */
+    FlatpakManifestGenerator(const QString& projectDir, const QString& projectName);
+
+    /**
+     * @brief Nadpisuje wykryty system budowania (np. menedżerem projektu KDevelop)
+     * @param buildSystem System budowania; UnknownBuildSystem zostawia wykryty
+     */
+    void setBuildSystem(BuildSystem buildSystem);
+
+    /**
+     * @brief Włącza optymalizację podczas konsolidacji (LTO)
+     * @param lto Czy włączyć LTO
+     */
+    void setLto(bool lto);
+
+    /**
+     * @brief Ustawia listę zainstalowanych runtime'ów do przypięcia wersji
+     * @param runtimes Wynik installedRuntimes()
+     */
+    void setInstalledRuntimes(const QVector<InstalledRuntime>& runtimes);
+
+    /**
+     * @brief Zwraca zainstalowane runtime'y i SDK
+     * @param flatpakPath Ścieżka do programu flatpak
+     * @return Lista runtime'ów; pusta, jeśli flatpak nie jest dostępny
+     */
+    static QVector<InstalledRuntime> installedRuntimes(const QString& flatpakPath);
+
+    /**
+     * @brief Rozpoznaje system budowania po plikach w katalogu projektu
+     */
+    static BuildSystem detectBuildSystem(const QString& projectDir);
+
+    BuildSystem buildSystem() const;
+    Toolkit toolkit() const;
+    QString appId() const;
+
+    /**
+     * @brief Zwraca runtime i SDK z przypiętą wersją, np. org.kde.Sdk//6.8
+     */
+    QStringList runtimeRefs() const;
+
+    /**
+     * @brief Czy wybrane SDK jest zainstalowane
+     *
+     * Gdy nie jest, manifest używa domyślnej wersji i SDK trzeba doinstalować.
+     */
+    bool isSdkInstalled() const;
+
+    /**
+     * @brief Tworzy manifest
+     * @return Obiekt JSON manifestu
+     */
+    QJsonObject manifest() const;
+
+    /**
+     * @brief Zwraca manifest jako sformatowany JSON
+     */
+    QByteArray toJson() const;
+
+private:
+    QString platformId() const;
+    QString sdkId() const;
+    QString runtimeVersion() const;
+    QJsonObject appModule() const;
+
+    QString m_projectName;
+    BuildSystem m_buildSystem;
+    Toolkit m_toolkit;
+    QString m_appId;
+    QString m_command;
+    QStringList m_skippedDirs;
+    bool m_lto;
+    QVector<InstalledRuntime> m_installed;
+};
+
+#endif // FLATPAKMANIFESTGENERATOR_H
@@ -0,0 +1,1362 @@
+/**
+ * @file flatpakmanifestmodel.cpp
+ * @brief Implementacja przyrostowego modelu manifestu Flatpak
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakmanifestmodel.h"
+
+#include <KLocalizedString>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+namespace {
+    // Głębsze zagnieżdżenie to raczej uszkodzony plik niż prawdziwy manifest
+    const int MaxNestingDepth = 64;
+
+    // Ogranicza dołączanie plików w kółko
+    const int MaxIncludeDepth = 8;
+
+    /**
+     * Węzeł drzewa dokumentu z położeniem w liniach źródła
+     */
+    struct Node {
+        enum Kind {
+            Null,
+            Scalar,
+            Object,
+            Array
+        };
+
+        Kind kind = Null;
+        int line = 0;
+        int column = 0;
+        int endLine = 0;
+        int endColumn = 0;
+        QString value;
+        QStringList keys;
+        QVector<int> keyLines;
+        QVector<int> keyColumns;
+        QVector<Node> children;
+
+        const Node* member(const QString& key) const
+        {
+            const int index = keys.indexOf(key);
+            return index < 0 ? nullptr : &children.at(index);
+        }
+
+        QString scalar(const QString& key) const
+        {
+            const Node* node = member(key);
+            return node && node->kind == Scalar ? node->value : QString();
+        }
+    };
+
+    struct ParseError {
+        bool failed = false;
+        bool trailing = false;      ///< Poprawna wartość, po której jest dalsza treść
+        int line = 0;
+        int column = 0;
+        QString message;
+    };
+
+    QStringList splitLines(const QString& text)
+    {
+        QStringList lines = text.split('\n');
+        for (QString& line : lines) {
+            if (line.endsWith('\r')) {
+                line.chop(1);
+            }
+        }
+        return lines;
+    }
+
+    /**
+     * Parser JSON działający na zakresie linii, który zapamiętuje położenie
+     * każdej wartości i klucza - QJsonDocument tego nie udostępnia
+     */
+    class JsonParser
+    {
+    public:
+        JsonParser(const QStringList& lines, int firstLine, int lastLine, ParseError* error)
+            : m_lines(lines)
+            , m_line(firstLine)
+            , m_column(0)
+            , m_lastLine(lastLine)
+            , m_error(error)
+        {
+        }
+
+        Node parseDocument()
+        {
+            Node node = parseValue(0);
+            if (m_error->failed) {
+                return node;
+            }
+
+            // Przecinek po obiekcie należy do tablicy, w której leży segment
+            QChar c = peek();
+            if (c == ',') {
+                ++m_column;
+                c = peek();
+            }
+            if (!c.isNull()) {
+                fail(i18n("Unexpected content after the end of the value"));
+                m_error->trailing = true;
+            }
+            return node;
+        }
+
+    private:
+        QChar peek()
+        {
+            while (m_line <= m_lastLine) {
+                const QString& text = m_lines.at(m_line);
+                while (m_column < text.size() && text.at(m_column).isSpace()) {
+                    ++m_column;
+                }
+                if (m_column < text.size()) {
+                    return text.at(m_column);
+                }
+                ++m_line;
+                m_column = 0;
+            }
+            return QChar();
+        }
+
+        void fail(const QString& message)
+        {
+            if (m_error->failed) {
+                return;
+            }
+            m_error->failed = true;
+            m_error->line = qMin(m_line, m_lastLine);
+            m_error->column = m_line > m_lastLine ? 0 : m_column;
+            m_error->message = message;
+        }
+
+        Node parseValue(int depth)
+        {
+            Node node;
+            const QChar c = peek();
+            if (c.isNull()) {
+                fail(i18n("Unexpected end of the document"));
+                return node;
+            }
+
+            node.line = m_line;
+            node.column = m_column;
+            node.endLine = m_line;
+            if (depth > MaxNestingDepth) {
+                fail(i18n("Values are nested too deeply"));
+            } else if (c == '{') {
+                parseObject(node, depth);
+            } else if (c == '[') {
+                parseArray(node, depth);
+            } else if (c == '"') {
+                node.kind = Node::Scalar;
+                node.value = parseString();
+                node.endColumn = m_column;
+            } else {
+                parseLiteral(node);
+            }
+            return node;
+        }
+
+        void parseObject(Node& node, int depth)
+        {
+            node.kind = Node::Object;
+            ++m_column;
+            if (peek() == '}') {
+                close(node);
+                return;
+            }
+
+            forever {
+                if (peek() != '"') {
+                    fail(i18n("Expected a quoted key"));
+                    break;
+                }
+                const int keyLine = m_line;
+                const int keyColumn = m_column + 1;
+                const QString key = parseString();
+                if (m_error->failed) {
+                    break;
+                }
+                if (peek() != ':') {
+                    fail(i18n("Expected ':' after \"%1\"", key));
+                    break;
+                }
+                ++m_column;
+
+                // Częściowo sparsowana wartość też trafia do drzewa
+                Node value = parseValue(depth + 1);
+                node.keys.append(key);
+                node.keyLines.append(keyLine);
+                node.keyColumns.append(keyColumn);
+                node.children.append(std::move(value));
+                if (m_error->failed) {
+                    break;
+                }
+
+                const QChar c = peek();
+                if (c == ',') {
+                    ++m_column;
+                    continue;
+                }
+                if (c == '}') {
+                    close(node);
+                    return;
+                }
+                fail(i18n("Expected ',' or '}'"));
+                break;
+            }
+            node.endLine = qMin(m_line, m_lastLine);
+        }
+
+        void parseArray(Node& node, int depth)
+        {
+            node.kind = Node::Array;
+            ++m_column;
+            if (peek() == ']') {
+                close(node);
+                return;
+            }
+
+            forever {
+                node.children.append(parseValue(depth + 1));
+                if (m_error->failed) {
+                    break;
+                }
+
+                const QChar c = peek();
+                if (c == ',') {
+                    ++m_column;
+                    continue;
+                }
+                if (c == ']') {
+                    close(node);
+                    return;
+                }
+                fail(i18n("Expected ',' or ']'"));
+                break;
+            }
+            node.endLine = qMin(m_line, m_lastLine);
+        }
+
+        void close(Node& node)
+        {
+            node.endLine = m_line;
+            node.endColumn = m_column;
+            ++m_column;
+        }
+
+        QString parseString()
+        {
+            const QString& text = m_lines.at(m_line);
+            QString result;
+            int i = m_column + 1;
+            while (i < text.size()) {
+                const QChar c = text.at(i);
+                if (c == '"') {
+                    m_column = i + 1;
+                    return result;
+                }
+                if (c == '\\' && i + 1 < text.size()) {
+                    const QChar escaped = text.at(i + 1);
+                    switch (escaped.unicode()) {
+                        case 'n':
+                            result += '\n';
+                            break;
+                        case 't':
+                            result += '\t';
+                            break;
+                        case 'r':
+                            result += '\r';
+                            break;
+                        case 'b':
+                            result += '\b';
+                            break;
+                        case 'f':
+                            result += '\f';
+                            break;
+                        case 'u':
+                            if (i + 5 < text.size()) {
+                                result += QChar(text.midRef(i + 2, 4).toUShort(nullptr, 16));
+                                i += 4;
+                            }
+                            break;
+                        default:
+                            result += escaped;
+                            break;
+                    }
+                    i += 2;
+                    continue;
+                }
+                result += c;
+                ++i;
+            }
+
+            // Łańcuch JSON nie może przechodzić do następnej linii
+            m_column = text.size();
+            fail(i18n("Unterminated string"));
+            return result;
+        }
+
+        void parseLiteral(Node& node)
+        {
+            static const QRegularExpression numberRegex("^-?(0|[1-9][0-9]*)(\\.[0-9]+)?([eE][+-]?[0-9]+)?$");
+
+            const QString& text = m_lines.at(m_line);
+            int end = m_column;
+            while (end < text.size() && !text.at(end).isSpace() && !QStringLiteral(",:]}").contains(text.at(end))) {
+                ++end;
+            }
+
+            const QString token = text.mid(m_column, end - m_column);
+            if (token == QLatin1String("true") || token == QLatin1String("false")
+                || token == QLatin1String("null") || numberRegex.match(token).hasMatch()) {
+                node.kind = token == QLatin1String("null") ? Node::Null : Node::Scalar;
+                node.value = token;
+                m_column = end;
+                node.endColumn = end;
+                return;
+            }
+            fail(i18n("Unexpected \"%1\"", token.isEmpty() ? QString(text.at(m_column)) : token));
+        }
+
+        const QStringList& m_lines;
+        int m_line;
+        int m_column;
+        int m_lastLine;
+        ParseError* m_error;
+    };
+
+    /**
+     * Parser podzbioru YAML używanego w manifestach: mapy i listy blokowe,
+     * listy i mapy w nawiasach w jednej linii oraz skalary blokowe | i >
+     */
+    class YamlParser
+    {
+    public:
+        YamlParser(const QStringList& lines, int firstLine, int lastLine, ParseError* error)
+            : m_pos(0)
+            , m_error(error)
+        {
+            for (int i = firstLine; i <= lastLine; ++i) {
+                const QString content = stripComment(lines.at(i));
+                const QString trimmed = content.trimmed();
+                if (trimmed.isEmpty() || trimmed == QLatin1String("---") || trimmed == QLatin1String("...")) {
+                    continue;
+                }
+
+                int indent = 0;
+                while (indent < content.size() && (content.at(indent) == ' ' || content.at(indent) == '\t')) {
+                    if (content.at(indent) == '\t') {
+                        fail(i, indent, i18n("Tabs are not allowed in YAML indentation"));
+                    }
+                    ++indent;
+                }
+                m_items.append({i, indent, content.mid(indent)});
+            }
+        }
+
+        Node parseDocument()
+        {
+            if (m_error->failed || m_items.isEmpty()) {
+                return Node();
+            }
+
+            Node node = parseNode(0);
+            if (!m_error->failed && m_pos < m_items.size()) {
+                const Line& line = m_items.at(m_pos);
+                fail(line.number, line.indent, i18n("Unexpected indentation"));
+                m_error->trailing = true;
+            }
+            return node;
+        }
+
+    private:
+        struct Line {
+            int number;
+            int indent;
+            QString content;
+        };
+
+        static const QRegularExpression& keyRegex()
+        {
+            static const QRegularExpression regex("^(\"(?:[^\"\\\\]|\\\\.)*\"|'[^']*'|[^\\s'\"#\\[\\]{}][^:#]*?)\\s*:(?:\\s+(.*))?$");
+            return regex;
+        }
+
+        static bool isSequenceItem(const QString& content)
+        {
+            return content == QLatin1String("-") || content.startsWith(QLatin1String("- "));
+        }
+
+        static QString stripComment(const QString& line)
+        {
+            QChar quote;
+            for (int i = 0; i < line.size(); ++i) {
+                const QChar c = line.at(i);
+                if (!quote.isNull()) {
+                    if (c == '\\' && quote == '"') {
+                        ++i;
+                    } else if (c == quote) {
+                        quote = QChar();
+                    }
+                } else if (c == '#' && (i == 0 || line.at(i - 1).isSpace())) {
+                    return line.left(i);
+                } else if ((c == '"' || c == '\'') && (i == 0 || QStringLiteral(" \t[{,:-").contains(line.at(i - 1)))) {
+                    quote = c;
+                }
+            }
+            QString result = line;
+            while (!result.isEmpty() && result.at(result.size() - 1).isSpace()) {
+                result.chop(1);
+            }
+            return result;
+        }
+
+        static QString unquote(const QString& text)
+        {
+            if (text.size() >= 2 && text.startsWith('"') && text.endsWith('"')) {
+                QString inner = text.mid(1, text.size() - 2);
+                inner.replace(QLatin1String("\\\""), QLatin1String("\""));
+                inner.replace(QLatin1String("\\\\"), QLatin1String("\\"));
+                return inner;
+            }
+            if (text.size() >= 2 && text.startsWith('\'') && text.endsWith('\'')) {
+                return text.mid(1, text.size() - 2).replace(QLatin1String("''"), QLatin1String("'"));
+            }
+            return text;
+        }
+
+        static QStringList splitFlow(const QString& text)
+        {
+            QStringList parts;
+            QString current;
+            QChar quote;
+            for (const QChar c : text) {
+                if (!quote.isNull()) {
+                    if (c == quote) {
+                        quote = QChar();
+                    }
+                } else if (c == '"' || c == '\'') {
+                    quote = c;
+                } else if (c == ',') {
+                    parts << current.trimmed();
+                    current.clear();
+                    continue;
+                }
+                current += c;
+            }
+            if (!current.trimmed().isEmpty()) {
+                parts << current.trimmed();
+            }
+            return parts;
+        }
+
+        void fail(int line, int column, const QString& message)
+        {
+            if (m_error->failed) {
+                return;
+            }
+            m_error->failed = true;
+            m_error->line = line;
+            m_error->column = column;
+            m_error->message = message;
+            m_pos = m_items.size();
+        }
+
+        int lastConsumedLine(int fallback) const
+        {
+            return m_pos > 0 && m_pos <= m_items.size() ? m_items.at(m_pos - 1).number : fallback;
+        }
+
+        Node parseNode(int depth)
+        {
+            const Line& line = m_items.at(m_pos);
+            if (depth > MaxNestingDepth) {
+                fail(line.number, line.indent, i18n("Values are nested too deeply"));
+                return Node();
+            }
+            if (isSequenceItem(line.content)) {
+                return parseSequence(line.indent, depth);
+            }
+            if (keyRegex().match(line.content).hasMatch()) {
+                return parseMapping(line.indent, depth);
+            }
+
+            const int number = line.number;
+            const int column = line.indent;
+            const QString content = line.content;
+            ++m_pos;
+            return parseInline(gatherFlow(content), number, column);
+        }
+
+        Node parseMapping(int indent, int depth)
+        {
+            Node node;
+            node.kind = Node::Object;
+            node.line = m_items.at(m_pos).number;
+            node.column = indent;
+            node.endLine = node.line;
+
+            while (m_pos < m_items.size()) {
+                const Line line = m_items.at(m_pos);
+                if (line.indent < indent || isSequenceItem(line.content)) {
+                    break;
+                }
+                if (line.indent > indent) {
+                    fail(line.number, line.indent, i18n("Unexpected indentation"));
+                    break;
+                }
+
+                const QRegularExpressionMatch match = keyRegex().match(line.content);
+                if (!match.hasMatch()) {
+                    fail(line.number, line.indent, i18n("Expected \"key: value\""));
+                    break;
+                }
+
+                const QString key = unquote(match.captured(1).trimmed());
+                const QString rest = match.captured(2).trimmed();
+                ++m_pos;
+
+                Node value;
+                value.line = line.number;
+                value.endLine = line.number;
+                if (rest.isEmpty()) {
+                    // Lista może mieć to samo wcięcie co jej klucz
+                    if (m_pos < m_items.size()) {
+                        const Line& next = m_items.at(m_pos);
+                        if (next.indent > indent || (next.indent == indent && isSequenceItem(next.content))) {
+                            value = parseNode(depth + 1);
+                        }
+                    }
+                } else if (rest.startsWith('|') || rest.startsWith('>')) {
+                    value = parseBlockScalar(indent, line.number);
+                } else {
+                    value = parseInline(gatherFlow(rest), line.number, line.indent + match.capturedStart(2));
+                }
+
+                node.keys.append(key);
+                node.keyLines.append(line.number);
+                node.keyColumns.append(line.indent);
+                node.endLine = qMax(line.number, value.endLine);
+                node.children.append(std::move(value));
+                if (m_error->failed) {
+                    break;
+                }
+            }
+            return node;
+        }
+
+        Node parseSequence(int indent, int depth)
+        {
+            Node node;
+            node.kind = Node::Array;
+            node.line = m_items.at(m_pos).number;
+            node.column = indent;
+            node.endLine = node.line;
+
+            while (m_pos < m_items.size() && !m_error->failed) {
+                Line& line = m_items[m_pos];
+                if (line.indent != indent || !isSequenceItem(line.content)) {
+                    break;
+                }
+
+                const QString rest = line.content.mid(1);
+                int spaces = 0;
+                while (spaces < rest.size() && rest.at(spaces) == ' ') {
+                    ++spaces;
+                }
+
+                if (spaces == rest.size()) {
+                    Node child;
+                    child.line = line.number;
+                    child.endLine = line.number;
+                    ++m_pos;
+                    if (m_pos < m_items.size() && m_items.at(m_pos).indent > indent) {
+                        child = parseNode(depth + 1);
+                    }
+                    node.children.append(std::move(child));
+                } else {
+                    // Treść po "- " to węzeł o wcięciu równym jej kolumnie
+                    line.indent = indent + 1 + spaces;
+                    line.content = rest.mid(spaces);
+                    node.children.append(parseNode(depth + 1));
+                }
+                node.endLine = qMax(node.endLine, node.children.last().endLine);
+            }
+            return node;
+        }
+
+        Node parseBlockScalar(int indent, int keyLine)
+        {
+            Node node;
+            node.kind = Node::Scalar;
+            node.line = keyLine;
+            node.endLine = keyLine;
+
+            QStringList lines;
+            while (m_pos < m_items.size() && m_items.at(m_pos).indent > indent) {
+                lines << m_items.at(m_pos).content;
+                node.endLine = m_items.at(m_pos).number;
+                ++m_pos;
+            }
+            node.value = lines.join('\n');
+            return node;
+        }
+
+        QString gatherFlow(const QString& text)
+        {
+            if (!text.startsWith('[') && !text.startsWith('{')) {
+                return text;
+            }
+
+            // Lista w nawiasach może ciągnąć się przez kilka linii
+            QString result = text;
+            auto balance = [](const QString& value) {
+                return value.count('[') + value.count('{') - value.count(']') - value.count('}');
+            };
+            while (balance(result) > 0 && m_pos < m_items.size()) {
+                result += ' ' + m_items.at(m_pos).content;
+                ++m_pos;
+            }
+            return result;
+        }
+
+        Node parseInline(const QString& text, int line, int column)
+        {
+            Node node;
+            node.line = line;
+            node.column = column;
+            node.endLine = lastConsumedLine(line);
+
+            if (text.startsWith('[') && text.endsWith(']')) {
+                node.kind = Node::Array;
+                for (const QString& part : splitFlow(text.mid(1, text.size() - 2))) {
+                    Node child;
+                    child.kind = Node::Scalar;
+                    child.line = line;
+                    child.column = column;
+                    child.endLine = line;
+                    child.value = unquote(part);
+                    node.children.append(std::move(child));
+                }
+            } else if (text.startsWith('{') && text.endsWith('}')) {
+                node.kind = Node::Object;
+                for (const QString& part : splitFlow(text.mid(1, text.size() - 2))) {
+                    const int colon = part.indexOf(':');
+                    Node child;
+                    child.kind = Node::Scalar;
+                    child.line = line;
+                    child.column = column;
+                    child.endLine = line;
+                    child.value = colon < 0 ? QString() : unquote(part.mid(colon + 1).trimmed());
+                    node.keys.append(unquote((colon < 0 ? part : part.left(colon)).trimmed()));
+                    node.keyLines.append(line);
+                    node.keyColumns.append(column);
+                    node.children.append(std::move(child));
+                }
+            } else if (text == QLatin1String("~") || text == QLatin1String("null")) {
+                node.kind = Node::Null;
+            } else {
+                node.kind = Node::Scalar;
+                node.value = unquote(text);
+            }
+            return node;
+        }
+
+        QVector<Line> m_items;
+        int m_pos;
+        ParseError* m_error;
+    };
+
+    Node parseLines(FlatpakManifestModel::Format format, const QStringList& lines, int firstLine, int lastLine, ParseError* error)
+    {
+        if (format == FlatpakManifestModel::Yaml) {
+            return YamlParser(lines, firstLine, lastLine, error).parseDocument();
+        }
+        return JsonParser(lines, firstLine, lastLine, error).parseDocument();
+    }
+
+    bool isHex(const QString& value)
+    {
+        static const QRegularExpression hexRegex("^[0-9a-fA-F]+$");
+        return hexRegex.match(value).hasMatch();
+    }
+}
+
+/**
+ * Zbiera moduły, zakresy i diagnostykę z drzewa dokumentu. Linie bieżącego
+ * dokumentu są zapisywane względem początku segmentu (offset), linie plików
+ * dołączonych - bezwzględnie.
+ */
+class FlatpakManifestModel::Collector
+{
+public:
+    Collector(const QString& file, const QString& dir, int offset,
+              QHash<QString, IncludedFile>* includes, int includeDepth)
+        : m_file(file)
+        , m_dir(dir)
+        , m_offset(offset)
+        , m_includes(includes)
+        , m_includeDepth(includeDepth)
+    {
+    }
+
+    void moduleEntry(const Node& node, int depth)
+    {
+        if (node.kind == Node::Object) {
+            module(node, depth);
+        } else if (node.kind == Node::Scalar) {
+            include(node, depth);
+        } else {
+            report(true, node.line, node.column, 1, i18n("Modules must be objects or names of module files"));
+        }
+    }
+
+    void module(const Node& node, int depth)
+    {
+        checkKeys(node, FlatpakManifestSchema::Module);
+        span(node, FlatpakManifestSchema::Module);
+
+        Module module;
+        module.name = node.scalar("name");
+        module.buildsystem = node.scalar("buildsystem");
+        module.file = m_file;
+        module.line = node.line - m_offset;
+        module.depth = depth;
+
+        if (module.name.isEmpty()) {
+            report(true, node.line, node.column, 1, i18n("Module has no name"));
+        }
+
+        if (const Node* buildsystem = node.member("buildsystem")) {
+            const QStringList allowed = FlatpakManifestSchema::values(FlatpakManifestSchema::Module, "buildsystem");
+            if (!allowed.contains(buildsystem->value)) {
+                report(true, buildsystem->line, buildsystem->column, buildsystem->value.size() + 2,
+                       i18n("Unknown build system \"%1\"; expected one of: %2", buildsystem->value, allowed.join(", ")));
+            }
+        }
+
+        if (const Node* options = node.member("build-options")) {
+            buildOptions(*options);
+        }
+
+        if (const Node* sources = node.member("sources")) {
+            if (sources->kind != Node::Array) {
+                report(true, sources->line, sources->column, 1, i18n("\"sources\" must be a list"));
+            } else {
+                span(*sources, FlatpakManifestSchema::Source);
+                for (const Node& child : sources->children) {
+                    if (child.kind == Node::Object) {
+                        source(child, module.sources);
+                    } else if (child.kind == Node::Scalar) {
+                        // Plik JSON z listą źródeł
+                        Source included;
+                        included.type = QStringLiteral("include");
+                        included.location = child.value;
+                        included.line = child.line - m_offset;
+                        module.sources.append(included);
+                    }
+                }
+            }
+        }
+
+        modules.append(module);
+
+        if (const Node* nested = node.member("modules")) {
+            if (nested->kind != Node::Array) {
+                report(true, nested->line, nested->column, 1, i18n("\"modules\" must be a list"));
+            } else {
+                span(*nested, FlatpakManifestSchema::Module);
+                for (const Node& child : nested->children) {
+                    moduleEntry(child, depth + 1);
+                }
+            }
+        }
+    }
+
+    void buildOptions(const Node& node)
+    {
+        if (node.kind != Node::Object) {
+            report(true, node.line, node.column, 1, i18n("\"build-options\" must be an object"));
+            return;
+        }
+
+        checkKeys(node, FlatpakManifestSchema::BuildOptions);
+        span(node, FlatpakManifestSchema::BuildOptions);
+
+        // Opcje dla architektur mają tę samą postać
+        if (const Node* arches = node.member("arch")) {
+            for (const Node& child : arches->children) {
+                if (child.kind == Node::Object) {
+                    buildOptions(child);
+                }
+            }
+        }
+    }
+
+    void checkKeys(const Node& node, FlatpakManifestSchema::Context context)
+    {
+        for (int i = 0; i < node.keys.size(); ++i) {
+            const QString& key = node.keys.at(i);
+            if (!FlatpakManifestSchema::isKnownKey(context, key)) {
+                report(false, node.keyLines.at(i), node.keyColumns.at(i), key.size(),
+                       i18n("Unknown key \"%1\" in %2", key, FlatpakManifestSchema::contextName(context)));
+            }
+
+            // Obiekty bez znaczenia dla schematu (env, x-checker-data) nie dziedziczą
+            // kontekstu rodzica; znane obiekty nadpiszą ten zakres własnym
+            if (node.children.at(i).kind == Node::Object) {
+                span(node.children.at(i), FlatpakManifestSchema::UnknownContext);
+            }
+        }
+    }
+
+    void span(const Node& node, FlatpakManifestSchema::Context context)
+    {
+        // Podpowiedzi dotyczą tylko bieżącego dokumentu
+        if (m_file.isEmpty()) {
+            Span span;
+            span.startLine = node.line - m_offset;
+            span.endLine = node.endLine - m_offset;
+            span.context = context;
+            spans.append(span);
+        }
+    }
+
+    void report(bool error, int line, int column, int length, const QString& message)
+    {
+        Diagnostic diagnostic;
+        diagnostic.file = m_file;
+        diagnostic.line = line - m_offset;
+        diagnostic.column = column;
+        diagnostic.length = length;
+        diagnostic.error = error;
+        diagnostic.message = message;
+        diagnostics.append(diagnostic);
+    }
+
+    QVector<Module> modules;
+    QVector<Span> spans;
+    QVector<Diagnostic> diagnostics;
+
+private:
+    void source(const Node& node, QVector<Source>& sources)
+    {
+        checkKeys(node, FlatpakManifestSchema::Source);
+        span(node, FlatpakManifestSchema::Source);
+
+        Source source;
+        source.type = node.scalar("type");
+        source.location = node.member("url") ? node.scalar("url") : node.scalar("path");
+        source.checksumType = node.member("sha512") ? QStringLiteral("sha512")
+                            : node.member("sha256") ? QStringLiteral("sha256") : QString();
+        source.checksum = source.checksumType.isEmpty() ? QString() : node.scalar(source.checksumType);
+        source.line = node.line - m_offset;
+        if (const Node* location = node.member("url") ? node.member("url") : node.member("path")) {
+            source.locationLine = location->line - m_offset;
+        }
+        if (!source.checksumType.isEmpty()) {
+            source.checksumLine = node.member(source.checksumType)->line - m_offset;
+        }
+
+        const Node* type = node.member("type");
+        if (!type) {
+            report(true, node.line, node.column, 1, i18n("Source has no type"));
+        } else if (!FlatpakManifestSchema::values(FlatpakManifestSchema::Source, "type").contains(type->value)) {
+            report(true, type->line, type->column, type->value.size() + 2, i18n("Unknown source type \"%1\"", type->value));
+        }
+
+        const Node* url = node.member("url");
+        if (source.type == QLatin1String("archive") || source.type == QLatin1String("file")
+            || source.type == QLatin1String("extra-data")) {
+            if (!url && !node.member("path")) {
+                report(true, node.line, node.column, 1, i18n("Source of type %1 needs a url or path", source.type));
+            } else if (url && !node.member("sha256") && !node.member("sha512")) {
+                report(true, url->line, url->column, url->value.size() + 2,
+                       i18n("Downloaded sources need a sha256 or sha512 checksum"));
+            }
+        } else if (source.type == QLatin1String("git") && url && !node.member("commit") && !node.member("tag")) {
+            report(false, url->line, url->column, url->value.size() + 2,
+                   i18n("Pin git sources to a commit or tag for reproducible builds"));
+        }
+
+        checkChecksum(node, "sha256", 64);
+        checkChecksum(node, "sha512", 128);
+
+        sources.append(source);
+    }
+
+    void checkChecksum(const Node& node, const QString& key, int length)
+    {
+        const Node* checksum = node.member(key);
+        if (checksum && (checksum->value.size() != length || !isHex(checksum->value))) {
+            report(true, checksum->line, checksum->column, checksum->value.size() + 2,
+                   i18n("\"%1\" must be %2 hexadecimal digits", key, length));
+        }
+    }
+
+    void include(const Node& node, int depth)
+    {
+        const QString path = QDir::cleanPath(QDir(m_dir).absoluteFilePath(node.value));
+        const QFileInfo info(path);
+        if (!info.isFile()) {
+            report(true, node.line, node.column, node.value.size() + 2, i18n("Included file %1 does not exist", node.value));
+            return;
+        }
+        if (m_includeDepth >= MaxIncludeDepth) {
+            report(true, node.line, node.column, node.value.size() + 2,
+                   i18n("Files are included too deeply; do they include each other?"));
+            return;
+        }
+
+        // Plik dołączony jest parsowany ponownie dopiero po zmianie na dysku
+        QHash<QString, IncludedFile>::const_iterator it = m_includes->constFind(path);
+        if (it == m_includes->constEnd() || it->modified != info.lastModified()) {
+            IncludedFile included;
+            included.modified = info.lastModified();
+
+            QFile file(path);
+            if (file.open(QIODevice::ReadOnly)) {
+                const QStringList lines = splitLines(QString::fromUtf8(file.readAll()));
+                ParseError error;
+                const Node root = parseLines(formatForPath(path), lines, 0, lines.size() - 1, &error);
+
+                Collector collector(path, info.absolutePath(), 0, m_includes, m_includeDepth + 1);
+                if (error.failed) {
+                    collector.report(true, error.line, error.column, 1, error.message);
+                }
+                if (root.kind == Node::Object) {
+                    collector.module(root, 0);
+                }
+                included.modules = collector.modules;
+                included.diagnostics = collector.diagnostics;
+            }
+            it = m_includes->insert(path, included);
+        }
+
+        for (Module module : it->modules) {
+            module.depth += depth;
+            modules.append(module);
+        }
+        diagnostics += it->diagnostics;
+    }
+
+    QString m_file;
+    QString m_dir;
+    int m_offset;
+    QHash<QString, IncludedFile>* m_includes;
+    int m_includeDepth;
+};
+
+FlatpakManifestModel::FlatpakManifestModel(Format format, const QString& baseDir)
+    : m_format(format)
+    , m_baseDir(baseDir)
+{
+}
+
+FlatpakManifestModel::Format FlatpakManifestModel::formatForPath(const QString& path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == QLatin1String("yaml") || suffix == QLatin1String("yml") ? Yaml : Json;
+}
+
+void FlatpakManifestModel::setText(const QString& text)
+{
+    m_lines = splitLines(text);
+    m_segments.clear();
+    m_rootSpans.clear();
+    m_rootDiagnostics.clear();
+    m_topLevel.clear();
+    m_sdkExtensions.clear();
+
+    ParseError error;
+    const Node root = parseLines(m_format, m_lines, 0, m_lines.size() - 1, &error);
+
+    Collector collector(QString(), m_baseDir, 0, &m_includes, 0);
+    if (root.kind == Node::Object) {
+        collector.checkKeys(root, FlatpakManifestSchema::TopLevel);
+        collector.span(root, FlatpakManifestSchema::TopLevel);
+
+        if (!root.member("id") && !root.member("app-id")) {
+            collector.report(true, root.line, root.column, 1, i18n("The manifest has no \"id\""));
+        }
+        if (!root.member("runtime")) {
+            collector.report(true, root.line, root.column, 1, i18n("The manifest has no \"runtime\""));
+        }
+        if (!root.member("sdk")) {
+            collector.report(true, root.line, root.column, 1, i18n("The manifest has no \"sdk\""));
+        }
+
+        for (int i = 0; i < root.keys.size(); ++i) {
+            const Node& child = root.children.at(i);
+            if (child.kind == Node::Scalar) {
+                m_topLevel.insert(root.keys.at(i), {child.value, child.line, child.column});
+            }
+        }
+
+        if (const Node* options = root.member("build-options")) {
+            collector.buildOptions(*options);
+        }
+
+        if (const Node* extensions = root.member("sdk-extensions")) {
+            collector.span(*extensions, FlatpakManifestSchema::ExtensionList);
+            for (const Node& child : extensions->children) {
+                if (child.kind == Node::Scalar) {
+                    m_sdkExtensions.append({child.value, child.line, child.column});
+                }
+            }
+        }
+
+        const Node* modules = root.member("modules");
+        if (!modules) {
+            collector.report(true, root.line, root.column, 1, i18n("The manifest has no \"modules\""));
+        } else if (modules->kind == Node::Array) {
+            collector.span(*modules, FlatpakManifestSchema::Module);
+
+            const QVector<Node>& children = modules->children;
+            for (int i = 0; i < children.size(); ++i) {
+                const Node& child = children.at(i);
+
+                Segment segment;
+                segment.startLine = child.line;
+                segment.endLine = child.endLine;
+                if (m_format == Yaml && i + 1 < children.size()) {
+                    // Puste linie i komentarze przed następnym modułem należą do tego segmentu
+                    segment.endLine = qMax(segment.endLine, children.at(i + 1).line - 1);
+                }
+
+                // Segment JSON musi zajmować całe linie, inaczej nie da się go
+                // sparsować bez sąsiadów ("}, {" w jednej linii)
+                segment.isolated = child.kind == Node::Object;
+                if (m_format == Json && segment.isolated) {
+                    const QString& first = m_lines.at(child.line);
+                    const QString& last = m_lines.at(child.endLine);
+                    segment.isolated = first.left(child.column).trimmed().isEmpty()
+                        && last.mid(child.endColumn + 1).trimmed().remove(QRegularExpression("^,")).trimmed().isEmpty()
+                        && (i == 0 || children.at(i - 1).endLine < child.line)
+                        && (i + 1 == children.size() || children.at(i + 1).line > child.endLine);
+                }
+
+                Collector segmentCollector(QString(), m_baseDir, segment.startLine, &m_includes, 0);
+                segmentCollector.moduleEntry(child, 0);
+                segment.modules = segmentCollector.modules;
+                segment.spans = segmentCollector.spans;
+                segment.diagnostics = segmentCollector.diagnostics;
+                m_segments.append(segment);
+            }
+        } else {
+            collector.report(true, modules->line, modules->column, 1, i18n("\"modules\" must be a list"));
+        }
+    } else if (!error.failed) {
+        collector.report(true, root.line, root.column, 1, i18n("The manifest must be an object"));
+    }
+
+    m_rootSpans = collector.spans;
+    m_rootDiagnostics = collector.diagnostics;
+
+    if (error.failed) {
+        Diagnostic diagnostic;
+        diagnostic.line = error.line;
+        diagnostic.column = error.column;
+        diagnostic.length = 1;
+        diagnostic.message = error.message;
+
+        // Błąd w module znika po jego poprawieniu, bez parsowania całości
+        const int index = segmentAt(error.line);
+        if (index >= 0) {
+            Segment& segment = m_segments[index];
+            diagnostic.line -= segment.startLine;
+            segment.diagnostics.append(diagnostic);
+            segment.syntaxError = true;
+        } else {
+            m_rootDiagnostics.append(diagnostic);
+        }
+    }
+}
+
+FlatpakManifestModel::EditResult FlatpakManifestModel::replaceLines(int firstLine, int removedCount, const QStringList& lines)
+{
+    firstLine = qBound(0, firstLine, m_lines.size());
+    removedCount = qBound(0, removedCount, m_lines.size() - firstLine);
+    const int lastLine = firstLine + removedCount - 1;
+    const int delta = lines.size() - removedCount;
+
+    m_lines.erase(m_lines.begin() + firstLine, m_lines.begin() + firstLine + removedCount);
+    for (int i = 0; i < lines.size(); ++i) {
+        m_lines.insert(firstLine + i, lines.at(i));
+    }
+
+    const int index = segmentAt(firstLine);
+    const bool contained = index >= 0 && m_segments.at(index).isolated && lastLine <= m_segments.at(index).endLine;
+    shiftLines(firstLine, lastLine, delta, contained ? index : -1);
+    if (!contained) {
+        return NeedsFullParse;
+    }
+
+    Segment& segment = m_segments[index];
+    segment.endLine += delta;
+    const bool hadSyntaxError = segment.syntaxError;
+    if (!reparseSegment(segment)) {
+        return NeedsFullParse;
+    }
+
+    // Po poprawieniu błędu składni dalsza część dokumentu mogła nie zostać
+    // jeszcze podzielona na segmenty
+    return hadSyntaxError && !segment.syntaxError ? NeedsFullParse : Updated;
+}
+
+int FlatpakManifestModel::lineCount() const
+{
+    return m_lines.size();
+}
+
+void FlatpakManifestModel::setInstalledRuntimes(const QVector<FlatpakManifestGenerator::InstalledRuntime>& runtimes)
+{
+    m_installedRuntimes = runtimes;
+}
+
+QVector<FlatpakManifestModel::Module> FlatpakManifestModel::modules() const
+{
+    QVector<Module> result;
+    for (const Segment& segment : m_segments) {
+        for (Module module : segment.modules) {
+            if (module.file.isEmpty()) {
+                module.line += segment.startLine;
+                for (Source& source : module.sources) {
+                    source.line += segment.startLine;
+                    if (source.locationLine >= 0) {
+                        source.locationLine += segment.startLine;
+                    }
+                    if (source.checksumLine >= 0) {
+                        source.checksumLine += segment.startLine;
+                    }
+                }
+            }
+            result.append(module);
+        }
+    }
+    return result;
+}
+
+QVector<FlatpakManifestModel::Diagnostic> FlatpakManifestModel::diagnostics() const
+{
+    QVector<Diagnostic> result = m_rootDiagnostics;
+    for (const Segment& segment : m_segments) {
+        for (Diagnostic diagnostic : segment.diagnostics) {
+            if (diagnostic.file.isEmpty()) {
+                diagnostic.line += segment.startLine;
+            }
+            result.append(diagnostic);
+        }
+    }
+
+    // flatpak-builder rozróżnia moduły po nazwie, także w katalogu stanu
+    const QVector<Module> allModules = modules();
+    QHash<QString, int> nameCounts;
+    for (const Module& module : allModules) {
+        if (!module.name.isEmpty()) {
+            ++nameCounts[module.name];
+        }
+    }
+    for (const Module& module : allModules) {
+        const int count = nameCounts.value(module.name);
+        if (module.file.isEmpty() && count > 1) {
+            Diagnostic diagnostic;
+            diagnostic.line = module.line;
+            diagnostic.length = 1;
+            diagnostic.error = false;
+            diagnostic.message = i18n("Module \"%1\" is defined %2 times", module.name, count);
+            result.append(diagnostic);
+        }
+    }
+
+    // Lista runtime'ów wczytuje się w tle; do tego czasu nie ma czego sprawdzać
+    if (!m_installedRuntimes.isEmpty()) {
+        auto isInstalled = [this](const QString& id, const QString& branch) {
+            return std::any_of(m_installedRuntimes.cbegin(), m_installedRuntimes.cend(),
+                               [&](const FlatpakManifestGenerator::InstalledRuntime& runtime) {
+                return runtime.id == id && (branch.isEmpty() || runtime.branch == branch);
+            });
+        };
+
+        const QString version = m_topLevel.contains("runtime-version")
+            ? m_topLevel.value("runtime-version").text : QStringLiteral("master");
+        for (const QString& key : {QStringLiteral("runtime"), QStringLiteral("sdk")}) {
+            if (!m_topLevel.contains(key)) {
+                continue;
+            }
+
+            // "sdk" może być pełnym odwołaniem id/arch/gałąź
+            const Value value = m_topLevel.value(key);
+            const QString id = value.text.section('/', 0, 0);
+            const QString branch = value.text.count('/') >= 2 ? value.text.section('/', 2, 2) : version;
+            if (!isInstalled(id, branch)) {
+                Diagnostic diagnostic;
+                diagnostic.line = value.line;
+                diagnostic.column = value.column;
+                diagnostic.length = value.text.size() + 2;
+                diagnostic.error = false;
+                diagnostic.message = i18n("%1//%2 is not installed; install it with: flatpak install flathub %1//%2", id, branch);
+                result.append(diagnostic);
+            }
+        }
+
+        for (const Value& extension : m_sdkExtensions) {
+            if (!isInstalled(extension.text, QString())) {
+                Diagnostic diagnostic;
+                diagnostic.line = extension.line;
+                diagnostic.column = extension.column;
+                diagnostic.length = extension.text.size() + 2;
+                diagnostic.error = false;
+                diagnostic.message = i18n("SDK extension %1 is not installed", extension.text);
+                result.append(diagnostic);
+            }
+        }
+    }
+
+    return result;
+}
+
+FlatpakManifestSchema::Context FlatpakManifestModel::contextAt(int line) const
+{
+    // Najgłębszy zakres to ten, który zaczyna się najpóźniej; przy równym
+    // początku późniejszy wpis opisuje obiekt dokładniej
+    auto innermost = [](const QVector<Span>& spans, int line, FlatpakManifestSchema::Context* context) {
+        int bestStart = -1;
+        for (const Span& span : spans) {
+            if (span.startLine <= line && line <= span.endLine && span.startLine >= bestStart) {
+                bestStart = span.startLine;
+                *context = span.context;
+            }
+        }
+        return bestStart >= 0;
+    };
+
+    FlatpakManifestSchema::Context context = FlatpakManifestSchema::UnknownContext;
+    const int index = segmentAt(line);
+    if (index >= 0) {
+        const Segment& segment = m_segments.at(index);
+        if (innermost(segment.spans, line - segment.startLine, &context)) {
+            return context;
+        }
+    }
+    innermost(m_rootSpans, line, &context);
+    return context;
+}
+
+QString FlatpakManifestModel::topLevelValue(const QString& key) const
+{
+    return m_topLevel.value(key).text;
+}
+
+bool FlatpakManifestModel::reparseSegment(Segment& segment)
+{
+    if (segment.endLine < segment.startLine || segment.endLine >= m_lines.size()) {
+        return false;
+    }
+
+    ParseError error;
+    Node node = parseLines(m_format, m_lines, segment.startLine, segment.endLine, &error);
+    if (error.trailing) {
+        return false;
+    }
+
+    if (error.failed) {
+        // Zostaje struktura z ostatniej poprawnej wersji - błąd jest zwykle
+        // chwilowy, w trakcie pisania
+        Diagnostic diagnostic;
+        diagnostic.line = error.line - segment.startLine;
+        diagnostic.column = error.column;
+        diagnostic.length = 1;
+        diagnostic.message = error.message;
+        segment.diagnostics = {diagnostic};
+        segment.syntaxError = true;
+        return true;
+    }
+
+    // Segment YAML to jednoelementowa lista ("- name: ...")
+    if (m_format == Yaml) {
+        if (node.kind != Node::Array || node.children.size() != 1) {
+            return false;
+        }
+        node = node.children.first();
+    }
+    if (node.kind != Node::Object) {
+        return false;
+    }
+
+    Collector collector(QString(), m_baseDir, segment.startLine, &m_includes, 0);
+    collector.module(node, 0);
+    segment.modules = collector.modules;
+    segment.spans = collector.spans;
+    segment.diagnostics = collector.diagnostics;
+    segment.syntaxError = false;
+    return true;
+}
+
+int FlatpakManifestModel::segmentAt(int line) const
+{
+    auto it = std::upper_bound(m_segments.cbegin(), m_segments.cend(), line, [](int value, const Segment& segment) {
+        return value < segment.startLine;
+    });
+    if (it == m_segments.cbegin()) {
+        return -1;
+    }
+    --it;
+    return line <= it->endLine ? static_cast<int>(it - m_segments.cbegin()) : -1;
+}
+
+void FlatpakManifestModel::shiftLines(int firstLine, int lastLine, int delta, int skipSegment)
+{
+    for (int i = 0; i < m_segments.size(); ++i) {
+        if (i == skipSegment) {
+            continue;
+        }
+        Segment& segment = m_segments[i];
+        if (segment.startLine > lastLine) {
+            segment.startLine += delta;
+            segment.endLine += delta;
+        } else if (segment.endLine >= firstLine) {
+            // Zmiana przecina segment z zewnątrz - do pełnego parsowania jest nieaktualny
+            segment.endLine = qMax(segment.startLine, segment.endLine + delta);
+            segment.isolated = false;
+        }
+    }
+
+    for (Span& span : m_rootSpans) {
+        if (span.startLine > lastLine) {
+            span.startLine += delta;
+            span.endLine += delta;
+        } else if (span.endLine >= firstLine) {
+            span.endLine = qMax(span.startLine, span.endLine + delta);
+        }
+    }
+
+    for (Diagnostic& diagnostic : m_rootDiagnostics) {
+        if (diagnostic.file.isEmpty() && diagnostic.line > lastLine) {
+            diagnostic.line += delta;
+        }
+    }
+    for (Value& value : m_topLevel) {
+        if (value.line > lastLine) {
+            value.line += delta;
+        }
+    }
+    for (Value& value : m_sdkExtensions) {
+        if (value.line > lastLine) {
+            value.line += delta;
+        }
+    }
+}
@@ -0,0 +1,213 @@
+/**
+ * @file flatpakmanifestmodel.h
+ * @brief Przyrostowy model struktury manifestu Flatpak
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKMANIFESTMODEL_H
+#define FLATPAKMANIFESTMODEL_H
+
+#include "flatpakmanifestgenerator.h"
+#include "flatpakmanifestschema.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @class FlatpakManifestModel
+ * @brief Moduły, źródła, sumy kontrolne i diagnostyka otwartego manifestu
+ *
+ * Każdy element tablicy "modules" jest osobnym segmentem z własnym zakresem
+ * linii. Zmiana w obrębie jednego segmentu parsuje ponownie tylko jego linie
+ * (moduł wraz z zagnieżdżonymi modułami), a pozostałe segmenty przesuwają
+ * się o różnicę liczby linii. Struktura segmentu przechowuje linie względem
+ * jego początku, więc przesunięcie nie dotyka modułów ani diagnostyki.
+ *
+ * Zmiany poza segmentami albo zmieniające granice segmentów (nowy moduł,
+ * usunięty nawias) zwracają NeedsFullParse - wtedy wywołujący powinien
+ * w tle sparsować cały dokument przez setText(). Do tego czasu model
+ * pozostaje spójny, tylko bez nowej struktury.
+ *
+ * Obsługiwany jest JSON oraz podzbiór YAML używany w manifestach (bloki
+ * map i list, proste listy w nawiasach, skalary blokowe). Pliki dołączane
+ * przez nazwę w "modules" są wczytywane z dysku i pamiętane do zmiany daty
+ * modyfikacji.
+ */
+class FlatpakManifestModel
+{
+public:
+    /**
+     * Format pliku manifestu
+     */
+    enum Format {
+        Json,
+        Yaml
+    };
+
+    /**
+     * Wynik przyrostowej aktualizacji
+     */
+    enum EditResult {
+        Updated,            ///< Zmieniony segment został sparsowany ponownie
+        NeedsFullParse      ///< Struktura jest nieaktualna do czasu setText()
+    };
+
+    /**
+     * Błąd lub ostrzeżenie w manifeście (linie i kolumny od 0)
+     */
+    struct Diagnostic {
+        QString file;       ///< Plik dołączony albo pusty dla bieżącego dokumentu
+        int line = 0;
+        int column = 0;
+        int length = 0;
+        bool error = true;
+        QString message;
+    };
+
+    /**
+     * Źródło modułu
+     */
+    struct Source {
+        QString type;
+        QString location;       ///< url albo path
+        QString checksum;       ///< sha256 lub sha512
+        QString checksumType;   ///< "sha256", "sha512" albo pusty, gdy sumy brak
+        int line = 0;
+        int locationLine = -1;  ///< Linia wartości url albo path
+        int checksumLine = -1;  ///< Linia wartości sumy kontrolnej
+    };
+
+    /**
+     * Moduł manifestu
+     */
+    struct Module {
+        QString name;
+        QString buildsystem;
+        QString file;       ///< Plik dołączony albo pusty dla bieżącego dokumentu
+        int line = 0;
+        int depth = 0;      ///< Poziom zagnieżdżenia w "modules"
+        QVector<Source> sources;
+    };
+
+    /**
+     * Konstruktor
+     *
+     * @param format Format dokumentu
+     * @param baseDir Katalog, względem którego rozwiązywane są pliki dołączane
+     */
+    explicit FlatpakManifestModel(Format format = Json, const QString& baseDir = QString());
+
+    /**
+     * @brief Wybiera format na podstawie rozszerzenia pliku
+     */
+    static Format formatForPath(const QString& path);
+
+    /**
+     * @brief Parsuje cały dokument od nowa
+     */
+    void setText(const QString& text);
+
+    /**
+     * @brief Zastępuje linie dokumentu i aktualizuje strukturę zmienionego segmentu
+     *
+     * @param firstLine Pierwsza zmieniona linia
+     * @param removedCount Liczba linii przed zmianą, które zostały zastąpione
+     * @param lines Nowa treść tych linii
+     * @return Updated albo NeedsFullParse
+     */
+    EditResult replaceLines(int firstLine, int removedCount, const QStringList& lines);
+
+    /**
+     * @brief Zwraca liczbę linii dokumentu
+     */
+    int lineCount() const;
+
+    /**
+     * @brief Ustawia listę zainstalowanych runtime'ów do sprawdzania runtime, sdk i rozszerzeń
+     */
+    void setInstalledRuntimes(const QVector<FlatpakManifestGenerator::InstalledRuntime>& runtimes);
+
+    /**
+     * @brief Zwraca moduły w kolejności z dokumentu, razem z zagnieżdżonymi i dołączonymi
+     */
+    QVector<Module> modules() const;
+
+    /**
+     * @brief Zwraca błędy składni i schematu wszystkich segmentów
+     */
+    QVector<Diagnostic> diagnostics() const;
+
+    /**
+     * @brief Zwraca część manifestu, w której leży linia (do podpowiedzi)
+     */
+    FlatpakManifestSchema::Context contextAt(int line) const;
+
+    /**
+     * @brief Zwraca wartość skalarnego klucza głównego obiektu (np. "runtime")
+     */
+    QString topLevelValue(const QString& key) const;
+
+private:
+    class Collector;
+
+    /**
+     * Zakres linii obiektu lub tablicy o znanym znaczeniu
+     */
+    struct Span {
+        int startLine = 0;
+        int endLine = 0;
+        FlatpakManifestSchema::Context context = FlatpakManifestSchema::UnknownContext;
+    };
+
+    /**
+     * Wartość klucza głównego obiektu z położeniem
+     */
+    struct Value {
+        QString text;
+        int line = 0;
+        int column = 0;
+    };
+
+    /**
+     * Element tablicy "modules" głównego obiektu; linie struktury są względne
+     */
+    struct Segment {
+        int startLine = 0;
+        int endLine = 0;
+        bool isolated = false;      ///< Segment zajmuje całe linie i może być parsowany osobno
+        bool syntaxError = false;   ///< Struktura pochodzi z ostatniej poprawnej wersji
+        QVector<Module> modules;
+        QVector<Span> spans;
+        QVector<Diagnostic> diagnostics;
+    };
+
+    /**
+     * Sparsowany plik dołączony
+     */
+    struct IncludedFile {
+        QDateTime modified;
+        QVector<Module> modules;
+        QVector<Diagnostic> diagnostics;
+    };
+
+    bool reparseSegment(Segment& segment);
+    int segmentAt(int line) const;
+    void shiftLines(int firstLine, int lastLine, int delta, int skipSegment);
+
+    Format m_format;
+    QString m_baseDir;
+    QStringList m_lines;
+    QVector<Segment> m_segments;
+    QVector<Span> m_rootSpans;
+    QVector<Diagnostic> m_rootDiagnostics;
+    QHash<QString, Value> m_topLevel;
+    QVector<Value> m_sdkExtensions;
+    QVector<FlatpakManifestGenerator::InstalledRuntime> m_installedRuntimes;
+    QHash<QString, IncludedFile> m_includes;
+};
+
+#endif // FLATPAKMANIFESTMODEL_H
@@ -0,0 +1,112 @@
+/**
+ * @file flatpakmanifestscanner.cpp
+ * @brief Implementacja wyszukiwania manifestów Flatpak w projekcie
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakmanifestscanner.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+
+namespace {
+    // Katalogi, w których projekty zwykle trzymają manifesty
+    const QStringList ManifestDirs = {
+        QStringLiteral("."),
+        QStringLiteral("flatpak"),
+        QStringLiteral("packaging"),
+        QStringLiteral("packaging/flatpak"),
+        QStringLiteral("build-aux"),
+        QStringLiteral("build-aux/flatpak"),
+        QStringLiteral("dist/flatpak")
+    };
+
+    // Manifesty są małe; większe pliki to raczej dane testowe
+    const qint64 MaxManifestSize = 1024 * 1024;
+}
+
+QStringList FlatpakManifestScanner::findManifests(const QString& projectDir)
+{
+    QStringList manifests;
+    const QDir root(projectDir);
+
+    for (const QString& subdir : ManifestDirs) {
+        const QDir dir(root.filePath(subdir));
+        if (!dir.exists()) {
+            continue;
+        }
+
+        const QFileInfoList files = dir.entryInfoList({"*.json", "*.yaml", "*.yml"}, QDir::Files | QDir::Readable);
+        for (const QFileInfo& file : files) {
+            const QString path = QDir::cleanPath(file.absoluteFilePath());
+            if (!manifests.contains(path) && isManifest(path)) {
+                manifests << path;
+            }
+        }
+    }
+
+    manifests.sort();
+    return manifests;
+}
+
+bool FlatpakManifestScanner::isManifest(const QString& path)
+{
+    QFile file(path);
+    if (file.size() > MaxManifestSize || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray content = file.readAll();
+
+    if (path.endsWith(QLatin1String(".json"))) {
+        const QJsonObject manifest = QJsonDocument::fromJson(content).object();
+        return (manifest.contains("app-id") || manifest.contains("id")) && manifest.contains("modules");
+    }
+
+    // YAML nie jest tu parsowany - wystarczą klucze najwyższego poziomu
+    static const QRegularExpression idRegex("^(app-)?id:", QRegularExpression::MultilineOption);
+    static const QRegularExpression modulesRegex("^modules:", QRegularExpression::MultilineOption);
+    const QString text = QString::fromUtf8(content);
+    return idRegex.match(text).hasMatch() && modulesRegex.match(text).hasMatch();
+}
+
+QString FlatpakManifestScanner::variantName(const QString& manifestPath)
+{
+    return QFileInfo(manifestPath).completeBaseName();
+}
+
+QString FlatpakManifestScanner::topLevelValue(const QString& manifestPath, const QString& key)
+{
+    QFile file(manifestPath);
+    if (file.size() > MaxManifestSize || !file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    const QByteArray content = file.readAll();
+    const QStringList keys = key == QLatin1String("id") ? QStringList{key, "app-id"} : QStringList{key};
+
+    if (manifestPath.endsWith(QLatin1String(".json"))) {
+        const QJsonObject manifest = QJsonDocument::fromJson(content).object();
+        for (const QString& candidate : keys) {
+            if (manifest.contains(candidate)) {
+                return manifest.value(candidate).toString();
+            }
+        }
+        return QString();
+    }
+
+    // W YAML klucz najwyższego poziomu zaczyna linię; cudzysłowy są opcjonalne
+    const QString text = QString::fromUtf8(content);
+    for (const QString& candidate : keys) {
+        const QRegularExpression regex("^" + QRegularExpression::escape(candidate) + ":\\s*[\"']?([^\"'#\\n]*?)[\"']?\\s*(#.*)?$",
+                                       QRegularExpression::MultilineOption);
+        const QRegularExpressionMatch match = regex.match(text);
+        if (match.hasMatch()) {
+            return match.captured(1);
+        }
+    }
+    return QString();
+}
@@ -0,0 +1,59 @@
+/**
+ * @file flatpakmanifestscanner.h
+ * @brief Wyszukiwanie wszystkich manifestów Flatpak w projekcie
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKMANIFESTSCANNER_H
+#define FLATPAKMANIFESTSCANNER_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @class FlatpakManifestScanner
+ * @brief Znajduje warianty manifestu projektu (stable, devel, gałęzie runtime'u)
+ *
+ * Przeszukiwany jest katalog projektu i typowe podkatalogi z plikami
+ * pakietowania. Plik uznawany jest za manifest, jeśli zawiera identyfikator
+ * aplikacji i listę modułów, więc inne pliki JSON/YAML są pomijane.
+ */
+class FlatpakManifestScanner
+{
+public:
+    /**
+     * @brief Zwraca manifesty znalezione w projekcie
+     * @param projectDir Katalog główny projektu
+     * @return Bezwzględne ścieżki manifestów, posortowane
+     */
+    static QStringList findManifests(const QString& projectDir);
+
+    /**
+     * @brief Sprawdza, czy plik wygląda na manifest Flatpak
+     * @param path Ścieżka do pliku JSON lub YAML
+     */
+    static bool isManifest(const QString& path);
+
+    /**
+     * @brief Zwraca nazwę wariantu wyświetlaną użytkownikowi
+     *
+     * Nazwa pliku bez rozszerzenia, np. "org.example.App.Devel".
+     *
+     * @param manifestPath Ścieżka do manifestu
+     */
+    static QString variantName(const QString& manifestPath);
+
+    /**
+     * @brief Zwraca tekstową wartość klucza najwyższego poziomu manifestu
+     *
+     * Dla "id" zwracane jest też starsze "app-id".
+     *
+     * @param manifestPath Ścieżka do manifestu JSON lub YAML
+     * @param key Klucz, np. "id" lub "command"
+     * @return Wartość albo pusty tekst, jeśli klucza nie ma
+     */
+    static QString topLevelValue(const QString& manifestPath, const QString& key);
+};
+
+#endif // FLATPAKMANIFESTSCANNER_H
@@ -0,0 +1,136 @@
+/**
+ * @file flatpakmanifestschema.cpp
+ * @brief Implementacja opisu kluczy i wartości manifestu Flatpak
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakmanifestschema.h"
+
+#include <KLocalizedString>
+
+#include <QSet>
+
+namespace {
+    const QStringList TopLevelKeys = {
+        "id", "app-id", "branch", "default-branch", "collection-id", "extension-tag",
+        "runtime", "runtime-version", "runtime-commit", "sdk", "sdk-commit",
+        "base", "base-version", "base-commit", "base-extensions", "var", "metadata",
+        "command", "build-runtime", "build-extension", "separate-locales",
+        "id-platform", "metadata-platform", "writable-sdk", "appstream-compose",
+        "sdk-extensions", "platform-extensions", "inherit-extensions", "inherit-sdk-extensions",
+        "tags", "build-options", "modules", "add-extensions", "add-build-extensions",
+        "cleanup", "cleanup-commands", "cleanup-platform", "cleanup-platform-commands",
+        "prepare-platform-commands", "finish-args", "rename-desktop-file", "rename-appdata-file",
+        "rename-mime-file", "rename-icon", "rename-mime-icons", "appdata-license", "copy-icon",
+        "desktop-file-name-prefix", "desktop-file-name-suffix"
+    };
+
+    const QStringList ModuleKeys = {
+        "name", "disabled", "sources", "config-opts", "make-args", "make-install-args",
+        "rm-configure", "no-autogen", "no-parallel-make", "install-rule", "no-make-install",
+        "no-python-timestamp-fix", "cmake", "builddir", "subdir", "build-options",
+        "build-commands", "buildsystem", "post-install", "cleanup", "ensure-writable",
+        "only-arches", "skip-arches", "cleanup-platform", "run-tests", "test-rule",
+        "test-commands", "modules"
+    };
+
+    const QStringList SourceKeys = {
+        "type", "dest", "only-arches", "skip-arches", "dest-filename", "url", "mirror-urls",
+        "path", "md5", "sha1", "sha256", "sha512", "strip-components", "git-init",
+        "archive-type", "commit", "tag", "branch", "revision", "disable-fsckobjects",
+        "disable-shallow-clone", "disable-submodules", "commands", "paths", "use-git",
+        "use-git-am", "options", "contents", "base64", "skip", "filename", "size",
+        "installed-size"
+    };
+
+    const QStringList BuildOptionsKeys = {
+        "cflags", "cflags-override", "cppflags", "cppflags-override", "cxxflags",
+        "cxxflags-override", "ldflags", "ldflags-override", "prefix", "libdir",
+        "append-path", "prepend-path", "append-ld-library-path", "prepend-ld-library-path",
+        "append-pkg-config-path", "prepend-pkg-config-path", "env", "secret-env",
+        "build-args", "test-args", "config-opts", "secret-opts", "make-args",
+        "make-install-args", "strip", "no-debuginfo", "no-debuginfo-compression", "arch"
+    };
+
+    const QStringList BuildSystems = {
+        "autotools", "cmake", "cmake-ninja", "meson", "qmake", "simple"
+    };
+
+    const QStringList SourceTypes = {
+        "archive", "git", "bzr", "svn", "dir", "file", "script", "inline", "shell",
+        "patch", "extra-data"
+    };
+
+    const QStringList Booleans = {"true", "false"};
+
+    // Klucze logiczne podpowiadane jako true/false
+    const QSet<QString> BooleanKeys = {
+        "separate-locales", "writable-sdk", "appstream-compose", "disabled", "rm-configure",
+        "no-autogen", "no-parallel-make", "no-make-install", "no-python-timestamp-fix",
+        "cmake", "builddir", "run-tests", "git-init", "disable-fsckobjects",
+        "disable-shallow-clone", "disable-submodules", "use-git", "use-git-am", "strip",
+        "no-debuginfo", "no-debuginfo-compression", "copy-icon"
+    };
+}
+
+QStringList FlatpakManifestSchema::keys(Context context)
+{
+    switch (context) {
+        case TopLevel:
+            return TopLevelKeys;
+        case Module:
+            return ModuleKeys;
+        case Source:
+            return SourceKeys;
+        case BuildOptions:
+            return BuildOptionsKeys;
+        case ExtensionList:
+        case UnknownContext:
+            break;
+    }
+    return QStringList();
+}
+
+bool FlatpakManifestSchema::isKnownKey(Context context, const QString& key)
+{
+    if (context == UnknownContext || context == ExtensionList) {
+        return true;
+    }
+    if (key.startsWith(QLatin1String("x-")) || key == QLatin1String("$schema")) {
+        return true;
+    }
+    return keys(context).contains(key);
+}
+
+QStringList FlatpakManifestSchema::values(Context context, const QString& key)
+{
+    if (context == Module && key == QLatin1String("buildsystem")) {
+        return BuildSystems;
+    }
+    if (context == Source && key == QLatin1String("type")) {
+        return SourceTypes;
+    }
+    if (BooleanKeys.contains(key)) {
+        return Booleans;
+    }
+    return QStringList();
+}
+
+QString FlatpakManifestSchema::contextName(Context context)
+{
+    switch (context) {
+        case TopLevel:
+            return i18n("the manifest");
+        case Module:
+            return i18n("a module");
+        case Source:
+            return i18n("a source");
+        case BuildOptions:
+            return i18n("build-options");
+        case ExtensionList:
+        case UnknownContext:
+            break;
+    }
+    return QString();
+}
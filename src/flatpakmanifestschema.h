@@ -0,0 +1,58 @@
+/**
+ * @file flatpakmanifestschema.h
+ * @brief Opis kluczy i wartości manifestu Flatpak dla podpowiedzi i walidacji
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKMANIFESTSCHEMA_H
+#define FLATPAKMANIFESTSCHEMA_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @class FlatpakManifestSchema
+ * @brief Klucze dozwolone w poszczególnych częściach manifestu (flatpak-manifest(5))
+ *
+ * Klucze zaczynające się od "x-" oraz "$schema" są dozwolone wszędzie,
+ * bo flatpak-builder je ignoruje, a narzędzia takie jak
+ * flatpak-external-data-checker przechowują w nich własne dane.
+ */
+class FlatpakManifestSchema
+{
+public:
+    /**
+     * Część manifestu, w której znajduje się obiekt
+     */
+    enum Context {
+        UnknownContext,
+        TopLevel,           ///< Główny obiekt manifestu
+        Module,             ///< Element tablicy "modules"
+        Source,             ///< Element tablicy "sources"
+        BuildOptions,       ///< Obiekt "build-options"
+        ExtensionList       ///< Tablica "sdk-extensions"
+    };
+
+    /**
+     * @brief Zwraca klucze dozwolone w danej części manifestu
+     */
+    static QStringList keys(Context context);
+
+    /**
+     * @brief Czy klucz jest dozwolony w danej części manifestu
+     */
+    static bool isKnownKey(Context context, const QString& key);
+
+    /**
+     * @brief Zwraca dozwolone wartości klucza albo pustą listę, jeśli są dowolne
+     */
+    static QStringList values(Context context, const QString& key);
+
+    /**
+     * @brief Zwraca nazwę części manifestu do komunikatów
+     */
+    static QString contextName(Context context);
+};
+
+#endif // FLATPAKMANIFESTSCHEMA_H
@@ -0,0 +1,187 @@
+/**
+ * @file flatpakmanifestsupport.cpp
+ * @brief Implementacja obsługi otwartych manifestów Flatpak w edytorze
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakmanifestsupport.h"
+#include "flatpakbuilderconfig.h"
+#include "flatpakbuilderplugin.h"
+#include "flatpakmanifestcompletionmodel.h"
+#include "flatpakmanifestdocument.h"
+#include "flatpakmanifestscanner.h"
+
+#include <interfaces/icore.h>
+#include <interfaces/ilanguagecontroller.h>
+#include <language/editor/documentrange.h>
+#include <serialization/indexedstring.h>
+#include <shell/problem.h>
+#include <shell/problemmodel.h>
+#include <shell/problemmodelset.h>
+
+#include <KLocalizedString>
+#include <KTextEditor/CodeCompletionInterface>
+#include <KTextEditor/Document>
+#include <KTextEditor/View>
+
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+namespace {
+    const QString ProblemModelId = QStringLiteral("FlatpakManifest");
+
+    // Odświeżanie widoku "Problemy" przy każdym klawiszu byłoby droższe niż parsowanie
+    const int ProblemsDelay = 100;
+}
+
+FlatpakManifestSupport::FlatpakManifestSupport(FlatpakBuilderPlugin* plugin)
+    : QObject(plugin)
+    , m_plugin(plugin)
+    , m_completionModel(new FlatpakManifestCompletionModel(this))
+    , m_problemModel(nullptr)
+{
+    m_problemsTimer.setSingleShot(true);
+    m_problemsTimer.setInterval(ProblemsDelay);
+    connect(&m_problemsTimer, &QTimer::timeout, this, &FlatpakManifestSupport::publishProblems);
+
+    // "flatpak list" trwa kilkaset milisekund - edytor nie może na to czekać
+    using Runtimes = QVector<FlatpakManifestGenerator::InstalledRuntime>;
+    const QString flatpakPath = plugin->config()->flatpakPath();
+    auto* watcher = new QFutureWatcher<Runtimes>(this);
+    connect(watcher, &QFutureWatcher<Runtimes>::finished, this, [this, watcher]() {
+        m_installedRuntimes = watcher->result();
+        watcher->deleteLater();
+        for (FlatpakManifestDocument* document : qAsConst(m_documents)) {
+            document->setInstalledRuntimes(m_installedRuntimes);
+        }
+        scheduleProblems();
+    });
+    watcher->setFuture(QtConcurrent::run(&FlatpakManifestGenerator::installedRuntimes, flatpakPath));
+}
+
+FlatpakManifestSupport::~FlatpakManifestSupport()
+{
+    for (auto it = m_documents.constBegin(); it != m_documents.constEnd(); ++it) {
+        const auto views = it.key()->views();
+        for (KTextEditor::View* view : views) {
+            if (auto* completion = qobject_cast<KTextEditor::CodeCompletionInterface*>(view)) {
+                completion->unregisterCompletionModel(m_completionModel);
+            }
+        }
+    }
+
+    if (m_problemModel) {
+        KDevelop::ICore::self()->languageController()->problemModelSet()->removeModel(ProblemModelId);
+    }
+}
+
+bool FlatpakManifestSupport::isManifest(KTextEditor::Document* document)
+{
+    const QUrl url = document->url();
+    return isManifestUrl(url) && FlatpakManifestScanner::isManifest(url.toLocalFile());
+}
+
+bool FlatpakManifestSupport::isManifestUrl(const QUrl& url)
+{
+    if (!url.isLocalFile()) {
+        return false;
+    }
+
+    const QString suffix = QFileInfo(url.toLocalFile()).suffix().toLower();
+    return suffix == QLatin1String("json") || suffix == QLatin1String("yaml") || suffix == QLatin1String("yml");
+}
+
+void FlatpakManifestSupport::addDocument(KTextEditor::Document* document)
+{
+    if (m_documents.contains(document)) {
+        return;
+    }
+
+    auto* manifest = new FlatpakManifestDocument(document, this);
+    manifest->setInstalledRuntimes(m_installedRuntimes);
+    m_documents.insert(document, manifest);
+
+    connect(document, &KTextEditor::Document::aboutToClose, this, &FlatpakManifestSupport::documentClosed);
+    connect(document, &KTextEditor::Document::viewCreated, this, &FlatpakManifestSupport::viewCreated);
+    const auto views = document->views();
+    for (KTextEditor::View* view : views) {
+        registerCompletion(view);
+    }
+
+    scheduleProblems();
+}
+
+FlatpakManifestDocument* FlatpakManifestSupport::document(KTextEditor::Document* document) const
+{
+    return m_documents.value(document);
+}
+
+QVector<FlatpakManifestGenerator::InstalledRuntime> FlatpakManifestSupport::installedRuntimes() const
+{
+    return m_installedRuntimes;
+}
+
+void FlatpakManifestSupport::scheduleProblems()
+{
+    m_problemsTimer.start();
+}
+
+void FlatpakManifestSupport::documentClosed(KTextEditor::Document* document)
+{
+    disconnect(document, nullptr, this, nullptr);
+    delete m_documents.take(document);
+    scheduleProblems();
+}
+
+void FlatpakManifestSupport::viewCreated(KTextEditor::Document* document, KTextEditor::View* view)
+{
+    Q_UNUSED(document);
+    registerCompletion(view);
+}
+
+void FlatpakManifestSupport::registerCompletion(KTextEditor::View* view)
+{
+    if (auto* completion = qobject_cast<KTextEditor::CodeCompletionInterface*>(view)) {
+        completion->registerCompletionModel(m_completionModel);
+    }
+}
+
+KDevelop::ProblemModel* FlatpakManifestSupport::problemModel()
+{
+    // Osobna zakładka, żeby wyniki budowania nie zastępowały błędów manifestu
+    if (!m_problemModel) {
+        m_problemModel = new KDevelop::ProblemModel(this);
+        m_problemModel->setFeatures(KDevelop::ProblemModel::SeverityFilter);
+        KDevelop::ICore::self()->languageController()->problemModelSet()->addModel(
+            ProblemModelId, i18n("Flatpak Manifest"), m_problemModel);
+    }
+    return m_problemModel;
+}
+
+void FlatpakManifestSupport::publishProblems()
+{
+    QVector<KDevelop::IProblem::Ptr> converted;
+
+    for (auto it = m_documents.constBegin(); it != m_documents.constEnd(); ++it) {
+        const QString path = it.key()->url().toLocalFile();
+        const QVector<FlatpakManifestModel::Diagnostic> diagnostics = it.value()->model().diagnostics();
+        for (const FlatpakManifestModel::Diagnostic& diagnostic : diagnostics) {
+            auto* problem = new KDevelop::DetectedProblem(i18n("Flatpak Manifest"));
+            problem->setSeverity(diagnostic.error ? KDevelop::IProblem::Error : KDevelop::IProblem::Warning);
+            problem->setDescription(diagnostic.message);
+
+            const KTextEditor::Range range(diagnostic.line, diagnostic.column,
+                                           diagnostic.line, diagnostic.column + diagnostic.length);
+            const QString file = diagnostic.file.isEmpty() ? path : diagnostic.file;
+            problem->setFinalLocation(KDevelop::DocumentRange(KDevelop::IndexedString(file), range));
+            converted.append(KDevelop::IProblem::Ptr(problem));
+        }
+    }
+
+    // Bez manifestów z problemami zakładka nie jest potrzebna
+    if (!converted.isEmpty() || m_problemModel) {
+        problemModel()->setProblems(converted);
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * @file flatpakmanifestsupport.h
+ * @brief Obsługa otwartych manifestów Flatpak w edytorze
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKMANIFESTSUPPORT_H
+#define FLATPAKMANIFESTSUPPORT_H
+
+#include "flatpakmanifestgenerator.h"
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+class FlatpakBuilderPlugin;
+class FlatpakManifestCompletionModel;
+class FlatpakManifestDocument;
+class QUrl;
+
+namespace KDevelop {
+    class ProblemModel;
+}
+
+namespace KTextEditor {
+    class Document;
+    class View;
+}
+
+/**
+ * @class FlatpakManifestSupport
+ * @brief Łączy otwarte manifesty z modelem, podpowiedziami i widokiem "Problemy"
+ *
+ * Obiekt powstaje przy otwarciu pierwszego manifestu. Lista zainstalowanych
+ * runtime'ów jest wczytywana raz, w tle, i przekazywana wszystkim dokumentom.
+ */
+class FlatpakManifestSupport : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param plugin Wtyczka (konfiguracja i rodzic)
+     */
+    explicit FlatpakManifestSupport(FlatpakBuilderPlugin* plugin);
+
+    /**
+     * Destruktor - wyrejestrowuje podpowiedzi i model problemów
+     */
+    ~FlatpakManifestSupport() override;
+
+    /**
+     * @brief Sprawdza, czy dokument jest manifestem obsługiwanym przez edytor
+     */
+    static bool isManifest(KTextEditor::Document* document);
+
+    /**
+     * @brief Sprawdza po samym adresie, czy plik może być manifestem (lokalny .json/.yaml/.yml)
+     */
+    static bool isManifestUrl(const QUrl& url);
+
+    /**
+     * @brief Zaczyna śledzić dokument manifestu
+     */
+    void addDocument(KTextEditor::Document* document);
+
+    /**
+     * @brief Zwraca model śledzonego dokumentu albo nullptr
+     */
+    FlatpakManifestDocument* document(KTextEditor::Document* document) const;
+
+    /**
+     * @brief Zwraca zainstalowane runtime'y (pusta lista do czasu wczytania)
+     */
+    QVector<FlatpakManifestGenerator::InstalledRuntime> installedRuntimes() const;
+
+    /**
+     * @brief Odświeża widok "Problemy" po krótkiej przerwie w pisaniu
+     */
+    void scheduleProblems();
+
+private Q_SLOTS:
+    void documentClosed(KTextEditor::Document* document);
+    void viewCreated(KTextEditor::Document* document, KTextEditor::View* view);
+    void publishProblems();
+
+private:
+    KDevelop::ProblemModel* problemModel();
+    void registerCompletion(KTextEditor::View* view);
+
+    FlatpakBuilderPlugin* m_plugin;
+    FlatpakManifestCompletionModel* m_completionModel;
+    KDevelop::ProblemModel* m_problemModel;
+    QHash<KTextEditor::Document*, FlatpakManifestDocument*> m_documents;
+    QVector<FlatpakManifestGenerator::InstalledRuntime> m_installedRuntimes;
+    QTimer m_problemsTimer;
+};
+
+#endif // FLATPAKMANIFESTSUPPORT_H
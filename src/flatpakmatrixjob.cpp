@@ -0,0 +1,215 @@
+/**
+ * @file flatpakmatrixjob.cpp
+ * @brief Implementacja zadania budującego kilka wariantów manifestu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakmatrixjob.h"
+#include "flatpakbuilderjob.h"
+#include "flatpakbuilderplugin.h"
+#include "flatpakmanifestscanner.h"
+
+#include <interfaces/iproject.h>
+
+#include <KLocalizedString>
+
+#include <QDir>
+
+namespace {
+    QString formatDuration(qint64 ms)
+    {
+        const qint64 seconds = ms / 1000;
+        return QString("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QLatin1Char('0'));
+    }
+}
+
+FlatpakMatrixJob::FlatpakMatrixJob(FlatpakBuilderPlugin* plugin, KDevelop::IProject* project, const QStringList& manifests)
+    : KJob(plugin)
+    , m_plugin(plugin)
+    , m_project(project)
+    , m_nextIndex(0)
+    , m_maxParallel(2)
+    , m_killed(false)
+{
+    setObjectName(i18n("Flatpak Variants: %1", project->name()));
+    setCapabilities(KJob::Killable);
+
+    for (const QString& manifest : manifests) {
+        Result result;
+        result.variant = FlatpakManifestScanner::variantName(manifest);
+        result.manifestPath = manifest;
+        m_results.append(result);
+    }
+}
+
+void FlatpakMatrixJob::setMaxParallel(int count)
+{
+    m_maxParallel = qMax(1, count);
+}
+
+int FlatpakMatrixJob::maxParallel() const
+{
+    return m_maxParallel;
+}
+
+void FlatpakMatrixJob::start()
+{
+    setTotalAmount(KJob::Items, m_results.size());
+    setProcessedAmount(KJob::Items, 0);
+    m_plugin->publishProblems({});
+
+    QMetaObject::invokeMethod(this, "startPending", Qt::QueuedConnection);
+}
+
+const QVector<FlatpakMatrixJob::Result>& FlatpakMatrixJob::results() const
+{
+    return m_results;
+}
+
+QString FlatpakMatrixJob::summaryTable() const
+{
+    QString html = "<table cellpadding=\"4\"><tr>";
+    html += "<th align=\"left\">" + i18n("Variant") + "</th>";
+    html += "<th align=\"left\">" + i18n("Result") + "</th>";
+    html += "<th align=\"right\">" + i18n("Time") + "</th>";
+    html += "<th align=\"right\">" + i18n("Errors") + "</th>";
+    html += "<th align=\"right\">" + i18n("Warnings") + "</th></tr>";
+
+    for (const Result& result : m_results) {
+        QString status;
+        if (!result.started) {
+            status = i18n("Not started");
+        } else if (!result.finished || result.error == KJob::KilledJobError) {
+            status = i18n("Cancelled");
+        } else if (result.error != 0) {
+            status = "<b>" + i18n("Failed") + "</b>";
+        } else {
+            status = i18n("Succeeded");
+        }
+
+        html += "<tr><td>" + result.variant.toHtmlEscaped() + "</td>";
+        html += "<td>" + status + "</td>";
+        html += "<td align=\"right\">" + (result.started ? formatDuration(result.elapsedMs) : QString()) + "</td>";
+        html += "<td align=\"right\">" + QString::number(result.errors) + "</td>";
+        html += "<td align=\"right\">" + QString::number(result.warnings) + "</td></tr>";
+    }
+
+    html += "</table>";
+    return html;
+}
+
+bool FlatpakMatrixJob::doKill()
+{
+    m_killed = true;
+
+    // Zadania wariantów przerywają własne drzewa procesów
+    const QList<FlatpakBuilderJob*> running = m_running.keys();
+    m_running.clear();
+    for (FlatpakBuilderJob* job : running) {
+        disconnect(job, nullptr, this, nullptr);
+        job->kill();
+    }
+
+    return true;
+}
+
+void FlatpakMatrixJob::startPending()
+{
+    // Wspólny katalog stanu - moduły o tej samej sumie kontrolnej budowane są raz
+    const QString stateDir = QDir(m_project->path().toLocalFile()).filePath(".flatpak-builder");
+
+    while (!m_killed && m_running.size() < m_maxParallel && m_nextIndex < m_results.size()) {
+        const int index = m_nextIndex++;
+        Result& result = m_results[index];
+
+        auto* job = new FlatpakBuilderJob(m_plugin, m_project, FlatpakBuilderJob::BuildOperation);
+        job->setManifestPath(result.manifestPath);
+        job->setVariantName(result.variant);
+        job->setStateDir(stateDir);
+
+        RunningVariant variant;
+        variant.index = index;
+        variant.timer.start();
+        m_running.insert(job, variant);
+        result.started = true;
+
+        connect(job, &KJob::result, this, &FlatpakMatrixJob::variantFinished);
+        job->start();
+    }
+}
+
+void FlatpakMatrixJob::variantFinished(KJob* job)
+{
+    auto* builderJob = static_cast<FlatpakBuilderJob*>(job);
+    const auto it = m_running.find(builderJob);
+    if (it == m_running.end()) {
+        return;
+    }
+
+    Result& result = m_results[it->index];
+    result.finished = true;
+    result.error = job->error();
+    result.elapsedMs = it->timer.elapsed();
+    for (const FlatpakProblem& problem : builderJob->problems()) {
+        problem.severity == FlatpakOutputLine::Error ? ++result.errors : ++result.warnings;
+    }
+
+    mergeProblems(result.variant, builderJob->problems());
+    publishProblems();
+
+    m_running.erase(it);
+    setProcessedAmount(KJob::Items, processedAmount(KJob::Items) + 1);
+
+    if (m_running.isEmpty() && m_nextIndex >= m_results.size()) {
+        int failed = 0;
+        for (const Result& variantResult : qAsConst(m_results)) {
+            if (variantResult.error != 0) {
+                ++failed;
+            }
+        }
+
+        if (failed > 0) {
+            setError(KJob::UserDefinedError);
+            setErrorText(i18np("%1 of %2 variants failed to build", "%1 of %2 variants failed to build",
+                               failed, m_results.size()));
+        }
+        emitResult();
+        return;
+    }
+
+    startPending();
+}
+
+void FlatpakMatrixJob::mergeProblems(const QString& variant, const QVector<FlatpakProblem>& problems)
+{
+    // Ten sam problem w kilku wariantach daje jeden wpis z listą wariantów
+    for (const FlatpakProblem& problem : problems) {
+        // Jedno podstawienie wszystkich pól - kolejne arg() podmieniałyby "%1"
+        // znalezione w ścieżce albo treści komunikatu
+        const QString key = QString("%1\n%2\n%3\n%4\n%5").arg(QString::number(problem.severity), problem.file,
+                                                                  QString::number(problem.line),
+                                                                  QString::number(problem.column), problem.message);
+
+        const auto it = m_problemIndex.constFind(key);
+        if (it != m_problemIndex.constEnd()) {
+            m_problems[*it].count += problem.count;
+            m_problemVariants[*it] << variant;
+            continue;
+        }
+
+        m_problemIndex.insert(key, m_problems.size());
+        m_problems.append(problem);
+        m_problemVariants.append(QStringList(variant));
+    }
+}
+
+void FlatpakMatrixJob::publishProblems()
+{
+    QVector<FlatpakProblem> problems = m_problems;
+    for (int i = 0; i < problems.size(); ++i) {
+        problems[i].message = i18nc("problem message, variant names", "%1 [%2]",
+                                    problems[i].message, m_problemVariants.at(i).join(", "));
+    }
+    m_plugin->publishProblems(problems);
+}
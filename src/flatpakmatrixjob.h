@@ -0,0 +1,122 @@
+/**
+ * @file flatpakmatrixjob.h
+ * @brief Zadanie budujące kilka wariantów manifestu naraz
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKMATRIXJOB_H
+#define FLATPAKMATRIXJOB_H
+
+#include "flatpakproblemaggregator.h"
+
+#include <KJob>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+class FlatpakBuilderJob;
+class FlatpakBuilderPlugin;
+
+namespace KDevelop {
+    class IProject;
+}
+
+/**
+ * @class FlatpakMatrixJob
+ * @brief Buduje wybrane manifesty projektu jako jedną operację
+ *
+ * Każdy wariant jest zwykłym FlatpakBuilderJob z własnym widokiem wyjścia
+ * i katalogiem wyjściowym. Wszystkie korzystają z jednego katalogu stanu
+ * flatpak-builder, więc pobrane źródła i moduły o tej samej sumie
+ * kontrolnej są współdzielone. Równolegle działa najwyżej maxParallel()
+ * budowań, a po zakończeniu problemy wszystkich wariantów są łączone.
+ */
+class FlatpakMatrixJob : public KJob
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Wynik budowania jednego wariantu
+     */
+    struct Result {
+        QString variant;
+        QString manifestPath;
+        bool started = false;
+        bool finished = false;
+        int error = 0;          ///< Kod błędu zadania (0 = sukces)
+        qint64 elapsedMs = 0;
+        int errors = 0;
+        int warnings = 0;
+    };
+
+    /**
+     * Konstruktor
+     *
+     * @param plugin Wtyczka
+     * @param project Projekt, którego manifesty są budowane
+     * @param manifests Ścieżki manifestów do zbudowania
+     */
+    FlatpakMatrixJob(FlatpakBuilderPlugin* plugin, KDevelop::IProject* project, const QStringList& manifests);
+
+    /**
+     * @brief Ustawia limit równolegle budowanych wariantów
+     * @param count Liczba budowań
+     */
+    void setMaxParallel(int count);
+
+    /**
+     * @brief Zwraca limit równolegle budowanych wariantów
+     */
+    int maxParallel() const;
+
+    /**
+     * @brief Uruchamia pierwsze warianty
+     */
+    void start() override;
+
+    /**
+     * @brief Zwraca wyniki wariantów w kolejności manifestów
+     */
+    const QVector<Result>& results() const;
+
+    /**
+     * @brief Zwraca podsumowanie budowań jako tabelę HTML
+     */
+    QString summaryTable() const;
+
+protected:
+    /**
+     * @brief Przerywa trwające budowania i porzuca oczekujące
+     */
+    bool doKill() override;
+
+private Q_SLOTS:
+    void startPending();
+    void variantFinished(KJob* job);
+
+private:
+    struct RunningVariant {
+        int index;
+        QElapsedTimer timer;
+    };
+
+    void mergeProblems(const QString& variant, const QVector<FlatpakProblem>& problems);
+    void publishProblems();
+
+    FlatpakBuilderPlugin* m_plugin;
+    KDevelop::IProject* m_project;
+    QVector<Result> m_results;
+    QHash<FlatpakBuilderJob*, RunningVariant> m_running;
+    int m_nextIndex;
+    int m_maxParallel;
+    bool m_killed;
+    QVector<FlatpakProblem> m_problems;
+    QVector<QStringList> m_problemVariants;
+    QHash<QString, int> m_problemIndex;
+};
+
+#endif // FLATPAKMATRIXJOB_H
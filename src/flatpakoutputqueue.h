@@ -0,0 +1,99 @@
+/**
+ * @file flatpakoutputqueue.h
+ * @brief Ograniczona kolejka bez blokad dla jednego producenta i jednego konsumenta
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKOUTPUTQUEUE_H
+#define FLATPAKOUTPUTQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @class FlatpakOutputQueue
+ * @brief Bufor cykliczny SPSC o stałej pojemności
+ *
+ * Producent (wątek czytający wyjście procesu) wywołuje wyłącznie tryPush(),
+ * konsument (wątek GUI) wyłącznie tryPop(). Pełna kolejka nie rośnie - producent
+ * dostaje false i musi poczekać, co przenosi nacisk wstecz aż do potoku procesu.
+ */
+template<typename T>
+class FlatpakOutputQueue
+{
+public:
+    /**
+     * Konstruktor
+     *
+     * @param capacity Maksymalna liczba elementów w kolejce
+     */
+    explicit FlatpakOutputQueue(std::size_t capacity)
+        : m_slots(capacity + 1)
+    {
+    }
+
+    FlatpakOutputQueue(const FlatpakOutputQueue&) = delete;
+    FlatpakOutputQueue& operator=(const FlatpakOutputQueue&) = delete;
+
+    /**
+     * @brief Wstawia element (tylko wątek producenta)
+     * @param value Element do wstawienia; przenoszony tylko przy powodzeniu
+     * @return false jeśli kolejka jest pełna
+     */
+    bool tryPush(T& value)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t next = increment(tail);
+        if (next == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        m_slots[tail] = std::move(value);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pobiera element (tylko wątek konsumenta)
+     * @param value Miejsce na pobrany element
+     * @return false jeśli kolejka jest pusta
+     */
+    bool tryPop(T& value)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = std::move(m_slots[head]);
+        m_slots[head] = T();
+        m_head.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Przybliżona liczba elementów w kolejce (do statystyk)
+     */
+    std::size_t sizeApprox() const
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t size = m_slots.size();
+        return (tail + size - head) % size;
+    }
+
+private:
+    std::size_t increment(std::size_t index) const
+    {
+        return (index + 1) % m_slots.size();
+    }
+
+    std::vector<T> m_slots;
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+};
+
+#endif // FLATPAKOUTPUTQUEUE_H
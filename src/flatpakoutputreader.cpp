@@ -0,0 +1,265 @@
+/**
+ * @file flatpakoutputreader.cpp
+ * @brief Implementacja odczytu wyjścia procesu poza wątkiem GUI
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakoutputreader.h"
+#include "flatpakbuilderoutputdebug.h"
+#include "flatpakjobstats.h"
+#include "flatpakoutputsource.h"
+
+#include <QTextCodec>
+#include <QTextDecoder>
+#include <QThread>
+
+namespace {
+    // Maksymalna liczba linii w jednej porcji przekazywanej do GUI
+    const int MaxBatchLines = 1024;
+
+    // Liczba porcji, które mogą czekać na wątek GUI, zanim czytanie się zatrzyma
+    const std::size_t QueueCapacity = 256;
+}
+
+FlatpakOutputReader::FlatpakOutputReader(FlatpakOutputSource* source)
+    : QObject(nullptr)
+    , m_source(source)
+    , m_queue(QueueCapacity)
+    , m_batchProblemLines(0)
+    , m_notified(false)
+    , m_stopping(false)
+    , m_detached(false)
+{
+    m_source->setParent(this);
+
+    QTextCodec* codec = QTextCodec::codecForName("UTF-8");
+    m_stdout.decoder.reset(codec->makeDecoder());
+    m_stderr.decoder.reset(codec->makeDecoder());
+    m_stderr.isStderr = true;
+
+    m_batch.reserve(MaxBatchLines);
+
+    connect(m_source, &FlatpakOutputSource::started, this, &FlatpakOutputReader::started);
+    connect(m_source, &FlatpakOutputSource::output, this, &FlatpakOutputReader::sourceOutput);
+    connect(m_source, &FlatpakOutputSource::finished, this, &FlatpakOutputReader::sourceFinished);
+    connect(m_source, &FlatpakOutputSource::failedToStart, this, &FlatpakOutputReader::sourceFailedToStart);
+}
+
+FlatpakOutputReader::~FlatpakOutputReader()
+{
+}
+
+void FlatpakOutputReader::setStats(const std::shared_ptr<FlatpakJobStats>& stats)
+{
+    m_stats = stats;
+}
+
+bool FlatpakOutputReader::takeBatch(FlatpakOutputBatch& batch)
+{
+    return m_queue.tryPop(batch);
+}
+
+void FlatpakOutputReader::acknowledge()
+{
+    m_notified.store(false, std::memory_order_release);
+}
+
+int FlatpakOutputReader::pendingBatches() const
+{
+    return static_cast<int>(m_queue.sizeApprox());
+}
+
+void FlatpakOutputReader::terminate()
+{
+    m_stopping.store(true, std::memory_order_release);
+    QMetaObject::invokeMethod(this, "kill", Qt::QueuedConnection);
+}
+
+void FlatpakOutputReader::detach()
+{
+    m_detached.store(true, std::memory_order_release);
+    m_stopping.store(true, std::memory_order_release);
+    QMetaObject::invokeMethod(this, "detachSource", Qt::QueuedConnection);
+}
+
+void FlatpakOutputReader::start()
+{
+    m_source->start();
+}
+
+void FlatpakOutputReader::kill()
+{
+    m_source->terminate();
+}
+
+void FlatpakOutputReader::detachSource()
+{
+    m_source->detach();
+
+    if (m_source->isFinished()) {
+        thread()->quit();
+    }
+}
+
+void FlatpakOutputReader::sourceOutput(const QByteArray& data, bool isStderr)
+{
+    if (m_stats) {
+        m_stats->addRead(data.size());
+    }
+    consume(isStderr ? m_stderr : m_stdout, data);
+    pushBatch();
+}
+
+void FlatpakOutputReader::sourceFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    // Niedokończona ostatnia linia też jest częścią wyjścia
+    flushPending(m_stdout);
+    flushPending(m_stderr);
+    pushBatch();
+
+    qCDebug(KDEV_FLATPAKBUILDER_OUTPUT) << "output source finished with code" << exitCode << "status" << exitStatus;
+    emit finished(exitCode, exitStatus);
+
+    if (m_detached.load(std::memory_order_acquire)) {
+        thread()->quit();
+    }
+}
+
+void FlatpakOutputReader::sourceFailedToStart(const QString& errorString)
+{
+    qCWarning(KDEV_FLATPAKBUILDER_OUTPUT) << "output source failed to start:" << errorString;
+    emit failedToStart(errorString);
+
+    if (m_detached.load(std::memory_order_acquire)) {
+        thread()->quit();
+    }
+}
+
+void FlatpakOutputReader::consume(Channel& channel, const QByteArray& data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+
+    // Dekoder zachowuje stan między wywołaniami, więc znak UTF-8 rozcięty
+    // na granicy odczytu zostanie poprawnie złożony
+    channel.pending += channel.decoder->toUnicode(data);
+
+    int start = 0;
+    int newline;
+    while ((newline = channel.pending.indexOf(QLatin1Char('\n'), start)) != -1) {
+        int end = newline;
+        if (end > start && channel.pending.at(end - 1) == QLatin1Char('\r')) {
+            --end;
+        }
+
+        // Segmenty rozdzielone \r nadpisują się nawzajem w terminalu;
+        // pokazujemy tylko ostatni, pozostałe służą jedynie do śledzenia postępu
+        int segmentStart = start;
+        int carriageReturn;
+        while ((carriageReturn = channel.pending.indexOf(QLatin1Char('\r'), segmentStart)) != -1 && carriageReturn < end) {
+            appendLine(channel, channel.pending.mid(segmentStart, carriageReturn - segmentStart), true);
+            segmentStart = carriageReturn + 1;
+        }
+        appendLine(channel, channel.pending.mid(segmentStart, end - segmentStart), false);
+
+        start = newline + 1;
+    }
+
+    // Niedokończona linia może zawierać aktualizacje postępu zakończone \r.
+    // Znak \r na samym końcu zostaje - odczyt mógł rozciąć parę \r\n, a wtedy
+    // to koniec zwykłej linii, nie nadpisany stan pośredni
+    const int lastCarriageReturn = channel.pending.lastIndexOf(QLatin1Char('\r'), channel.pending.size() - 2);
+    if (lastCarriageReturn >= start) {
+        int segmentStart = start;
+        int carriageReturn;
+        while ((carriageReturn = channel.pending.indexOf(QLatin1Char('\r'), segmentStart)) != -1
+               && carriageReturn < channel.pending.size() - 1) {
+            appendLine(channel, channel.pending.mid(segmentStart, carriageReturn - segmentStart), true);
+            segmentStart = carriageReturn + 1;
+        }
+        start = segmentStart;
+    }
+
+    channel.pending.remove(0, start);
+}
+
+void FlatpakOutputReader::flushPending(Channel& channel)
+{
+    // Wstrzymany \r bez następującego \n kończy ostatni stan linii
+    if (channel.pending.endsWith(QLatin1Char('\r'))) {
+        channel.pending.chop(1);
+    }
+    if (!channel.pending.isEmpty()) {
+        appendLine(channel, channel.pending, false);
+        channel.pending.clear();
+    }
+}
+
+void FlatpakOutputReader::appendLine(Channel& channel, const QString& text, bool transient)
+{
+    if (transient && text.isEmpty()) {
+        return;
+    }
+
+    FlatpakOutputLine line;
+    line.text = text;
+    line.fromStderr = channel.isStderr;
+    line.transient = transient;
+    m_classifier.classify(line);
+
+    // Stany pośrednie bez informacji o postępie nie niosą żadnej treści
+    if (transient && line.kind != FlatpakOutputLine::Progress) {
+        return;
+    }
+
+    if (line.kind == FlatpakOutputLine::Error || line.kind == FlatpakOutputLine::Warning) {
+        ++m_batchProblemLines;
+    }
+
+    m_batch.append(line);
+    if (m_batch.size() >= MaxBatchLines) {
+        pushBatch();
+    }
+}
+
+void FlatpakOutputReader::pushBatch()
+{
+    if (m_batch.isEmpty()) {
+        return;
+    }
+
+    // Pełna kolejka oznacza, że GUI nie nadąża. Czekamy, nie wracając do pętli
+    // zdarzeń - dzięki temu QProcess nie czyta potoku i proces potomny
+    // zostaje zablokowany na zapisie
+    const int lineCount = m_batch.size();
+    bool stalled = false;
+    while (!m_queue.tryPush(m_batch)) {
+        if (m_stopping.load(std::memory_order_acquire)) {
+            m_batch.clear();
+            m_batchProblemLines = 0;
+            return;
+        }
+        if (!stalled) {
+            stalled = true;
+            qCDebug(KDEV_FLATPAKBUILDER_OUTPUT) << "output queue full, pausing the reader";
+            if (m_stats) {
+                m_stats->addStall();
+            }
+        }
+        QThread::usleep(500);
+    }
+
+    if (m_stats) {
+        m_stats->addBatch(lineCount, m_batchProblemLines, static_cast<int>(m_queue.sizeApprox()));
+    }
+    m_batchProblemLines = 0;
+
+    m_batch = FlatpakOutputBatch();
+    m_batch.reserve(MaxBatchLines);
+
+    if (!m_notified.exchange(true, std::memory_order_acq_rel)) {
+        emit batchesAvailable();
+    }
+}
@@ -0,0 +1,161 @@
+/**
+ * @file flatpakoutputreader.h
+ * @brief Odczyt i dekodowanie wyjścia procesu poza wątkiem GUI
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKOUTPUTREADER_H
+#define FLATPAKOUTPUTREADER_H
+
+#include "flatpaklineclassifier.h"
+#include "flatpakoutputqueue.h"
+
+#include <QObject>
+#include <QProcess>
+
+#include <atomic>
+#include <memory>
+
+class FlatpakJobStats;
+class FlatpakOutputSource;
+class QTextDecoder;
+
+/**
+ * @class FlatpakOutputReader
+ * @brief Etap czytający wyjście procesu w wątku roboczym
+ *
+ * Obiekt jest przenoszony do osobnego wątku razem ze źródłem wyjścia
+ * (lokalnym procesem albo połączeniem z demonem budowania). Dekoduje UTF-8, dzieli wyjście na linie, obsługuje znaki \r
+ * i klasyfikuje linie, a gotowe porcje przekazuje do wątku GUI przez
+ * ograniczoną kolejkę. Gdy kolejka jest pełna, wątek czytający przestaje
+ * odbierać dane z potoku, więc proces potomny zostaje spowolniony zamiast
+ * zapychać pamięć.
+ */
+class FlatpakOutputReader : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param source Źródło wyjścia; reader przejmuje je na własność
+     */
+    explicit FlatpakOutputReader(FlatpakOutputSource* source);
+
+    /**
+     * Destruktor
+     */
+    ~FlatpakOutputReader() override;
+
+    /**
+     * @brief Ustawia liczniki zadania (przed przeniesieniem do wątku czytającego)
+     * @param stats Liczniki współdzielone z zadaniem
+     */
+    void setStats(const std::shared_ptr<FlatpakJobStats>& stats);
+
+    /**
+     * @brief Pobiera kolejną porcję linii (wywoływane z wątku GUI)
+     * @param batch Miejsce na porcję
+     * @return false jeśli kolejka jest pusta
+     */
+    bool takeBatch(FlatpakOutputBatch& batch);
+
+    /**
+     * @brief Potwierdza odebranie powiadomienia batchesAvailable()
+     *
+     * Wątek GUI wywołuje tę metodę przed opróżnianiem kolejki, aby kolejne
+     * porcje wygenerowały nowe powiadomienie.
+     */
+    void acknowledge();
+
+    /**
+     * @brief Liczba porcji oczekujących w kolejce
+     */
+    int pendingBatches() const;
+
+    /**
+     * @brief Przerywa budowanie i odczyt (bezpieczne z dowolnego wątku)
+     *
+     * Zwalnia także wątek czytający, jeśli czeka na miejsce w kolejce.
+     */
+    void terminate();
+
+    /**
+     * @brief Odłącza czytnik od zadania, które zostało usunięte
+     *
+     * Lokalny proces jest przerywany, budowanie w demonie trwa dalej.
+     * Wątek czytający kończy się sam, bez udziału wątku GUI.
+     */
+    void detach();
+
+public Q_SLOTS:
+    /**
+     * @brief Uruchamia źródło wyjścia (wywoływane w wątku czytającym)
+     */
+    void start();
+
+Q_SIGNALS:
+    /**
+     * @brief Proces został uruchomiony
+     * @param pid Identyfikator procesu
+     */
+    void started(qint64 pid);
+
+    /**
+     * @brief W kolejce pojawiły się nowe porcje linii
+     *
+     * Sygnał jest wysyłany najwyżej raz do czasu wywołania acknowledge().
+     */
+    void batchesAvailable();
+
+    /**
+     * @brief Proces zakończył się, a cała jego treść trafiła do kolejki
+     * @param exitCode Kod wyjścia procesu
+     * @param exitStatus Sposób zakończenia procesu
+     */
+    void finished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    /**
+     * @brief Nie udało się uruchomić procesu
+     * @param errorString Opis błędu
+     */
+    void failedToStart(const QString& errorString);
+
+private Q_SLOTS:
+    void kill();
+    void detachSource();
+    void sourceOutput(const QByteArray& data, bool isStderr);
+    void sourceFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void sourceFailedToStart(const QString& errorString);
+
+private:
+    /**
+     * Stan dekodowania jednego kanału (stdout albo stderr)
+     */
+    struct Channel {
+        std::unique_ptr<QTextDecoder> decoder;
+        QString pending;
+        bool isStderr = false;
+    };
+
+    void consume(Channel& channel, const QByteArray& data);
+    void flushPending(Channel& channel);
+    void appendLine(Channel& channel, const QString& text, bool transient);
+    void pushBatch();
+
+    FlatpakOutputSource* m_source;
+    FlatpakLineClassifier m_classifier;
+    FlatpakOutputQueue<FlatpakOutputBatch> m_queue;
+    FlatpakOutputBatch m_batch;
+    int m_batchProblemLines;
+    std::shared_ptr<FlatpakJobStats> m_stats;
+    Channel m_stdout;
+    Channel m_stderr;
+    std::atomic<bool> m_notified;
+    std::atomic<bool> m_stopping;
+    std::atomic<bool> m_detached;
+};
+
+#endif // FLATPAKOUTPUTREADER_H
@@ -0,0 +1,134 @@
+/**
+ * @file flatpakoutputsource.cpp
+ * @brief Implementacja źródła wyjścia lokalnego procesu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakoutputsource.h"
+#include "flatpakprocess.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <signal.h>
+
+namespace {
+    // Czas na posprzątanie po SIGTERM, zanim drzewo procesów dostanie SIGKILL
+    const int KillGracePeriodMs = 3000;
+}
+
+FlatpakOutputSource::FlatpakOutputSource(QObject* parent)
+    : QObject(parent)
+{
+}
+
+FlatpakOutputSource::~FlatpakOutputSource()
+{
+}
+
+FlatpakProcessSource::FlatpakProcessSource(FlatpakProcess* process)
+    : m_process(process)
+    , m_killTimer(new QTimer(this))
+{
+    m_process->setParent(this);
+
+    m_killTimer->setSingleShot(true);
+    m_killTimer->setInterval(KillGracePeriodMs);
+    connect(m_killTimer, &QTimer::timeout, this, &FlatpakProcessSource::forceKill);
+
+    connect(m_process, &QProcess::started, this, &FlatpakProcessSource::processStarted);
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &FlatpakProcessSource::readStandardOutput);
+    connect(m_process, &QProcess::readyReadStandardError, this, &FlatpakProcessSource::readStandardError);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &FlatpakProcessSource::processFinished);
+    connect(m_process, &QProcess::errorOccurred, this, &FlatpakProcessSource::processError);
+}
+
+FlatpakProcessSource::~FlatpakProcessSource()
+{
+    if (m_process->state() != QProcess::NotRunning) {
+        m_process->signalTree(SIGKILL);
+        FlatpakProcess::signalProcesses(m_signalled, SIGKILL);
+        m_process->waitForFinished(1000);
+        return;
+    }
+
+    // Wątek czytający kończy się razem z procesem głównym, ale procesy, które
+    // uciekły z drzewa i zignorowały SIGTERM, nadal czekają na SIGKILL
+    if (m_killTimer->isActive() && QCoreApplication::instance()) {
+        const QVector<FlatpakProcess::ProcessId> signalled = m_signalled;
+        QTimer::singleShot(m_killTimer->remainingTime(), QCoreApplication::instance(), [signalled]() {
+            FlatpakProcess::signalProcesses(signalled, SIGKILL);
+        });
+    }
+}
+
+void FlatpakProcessSource::start()
+{
+    m_process->start();
+}
+
+void FlatpakProcessSource::terminate()
+{
+    if (m_process->state() == QProcess::NotRunning || m_killTimer->isActive()) {
+        return;
+    }
+
+    // Najpierw łagodnie - flatpak-builder i kompilatory mogą posprzątać pliki tymczasowe
+    m_signalled = m_process->signalTree(SIGTERM);
+    m_killTimer->start();
+}
+
+void FlatpakProcessSource::detach()
+{
+    terminate();
+}
+
+bool FlatpakProcessSource::isFinished() const
+{
+    return m_process->state() == QProcess::NotRunning;
+}
+
+void FlatpakProcessSource::forceKill()
+{
+    // Bieżące drzewo oraz procesy, które uciekły z niego po SIGTERM - także
+    // wtedy, gdy sam flatpak-builder już się zakończył. Czas startu chroni
+    // przed trafieniem w proces, który dostał zwolniony identyfikator
+    if (m_process->state() != QProcess::NotRunning) {
+        m_process->signalTree(SIGKILL);
+    }
+    FlatpakProcess::signalProcesses(m_signalled, SIGKILL);
+    m_signalled.clear();
+}
+
+void FlatpakProcessSource::processStarted()
+{
+    emit started(m_process->processId());
+}
+
+void FlatpakProcessSource::readStandardOutput()
+{
+    emit output(m_process->readAllStandardOutput(), false);
+}
+
+void FlatpakProcessSource::readStandardError()
+{
+    emit output(m_process->readAllStandardError(), true);
+}
+
+void FlatpakProcessSource::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    // Zabierz wszystko, co zostało w potokach
+    emit output(m_process->readAllStandardOutput(), false);
+    emit output(m_process->readAllStandardError(), true);
+
+    emit finished(exitCode, exitStatus);
+}
+
+void FlatpakProcessSource::processError(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart) {
+        emit failedToStart(m_process->errorString());
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ * @file flatpakoutputsource.h
+ * @brief Źródła wyjścia budowania: lokalny proces albo demon
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKOUTPUTSOURCE_H
+#define FLATPAKOUTPUTSOURCE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QVector>
+
+#include "flatpakprocess.h"
+
+class QTimer;
+
+/**
+ * @class FlatpakOutputSource
+ * @brief Źródło surowego wyjścia, z którego korzysta FlatpakOutputReader
+ *
+ * Źródło żyje w wątku czytającym razem z czytnikiem, więc jego sygnały są
+ * dostarczane bezpośrednio, bez kolejki zdarzeń.
+ */
+class FlatpakOutputSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param parent Obiekt rodzica
+     */
+    explicit FlatpakOutputSource(QObject* parent = nullptr);
+
+    /**
+     * Destruktor
+     */
+    ~FlatpakOutputSource() override;
+
+    /**
+     * @brief Uruchamia budowanie albo podłącza się do trwającego
+     */
+    virtual void start() = 0;
+
+    /**
+     * @brief Przerywa budowanie
+     */
+    virtual void terminate() = 0;
+
+    /**
+     * @brief Odłącza źródło od zadania, które zostało usunięte
+     *
+     * Lokalny proces jest przerywany; budowanie prowadzone przez demona
+     * trwa dalej i można się do niego później podłączyć.
+     */
+    virtual void detach() = 0;
+
+    /**
+     * @brief Czy źródło nie dostarczy już żadnych danych
+     */
+    virtual bool isFinished() const = 0;
+
+Q_SIGNALS:
+    /**
+     * @brief Proces budowania został uruchomiony
+     * @param pid Identyfikator procesu
+     */
+    void started(qint64 pid);
+
+    /**
+     * @brief Nowy fragment wyjścia
+     * @param data Surowe bajty
+     * @param isStderr Czy dane pochodzą ze standardowego wyjścia błędów
+     */
+    void output(const QByteArray& data, bool isStderr);
+
+    /**
+     * @brief Budowanie się zakończyło, a całe wyjście zostało przekazane
+     * @param exitCode Kod wyjścia procesu
+     * @param exitStatus Sposób zakończenia procesu
+     */
+    void finished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    /**
+     * @brief Nie udało się uruchomić budowania
+     * @param errorString Opis błędu
+     */
+    void failedToStart(const QString& errorString);
+};
+
+/**
+ * @class FlatpakProcessSource
+ * @brief Wyjście procesu uruchomionego bezpośrednio w KDevelop
+ *
+ * Przerwanie wysyła SIGTERM do całego drzewa procesów, a po krótkim czasie
+ * SIGKILL do tych, które jeszcze żyją. Procesy są rozpoznawane po
+ * identyfikatorze i czasie startu, więc SIGKILL nie trafi w obcy proces,
+ * który dostał zwolniony identyfikator.
+ */
+class FlatpakProcessSource : public FlatpakOutputSource
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param process Proces do uruchomienia; źródło przejmuje go na własność
+     */
+    explicit FlatpakProcessSource(FlatpakProcess* process);
+
+    /**
+     * Destruktor
+     */
+    ~FlatpakProcessSource() override;
+
+    void start() override;
+    void terminate() override;
+    void detach() override;
+    bool isFinished() const override;
+
+private Q_SLOTS:
+    void forceKill();
+    void processStarted();
+    void readStandardOutput();
+    void readStandardError();
+    void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void processError(QProcess::ProcessError error);
+
+private:
+    FlatpakProcess* m_process;
+    QTimer* m_killTimer;
+    QVector<FlatpakProcess::ProcessId> m_signalled;
+};
+
+#endif // FLATPAKOUTPUTSOURCE_H
@@ -0,0 +1,155 @@
+/**
+ * @file flatpakpgo.cpp
+ * @brief Implementacja etapów budowania PGO
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakpgo.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+namespace {
+    // Katalog profilu w /app, czyli w files/ katalogu budowania
+    const QString ProfileDirName = QStringLiteral("pgo-data");
+
+    // Profil połączony przez llvm-profdata
+    const QString MergedClangProfile = QStringLiteral("default.profdata");
+
+    // Flagi dopisywane do cflags, cxxflags i ldflags modułu aplikacji
+    const QString GenerateFlags = QStringLiteral("-fprofile-generate=/app/pgo-data -fprofile-update=atomic");
+    const QString GccUseFlags = QStringLiteral("-fprofile-use=%1 -fprofile-correction -Wno-missing-profile");
+    const QString ClangUseFlags = QStringLiteral("-fprofile-use=%1/default.profdata");
+
+    QString profileDataDir(const QString& buildDir)
+    {
+        return QDir(buildDir).filePath("files/" + ProfileDirName);
+    }
+
+    void appendFlags(QJsonObject& buildOptions, const QString& key, const QString& flags)
+    {
+        const QString existing = buildOptions.value(key).toString();
+        buildOptions[key] = existing.isEmpty() ? flags : existing + ' ' + flags;
+    }
+
+    /**
+     * Zapisuje kopię manifestu ze zmienionym modułem aplikacji obok oryginału,
+     * żeby względne ścieżki źródeł nadal wskazywały te same pliki
+     */
+    template<typename Modify>
+    QString writeDerivedManifest(const QString& manifestPath, const QString& stage, Modify modify)
+    {
+        QFile file(manifestPath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QString();
+        }
+
+        QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+        QJsonArray modules = manifest.value("modules").toArray();
+        if (modules.isEmpty() || !modules.last().isObject()) {
+            return QString();
+        }
+
+        QJsonObject appModule = modules.last().toObject();
+        modify(appModule);
+        modules[modules.size() - 1] = appModule;
+        manifest["modules"] = modules;
+
+        const QFileInfo info(manifestPath);
+        const QString path = info.absoluteDir().filePath(QString(".%1.%2.json").arg(info.completeBaseName(), stage));
+        QSaveFile output(path);
+        if (!output.open(QIODevice::WriteOnly)
+            || output.write(QJsonDocument(manifest).toJson(QJsonDocument::Indented)) < 0
+            || !output.commit()) {
+            return QString();
+        }
+        return path;
+    }
+}
+
+QString FlatpakPgo::sandboxProfileDir()
+{
+    return "/app/" + ProfileDirName;
+}
+
+QString FlatpakPgo::writeInstrumentedManifest(const QString& manifestPath)
+{
+    return writeDerivedManifest(manifestPath, "pgo-instrumented", [](QJsonObject& module) {
+        QJsonObject buildOptions = module.value("build-options").toObject();
+        appendFlags(buildOptions, "cflags", GenerateFlags);
+        appendFlags(buildOptions, "cxxflags", GenerateFlags);
+        appendFlags(buildOptions, "ldflags", GenerateFlags);
+        module["build-options"] = buildOptions;
+    });
+}
+
+QString FlatpakPgo::writeOptimizedManifest(const QString& manifestPath, const QString& profileDir)
+{
+    const bool clang = QFileInfo::exists(QDir(profileDir).filePath(MergedClangProfile));
+
+    return writeDerivedManifest(manifestPath, "pgo-optimized", [&](QJsonObject& module) {
+        // Profil trafia do katalogu budowania modułu jako dodatkowe źródło
+        QJsonObject source;
+        source["type"] = "dir";
+        source["path"] = profileDir;
+        source["dest"] = ProfileDirName;
+        QJsonArray sources = module.value("sources").toArray();
+        sources.append(source);
+        module["sources"] = sources;
+
+        const QString sandboxDir = QString("/run/build/%1/%2").arg(module.value("name").toString(), ProfileDirName);
+        const QString flags = (clang ? ClangUseFlags : GccUseFlags).arg(sandboxDir);
+        QJsonObject buildOptions = module.value("build-options").toObject();
+        appendFlags(buildOptions, "cflags", flags);
+        appendFlags(buildOptions, "cxxflags", flags);
+        appendFlags(buildOptions, "ldflags", flags);
+        module["build-options"] = buildOptions;
+    });
+}
+
+void FlatpakPgo::clearProfiles(const QString& buildDir)
+{
+    QDir(profileDataDir(buildDir)).removeRecursively();
+}
+
+bool FlatpakPgo::hasRawClangProfiles(const QString& buildDir)
+{
+    return !QDir(profileDataDir(buildDir)).entryList({"*.profraw"}, QDir::Files).isEmpty();
+}
+
+QStringList FlatpakPgo::mergeCommand()
+{
+    const QString dir = sandboxProfileDir();
+    return {"sh", "-c", QString("llvm-profdata merge -o %1/%2 %1/*.profraw && rm -f %1/*.profraw").arg(dir, MergedClangProfile)};
+}
+
+int FlatpakPgo::collectProfiles(const QString& buildDir, const QString& targetDir)
+{
+    const QString sourceDir = profileDataDir(buildDir);
+    QDir target(targetDir);
+    if (!target.removeRecursively() || !QDir().mkpath(targetDir)) {
+        return -1;
+    }
+
+    int count = 0;
+    QDirIterator it(sourceDir, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        const QString destination = target.filePath(QDir(sourceDir).relativeFilePath(path));
+        if (!QDir().mkpath(QFileInfo(destination).absolutePath()) || !QFile::copy(path, destination)) {
+            return -1;
+        }
+        ++count;
+    }
+
+    // Profil nie może trafić do instalacji ani eksportu wersji instrumentowanej
+    QDir(sourceDir).removeRecursively();
+    return count;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file flatpakpgo.h
+ * @brief Manifesty i dane profilu dla budowania z optymalizacją sterowaną profilem
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKPGO_H
+#define FLATPAKPGO_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @class FlatpakPgo
+ * @brief Przygotowuje kolejne etapy budowania PGO (profile-guided optimization)
+ *
+ * Oba pochodne manifesty różnią się od oryginału tylko modułem aplikacji
+ * (ostatnim), więc zależności są odtwarzane z cache flatpak-builder:
+ *
+ * - manifest instrumentowany dokleja do build-options modułu flagi
+ *   -fprofile-generate, a program zapisuje profil w /app/pgo-data, czyli
+ *   w katalogu budowania, do którego sandbox ma prawo zapisu;
+ * - manifest optymalizowany dodaje zebrany profil jako źródło "dir"
+ *   modułu i kompiluje z -fprofile-use. Ścieżka budowania w piaskownicy
+ *   (/run/build/<moduł>) jest w obu przebiegach ta sama, więc nazwy plików
+ *   .gcda pasują do obiektów.
+ *
+ * Obsługiwane są pliki .gcda (GCC) i .profraw (Clang); te drugie przed
+ * użyciem są łączone przez llvm-profdata w default.profdata.
+ */
+class FlatpakPgo
+{
+public:
+    /**
+     * @brief Katalog profilu w piaskownicy podczas treningu
+     */
+    static QString sandboxProfileDir();
+
+    /**
+     * @brief Tworzy manifest z instrumentowanym modułem aplikacji
+     * @param manifestPath Manifest JSON z modułem aplikacji zdefiniowanym na końcu listy
+     * @return Ścieżka zapisanego manifestu albo pusty tekst w razie błędu
+     */
+    static QString writeInstrumentedManifest(const QString& manifestPath);
+
+    /**
+     * @brief Tworzy manifest budujący moduł aplikacji z zebranym profilem
+     * @param manifestPath Manifest JSON z modułem aplikacji zdefiniowanym na końcu listy
+     * @param profileDir Katalog z zebranymi danymi profilu
+     * @return Ścieżka zapisanego manifestu albo pusty tekst w razie błędu
+     */
+    static QString writeOptimizedManifest(const QString& manifestPath, const QString& profileDir);
+
+    /**
+     * @brief Usuwa dane profilu pozostawione w katalogu budowania (np. przez narzędzia budowania)
+     * @param buildDir Katalog budowania instrumentowanej wersji
+     */
+    static void clearProfiles(const QString& buildDir);
+
+    /**
+     * @brief Czy trening wygenerował surowe profile Clang wymagające połączenia
+     * @param buildDir Katalog budowania instrumentowanej wersji
+     */
+    static bool hasRawClangProfiles(const QString& buildDir);
+
+    /**
+     * @brief Zwraca polecenie łączące profile Clang, do uruchomienia w piaskownicy
+     */
+    static QStringList mergeCommand();
+
+    /**
+     * @brief Przenosi dane profilu z katalogu budowania do projektu
+     * @param buildDir Katalog budowania instrumentowanej wersji
+     * @param targetDir Katalog profilu w projekcie (poprzednia zawartość jest usuwana)
+     * @return Liczba przeniesionych plików albo -1 w razie błędu
+     */
+    static int collectProfiles(const QString& buildDir, const QString& targetDir);
+};
+
+#endif // FLATPAKPGO_H
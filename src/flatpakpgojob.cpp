@@ -0,0 +1,288 @@
+/**
+ * @file flatpakpgojob.cpp
+ * @brief Implementacja zadania budowania PGO
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakpgojob.h"
+#include "flatpakbuilderconfig.h"
+#include "flatpakbuilderjob.h"
+#include "flatpakbuilderplugin.h"
+#include "flatpakpgo.h"
+#include "flatpakprocess.h"
+
+#include <interfaces/iproject.h>
+
+#include <KLocalizedString>
+
+#include <QDir>
+#include <QFile>
+
+#include <csignal>
+
+namespace {
+    // Katalog profilu w projekcie
+    const QString ProfileDirName = QStringLiteral(".flatpak-pgo");
+
+    // Tyle ostatnich linii wyjścia trafia do komunikatu o błędzie
+    const int ErrorTailLines = 20;
+
+    QString formatSeconds(qint64 ms)
+    {
+        return QString::number(ms / 1000.0, 'f', 2);
+    }
+}
+
+FlatpakPgoJob::FlatpakPgoJob(FlatpakBuilderPlugin* plugin, KDevelop::IProject* project,
+                             const QString& manifestPath, const QString& workload)
+    : KJob(plugin)
+    , m_plugin(plugin)
+    , m_project(project)
+    , m_manifestPath(manifestPath)
+    , m_workload(workload)
+    , m_stage(BaselineBuild)
+    , m_process(nullptr)
+    , m_baselineMs(-1)
+    , m_trainingMs(-1)
+    , m_optimizedMs(-1)
+    , m_profileFiles(0)
+{
+    setObjectName(i18n("Flatpak PGO Build: %1", project->name()));
+    setCapabilities(KJob::Killable);
+
+    const QDir projectDir(project->path().toLocalFile());
+    m_stateDir = projectDir.filePath(".flatpak-builder");
+    m_profileDir = projectDir.filePath(ProfileDirName);
+}
+
+FlatpakPgoJob::~FlatpakPgoJob()
+{
+    if (!m_instrumentedManifest.isEmpty()) {
+        QFile::remove(m_instrumentedManifest);
+    }
+    if (!m_optimizedManifest.isEmpty()) {
+        QFile::remove(m_optimizedManifest);
+    }
+}
+
+void FlatpakPgoJob::start()
+{
+    if (m_workload.trimmed().isEmpty()) {
+        fail(i18n("No training workload was specified."));
+        return;
+    }
+
+    m_instrumentedManifest = FlatpakPgo::writeInstrumentedManifest(m_manifestPath);
+    if (m_instrumentedManifest.isEmpty()) {
+        fail(i18n("PGO builds need a JSON manifest whose application module is defined inline as the last module."));
+        return;
+    }
+
+    setTotalAmount(KJob::Items, Finished);
+    setProcessedAmount(KJob::Items, 0);
+    m_plugin->publishProblems({});
+
+    QMetaObject::invokeMethod(this, "runStage", Qt::QueuedConnection);
+}
+
+qint64 FlatpakPgoJob::baselineMs() const
+{
+    return m_baselineMs;
+}
+
+qint64 FlatpakPgoJob::optimizedMs() const
+{
+    return m_optimizedMs;
+}
+
+QString FlatpakPgoJob::summary() const
+{
+    QStringList lines;
+    if (m_baselineMs >= 0) {
+        lines << i18n("Training workload without PGO: %1 s", formatSeconds(m_baselineMs));
+    }
+    if (m_trainingMs >= 0) {
+        lines << i18n("Training run with instrumentation: %1 s (%2 profile files)",
+                      formatSeconds(m_trainingMs), m_profileFiles);
+    }
+    if (m_optimizedMs >= 0) {
+        lines << i18n("Training workload with PGO: %1 s", formatSeconds(m_optimizedMs));
+    }
+    if (m_baselineMs > 0 && m_optimizedMs >= 0) {
+        const double change = 100.0 * (m_baselineMs - m_optimizedMs) / m_baselineMs;
+        lines << (change >= 0 ? i18n("The optimized build is %1% faster.", QString::number(change, 'f', 1))
+                              : i18n("The optimized build is %1% slower.", QString::number(-change, 'f', 1)));
+    }
+    return lines.join('\n');
+}
+
+bool FlatpakPgoJob::doKill()
+{
+    m_stage = Finished;
+
+    if (m_build) {
+        disconnect(m_build, nullptr, this, nullptr);
+        m_build->kill();
+    }
+    if (m_process) {
+        disconnect(m_process, nullptr, this, nullptr);
+        m_process->signalTree(SIGTERM);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+    return true;
+}
+
+void FlatpakPgoJob::runStage()
+{
+    setProcessedAmount(KJob::Items, m_stage);
+
+    switch (m_stage) {
+        case BaselineBuild:
+            startBuild(m_manifestPath, "pgo-baseline");
+            break;
+
+        case BaselineRun:
+            startInSandbox(buildDir("pgo-baseline"), m_manifestPath, workloadCommand());
+            break;
+
+        case InstrumentedBuild:
+            startBuild(m_instrumentedManifest, "pgo-instrumented");
+            break;
+
+        case TrainingRun:
+            // Profil ma opisywać tylko trening, a nie narzędzia uruchamiane podczas budowania
+            FlatpakPgo::clearProfiles(buildDir("pgo-instrumented"));
+            startInSandbox(buildDir("pgo-instrumented"), m_instrumentedManifest, workloadCommand());
+            break;
+
+        case MergeProfiles:
+            if (FlatpakPgo::hasRawClangProfiles(buildDir("pgo-instrumented"))) {
+                startInSandbox(buildDir("pgo-instrumented"), m_instrumentedManifest, FlatpakPgo::mergeCommand());
+            } else {
+                advance(OptimizedBuild);
+            }
+            break;
+
+        case OptimizedBuild:
+            m_profileFiles = FlatpakPgo::collectProfiles(buildDir("pgo-instrumented"), m_profileDir);
+            if (m_profileFiles <= 0) {
+                fail(i18n("The training workload produced no profile data in %1.", FlatpakPgo::sandboxProfileDir()));
+                return;
+            }
+
+            m_optimizedManifest = FlatpakPgo::writeOptimizedManifest(m_manifestPath, m_profileDir);
+            if (m_optimizedManifest.isEmpty()) {
+                fail(i18n("Could not write the optimized manifest."));
+                return;
+            }
+            startBuild(m_optimizedManifest, QString());
+            break;
+
+        case OptimizedRun:
+            startInSandbox(buildDir(QString()), m_optimizedManifest, workloadCommand());
+            break;
+
+        case Finished:
+            emitResult();
+            break;
+    }
+}
+
+void FlatpakPgoJob::startBuild(const QString& manifestPath, const QString& variant)
+{
+    m_build = new FlatpakBuilderJob(m_plugin, m_project, FlatpakBuilderJob::BuildOperation);
+    m_build->setManifestPath(manifestPath);
+    m_build->setStateDir(m_stateDir);
+    if (!variant.isEmpty()) {
+        m_build->setVariantName(variant);
+    }
+
+    connect(m_build, &KJob::result, this, &FlatpakPgoJob::buildFinished);
+    m_build->start();
+}
+
+void FlatpakPgoJob::buildFinished(KJob* job)
+{
+    m_build = nullptr;
+
+    if (job->error() != 0) {
+        // Warianty nie publikują problemów same - robi to zadanie nadrzędne
+        m_plugin->publishProblems(static_cast<FlatpakBuilderJob*>(job)->problems());
+        fail(i18n("PGO build stage failed: %1", job->errorText()));
+        return;
+    }
+
+    advance(Stage(m_stage + 1));
+}
+
+void FlatpakPgoJob::startInSandbox(const QString& buildDir, const QString& manifestPath, const QStringList& command)
+{
+    QStringList args;
+    args << "--run" << "--state-dir=" + m_stateDir << buildDir << manifestPath << command;
+
+    m_process = new FlatpakProcess(this);
+    m_process->setWorkingDirectory(m_project->path().toLocalFile());
+    m_process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &FlatpakPgoJob::processFinished);
+
+    m_timer.start();
+    m_process->start(m_plugin->config()->flatpakBuilderPath(), args);
+}
+
+void FlatpakPgoJob::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    const qint64 elapsed = m_timer.elapsed();
+    const QStringList output = QString::fromUtf8(m_process->readAll()).split('\n', QString::SkipEmptyParts);
+    m_process->deleteLater();
+    m_process = nullptr;
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        fail(i18n("The command in the sandbox exited with code %1:\n%2", exitCode,
+                  QStringList(output.mid(qMax(0, output.size() - ErrorTailLines))).join('\n')));
+        return;
+    }
+
+    switch (m_stage) {
+        case BaselineRun:
+            m_baselineMs = elapsed;
+            break;
+        case TrainingRun:
+            m_trainingMs = elapsed;
+            break;
+        case OptimizedRun:
+            m_optimizedMs = elapsed;
+            break;
+        default:
+            break;
+    }
+
+    advance(Stage(m_stage + 1));
+}
+
+void FlatpakPgoJob::advance(Stage stage)
+{
+    m_stage = stage;
+    QMetaObject::invokeMethod(this, "runStage", Qt::QueuedConnection);
+}
+
+void FlatpakPgoJob::fail(const QString& message)
+{
+    m_stage = Finished;
+    setError(KJob::UserDefinedError);
+    setErrorText(message);
+    emitResult();
+}
+
+QString FlatpakPgoJob::buildDir(const QString& variant) const
+{
+    const QString dir = FlatpakBuilderJob::defaultBuildDir(m_project);
+    return variant.isEmpty() ? dir : dir + '-' + variant;
+}
+
+QStringList FlatpakPgoJob::workloadCommand() const
+{
+    return {"sh", "-c", m_workload};
+}
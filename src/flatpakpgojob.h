@@ -0,0 +1,134 @@
+/**
+ * @file flatpakpgojob.h
+ * @brief Zadanie budowania z optymalizacją sterowaną profilem (PGO)
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKPGOJOB_H
+#define FLATPAKPGOJOB_H
+
+#include <KJob>
+
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QProcess>
+#include <QStringList>
+
+class FlatpakBuilderJob;
+class FlatpakBuilderPlugin;
+class FlatpakProcess;
+
+namespace KDevelop {
+    class IProject;
+}
+
+/**
+ * @class FlatpakPgoJob
+ * @brief Buduje aplikację trzykrotnie i uczy kompilator na obciążeniu treningowym
+ *
+ * Etapy:
+ * 1. zwykłe budowanie i pomiar czasu obciążenia treningowego,
+ * 2. budowanie z instrumentacją i trening w piaskownicy (flatpak-builder --run),
+ * 3. przeniesienie profilu do .flatpak-pgo/ w projekcie,
+ * 4. budowanie z profilem do domyślnego katalogu budowania i ponowny pomiar.
+ *
+ * Budowania są zwykłymi FlatpakBuilderJob z własnymi widokami wyjścia.
+ * Wszystkie używają katalogu stanu projektu, a pochodne manifesty różnią
+ * się tylko modułem aplikacji, więc zależności są budowane najwyżej raz.
+ * Wynik trafia do domyślnego katalogu budowania, skąd instalują go
+ * i eksportują zwykłe akcje.
+ */
+class FlatpakPgoJob : public KJob
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Etap budowania PGO
+     */
+    enum Stage {
+        BaselineBuild,
+        BaselineRun,
+        InstrumentedBuild,
+        TrainingRun,
+        MergeProfiles,
+        OptimizedBuild,
+        OptimizedRun,
+        Finished
+    };
+
+    /**
+     * Konstruktor
+     *
+     * @param plugin Wtyczka
+     * @param project Projekt
+     * @param manifestPath Manifest JSON projektu
+     * @param workload Polecenie powłoki uruchamiane w piaskownicy jako trening
+     */
+    FlatpakPgoJob(FlatpakBuilderPlugin* plugin, KDevelop::IProject* project,
+                  const QString& manifestPath, const QString& workload);
+
+    /**
+     * Destruktor - usuwa pochodne manifesty
+     */
+    ~FlatpakPgoJob() override;
+
+    /**
+     * @brief Uruchamia pierwszy etap
+     */
+    void start() override;
+
+    /**
+     * @brief Zwraca czas obciążenia treningowego przed optymalizacją (ms, -1 jeśli nie zmierzono)
+     */
+    qint64 baselineMs() const;
+
+    /**
+     * @brief Zwraca czas obciążenia treningowego po optymalizacji (ms, -1 jeśli nie zmierzono)
+     */
+    qint64 optimizedMs() const;
+
+    /**
+     * @brief Zwraca podsumowanie pomiarów do wyświetlenia
+     */
+    QString summary() const;
+
+protected:
+    /**
+     * @brief Przerywa bieżące budowanie lub uruchomienie w piaskownicy
+     */
+    bool doKill() override;
+
+private Q_SLOTS:
+    void runStage();
+    void buildFinished(KJob* job);
+    void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    void startBuild(const QString& manifestPath, const QString& variant);
+    void startInSandbox(const QString& buildDir, const QString& manifestPath, const QStringList& command);
+    void advance(Stage stage);
+    void fail(const QString& message);
+    QString buildDir(const QString& variant) const;
+    QStringList workloadCommand() const;
+
+    FlatpakBuilderPlugin* m_plugin;
+    KDevelop::IProject* m_project;
+    QString m_manifestPath;
+    QString m_workload;
+    QString m_stateDir;
+    QString m_profileDir;
+    QString m_instrumentedManifest;
+    QString m_optimizedManifest;
+    Stage m_stage;
+    QPointer<FlatpakBuilderJob> m_build;
+    FlatpakProcess* m_process;
+    QElapsedTimer m_timer;
+    qint64 m_baselineMs;
+    qint64 m_trainingMs;
+    qint64 m_optimizedMs;
+    int m_profileFiles;
+};
+
+#endif // FLATPAKPGOJOB_H
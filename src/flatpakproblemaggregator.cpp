@@ -0,0 +1,154 @@
+/**
+ * @file flatpakproblemaggregator.cpp
+ * @brief Implementacja agregacji problemów zgłaszanych podczas budowania Flatpak
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakproblemaggregator.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpressionMatch>
+
+#include <algorithm>
+
+uint qHash(const FlatpakProblemAggregator::Key& key, uint seed)
+{
+    seed = ::qHash(key.message, seed);
+    seed = ::qHash(key.file, seed);
+    return seed ^ ::qHash((key.line << 12) ^ key.column ^ (key.severity << 28), seed);
+}
+
+FlatpakProblemAggregator::FlatpakProblemAggregator()
+    // plik:linia[:kolumna]: [fatal ]error|warning: treść
+    : m_diagnosticRegex("^([^\\s:][^:]*):(\\d+):(?:(\\d+):)?\\s*(?:fatal )?(?:error|warning|Error|Warning):\\s*(.*)$")
+    , m_duplicates(0)
+{
+    m_diagnosticRegex.optimize();
+}
+
+void FlatpakProblemAggregator::setPathPrefixes(const QVector<PathPrefix>& prefixes)
+{
+    m_prefixes = prefixes;
+
+    // Najdłuższe prefiksy najpierw, żeby moduł zagnieżdżony wygrał z nadrzędnym
+    std::sort(m_prefixes.begin(), m_prefixes.end(), [](const PathPrefix& a, const PathPrefix& b) {
+        return a.first.size() > b.first.size();
+    });
+}
+
+void FlatpakProblemAggregator::setModuleBuildDirs(const QHash<QString, QString>& buildDirs)
+{
+    m_moduleBuildDirs = buildDirs;
+}
+
+int FlatpakProblemAggregator::add(const FlatpakOutputLine& line, bool* isNew)
+{
+    if (isNew) {
+        *isNew = false;
+    }
+
+    if (!line.module.isEmpty()) {
+        m_currentModule = line.module;
+    }
+
+    if (line.kind != FlatpakOutputLine::Error && line.kind != FlatpakOutputLine::Warning) {
+        return -1;
+    }
+
+    Key key;
+    key.severity = line.kind;
+    key.line = -1;
+    key.column = -1;
+
+    const QRegularExpressionMatch match = m_diagnosticRegex.match(line.text);
+    if (match.hasMatch()) {
+        key.line = match.captured(2).toInt();
+        key.column = match.capturedLength(3) > 0 ? match.captured(3).toInt() : -1;
+        key.message = normalizeMessage(match.captured(4));
+        key.file = match.captured(1);
+
+        // Kompilator podaje ścieżkę względem katalogu, w którym go uruchomiono
+        if (!QDir::isAbsolutePath(key.file) && !m_currentModule.isEmpty()) {
+            const QString buildDir = m_moduleBuildDirs.value(m_currentModule, "/run/build/" + m_currentModule);
+            key.file = QDir::cleanPath(buildDir + '/' + key.file);
+        }
+    } else {
+        key.message = normalizeMessage(line.message);
+    }
+
+    // Klucz zawiera ścieżkę z logu - przemapowanie (z testem istnienia pliku)
+    // wykonujemy tylko raz, dla nowego problemu
+    const auto it = m_index.constFind(key);
+    if (it != m_index.constEnd()) {
+        ++m_problems[it.value()].count;
+        ++m_duplicates;
+        return it.value();
+    }
+
+    FlatpakProblem problem;
+    problem.severity = line.kind;
+    problem.message = key.message;
+    problem.file = key.file.isEmpty() ? QString() : remapPath(key.file);
+    problem.line = key.line;
+    problem.column = key.column;
+
+    const int index = m_problems.size();
+    m_problems.append(problem);
+    m_index.insert(key, index);
+
+    if (isNew) {
+        *isNew = true;
+    }
+    return index;
+}
+
+const QVector<FlatpakProblem>& FlatpakProblemAggregator::problems() const
+{
+    return m_problems;
+}
+
+int FlatpakProblemAggregator::duplicateCount() const
+{
+    return m_duplicates;
+}
+
+void FlatpakProblemAggregator::clear()
+{
+    m_problems.clear();
+    m_index.clear();
+    m_currentModule.clear();
+    m_duplicates = 0;
+}
+
+QString FlatpakProblemAggregator::remapPath(const QString& path) const
+{
+    const QString cleanPath = QDir::cleanPath(path);
+
+    for (const PathPrefix& prefix : m_prefixes) {
+        if (cleanPath.startsWith(prefix.first)) {
+            return prefix.second + cleanPath.mid(prefix.first.size());
+        }
+    }
+
+    // Ścieżki spoza piaskownicy zostawiamy, o ile wskazują na istniejący plik
+    if (QDir::isAbsolutePath(cleanPath) && !cleanPath.startsWith(QLatin1String("/run/build"))
+        && QFileInfo::exists(cleanPath)) {
+        return cleanPath;
+    }
+
+    return QString();
+}
+
+QString FlatpakProblemAggregator::normalizeMessage(const QString& message)
+{
+    static const QRegularExpression ansiRegex("\\x1b\\[[0-9;]*[A-Za-z]");
+
+    QString normalized = message;
+    if (normalized.contains(QLatin1Char('\x1b'))) {
+        normalized.remove(ansiRegex);
+    }
+
+    return normalized.simplified();
+}
@@ -0,0 +1,134 @@
+/**
+ * @file flatpakproblemaggregator.h
+ * @brief Agregacja problemów zgłaszanych podczas budowania Flatpak
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKPROBLEMAGGREGATOR_H
+#define FLATPAKPROBLEMAGGREGATOR_H
+
+#include "flatpaklineclassifier.h"
+
+#include <QHash>
+#include <QPair>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+/**
+ * @struct FlatpakProblem
+ * @brief Pojedynczy, zdeduplikowany problem z logu budowania
+ */
+struct FlatpakProblem
+{
+    FlatpakOutputLine::Kind severity = FlatpakOutputLine::Error;
+    QString message;    ///< Znormalizowana treść komunikatu
+    QString file;       ///< Ścieżka lokalna (po przemapowaniu) albo pusta
+    int line = -1;      ///< Numer linii liczony od 1, -1 jeśli nieznany
+    int column = -1;    ///< Numer kolumny liczony od 1, -1 jeśli nieznany
+    int count = 1;      ///< Liczba wystąpień w logu
+};
+
+/**
+ * @class FlatpakProblemAggregator
+ * @brief Zbiera błędy i ostrzeżenia, łącząc powtarzające się wpisy
+ *
+ * Problemy są identyfikowane przez znormalizowaną treść i położenie, więc
+ * to samo ostrzeżenie z nagłówka dołączanego w tysiącu plików daje jeden
+ * wpis z licznikiem. Diagnostyki kompilatora w postaci plik:linia:kolumna
+ * są rozpoznawane, a ścieżki z piaskownicy (/run/build/<moduł>/...) są
+ * zamieniane na ścieżki w projekcie na podstawie tablicy prefiksów.
+ * Ścieżki względne (np. ../src/foo.c z mesona) są rozwiązywane względem
+ * katalogu budowania modułu, który wskazała ostatnia linia "Building module".
+ */
+class FlatpakProblemAggregator
+{
+public:
+    /**
+     * Para prefiksów: ścieżka w piaskownicy i odpowiadający jej katalog lokalny
+     */
+    using PathPrefix = QPair<QString, QString>;
+
+    FlatpakProblemAggregator();
+
+    /**
+     * @brief Ustawia tablicę przemapowań ścieżek
+     * @param prefixes Pary (prefiks w piaskownicy, prefiks lokalny)
+     */
+    void setPathPrefixes(const QVector<PathPrefix>& prefixes);
+
+    /**
+     * @brief Ustawia katalogi budowania modułów, które nie kompilują się w /run/build/<moduł>
+     * @param buildDirs Nazwa modułu -> katalog w piaskownicy (FlatpakBuildCommand::sandboxBuildDirs())
+     */
+    void setModuleBuildDirs(const QHash<QString, QString>& buildDirs);
+
+    /**
+     * @brief Dodaje problem z sklasyfikowanej linii
+     *
+     * Linie rozpoczynające moduł nie są problemami, ale też powinny tu trafić -
+     * wyznaczają katalog dla ścieżek względnych.
+     *
+     * @param line Sklasyfikowana linia; problemem są tylko linie Error i Warning
+     * @param isNew Ustawiane na true, jeśli problem nie był wcześniej widziany
+     * @return Indeks problemu w problems() albo -1 dla linii bez problemu
+     */
+    int add(const FlatpakOutputLine& line, bool* isNew = nullptr);
+
+    /**
+     * @brief Zwraca zebrane problemy w kolejności pierwszego wystąpienia
+     */
+    const QVector<FlatpakProblem>& problems() const;
+
+    /**
+     * @brief Zwraca liczbę linii, które okazały się duplikatami
+     */
+    int duplicateCount() const;
+
+    /**
+     * @brief Usuwa wszystkie zebrane problemy
+     */
+    void clear();
+
+    /**
+     * @brief Zamienia ścieżkę z piaskownicy na lokalną
+     * @param path Ścieżka z logu
+     * @return Ścieżka lokalna albo pusty QString, jeśli nie da się jej przemapować
+     */
+    QString remapPath(const QString& path) const;
+
+    /**
+     * @brief Normalizuje treść komunikatu (kody ANSI, białe znaki)
+     * @param message Treść komunikatu
+     * @return Znormalizowana treść
+     */
+    static QString normalizeMessage(const QString& message);
+
+private:
+    struct Key {
+        int severity;
+        QString message;
+        QString file;
+        int line;
+        int column;
+
+        bool operator==(const Key& other) const
+        {
+            return severity == other.severity && line == other.line && column == other.column
+                && message == other.message && file == other.file;
+        }
+    };
+
+    friend uint qHash(const Key& key, uint seed);
+
+    QRegularExpression m_diagnosticRegex;
+    QVector<PathPrefix> m_prefixes;
+    QHash<QString, QString> m_moduleBuildDirs;
+    QString m_currentModule;
+    QVector<FlatpakProblem> m_problems;
+    QHash<Key, int> m_index;
+    int m_duplicates;
+};
+
+#endif // FLATPAKPROBLEMAGGREGATOR_H
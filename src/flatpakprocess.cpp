@@ -0,0 +1,126 @@
+/**
+ * @file flatpakprocess.cpp
+ * @brief Implementacja procesu flatpak-builder we własnej grupie procesów
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakprocess.h"
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+
+#include <signal.h>
+#include <unistd.h>
+
+namespace {
+    // Pola /proc/<pid>/stat po nazwie procesu (od pola 3 - stanu);
+    // nazwa może zawierać spacje i nawiasy
+    QList<QByteArray> statFields(const QString& pid)
+    {
+        QFile stat("/proc/" + pid + "/stat");
+        if (!stat.open(QIODevice::ReadOnly)) {
+            return {};
+        }
+
+        const QByteArray line = stat.readAll();
+        const int commEnd = line.lastIndexOf(')');
+        if (commEnd < 0) {
+            return {};
+        }
+        return line.mid(commEnd + 2).split(' ');
+    }
+
+    // Indeksy w statFields(): ppid to pole 4, starttime pole 22
+    const int ParentField = 1;
+    const int StartTimeField = 19;
+}
+
+FlatpakProcess::FlatpakProcess(QObject* parent)
+    : QProcess(parent)
+{
+}
+
+FlatpakProcess::~FlatpakProcess()
+{
+}
+
+QVector<FlatpakProcess::ProcessId> FlatpakProcess::signalTree(int signal)
+{
+    const qint64 pid = processId();
+    if (pid <= 0) {
+        return {};
+    }
+
+    // Potomków zbieramy przed wysłaniem sygnału - po śmierci rodzica
+    // zostaliby przepięci do init i nie dałoby się ich znaleźć
+    QVector<ProcessId> processes;
+    const QVector<qint64> pids = QVector<qint64>{pid} + descendants(pid);
+    for (qint64 member : pids) {
+        ProcessId process;
+        process.pid = member;
+        process.startTime = startTime(member);
+        if (process.startTime > 0) {
+            processes.append(process);
+        }
+    }
+
+    ::kill(-static_cast<pid_t>(pid), signal);
+    signalProcesses(processes, signal);
+
+    return processes;
+}
+
+void FlatpakProcess::signalProcesses(const QVector<ProcessId>& processes, int signal)
+{
+    for (const ProcessId& process : processes) {
+        if (startTime(process.pid) == process.startTime) {
+            ::kill(static_cast<pid_t>(process.pid), signal);
+        }
+    }
+}
+
+quint64 FlatpakProcess::startTime(qint64 pid)
+{
+    const QList<QByteArray> fields = statFields(QString::number(pid));
+    return fields.size() > StartTimeField ? fields.at(StartTimeField).toULongLong() : 0;
+}
+
+QVector<qint64> FlatpakProcess::descendants(qint64 pid)
+{
+    QMultiHash<qint64, qint64> children;
+
+    const QStringList entries = QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        bool ok = false;
+        const qint64 child = entry.toLongLong(&ok);
+        if (!ok) {
+            continue;
+        }
+
+        const QList<QByteArray> fields = statFields(entry);
+        if (fields.size() > ParentField) {
+            children.insert(fields.at(ParentField).toLongLong(), child);
+        }
+    }
+
+    QVector<qint64> result;
+    QVector<qint64> queue = {pid};
+    while (!queue.isEmpty()) {
+        const qint64 parent = queue.takeLast();
+        const QList<qint64> direct = children.values(parent);
+        for (qint64 child : direct) {
+            result.append(child);
+            queue.append(child);
+        }
+    }
+
+    return result;
+}
+
+void FlatpakProcess::setupChildProcess()
+{
+    // Wywoływane w procesie potomnym między fork() a exec()
+    ::setpgid(0, 0);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file flatpakprocess.h
+ * @brief Proces flatpak-builder uruchamiany we własnej grupie procesów
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKPROCESS_H
+#define FLATPAKPROCESS_H
+
+#include <QProcess>
+#include <QVector>
+
+/**
+ * @class FlatpakProcess
+ * @brief QProcess, który potrafi zakończyć całe drzewo swoich potomków
+ *
+ * Proces potomny zakłada własną grupę procesów, więc sygnał wysłany do grupy
+ * dociera do kompilatorów uruchomionych przez flatpak-builder. Procesy
+ * w piaskownicy bwrap często zakładają nową sesję, dlatego dodatkowo
+ * zbierane są wszyscy potomkowie z /proc.
+ */
+class FlatpakProcess : public QProcess
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param parent Obiekt rodzica
+     */
+    explicit FlatpakProcess(QObject* parent = nullptr);
+
+    /**
+     * Destruktor
+     */
+    ~FlatpakProcess() override;
+
+    /**
+     * Proces zapamiętany razem z czasem startu - identyfikator procesu może
+     * zostać użyty ponownie, gdy proces się zakończy
+     */
+    struct ProcessId {
+        qint64 pid = 0;
+        quint64 startTime = 0;  ///< Pole 22 z /proc/<pid>/stat (takty zegara od startu systemu)
+    };
+
+    /**
+     * @brief Wysyła sygnał do grupy procesów i wszystkich potomków
+     * @param signal Numer sygnału (np. SIGTERM)
+     * @return Lista procesów, do których wysłano sygnał
+     */
+    QVector<ProcessId> signalTree(int signal);
+
+    /**
+     * @brief Wysyła sygnał do podanych procesów, które nadal istnieją
+     *
+     * Proces, którego czas startu różni się od zapamiętanego, to już inny
+     * proces z tym samym identyfikatorem - jest pomijany.
+     *
+     * @param processes Lista procesów
+     * @param signal Numer sygnału
+     */
+    static void signalProcesses(const QVector<ProcessId>& processes, int signal);
+
+    /**
+     * @brief Zwraca czas startu procesu albo 0, jeśli proces nie istnieje
+     * @param pid Identyfikator procesu
+     */
+    static quint64 startTime(qint64 pid);
+
+    /**
+     * @brief Zwraca wszystkich potomków procesu na podstawie /proc
+     * @param pid Proces główny
+     * @return Lista identyfikatorów potomków
+     */
+    static QVector<qint64> descendants(qint64 pid);
+
+protected:
+    /**
+     * @brief Przenosi proces potomny do nowej grupy procesów
+     */
+    void setupChildProcess() override;
+};
+
+#endif // FLATPAKPROCESS_H
@@ -0,0 +1,201 @@
+/**
+ * @file flatpakprofilejob.cpp
+ * @brief Implementacja zadania profilowania aplikacji w piaskownicy
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakprofilejob.h"
+#include "flatpakbuilderplugin.h"
+#include "flatpakbuilderconfig.h"
+#include "flatpakmanifestscanner.h"
+
+#include <interfaces/icore.h>
+#include <interfaces/idocumentcontroller.h>
+#include <interfaces/iproject.h>
+#include <interfaces/iuicontroller.h>
+
+#include <KLocalizedString>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+namespace {
+    // Katalog wyników w projekcie
+    const QString ProfileDirName = QStringLiteral(".flatpak-profile");
+
+    // Funkcje poniżej tego udziału są pomijane w podsumowaniu perf
+    const QString PerfPercentLimit = QStringLiteral("0.5");
+}
+
+FlatpakProfileJob::FlatpakProfileJob(FlatpakBuilderPlugin* parent, KDevelop::IProject* project,
+                                     const QString& manifestPath, Profiler profiler)
+    : KDevelop::OutputExecuteJob(parent)
+    , m_plugin(parent)
+    , m_project(project)
+    , m_manifestPath(manifestPath)
+    , m_profiler(profiler)
+    , m_summaryProcess(nullptr)
+{
+    switch (m_profiler) {
+        case Perf:
+            setJobName(i18n("Flatpak perf: %1", project->name()));
+            break;
+        case Heaptrack:
+            setJobName(i18n("Flatpak heaptrack: %1", project->name()));
+            break;
+        case Massif:
+            setJobName(i18n("Flatpak Massif: %1", project->name()));
+            break;
+    }
+
+    setStandardToolView(KDevelop::IOutputView::RunView);
+    setBehaviours(KDevelop::IOutputView::AllowUserClose | KDevelop::IOutputView::AutoScroll);
+    setProperties(KDevelop::OutputExecuteJob::JobProperty::DisplayStdout
+                  | KDevelop::OutputExecuteJob::JobProperty::DisplayStderr
+                  | KDevelop::OutputExecuteJob::JobProperty::Killable);
+    setWorkingDirectory(QUrl::fromLocalFile(project->path().toLocalFile()));
+
+    m_outputDir = QDir(project->path().toLocalFile()).filePath(ProfileDirName);
+}
+
+QString FlatpakProfileJob::outputFile() const
+{
+    return m_outputFile;
+}
+
+void FlatpakProfileJob::start()
+{
+    m_appId = FlatpakManifestScanner::topLevelValue(m_manifestPath, "id");
+    const QString command = FlatpakManifestScanner::topLevelValue(m_manifestPath, "command");
+    if (m_appId.isEmpty() || command.isEmpty()) {
+        setError(1);
+        setErrorText(i18n("The manifest %1 does not define the application id and command.", m_manifestPath));
+        emitResult();
+        return;
+    }
+
+    if (!QDir().mkpath(m_outputDir)) {
+        setError(2);
+        setErrorText(i18n("Could not create the profile directory: %1", m_outputDir));
+        emitResult();
+        return;
+    }
+
+    // Ścieżki są takie same w piaskownicy i na hoście dzięki --filesystem
+    const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    QStringList profilerArgs;
+    QString tool;
+    switch (m_profiler) {
+        case Perf:
+            tool = "perf";
+            m_outputFile = QDir(m_outputDir).filePath(QString("perf-%1.data").arg(stamp));
+            profilerArgs << "record" << "--call-graph=dwarf" << "-o" << m_outputFile << "--" << command;
+            break;
+        case Heaptrack:
+            tool = "heaptrack";
+            m_outputFile = QDir(m_outputDir).filePath(QString("heaptrack-%1").arg(stamp));
+            profilerArgs << "-o" << m_outputFile << command;
+            break;
+        case Massif:
+            tool = "valgrind";
+            m_outputFile = QDir(m_outputDir).filePath(QString("massif-%1.out").arg(stamp));
+            profilerArgs << "--tool=massif" << "--massif-out-file=" + m_outputFile << command;
+            break;
+    }
+
+    *this << sandboxCommand(tool, profilerArgs);
+    KDevelop::OutputExecuteJob::start();
+}
+
+QStringList FlatpakProfileJob::sandboxCommand(const QString& tool, const QStringList& arguments) const
+{
+    // Profilowana jest zainstalowana aplikacja, a nie katalog budowania,
+    // żeby wyniki odpowiadały temu, co trafia do użytkowników
+    QStringList commandLine;
+    commandLine << m_plugin->config()->flatpakPath() << "run" << "--devel"
+                << "--filesystem=" + m_outputDir << "--command=" + tool << m_appId << arguments;
+    return commandLine;
+}
+
+QString FlatpakProfileJob::findOutputFile() const
+{
+    if (QFileInfo::exists(m_outputFile)) {
+        return m_outputFile;
+    }
+
+    // heaptrack zapisuje <nazwa>.gz lub <nazwa>.zst w zależności od wersji
+    const QFileInfo base(m_outputFile);
+    const QFileInfoList candidates = QDir(m_outputDir).entryInfoList({base.fileName() + ".*"}, QDir::Files, QDir::Time);
+    return candidates.isEmpty() ? QString() : candidates.first().absoluteFilePath();
+}
+
+void FlatpakProfileJob::childProcessExited(int exitCode)
+{
+    // Aplikacja może zakończyć się błędem, a profil i tak jest kompletny
+    const QString file = findOutputFile();
+    if (file.isEmpty()) {
+        KDevelop::OutputExecuteJob::childProcessExited(exitCode);
+        return;
+    }
+    m_outputFile = file;
+
+    QString viewer;
+    QStringList summaryArgs;
+    QString summaryTool;
+    switch (m_profiler) {
+        case Perf:
+            viewer = "hotspot";
+            summaryTool = "perf";
+            summaryArgs << "report" << "--stdio" << "--no-children" << "--percent-limit" << PerfPercentLimit
+                        << "-i" << m_outputFile;
+            break;
+        case Heaptrack:
+            viewer = "heaptrack_gui";
+            summaryTool = "heaptrack_print";
+            summaryArgs << m_outputFile;
+            break;
+        case Massif:
+            viewer = "massif-visualizer";
+            summaryTool = "ms_print";
+            summaryArgs << m_outputFile;
+            break;
+    }
+
+    // Przeglądarka z hosta czyta plik bezpośrednio z katalogu projektu
+    const QString viewerPath = QStandardPaths::findExecutable(viewer);
+    if (!viewerPath.isEmpty() && QProcess::startDetached(viewerPath, {m_outputFile})) {
+        KDevelop::OutputExecuteJob::childProcessExited(0);
+        return;
+    }
+
+    // Bez przeglądarki podsumowanie generuje narzędzie z SDK, w tej samej piaskownicy
+    const QStringList commandLine = sandboxCommand(summaryTool, summaryArgs);
+    m_summaryProcess = new QProcess(this);
+    m_summaryProcess->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_summaryProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &FlatpakProfileJob::slotSummaryFinished);
+    m_summaryProcess->start(commandLine.first(), commandLine.mid(1));
+}
+
+void FlatpakProfileJob::slotSummaryFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    Q_UNUSED(exitStatus);
+
+    const QString summary = QString::fromUtf8(m_summaryProcess->readAll());
+    m_summaryProcess->deleteLater();
+    m_summaryProcess = nullptr;
+
+    if (exitCode == 0 && !summary.isEmpty()) {
+        KDevelop::ICore::self()->documentController()->openDocumentFromText(
+            i18n("Profile: %1", m_outputFile) + "\n\n" + summary);
+    } else {
+        KDevelop::ICore::self()->uiController()->showErrorMessage(
+            i18n("The profile was saved to %1, but no viewer is installed and the summary could not be generated.",
+                 m_outputFile));
+    }
+
+    KDevelop::OutputExecuteJob::childProcessExited(0);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file flatpakprofilejob.h
+ * @brief Zadanie uruchamiające zainstalowaną aplikację pod profilerem w piaskownicy
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKPROFILEJOB_H
+#define FLATPAKPROFILEJOB_H
+
+#include <outputview/outputexecutejob.h>
+
+#include <QProcess>
+
+class FlatpakBuilderPlugin;
+
+namespace KDevelop {
+    class IProject;
+}
+
+/**
+ * @class FlatpakProfileJob
+ * @brief Profiluje aplikację w tym samym runtime, w którym jest dostarczana
+ *
+ * Aplikacja jest uruchamiana przez "flatpak run --devel --command=<profiler>".
+ * Tryb --devel podmienia runtime na SDK tej samej wersji, w którym są perf
+ * i valgrind, i zezwala na perf_event_open oraz ptrace. Katalog wyników
+ * w projekcie (.flatpak-profile/) jest udostępniany piaskownicy, więc plik
+ * profilu trafia od razu do projektu.
+ *
+ * Po zakończeniu plik otwiera przeglądarka z hosta (hotspot, heaptrack_gui,
+ * massif-visualizer), a gdy jej nie ma, podsumowanie tekstowe wygenerowane
+ * w piaskownicy otwiera się w edytorze.
+ */
+class FlatpakProfileJob : public KDevelop::OutputExecuteJob
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Obsługiwane profilery
+     */
+    enum Profiler {
+        Perf,       ///< perf record - czas procesora
+        Heaptrack,  ///< heaptrack - alokacje pamięci
+        Massif      ///< valgrind --tool=massif - sterta w czasie
+    };
+
+    /**
+     * Konstruktor
+     *
+     * @param parent Obiekt rodzica (plugin)
+     * @param project Projekt, do którego trafia plik profilu
+     * @param manifestPath Manifest z identyfikatorem aplikacji i poleceniem
+     * @param profiler Profiler
+     */
+    FlatpakProfileJob(FlatpakBuilderPlugin* parent, KDevelop::IProject* project,
+                      const QString& manifestPath, Profiler profiler);
+
+    /**
+     * @brief Zwraca plik z wynikami profilowania
+     */
+    QString outputFile() const;
+
+    /**
+     * @brief Uruchamia aplikację pod profilerem
+     */
+    void start() override;
+
+protected:
+    /**
+     * @brief Otwiera wynik w przeglądarce lub generuje podsumowanie
+     * @param exitCode Kod wyjścia aplikacji
+     */
+    void childProcessExited(int exitCode) override;
+
+private Q_SLOTS:
+    /**
+     * @brief Otwiera tekstowe podsumowanie profilu w edytorze
+     */
+    void slotSummaryFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    /**
+     * @brief Zwraca polecenie "flatpak run" uruchamiające narzędzie w piaskownicy aplikacji
+     * @param tool Program z SDK
+     * @param arguments Argumenty programu
+     */
+    QStringList sandboxCommand(const QString& tool, const QStringList& arguments) const;
+
+    /**
+     * @brief Szuka pliku wyników (heaptrack sam dokleja rozszerzenie)
+     */
+    QString findOutputFile() const;
+
+    FlatpakBuilderPlugin* m_plugin;
+    KDevelop::IProject* m_project;
+    QString m_manifestPath;
+    Profiler m_profiler;
+    QString m_appId;
+    QString m_outputDir;
+    QString m_outputFile;
+    QProcess* m_summaryProcess;
+};
+
+#endif // FLATPAKPROFILEJOB_H
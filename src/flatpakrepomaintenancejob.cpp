@@ -0,0 +1,257 @@
+/**
+ * @file flatpakrepomaintenancejob.cpp
+ * @brief Implementacja utrzymania repozytorium eksportu w tle
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakrepomaintenancejob.h"
+#include "flatpakbuilderconfig.h"
+#include "flatpakbuilderplugin.h"
+#include "flatpakprocess.h"
+#include "flatpakresourcelimits.h"
+
+#include <KLocalizedString>
+
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QLocale>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+#include <csignal>
+
+namespace {
+    // Utrzymanie ustępuje budowaniu (waga 20) i IDE (waga 100)
+    const int MaintenanceWeight = 10;
+
+    // Tyle ostatnich linii wyjścia trafia do komunikatu o błędzie
+    const int ErrorTailLines = 20;
+
+    struct RepoSizes {
+        qint64 repoSize = 0;
+        qint64 deltaSize = 0;
+        qint64 largestDelta = 0;
+        int deltaCount = 0;
+    };
+}
+
+FlatpakRepoMaintenanceJob::FlatpakRepoMaintenanceJob(FlatpakBuilderPlugin* plugin, const QString& repoPath)
+    : KJob(plugin)
+    , m_plugin(plugin)
+    , m_repo(repoPath)
+    , m_repoPath(repoPath)
+    , m_ostreePath(QStandardPaths::findExecutable("ostree"))
+    , m_stage(Prune)
+    , m_process(nullptr)
+    , m_generatedDeltas(0)
+{
+    setObjectName(i18n("Flatpak Repository Maintenance"));
+    setCapabilities(KJob::Killable);
+}
+
+void FlatpakRepoMaintenanceJob::start()
+{
+    if (!m_repo.isValid()) {
+        fail(i18n("%1 is not an OSTree repository.", m_repoPath));
+        return;
+    }
+
+    setTotalAmount(KJob::Items, Finished);
+    setProcessedAmount(KJob::Items, 0);
+    QMetaObject::invokeMethod(this, "runStage", Qt::QueuedConnection);
+}
+
+QString FlatpakRepoMaintenanceJob::repoPath() const
+{
+    return m_repoPath;
+}
+
+QString FlatpakRepoMaintenanceJob::summary() const
+{
+    return m_summary;
+}
+
+bool FlatpakRepoMaintenanceJob::doKill()
+{
+    m_stage = Finished;
+
+    if (m_process) {
+        disconnect(m_process, nullptr, this, nullptr);
+        m_process->signalTree(SIGTERM);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+    return true;
+}
+
+void FlatpakRepoMaintenanceJob::runStage()
+{
+    setProcessedAmount(KJob::Items, m_stage);
+    FlatpakBuilderConfig* config = m_plugin->config();
+
+    switch (m_stage) {
+        case Prune:
+            runProcess(config->flatpakPath(), m_repo.pruneArguments(config->exportRetention(), m_ostreePath.isEmpty()));
+            break;
+
+        case ReadHistory:
+            if (m_ostreePath.isEmpty()) {
+                advance(Report);
+            } else if (m_refs.isEmpty()) {
+                advance(GenerateDeltas);
+            } else {
+                runProcess(m_ostreePath, m_repo.logArguments(m_refs.first()));
+            }
+            break;
+
+        case GenerateDeltas:
+            if (m_missingDeltas.isEmpty()) {
+                advance(m_generatedDeltas > 0 ? RefreshSummary : Report);
+            } else {
+                const QPair<QString, QString> delta = m_missingDeltas.first();
+                runProcess(m_ostreePath, m_repo.deltaArguments(delta.first, delta.second));
+            }
+            break;
+
+        case RefreshSummary:
+            // Podsumowanie zawiera indeks delt, bez niego klienci ich nie znajdą
+            runProcess(config->flatpakPath(), m_repo.summaryArguments());
+            break;
+
+        case Report: {
+            const FlatpakExportRepo repo = m_repo;
+            auto* watcher = new QFutureWatcher<RepoSizes>(this);
+            connect(watcher, &QFutureWatcher<RepoSizes>::finished, this, &FlatpakRepoMaintenanceJob::reportReady);
+            watcher->setFuture(QtConcurrent::run([repo]() {
+                RepoSizes sizes;
+                sizes.repoSize = repo.size();
+                for (const FlatpakExportRepo::Delta& delta : repo.deltas()) {
+                    sizes.deltaSize += delta.size;
+                    sizes.largestDelta = qMax(sizes.largestDelta, delta.size);
+                    ++sizes.deltaCount;
+                }
+                return sizes;
+            }));
+            break;
+        }
+
+        case Finished:
+            emitResult();
+            break;
+    }
+}
+
+void FlatpakRepoMaintenanceJob::runProcess(const QString& program, const QStringList& args)
+{
+    m_process = new FlatpakProcess(this);
+    m_process->setProcessChannelMode(QProcess::MergedChannels);
+    m_process->setProgram(program);
+    m_process->setArguments(args);
+
+    FlatpakResourceLimits::Settings settings;
+    settings.enabled = true;
+    settings.cpuWeight = MaintenanceWeight;
+    settings.ioWeight = MaintenanceWeight;
+    FlatpakResourceLimits(settings).apply(m_process, QString("kdev-flatpak-repo-%1").arg(QDateTime::currentMSecsSinceEpoch()));
+
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &FlatpakRepoMaintenanceJob::processFinished);
+    m_process->start();
+}
+
+void FlatpakRepoMaintenanceJob::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    const QString output = QString::fromUtf8(m_process->readAll());
+    m_process->deleteLater();
+    m_process = nullptr;
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        const QStringList lines = output.split('\n', QString::SkipEmptyParts);
+        fail(i18n("Repository maintenance failed with code %1:\n%2", exitCode,
+                  QStringList(lines.mid(qMax(0, lines.size() - ErrorTailLines))).join('\n')));
+        return;
+    }
+
+    switch (m_stage) {
+        case Prune:
+            m_refs = m_repo.refs();
+            advance(ReadHistory);
+            break;
+
+        case ReadHistory: {
+            // Indeks 0 to bieżący commit, dalej jego poprzednicy po przycięciu
+            const QStringList commits = FlatpakExportRepo::parseLog(output);
+            const int depth = m_plugin->config()->exportDeltaDepth();
+            if (!commits.isEmpty()) {
+                const QString head = commits.first();
+                if (!m_repo.hasDelta(QString(), head)) {
+                    m_missingDeltas.append(qMakePair(QString(), head));
+                }
+                for (int i = 1; i <= depth && i < commits.size(); ++i) {
+                    if (!m_repo.hasDelta(commits.at(i), head)) {
+                        m_missingDeltas.append(qMakePair(commits.at(i), head));
+                    }
+                }
+            }
+            m_refs.removeFirst();
+            advance(ReadHistory);
+            break;
+        }
+
+        case GenerateDeltas:
+            m_missingDeltas.removeFirst();
+            ++m_generatedDeltas;
+            advance(GenerateDeltas);
+            break;
+
+        case RefreshSummary:
+            advance(Report);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void FlatpakRepoMaintenanceJob::reportReady()
+{
+    auto* watcher = static_cast<QFutureWatcher<RepoSizes>*>(sender());
+    const RepoSizes sizes = watcher->result();
+    watcher->deleteLater();
+
+    if (m_stage == Finished) {
+        return;
+    }
+
+    const QLocale locale;
+    QStringList parts;
+    parts << i18n("Export repository: %1", locale.formattedDataSize(sizes.repoSize));
+    parts << i18np("%1 static delta, %2 (largest %3)", "%1 static deltas, %2 (largest %3)", sizes.deltaCount,
+                   locale.formattedDataSize(sizes.deltaSize), locale.formattedDataSize(sizes.largestDelta));
+    if (m_generatedDeltas > 0) {
+        parts << i18np("%1 new delta", "%1 new deltas", m_generatedDeltas);
+    }
+    if (m_ostreePath.isEmpty()) {
+        parts << i18n("install ostree for deltas from older commits");
+    }
+    m_summary = parts.join("; ");
+
+    m_stage = Finished;
+    setProcessedAmount(KJob::Items, Finished);
+    emitResult();
+}
+
+void FlatpakRepoMaintenanceJob::advance(Stage stage)
+{
+    m_stage = stage;
+    QMetaObject::invokeMethod(this, "runStage", Qt::QueuedConnection);
+}
+
+void FlatpakRepoMaintenanceJob::fail(const QString& message)
+{
+    m_stage = Finished;
+    setError(KJob::UserDefinedError);
+    setErrorText(message);
+    emitResult();
+}
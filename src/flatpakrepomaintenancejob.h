@@ -0,0 +1,99 @@
+/**
+ * @file flatpakrepomaintenancejob.h
+ * @brief Zadanie utrzymania repozytorium eksportu w tle
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKREPOMAINTENANCEJOB_H
+#define FLATPAKREPOMAINTENANCEJOB_H
+
+#include "flatpakexportrepo.h"
+
+#include <KJob>
+
+#include <QPair>
+#include <QProcess>
+#include <QStringList>
+#include <QVector>
+
+class FlatpakBuilderPlugin;
+class FlatpakProcess;
+
+/**
+ * @class FlatpakRepoMaintenanceJob
+ * @brief Przycina historię repozytorium eksportu i generuje delty statyczne
+ *
+ * Polecenia działają po kolei z niską wagą CPU i IO, więc utrzymanie nie
+ * spowalnia edytora ani kolejnego budowania. Kolejność kroków opisuje
+ * FlatpakExportRepo. Na końcu liczony jest rozmiar repozytorium i delt.
+ */
+class FlatpakRepoMaintenanceJob : public KJob
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Etap utrzymania
+     */
+    enum Stage {
+        Prune,
+        ReadHistory,
+        GenerateDeltas,
+        RefreshSummary,
+        Report,
+        Finished
+    };
+
+    /**
+     * Konstruktor
+     *
+     * @param plugin Wtyczka
+     * @param repoPath Repozytorium utworzone przez "flatpak build-export"
+     */
+    FlatpakRepoMaintenanceJob(FlatpakBuilderPlugin* plugin, const QString& repoPath);
+
+    /**
+     * @brief Uruchamia pierwszy etap
+     */
+    void start() override;
+
+    /**
+     * @brief Zwraca ścieżkę repozytorium
+     */
+    QString repoPath() const;
+
+    /**
+     * @brief Zwraca podsumowanie rozmiarów do wyświetlenia
+     */
+    QString summary() const;
+
+protected:
+    /**
+     * @brief Przerywa bieżące polecenie
+     */
+    bool doKill() override;
+
+private Q_SLOTS:
+    void runStage();
+    void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void reportReady();
+
+private:
+    void runProcess(const QString& program, const QStringList& args);
+    void advance(Stage stage);
+    void fail(const QString& message);
+
+    FlatpakBuilderPlugin* m_plugin;
+    FlatpakExportRepo m_repo;
+    QString m_repoPath;
+    QString m_ostreePath;
+    Stage m_stage;
+    FlatpakProcess* m_process;
+    QStringList m_refs;
+    QVector<QPair<QString, QString>> m_missingDeltas;
+    int m_generatedDeltas;
+    QString m_summary;
+};
+
+#endif // FLATPAKREPOMAINTENANCEJOB_H
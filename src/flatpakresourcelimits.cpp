@@ -0,0 +1,257 @@
+/**
+ * @file flatpakresourcelimits.cpp
+ * @brief Implementacja ograniczania zasobów procesu budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakresourcelimits.h"
+#include "flatpakprocess.h"
+
+#include <KLocalizedString>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QProcess>
+#include <QStandardPaths>
+
+#include <cmath>
+#include <unistd.h>
+
+namespace {
+    // Prefiks jednostek systemd tworzonych przez wtyczkę
+    const QString UnitPrefix = QStringLiteral("kdev-flatpak-");
+
+    QByteArray readProcFile(const QString& path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QByteArray();
+        }
+        return file.readAll();
+    }
+}
+
+FlatpakResourceLimits::FlatpakResourceLimits(const Settings& settings)
+    : m_method(NoLimits)
+    , m_settings(settings)
+{
+    if (m_settings.enabled) {
+        m_method = systemdScopeAvailable() ? SystemdScope : Nice;
+    }
+}
+
+FlatpakResourceLimits::Method FlatpakResourceLimits::method() const
+{
+    return m_method;
+}
+
+void FlatpakResourceLimits::apply(QProcess* process, const QString& unitName) const
+{
+    QStringList args;
+
+    switch (m_method) {
+        case NoLimits:
+            return;
+
+        case SystemdScope:
+            // Zakres nie uruchamia procesu w tle - systemd-run sam wykonuje exec,
+            // więc PID, potoki i grupa procesów pozostają takie same
+            args << "--user" << "--scope" << "--quiet" << "--collect";
+            args << "--unit=" + unitName;
+            args << "-p" << QString("CPUWeight=%1").arg(m_settings.cpuWeight);
+            args << "-p" << QString("IOWeight=%1").arg(m_settings.ioWeight);
+            if (m_settings.memoryHighMiB > 0) {
+                args << "-p" << QString("MemoryHigh=%1M").arg(m_settings.memoryHighMiB);
+            }
+            if (m_settings.memoryMaxMiB > 0) {
+                args << "-p" << QString("MemoryMax=%1M").arg(m_settings.memoryMaxMiB);
+            }
+            args << "--" << process->program() << process->arguments();
+            process->setProgram(QStandardPaths::findExecutable("systemd-run"));
+            break;
+
+        case Nice: {
+            args << "-n" << QString::number(niceLevel(m_settings.cpuWeight));
+
+            // Klasa "best effort" z priorytetem zależnym od wagi IO; klasa
+            // "idle" mogłaby zagłodzić budowanie przy stale zajętym dysku
+            const QString ionice = QStandardPaths::findExecutable("ionice");
+            if (!ionice.isEmpty()) {
+                args << ionice << "-c" << "2" << "-n" << QString::number(qBound(0, niceLevel(m_settings.ioWeight) * 7 / 19 + 4, 7));
+            }
+
+            args << process->program() << process->arguments();
+            process->setProgram(QStandardPaths::findExecutable("nice"));
+            break;
+        }
+    }
+
+    process->setArguments(args);
+}
+
+bool FlatpakResourceLimits::systemdScopeAvailable()
+{
+    if (QStandardPaths::findExecutable("systemd-run").isEmpty()) {
+        return false;
+    }
+
+    // Menedżer użytkownika systemd nasłuchuje na prywatnym gnieździe
+    const QByteArray runtimeDir = qgetenv("XDG_RUNTIME_DIR");
+    return !runtimeDir.isEmpty()
+        && QFileInfo::exists(QString::fromLocal8Bit(runtimeDir) + "/systemd/private");
+}
+
+int FlatpakResourceLimits::niceLevel(int cpuWeight)
+{
+    // Jądro zmienia wagę procesu o ok. 25% na każdy poziom nice
+    if (cpuWeight >= 100) {
+        return 0;
+    }
+    const double level = std::log(100.0 / qMax(1, cpuWeight)) / std::log(1.25);
+    return qBound(0, static_cast<int>(std::lround(level)), 19);
+}
+
+FlatpakResourceMonitor::FlatpakResourceMonitor(qint64 pid)
+    : m_pid(pid)
+    , m_ownCgroup(unifiedCgroup(readProcFile(QStringLiteral("/proc/self/cgroup"))))
+    , m_lastCpuMicros(-1)
+{
+}
+
+QByteArray FlatpakResourceMonitor::unifiedCgroup(const QByteArray& contents)
+{
+    const QList<QByteArray> lines = contents.split('\n');
+    for (const QByteArray& line : lines) {
+        if (line.startsWith("0::")) {
+            return line.mid(3).trimmed();
+        }
+    }
+    return QByteArray();
+}
+
+void FlatpakResourceMonitor::resolveCgroup()
+{
+    // systemd-run przenosi się do zakresu dopiero po starcie, więc do tego
+    // czasu proces jest jeszcze w cgroup IDE. Tylko zakres utworzony przez
+    // wtyczkę - inaczej pomiar obejmowałby całe IDE
+    const QByteArray cgroup = unifiedCgroup(readProcFile(QString("/proc/%1/cgroup").arg(m_pid)));
+    if (cgroup.isEmpty() || cgroup == m_ownCgroup) {
+        return;
+    }
+    if (cgroup.contains(UnitPrefix.toLatin1()) && cgroup.endsWith(".scope")) {
+        m_cgroupPath = "/sys/fs/cgroup" + QString::fromLocal8Bit(cgroup);
+        m_lastCpuMicros = -1;
+    }
+}
+
+bool FlatpakResourceMonitor::sample(double* cpuPercent, qint64* memoryBytes)
+{
+    if (m_cgroupPath.isEmpty()) {
+        resolveCgroup();
+    }
+
+    qint64 cpuMicros = 0;
+    const bool ok = m_cgroupPath.isEmpty()
+        ? readProcTree(&cpuMicros, memoryBytes)
+        : readCgroup(&cpuMicros, memoryBytes);
+    if (!ok) {
+        return false;
+    }
+
+    // Potomek przejęty przez init zabiera swój czas z sumy drzewa - licznik
+    // nie może się cofać, bo dałby ujemne użycie
+    *cpuPercent = 0.0;
+    if (m_lastCpuMicros >= 0 && m_timer.isValid()) {
+        const qint64 elapsedMicros = m_timer.nsecsElapsed() / 1000;
+        if (elapsedMicros > 0 && cpuMicros > m_lastCpuMicros) {
+            *cpuPercent = 100.0 * (cpuMicros - m_lastCpuMicros) / elapsedMicros;
+        }
+    }
+
+    m_lastCpuMicros = qMax(cpuMicros, m_lastCpuMicros);
+    m_timer.restart();
+    return true;
+}
+
+QString FlatpakResourceMonitor::describe(double* cpuPercent, qint64* memoryBytes)
+{
+    double cpu = 0.0;
+    qint64 memory = 0;
+    if (!sample(&cpu, &memory)) {
+        return QString();
+    }
+
+    if (cpuPercent) {
+        *cpuPercent = cpu;
+    }
+    if (memoryBytes) {
+        *memoryBytes = memory;
+    }
+
+    return i18n("CPU %1%, memory %2",
+                QString::number(qRound(cpu)),
+                QLocale().formattedDataSize(memory));
+}
+
+bool FlatpakResourceMonitor::readCgroup(qint64* cpuMicros, qint64* memoryBytes) const
+{
+    const QByteArray memory = readProcFile(m_cgroupPath + "/memory.current");
+    const QByteArray cpuStat = readProcFile(m_cgroupPath + "/cpu.stat");
+    if (memory.isEmpty() || cpuStat.isEmpty()) {
+        return false;
+    }
+
+    *memoryBytes = memory.trimmed().toLongLong();
+
+    *cpuMicros = 0;
+    const QList<QByteArray> lines = cpuStat.split('\n');
+    for (const QByteArray& line : lines) {
+        if (line.startsWith("usage_usec ")) {
+            *cpuMicros = line.mid(11).toLongLong();
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool FlatpakResourceMonitor::readProcTree(qint64* cpuMicros, qint64* memoryBytes) const
+{
+    QVector<qint64> pids = FlatpakProcess::descendants(m_pid);
+    pids.prepend(m_pid);
+
+    const qint64 ticksPerSecond = sysconf(_SC_CLK_TCK);
+    const qint64 pageSize = sysconf(_SC_PAGESIZE);
+
+    *cpuMicros = 0;
+    *memoryBytes = 0;
+    bool found = false;
+
+    for (qint64 pid : qAsConst(pids)) {
+        const QByteArray stat = readProcFile(QString("/proc/%1/stat").arg(pid));
+        const int commEnd = stat.lastIndexOf(')');
+        if (commEnd < 0) {
+            continue;
+        }
+
+        // Po nazwie: stan, ppid, ..., utime, stime, cutime, cstime (pola 14-17).
+        // cutime/cstime zawierają czas zakończonych kompilatorów, na które
+        // czekał rodzic - bez nich suma spadałaby po każdym wyjściu potomka
+        const QList<QByteArray> fields = stat.mid(commEnd + 2).split(' ');
+        if (fields.size() > 14) {
+            const qint64 ticks = fields.at(11).toLongLong() + fields.at(12).toLongLong()
+                + fields.at(13).toLongLong() + fields.at(14).toLongLong();
+            *cpuMicros += ticks * 1000000 / ticksPerSecond;
+            found = true;
+        }
+
+        const QList<QByteArray> statm = readProcFile(QString("/proc/%1/statm").arg(pid)).split(' ');
+        if (statm.size() > 1) {
+            *memoryBytes += statm.at(1).toLongLong() * pageSize;
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file flatpakresourcelimits.h
+ * @brief Ograniczanie zasobów procesu budowania i pomiar ich zużycia
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKRESOURCELIMITS_H
+#define FLATPAKRESOURCELIMITS_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+
+class QProcess;
+
+/**
+ * @class FlatpakResourceLimits
+ * @brief Uruchamia proces budowania z obniżonym priorytetem
+ *
+ * Jeśli dostępny jest systemd w sesji użytkownika, proces trafia do
+ * tymczasowego zakresu (scope) z wagami CPU i IO oraz limitami pamięci.
+ * Waga działa tylko przy rywalizacji o zasoby, więc bezczynne rdzenie są
+ * nadal w pełni wykorzystywane. Bez systemd pozostaje nice/ionice.
+ */
+class FlatpakResourceLimits
+{
+public:
+    /**
+     * Sposób ograniczenia zasobów
+     */
+    enum Method {
+        NoLimits,       ///< Proces działa bez ograniczeń
+        SystemdScope,   ///< Tymczasowy zakres systemd (cgroup v2)
+        Nice            ///< Obniżony priorytet CPU i IO
+    };
+
+    /**
+     * Wartości limitów (wagi 1-10000, IDE ma wagę 100; pamięć 0 = bez limitu)
+     */
+    struct Settings {
+        bool enabled = false;
+        int cpuWeight = 20;
+        int ioWeight = 20;
+        int memoryHighMiB = 0;
+        int memoryMaxMiB = 0;
+    };
+
+    /**
+     * Konstruktor
+     *
+     * @param settings Wartości limitów
+     */
+    explicit FlatpakResourceLimits(const Settings& settings);
+
+    /**
+     * @brief Zwraca sposób, w jaki zostaną zastosowane ograniczenia
+     */
+    Method method() const;
+
+    /**
+     * @brief Opakowuje program procesu w systemd-run albo nice/ionice
+     *
+     * Musi zostać wywołane po ustawieniu programu i argumentów.
+     *
+     * @param process Proces przed uruchomieniem
+     * @param unitName Nazwa jednostki systemd dla zakresu
+     */
+    void apply(QProcess* process, const QString& unitName) const;
+
+    /**
+     * @brief Sprawdza, czy można tworzyć zakresy w systemd użytkownika
+     */
+    static bool systemdScopeAvailable();
+
+    /**
+     * @brief Przelicza wagę CPU (1-10000, domyślnie 100) na poziom nice
+     */
+    static int niceLevel(int cpuWeight);
+
+private:
+    Method m_method;
+    Settings m_settings;
+};
+
+/**
+ * @class FlatpakResourceMonitor
+ * @brief Mierzy zużycie CPU i pamięci przez drzewo procesów budowania
+ *
+ * Dla procesu w zakresie systemd dane pochodzą z plików cgroup, które
+ * obejmują wszystkie procesy zakresu. W przeciwnym razie sumowane są
+ * wartości z /proc dla procesu i jego potomków, razem z czasem CPU
+ * zakończonych potomków.
+ *
+ * Odczyt przechodzi po /proc, więc powinien działać poza wątkiem GUI;
+ * w danej chwili może trwać tylko jedno wywołanie sample().
+ */
+class FlatpakResourceMonitor
+{
+public:
+    /**
+     * Konstruktor
+     *
+     * @param pid Identyfikator głównego procesu budowania
+     */
+    explicit FlatpakResourceMonitor(qint64 pid);
+
+    /**
+     * @brief Odczytuje bieżące zużycie zasobów
+     *
+     * Użycie CPU liczone jest od poprzedniego wywołania, więc pierwsze
+     * wywołanie zwraca 0%.
+     *
+     * @param cpuPercent Użycie CPU w procentach jednego rdzenia
+     * @param memoryBytes Zajęta pamięć
+     * @return false jeśli proces już nie istnieje
+     */
+    bool sample(double* cpuPercent, qint64* memoryBytes);
+
+    /**
+     * @brief Zwraca czytelny opis zużycia do wyświetlenia w statusie zadania
+     *
+     * @param cpuPercent Opcjonalnie: miejsce na zmierzone użycie CPU
+     * @param memoryBytes Opcjonalnie: miejsce na zmierzoną pamięć
+     */
+    QString describe(double* cpuPercent = nullptr, qint64* memoryBytes = nullptr);
+
+private:
+    static QByteArray unifiedCgroup(const QByteArray& contents);
+    void resolveCgroup();
+    bool readCgroup(qint64* cpuMicros, qint64* memoryBytes) const;
+    bool readProcTree(qint64* cpuMicros, qint64* memoryBytes) const;
+
+    qint64 m_pid;
+    QByteArray m_ownCgroup;     ///< cgroup IDE - proces jest w nim do przeniesienia
+    QString m_cgroupPath;
+    qint64 m_lastCpuMicros;
+    QElapsedTimer m_timer;
+};
+
+#endif // FLATPAKRESOURCELIMITS_H
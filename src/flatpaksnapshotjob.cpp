@@ -0,0 +1,317 @@
+/**
+ * @file flatpaksnapshotjob.cpp
+ * @brief Implementacja tworzenia i przywracania migawek katalogu budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpaksnapshotjob.h"
+#include "flatpakbuilderdebug.h"
+#include "flatpakbuilderplugin.h"
+#include "flatpakprocess.h"
+#include "flatpakresourcelimits.h"
+#include "flatpaktreemanifest.h"
+
+#include <KLocalizedString>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QLocale>
+#include <QtConcurrent>
+
+#include <csignal>
+
+namespace {
+    // Migawki ustępują budowaniu (waga 20) i IDE (waga 100)
+    const int SnapshotWeight = 10;
+
+    // Tyle ostatnich linii wyjścia trafia do komunikatu o błędzie
+    const int ErrorTailLines = 10;
+}
+
+FlatpakSnapshotJob::FlatpakSnapshotJob(FlatpakBuilderPlugin* plugin, const QString& buildDir,
+                                       const QString& manifestPath, int keep)
+    : KJob(plugin)
+    , m_plugin(plugin)
+    , m_snapshots(buildDir)
+    , m_buildDir(QDir::cleanPath(buildDir))
+    , m_snapshot(m_snapshots.prepare(manifestPath))
+    , m_restore(false)
+    , m_keep(keep)
+    , m_stage(Copy)
+    , m_process(nullptr)
+{
+    setObjectName(i18n("Flatpak Build Snapshot"));
+    setCapabilities(KJob::Killable);
+}
+
+FlatpakSnapshotJob::FlatpakSnapshotJob(FlatpakBuilderPlugin* plugin, const QString& buildDir,
+                                       const FlatpakBuildSnapshots::Snapshot& snapshot)
+    : KJob(plugin)
+    , m_plugin(plugin)
+    , m_snapshots(buildDir)
+    , m_buildDir(QDir::cleanPath(buildDir))
+    , m_snapshot(snapshot)
+    , m_restore(true)
+    , m_keep(0)
+    , m_stage(Copy)
+    , m_process(nullptr)
+{
+    setObjectName(i18n("Restore Flatpak Build Snapshot"));
+    setCapabilities(KJob::Killable);
+}
+
+void FlatpakSnapshotJob::start()
+{
+    if (m_restore) {
+        if (!QFileInfo(m_snapshot.path).isDir()) {
+            fail(i18n("The snapshot %1 no longer exists.", m_snapshot.path));
+            return;
+        }
+
+        // Zmiana nazwy w obrębie jednego systemu plików jest natychmiastowa,
+        // a odsunięty katalog pozwala cofnąć nieudane przywracanie
+        if (QFileInfo::exists(m_buildDir)) {
+            m_trash = m_snapshots.trashPath();
+            if (!QDir().rename(m_buildDir, m_trash)) {
+                fail(i18n("Could not move the build directory %1 out of the way.", m_buildDir));
+                return;
+            }
+        }
+        m_source = m_snapshot.path;
+        m_target = m_buildDir;
+    } else {
+        if (!QDir().mkpath(m_snapshots.storePath())) {
+            fail(i18n("Could not create the snapshot directory %1.", m_snapshots.storePath()));
+            return;
+        }
+        m_source = m_buildDir;
+        m_target = m_snapshot.path;
+    }
+
+    m_methods = FlatpakBuildSnapshots::methodsFor(m_source);
+    setTotalAmount(KJob::Items, Finished);
+    setProcessedAmount(KJob::Items, 0);
+    QMetaObject::invokeMethod(this, "runStage", Qt::QueuedConnection);
+}
+
+QString FlatpakSnapshotJob::buildDir() const
+{
+    return m_buildDir;
+}
+
+bool FlatpakSnapshotJob::isRestore() const
+{
+    return m_restore;
+}
+
+QString FlatpakSnapshotJob::summary() const
+{
+    return m_summary;
+}
+
+bool FlatpakSnapshotJob::doKill()
+{
+    const bool copying = m_stage == Copy && m_process;
+    m_stage = Finished;
+
+    if (m_process) {
+        disconnect(m_process, nullptr, this, nullptr);
+        m_process->signalTree(SIGTERM);
+        m_process->waitForFinished(1000);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+
+    // Przerwana kopia jest niekompletna; przy przywracaniu wraca stary katalog
+    if (copying) {
+        removeTarget();
+        if (!m_trash.isEmpty()) {
+            QDir().rename(m_trash, m_buildDir);
+        }
+    }
+    return true;
+}
+
+void FlatpakSnapshotJob::runStage()
+{
+    setProcessedAmount(KJob::Items, m_stage);
+
+    switch (m_stage) {
+        case Copy:
+            if (m_methods.isEmpty()) {
+                if (!m_trash.isEmpty()) {
+                    QDir().rename(m_trash, m_buildDir);
+                }
+                fail(m_restore ? i18n("Could not restore the build snapshot:\n%1", m_lastError)
+                               : i18n("Could not snapshot the build directory:\n%1", m_lastError));
+            } else {
+                runProcess(FlatpakBuildSnapshots::copyCommand(m_methods.first(), m_source, m_target));
+            }
+            break;
+
+        case Record: {
+            if (!m_snapshots.writeMetadata(m_snapshot)) {
+                removeTarget();
+                fail(i18n("Could not record the build snapshot in %1.", m_snapshots.storePath()));
+                return;
+            }
+
+            // Opisy znikają od razu, więc lista migawek jest aktualna jeszcze
+            // przed usunięciem katalogów; podwoluminy usuwa btrfs, resztę Cleanup
+            const QVector<FlatpakBuildSnapshots::Snapshot> expired = m_snapshots.expired(m_keep);
+            for (const FlatpakBuildSnapshots::Snapshot& snapshot : expired) {
+                m_snapshots.removeMetadata(snapshot);
+                if (snapshot.method == FlatpakBuildSnapshots::Subvolume) {
+                    m_expiredSubvolumes << snapshot.path;
+                }
+            }
+            advance(Prune);
+            break;
+        }
+
+        case Prune:
+            if (m_expiredSubvolumes.isEmpty()) {
+                advance(Cleanup);
+            } else {
+                runProcess(FlatpakBuildSnapshots::deleteSubvolumeCommand(m_expiredSubvolumes.first()));
+            }
+            break;
+
+        case Cleanup: {
+            // Usuwanie drzew i ponowny spis katalogu nie blokują wątku GUI
+            QStringList paths = m_snapshots.staleTrash();
+            if (!m_restore) {
+                // Migawki bez opisu to te przycięte przed chwilą albo po przerwanej kopii
+                const QStringList known = [this]() {
+                    QStringList ids;
+                    for (const FlatpakBuildSnapshots::Snapshot& snapshot : m_snapshots.snapshots()) {
+                        ids << snapshot.id;
+                    }
+                    return ids;
+                }();
+                const QDir store(m_snapshots.storePath());
+                for (const QString& entry : store.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                    if (!known.contains(entry)) {
+                        paths << store.absoluteFilePath(entry);
+                    }
+                }
+            }
+
+            const QString buildDir = m_restore ? m_buildDir : QString();
+            auto* watcher = new QFutureWatcher<void>(this);
+            connect(watcher, &QFutureWatcher<void>::finished, this, &FlatpakSnapshotJob::cleanupFinished);
+            watcher->setFuture(QtConcurrent::run([paths, buildDir]() {
+                for (const QString& path : paths) {
+                    QDir(path).removeRecursively();
+                }
+                if (!buildDir.isEmpty()) {
+                    const QString treePath = buildDir + ".tree";
+                    FlatpakTreeManifest::scan(buildDir, FlatpakTreeManifest::load(treePath)).save(treePath);
+                }
+            }));
+            break;
+        }
+
+        case Finished:
+            emitResult();
+            break;
+    }
+}
+
+void FlatpakSnapshotJob::runProcess(const QStringList& command)
+{
+    m_process = new FlatpakProcess(this);
+    m_process->setProcessChannelMode(QProcess::MergedChannels);
+    m_process->setProgram(command.first());
+    m_process->setArguments(command.mid(1));
+
+    FlatpakResourceLimits::Settings settings;
+    settings.enabled = true;
+    settings.cpuWeight = SnapshotWeight;
+    settings.ioWeight = SnapshotWeight;
+    FlatpakResourceLimits(settings).apply(m_process, QString("kdev-flatpak-snapshot-%1").arg(QDateTime::currentMSecsSinceEpoch()));
+
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &FlatpakSnapshotJob::processFinished);
+    m_process->start();
+}
+
+void FlatpakSnapshotJob::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    const QString output = QString::fromUtf8(m_process->readAll());
+    m_process->deleteLater();
+    m_process = nullptr;
+
+    // Nieusunięty podwolumin nie ma już opisu, więc zajmie się nim Cleanup
+    if (m_stage == Prune) {
+        m_expiredSubvolumes.removeFirst();
+        advance(Prune);
+        return;
+    }
+
+    const FlatpakBuildSnapshots::Method method = m_methods.takeFirst();
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        // Brak reflinku albo podwoluminu to oczekiwany powód przejścia dalej
+        const QStringList lines = output.split('\n', QString::SkipEmptyParts);
+        m_lastError = QStringList(lines.mid(qMax(0, lines.size() - ErrorTailLines))).join('\n');
+        qCDebug(KDEV_FLATPAKBUILDER) << FlatpakBuildSnapshots::methodName(method) << "failed for" << m_source << m_lastError;
+        removeTarget();
+        advance(Copy);
+        return;
+    }
+
+    m_snapshot.method = method;
+    if (m_restore) {
+        m_summary = i18n("Build directory restored from the snapshot of %1 (%2).",
+                         QLocale().toString(m_snapshot.created, QLocale::ShortFormat),
+                         FlatpakBuildSnapshots::methodName(method));
+        advance(Cleanup);
+    } else {
+        m_summary = i18n("Build directory snapshot saved (%1).", FlatpakBuildSnapshots::methodName(method));
+        advance(Record);
+    }
+}
+
+void FlatpakSnapshotJob::cleanupFinished()
+{
+    sender()->deleteLater();
+
+    if (m_stage == Finished) {
+        return;
+    }
+
+    m_stage = Finished;
+    setProcessedAmount(KJob::Items, Finished);
+    emitResult();
+}
+
+void FlatpakSnapshotJob::advance(Stage stage)
+{
+    m_stage = stage;
+    QMetaObject::invokeMethod(this, "runStage", Qt::QueuedConnection);
+}
+
+void FlatpakSnapshotJob::fail(const QString& message)
+{
+    m_stage = Finished;
+    setError(KJob::UserDefinedError);
+    setErrorText(message);
+    emitResult();
+}
+
+void FlatpakSnapshotJob::removeTarget()
+{
+    if (m_target.isEmpty() || !QFileInfo::exists(m_target)) {
+        return;
+    }
+
+    // Niekompletny podwolumin trzeba usunąć przez btrfs, zwykły katalog wprost
+    if (FlatpakBuildSnapshots::isSubvolume(m_target)) {
+        const QStringList command = FlatpakBuildSnapshots::deleteSubvolumeCommand(m_target);
+        QProcess::execute(command.first(), command.mid(1));
+    }
+    QDir(m_target).removeRecursively();
+}
@@ -0,0 +1,122 @@
+/**
+ * @file flatpaksnapshotjob.h
+ * @brief Zadanie tworzenia i przywracania migawek katalogu budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKSNAPSHOTJOB_H
+#define FLATPAKSNAPSHOTJOB_H
+
+#include "flatpakbuildsnapshots.h"
+
+#include <KJob>
+
+#include <QProcess>
+#include <QStringList>
+#include <QVector>
+
+class FlatpakBuilderPlugin;
+class FlatpakProcess;
+
+/**
+ * @class FlatpakSnapshotJob
+ * @brief Kopiuje katalog budowania do magazynu migawek albo z powrotem
+ *
+ * Tworzenie próbuje kolejnych sposobów z FlatpakBuildSnapshots::methodsFor,
+ * zapisuje opis i usuwa migawki ponad limit. Przywracanie odsuwa bieżący
+ * katalog zmianą nazwy, kopiuje migawkę na jego miejsce i dopiero potem
+ * usuwa odsunięty katalog w tle. Kopie działają z niską wagą CPU i IO.
+ */
+class FlatpakSnapshotJob : public KJob
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Etap zadania
+     */
+    enum Stage {
+        Copy,
+        Record,
+        Prune,
+        Cleanup,
+        Finished
+    };
+
+    /**
+     * Konstruktor tworzący migawkę
+     *
+     * @param plugin Wtyczka
+     * @param buildDir Katalog budowania po udanym budowaniu
+     * @param manifestPath Manifest, z którego zbudowano katalog
+     * @param keep Liczba zachowywanych migawek
+     */
+    FlatpakSnapshotJob(FlatpakBuilderPlugin* plugin, const QString& buildDir,
+                       const QString& manifestPath, int keep);
+
+    /**
+     * Konstruktor przywracający migawkę
+     *
+     * @param plugin Wtyczka
+     * @param buildDir Katalog budowania
+     * @param snapshot Przywracana migawka
+     */
+    FlatpakSnapshotJob(FlatpakBuilderPlugin* plugin, const QString& buildDir,
+                       const FlatpakBuildSnapshots::Snapshot& snapshot);
+
+    /**
+     * @brief Uruchamia pierwszy etap
+     */
+    void start() override;
+
+    /**
+     * @brief Zwraca katalog budowania
+     */
+    QString buildDir() const;
+
+    /**
+     * @brief Czy zadanie przywraca migawkę
+     */
+    bool isRestore() const;
+
+    /**
+     * @brief Zwraca podsumowanie do wyświetlenia
+     */
+    QString summary() const;
+
+protected:
+    /**
+     * @brief Przerywa bieżące kopiowanie
+     */
+    bool doKill() override;
+
+private Q_SLOTS:
+    void runStage();
+    void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void cleanupFinished();
+
+private:
+    void runProcess(const QStringList& command);
+    void advance(Stage stage);
+    void fail(const QString& message);
+    void removeTarget();
+
+    FlatpakBuilderPlugin* m_plugin;
+    FlatpakBuildSnapshots m_snapshots;
+    QString m_buildDir;
+    FlatpakBuildSnapshots::Snapshot m_snapshot;
+    bool m_restore;
+    int m_keep;
+    QString m_source;
+    QString m_target;
+    QString m_trash;
+    Stage m_stage;
+    FlatpakProcess* m_process;
+    QVector<FlatpakBuildSnapshots::Method> m_methods;
+    QStringList m_expiredSubvolumes;
+    QString m_lastError;
+    QString m_summary;
+};
+
+#endif // FLATPAKSNAPSHOTJOB_H
@@ -0,0 +1,336 @@
+/**
+ * @file flatpaksourcechecksums.cpp
+ * @brief Implementacja aktualizacji sum kontrolnych źródeł manifestu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpaksourcechecksums.h"
+
+#include <KLocalizedString>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QUrl>
+
+#include <algorithm>
+
+namespace {
+    // Okno odwzorowania - duże archiwa nie zajmują całej przestrzeni adresowej
+    const qint64 MapWindow = 64 * 1024 * 1024;
+
+    // Odczyt zwykły, gdy odwzorowanie nie jest możliwe (np. FUSE, pliki specjalne)
+    const qint64 ReadChunk = 1024 * 1024;
+
+    const QString IndexFile = QStringLiteral("kdev-source-index.json");
+
+    // Kolumna klucza w linii; w YAML pomija znacznik elementu listy
+    int keyColumn(const QString& line)
+    {
+        int column = 0;
+        while (column < line.size() && line.at(column).isSpace()) {
+            ++column;
+        }
+        if (column < line.size() && line.at(column) == '-') {
+            ++column;
+            while (column < line.size() && line.at(column).isSpace()) {
+                ++column;
+            }
+        }
+        return column;
+    }
+
+    bool startsWithKey(const QString& text, FlatpakManifestModel::Format format)
+    {
+        if (format == FlatpakManifestModel::Json) {
+            return text.startsWith(QLatin1String("\"url\"")) || text.startsWith(QLatin1String("\"path\""));
+        }
+        return text.startsWith(QLatin1String("url:")) || text.startsWith(QLatin1String("path:"));
+    }
+}
+
+bool FlatpakSourceChecksums::Entry::changed() const
+{
+    return !newChecksum.isEmpty() && newChecksum.compare(oldChecksum, Qt::CaseInsensitive) != 0;
+}
+
+QVector<FlatpakSourceChecksums::Entry> FlatpakSourceChecksums::collect(
+    const QVector<FlatpakManifestModel::Module>& modules, const QString& manifestPath)
+{
+    QVector<Entry> result;
+    for (const FlatpakManifestModel::Module& module : modules) {
+        const QString file = module.file.isEmpty() ? manifestPath : module.file;
+        const QDir dir = QFileInfo(file).absoluteDir();
+
+        for (const FlatpakManifestModel::Source& source : module.sources) {
+            if (source.type != QLatin1String("archive") && source.type != QLatin1String("file")) {
+                continue;
+            }
+            if (source.location.isEmpty() || source.locationLine < 0) {
+                continue;
+            }
+
+            Entry entry;
+            entry.file = file;
+            entry.module = module.name;
+            entry.algorithm = source.checksumType.isEmpty() ? QStringLiteral("sha256") : source.checksumType;
+            entry.oldChecksum = source.checksum;
+            entry.locationLine = source.locationLine;
+            entry.checksumLine = source.checksumLine;
+
+            // Model nie rozróżnia url od path; ścieżki nie zawierają schematu
+            if (!source.location.contains(QLatin1String("://"))) {
+                if (source.checksumType.isEmpty()) {
+                    continue;
+                }
+                entry.path = QDir::cleanPath(dir.absoluteFilePath(source.location));
+            } else {
+                entry.url = source.location;
+            }
+            result.append(entry);
+        }
+    }
+    return result;
+}
+
+QString FlatpakSourceChecksums::locate(const Entry& entry, const QString& mirrorDir, const QString& stateDir,
+                                       const QHash<QString, QString>& index)
+{
+    if (!entry.path.isEmpty()) {
+        return QFileInfo(entry.path).isFile() ? entry.path : QString();
+    }
+
+    const QUrl url(entry.url);
+    if (url.isLocalFile()) {
+        return QFileInfo(url.toLocalFile()).isFile() ? url.toLocalFile() : QString();
+    }
+
+    if (!mirrorDir.isEmpty() && !url.fileName().isEmpty()) {
+        const QString mirrored = QDir(mirrorDir).filePath(url.fileName());
+        if (QFileInfo(mirrored).isFile()) {
+            return mirrored;
+        }
+    }
+
+    const auto cached = index.constFind(entry.url);
+    if (cached != index.constEnd()) {
+        const QString path = QDir(downloadsDir(stateDir)).filePath(cached.value());
+        if (QFileInfo(path).isFile()) {
+            return path;
+        }
+    }
+    return QString();
+}
+
+QHash<QString, QString> FlatpakSourceChecksums::loadIndex(const QString& stateDir)
+{
+    QHash<QString, QString> index;
+    QFile file(QDir(stateDir).filePath(IndexFile));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return index;
+    }
+
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = json.constBegin(); it != json.constEnd(); ++it) {
+        index.insert(it.key(), it.value().toString());
+    }
+    return index;
+}
+
+bool FlatpakSourceChecksums::saveIndex(const QString& stateDir, const QHash<QString, QString>& index)
+{
+    QJsonObject json;
+    for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+        json[it.key()] = it.value();
+    }
+
+    QSaveFile file(QDir(stateDir).filePath(IndexFile));
+    return QDir().mkpath(stateDir)
+        && file.open(QIODevice::WriteOnly)
+        && file.write(QJsonDocument(json).toJson()) >= 0
+        && file.commit();
+}
+
+QString FlatpakSourceChecksums::downloadsDir(const QString& stateDir)
+{
+    return QDir(stateDir).filePath("downloads");
+}
+
+QString FlatpakSourceChecksums::store(const QString& stateDir, const QString& tempPath, const QString& url,
+                                      const QString& checksum, QHash<QString, QString>* index)
+{
+    QString name = QUrl(url).fileName();
+    if (name.isEmpty()) {
+        name = QStringLiteral("download");
+    }
+
+    const QString relative = checksum + '/' + name;
+    const QString target = QDir(downloadsDir(stateDir)).filePath(relative);
+    if (!QDir().mkpath(QFileInfo(target).absolutePath())) {
+        return QString();
+    }
+
+    // Ten sam plik mógł już zostać pobrany przez flatpak-builder
+    if (QFileInfo::exists(target)) {
+        QFile::remove(tempPath);
+    } else if (!QFile::rename(tempPath, target)) {
+        return QString();
+    }
+
+    index->insert(url, relative);
+    return target;
+}
+
+void FlatpakSourceChecksums::hash(HashTask& task)
+{
+    QFile file(task.path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        task.error = i18n("Could not open %1: %2", task.path, file.errorString());
+        return;
+    }
+
+    QCryptographicHash hash(task.algorithm == QLatin1String("sha512") ? QCryptographicHash::Sha512
+                                                                      : QCryptographicHash::Sha256);
+    task.size = file.size();
+
+    qint64 offset = 0;
+    while (offset < task.size) {
+        const qint64 length = qMin(MapWindow, task.size - offset);
+        uchar* data = file.map(offset, length);
+        if (!data) {
+            break;
+        }
+        hash.addData(reinterpret_cast<const char*>(data), static_cast<int>(length));
+        file.unmap(data);
+        offset += length;
+    }
+
+    // Reszta pliku, jeśli system plików nie pozwala na odwzorowanie
+    if (offset < task.size) {
+        if (!file.seek(offset)) {
+            task.error = i18n("Could not read %1: %2", task.path, file.errorString());
+            return;
+        }
+        QByteArray buffer;
+        while (!(buffer = file.read(ReadChunk)).isEmpty()) {
+            hash.addData(buffer);
+        }
+        if (file.error() != QFile::NoError) {
+            task.error = i18n("Could not read %1: %2", task.path, file.errorString());
+            return;
+        }
+    }
+
+    task.checksum = QString::fromLatin1(hash.result().toHex());
+}
+
+QVector<FlatpakSourceChecksums::LineEdit> FlatpakSourceChecksums::edits(
+    const QStringList& lines, const QVector<Entry>& entries, FlatpakManifestModel::Format format, QStringList* skipped)
+{
+    QVector<LineEdit> result;
+
+    for (int i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries.at(i);
+        if (!entry.changed()) {
+            continue;
+        }
+
+        // Istniejąca suma: podmiana wartości w jej linii
+        if (entry.checksumLine >= 0 && entry.checksumLine < lines.size()) {
+            const QString line = lines.at(entry.checksumLine);
+            const int at = line.indexOf(entry.oldChecksum, 0, Qt::CaseInsensitive);
+            if (entry.oldChecksum.isEmpty() || at < 0) {
+                if (skipped) {
+                    *skipped << entry.module;
+                }
+                continue;
+            }
+
+            LineEdit edit;
+            edit.line = entry.checksumLine;
+            edit.source = i;
+            edit.expected = line;
+            edit.text = QString(line).replace(at, entry.oldChecksum.size(), entry.newChecksum);
+            result.append(edit);
+            continue;
+        }
+
+        // Brak sumy: nowa linia za url z tym samym wcięciem; obiekt zapisany
+        // w jednej linii trzeba uzupełnić ręcznie
+        if (entry.locationLine < 0 || entry.locationLine >= lines.size()) {
+            continue;
+        }
+        const QString anchor = lines.at(entry.locationLine);
+        const int column = keyColumn(anchor);
+        if (!startsWithKey(anchor.mid(column), format)
+            || (format == FlatpakManifestModel::Json && (anchor.contains('{') || anchor.contains('}')))) {
+            if (skipped) {
+                *skipped << entry.module;
+            }
+            continue;
+        }
+
+        const QString indent = QString(column, ' ');
+        LineEdit insert;
+        insert.kind = LineEdit::InsertAfter;
+        insert.source = i;
+        insert.line = entry.locationLine;
+        insert.expected = anchor;
+
+        if (format == FlatpakManifestModel::Yaml) {
+            insert.text = indent + entry.algorithm + ": " + entry.newChecksum;
+            result.append(insert);
+            continue;
+        }
+
+        const QString trimmed = anchor.trimmed();
+        if (trimmed.endsWith(',')) {
+            insert.text = indent + '"' + entry.algorithm + "\": \"" + entry.newChecksum + "\",";
+            result.append(insert);
+        } else {
+            // url był ostatnim kluczem obiektu - przecinek przechodzi do niego
+            insert.text = indent + '"' + entry.algorithm + "\": \"" + entry.newChecksum + '"';
+            result.append(insert);
+
+            LineEdit comma;
+            comma.line = entry.locationLine;
+            comma.source = i;
+            comma.expected = anchor;
+            int end = anchor.size();
+            while (end > 0 && anchor.at(end - 1).isSpace()) {
+                --end;
+            }
+            comma.text = QString(anchor).insert(end, ',');
+            result.append(comma);
+        }
+    }
+
+    // Od końca pliku, a w jednej linii najpierw wstawienie za nią, potem
+    // podmiana - żadna edycja nie przesuwa linii kolejnych edycji
+    std::stable_sort(result.begin(), result.end(), [](const LineEdit& a, const LineEdit& b) {
+        if (a.line != b.line) {
+            return a.line > b.line;
+        }
+        return a.kind == LineEdit::InsertAfter && b.kind == LineEdit::Replace;
+    });
+    return result;
+}
+
+bool FlatpakSourceChecksums::apply(QStringList& lines, const LineEdit& edit)
+{
+    if (edit.line < 0 || edit.line >= lines.size() || lines.at(edit.line) != edit.expected) {
+        return false;
+    }
+
+    if (edit.kind == LineEdit::InsertAfter) {
+        lines.insert(edit.line + 1, edit.text);
+    } else {
+        lines[edit.line] = edit.text;
+    }
+    return true;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file flatpaksourcechecksums.h
+ * @brief Wyszukiwanie, haszowanie i aktualizacja sum kontrolnych źródeł manifestu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKSOURCECHECKSUMS_H
+#define FLATPAKSOURCECHECKSUMS_H
+
+#include "flatpakmanifestmodel.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @class FlatpakSourceChecksums
+ * @brief Operacje bez stanu dla akcji "Update Source Checksums"
+ *
+ * Plik źródła jest szukany kolejno: lokalna ścieżka ("path" albo URL
+ * file://), katalog kopii źródeł (plik o nazwie z końca adresu URL) i
+ * katalog pobrań flatpak-builder, do którego trafiają pliki pobrane przez
+ * wtyczkę ("downloads/<suma>/<nazwa>", więc kolejne budowanie ich nie
+ * pobiera). Indeks adresów URL w katalogu stanu pozwala znaleźć pobrany
+ * plik bez znajomości jego nowej sumy.
+ *
+ * Haszowanie odwzorowuje plik w pamięć oknami po kilkadziesiąt MiB, więc
+ * zużycie pamięci nie zależy od rozmiaru archiwum. Zmiany w manifeście są
+ * liczone jako edycje pojedynczych linii z zapamiętaną poprzednią treścią;
+ * linia zmieniona w międzyczasie nie jest nadpisywana.
+ */
+class FlatpakSourceChecksums
+{
+public:
+    /**
+     * Źródło typu archive lub file wraz z wynikiem sprawdzenia
+     */
+    struct Entry {
+        QString file;           ///< Plik manifestu zawierający źródło
+        QString module;
+        QString url;            ///< Adres albo pusty dla źródeł "path"
+        QString path;           ///< Bezwzględna ścieżka źródła "path"
+        QString algorithm;      ///< "sha256" albo "sha512"
+        QString oldChecksum;
+        QString newChecksum;
+        QString localPath;      ///< Znaleziony albo pobrany plik
+        QString error;
+        int locationLine = -1;
+        int checksumLine = -1;
+        bool downloaded = false;
+
+        /**
+         * @brief Czy wyliczona suma różni się od zapisanej w manifeście
+         */
+        bool changed() const;
+    };
+
+    /**
+     * Haszowanie jednego pliku, współdzielone przez źródła o tym samym pliku
+     */
+    struct HashTask {
+        QString path;
+        QString algorithm;
+        QString checksum;
+        QString error;
+        qint64 size = 0;
+    };
+
+    /**
+     * Edycja jednej linii manifestu
+     */
+    struct LineEdit {
+        enum Kind {
+            Replace,        ///< Zastąpienie linii
+            InsertAfter     ///< Nowa linia za podaną
+        };
+
+        Kind kind = Replace;
+        int source = -1;    ///< Indeks źródła na liście przekazanej do edits()
+        int line = 0;
+        QString expected;   ///< Treść linii, na podstawie której liczono edycję
+        QString text;
+    };
+
+    /**
+     * @brief Zbiera źródła archive i file, których sumy można sprawdzić
+     *
+     * Źródła "path" bez sumy są pomijane - flatpak-builder jej nie wymaga.
+     *
+     * @param modules Moduły z FlatpakManifestModel::modules()
+     * @param manifestPath Ścieżka głównego manifestu
+     */
+    static QVector<Entry> collect(const QVector<FlatpakManifestModel::Module>& modules, const QString& manifestPath);
+
+    /**
+     * @brief Szuka lokalnej kopii pliku źródła
+     * @param entry Źródło
+     * @param mirrorDir Katalog kopii źródeł (może być pusty)
+     * @param stateDir Katalog stanu flatpak-builder
+     * @param index Indeks adresów URL z loadIndex()
+     * @return Ścieżka pliku albo pusty napis, jeśli trzeba go pobrać
+     */
+    static QString locate(const Entry& entry, const QString& mirrorDir, const QString& stateDir,
+                          const QHash<QString, QString>& index);
+
+    /**
+     * @brief Wczytuje indeks adresów URL pobranych plików
+     * @return Adres -> ścieżka względem katalogu pobrań
+     */
+    static QHash<QString, QString> loadIndex(const QString& stateDir);
+
+    /**
+     * @brief Zapisuje indeks adresów URL pobranych plików
+     */
+    static bool saveIndex(const QString& stateDir, const QHash<QString, QString>& index);
+
+    /**
+     * @brief Zwraca katalog pobrań flatpak-builder w katalogu stanu
+     */
+    static QString downloadsDir(const QString& stateDir);
+
+    /**
+     * @brief Przenosi pobrany plik pod ścieżkę, której użyje flatpak-builder
+     * @param stateDir Katalog stanu flatpak-builder
+     * @param tempPath Pobrany plik tymczasowy
+     * @param url Adres pliku
+     * @param checksum Suma pliku
+     * @param index Indeks adresów uzupełniany o ten plik
+     * @return Nowa ścieżka pliku albo pusty napis po błędzie
+     */
+    static QString store(const QString& stateDir, const QString& tempPath, const QString& url,
+                         const QString& checksum, QHash<QString, QString>* index);
+
+    /**
+     * @brief Haszuje plik strumieniowo przez odwzorowanie w pamięć
+     *
+     * Bezpieczne do wywołania z QtConcurrent::map.
+     */
+    static void hash(HashTask& task);
+
+    /**
+     * @brief Liczy edycje linii pliku dla zmienionych źródeł
+     * @param lines Bieżąca treść pliku
+     * @param entries Źródła z tego pliku
+     * @param format Format pliku
+     * @param skipped Moduły, w których nie udało się umieścić sumy (np. obiekt w jednej linii)
+     * @return Edycje w kolejności stosowania (od końca pliku)
+     */
+    static QVector<LineEdit> edits(const QStringList& lines, const QVector<Entry>& entries,
+                                   FlatpakManifestModel::Format format, QStringList* skipped = nullptr);
+
+    /**
+     * @brief Stosuje edycję, o ile linia nie zmieniła się od jej wyliczenia
+     * @return true jeśli edycja została zastosowana
+     */
+    static bool apply(QStringList& lines, const LineEdit& edit);
+};
+
+#endif // FLATPAKSOURCECHECKSUMS_H
@@ -0,0 +1,227 @@
+/**
+ * @file flatpaktreemanifest.cpp
+ * @brief Implementacja spisu plików katalogu budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpaktreemanifest.h"
+
+#include <KLocalizedString>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include <climits>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const quint32 FileMagic = 0x46544d31; // "FTM1"
+
+    struct PendingFile {
+        QString relativePath;
+        QString absolutePath;
+    };
+
+    QByteArray hashFile(const QString& path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QByteArray();
+        }
+
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        hash.addData(&file);
+        return hash.result();
+    }
+
+    QByteArray hashSymlink(const QString& path)
+    {
+        // Dowiązanie opisuje jego cel, a nie treść wskazywanego pliku
+        QByteArray target(PATH_MAX, '\0');
+        const ssize_t length = ::readlink(QFile::encodeName(path).constData(), target.data(), target.size());
+        target.resize(qMax<ssize_t>(0, length));
+        return QCryptographicHash::hash("link:" + target, QCryptographicHash::Sha256);
+    }
+}
+
+bool FlatpakTreeDiff::isEmpty() const
+{
+    return added.isEmpty() && removed.isEmpty() && modified.isEmpty();
+}
+
+QStringList FlatpakTreeDiff::summary(int maxEntries) const
+{
+    QStringList lines;
+    lines << i18n("%1 added, %2 removed, %3 modified", added.size(), removed.size(), modified.size());
+
+    auto append = [&](const QStringList& paths, QChar prefix) {
+        for (const QString& path : paths) {
+            if (lines.size() > maxEntries) {
+                return;
+            }
+            lines << QString("%1 %2").arg(prefix, path);
+        }
+    };
+    append(modified, '~');
+    append(added, '+');
+    append(removed, '-');
+
+    const int total = added.size() + removed.size() + modified.size();
+    if (total > maxEntries) {
+        lines << i18np("... and %1 more", "... and %1 more", total - maxEntries);
+    }
+    return lines;
+}
+
+FlatpakTreeManifest FlatpakTreeManifest::scan(const QString& buildDir, const FlatpakTreeManifest& previous)
+{
+    FlatpakTreeManifest manifest;
+    QVector<PendingFile> pending;
+    const QDir root(buildDir);
+
+    auto visit = [&](const QString& absolutePath) {
+        struct stat st;
+        if (::lstat(QFile::encodeName(absolutePath).constData(), &st) != 0 || S_ISDIR(st.st_mode)) {
+            return;
+        }
+
+        Entry entry;
+        entry.size = st.st_size;
+        entry.mtimeNs = qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        entry.inode = st.st_ino;
+
+        const QString relativePath = root.relativeFilePath(absolutePath);
+        const auto it = previous.m_entries.constFind(relativePath);
+        if (it != previous.m_entries.constEnd() && it->sameStat(entry) && !it->hash.isEmpty()) {
+            entry.hash = it->hash;
+        } else if (S_ISLNK(st.st_mode)) {
+            entry.hash = hashSymlink(absolutePath);
+            ++manifest.m_rehashed;
+        } else {
+            pending.append({relativePath, absolutePath});
+        }
+        manifest.m_entries.insert(relativePath, entry);
+    };
+
+    visit(root.filePath("metadata"));
+
+    // Bez FollowSymlinks iterator nie wchodzi do dowiązanych katalogów
+    QDirIterator it(root.filePath("files"), QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        visit(it.next());
+    }
+
+    // Haszowanie zmienionych plików rozkłada się na globalną pulę wątków
+    const QVector<QByteArray> hashes = QtConcurrent::blockingMapped<QVector<QByteArray>>(pending,
+        [](const PendingFile& file) { return hashFile(file.absolutePath); });
+
+    for (int i = 0; i < pending.size(); ++i) {
+        manifest.m_entries[pending.at(i).relativePath].hash = hashes.at(i);
+    }
+    manifest.m_rehashed += pending.size();
+
+    return manifest;
+}
+
+FlatpakTreeManifest FlatpakTreeManifest::load(const QString& path)
+{
+    FlatpakTreeManifest manifest;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return manifest;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0;
+    qint32 count = 0;
+    stream >> magic >> count;
+    if (magic != FileMagic || count < 0) {
+        return manifest;
+    }
+
+    manifest.m_entries.reserve(count);
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString relativePath;
+        Entry entry;
+        stream >> relativePath >> entry.size >> entry.mtimeNs >> entry.inode >> entry.hash;
+        manifest.m_entries.insert(relativePath, entry);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        return FlatpakTreeManifest();
+    }
+    return manifest;
+}
+
+bool FlatpakTreeManifest::save(const QString& path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream << FileMagic << qint32(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        stream << it.key() << it->size << it->mtimeNs << it->inode << it->hash;
+    }
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+bool FlatpakTreeManifest::isEmpty() const
+{
+    return m_entries.isEmpty();
+}
+
+int FlatpakTreeManifest::fileCount() const
+{
+    return m_entries.size();
+}
+
+int FlatpakTreeManifest::rehashedCount() const
+{
+    return m_rehashed;
+}
+
+const QHash<QString, FlatpakTreeManifest::Entry>& FlatpakTreeManifest::entries() const
+{
+    return m_entries;
+}
+
+FlatpakTreeDiff FlatpakTreeManifest::diff(const FlatpakTreeManifest& before) const
+{
+    FlatpakTreeDiff result;
+
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        const auto old = before.m_entries.constFind(it.key());
+        if (old == before.m_entries.constEnd()) {
+            result.added << it.key();
+        } else if (old->hash != it->hash) {
+            result.modified << it.key();
+        }
+    }
+
+    for (auto it = before.m_entries.constBegin(); it != before.m_entries.constEnd(); ++it) {
+        if (!m_entries.contains(it.key())) {
+            result.removed << it.key();
+        }
+    }
+
+    result.added.sort();
+    result.removed.sort();
+    result.modified.sort();
+    return result;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file flatpaktreemanifest.h
+ * @brief Spis plików katalogu budowania z sumami kontrolnymi
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKTREEMANIFEST_H
+#define FLATPAKTREEMANIFEST_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @struct FlatpakTreeDiff
+ * @brief Różnica między dwoma spisami drzewa plików
+ */
+struct FlatpakTreeDiff
+{
+    QStringList added;
+    QStringList removed;
+    QStringList modified;
+
+    /**
+     * @brief Czy drzewa są identyczne
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Zwraca czytelne podsumowanie zmian
+     * @param maxEntries Największa liczba wypisywanych ścieżek
+     * @return Linie podsumowania (liczniki, a potem ścieżki z prefiksem +, - lub ~)
+     */
+    QStringList summary(int maxEntries = 20) const;
+};
+
+/**
+ * @class FlatpakTreeManifest
+ * @brief Spis (ścieżka, rozmiar, czas zmiany, skrót treści) drzewa files/
+ *
+ * Spis pozwala stwierdzić, czy wynik budowania zmienił się od ostatniego
+ * eksportu lub instalacji. Ponowne skanowanie liczy skrót tylko dla plików,
+ * których rozmiar, czas zmiany lub i-węzeł różnią się od poprzedniego spisu;
+ * pozostałe pliki są haszowane równolegle na wszystkich rdzeniach.
+ *
+ * I-węzeł jest częścią klucza, ponieważ flatpak-builder odtwarza moduły
+ * z cache ostree jako twarde dowiązania z wyzerowanym czasem zmiany - sam
+ * rozmiar i czas nie odróżniłyby wtedy dwóch wersji pliku.
+ */
+class FlatpakTreeManifest
+{
+public:
+    /**
+     * Wpis o jednym pliku
+     */
+    struct Entry {
+        qint64 size = 0;
+        qint64 mtimeNs = 0;
+        quint64 inode = 0;
+        QByteArray hash;
+
+        bool sameStat(const Entry& other) const
+        {
+            return size == other.size && mtimeNs == other.mtimeNs && inode == other.inode;
+        }
+    };
+
+    /**
+     * @brief Skanuje katalog budowania (files/ i plik metadata)
+     *
+     * Wywołanie blokuje do zakończenia haszowania; z wątku GUI należy je
+     * uruchamiać przez QtConcurrent::run.
+     *
+     * @param buildDir Katalog budowania flatpak-builder
+     * @param previous Poprzedni spis, z którego brane są niezmienione skróty
+     * @return Nowy spis
+     */
+    static FlatpakTreeManifest scan(const QString& buildDir, const FlatpakTreeManifest& previous = FlatpakTreeManifest());
+
+    /**
+     * @brief Wczytuje spis z pliku
+     * @param path Ścieżka do pliku spisu
+     * @return Spis albo pusty spis, jeśli plik nie istnieje lub jest uszkodzony
+     */
+    static FlatpakTreeManifest load(const QString& path);
+
+    /**
+     * @brief Zapisuje spis do pliku (atomowo)
+     * @param path Ścieżka do pliku spisu
+     * @return false w razie błędu zapisu
+     */
+    bool save(const QString& path) const;
+
+    /**
+     * @brief Czy spis jest pusty (np. nie został jeszcze zapisany)
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Liczba plików w spisie
+     */
+    int fileCount() const;
+
+    /**
+     * @brief Liczba plików, których skrót trzeba było policzyć podczas skanowania
+     */
+    int rehashedCount() const;
+
+    /**
+     * @brief Zwraca wpisy spisu według ścieżki względem katalogu budowania
+     */
+    const QHash<QString, Entry>& entries() const;
+
+    /**
+     * @brief Porównuje spis z wcześniejszym
+     * @param before Spis wcześniejszy
+     * @return Ścieżki dodane, usunięte i zmienione względem before
+     */
+    FlatpakTreeDiff diff(const FlatpakTreeManifest& before) const;
+
+private:
+    QHash<QString, Entry> m_entries;
+    int m_rehashed = 0;
+};
+
+#endif // FLATPAKTREEMANIFEST_H
@@ -0,0 +1,165 @@
+/**
+ * @file flatpakwatchmode.cpp
+ * @brief Implementacja automatycznego budowania po zapisaniu zmian
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakwatchmode.h"
+#include "flatpakbuilderdebug.h"
+#include "flatpakbuilderjob.h"
+#include "flatpakbuilderplugin.h"
+
+#include <interfaces/icore.h>
+#include <interfaces/idocument.h>
+#include <interfaces/idocumentcontroller.h>
+#include <interfaces/iproject.h>
+#include <interfaces/iruncontroller.h>
+#include <project/projectmodel.h>
+
+#include <KJob>
+
+#include <QFileInfo>
+
+namespace {
+    // Tyle musi minąć od ostatniego zapisu, by uznać serię zmian za zakończoną
+    const int SettleIntervalMs = 1500;
+
+    // Katalogi w projekcie zapisywane przez samą wtyczkę i narzędzia
+    const QStringList IgnoredDirs = {
+        QStringLiteral(".flatpak-builder"),
+        QStringLiteral(".flatpak-profile"),
+        QStringLiteral(".git"),
+    };
+}
+
+FlatpakWatchMode::FlatpakWatchMode(FlatpakBuilderPlugin* plugin, KDevelop::IProject* project, const QString& manifestPath)
+    : QObject(plugin)
+    , m_plugin(plugin)
+    , m_project(project)
+    , m_projectDir(project->path().toLocalFile())
+    , m_manifestPath(manifestPath)
+    , m_pending(false)
+    , m_state(Idle)
+{
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(SettleIntervalMs);
+    connect(&m_settleTimer, &QTimer::timeout, this, &FlatpakWatchMode::slotSettled);
+
+    // Zapisy w IDE są najczęstsze; manifest bywa też zmieniany poza IDE
+    connect(KDevelop::ICore::self()->documentController(), &KDevelop::IDocumentController::documentSaved,
+            this, &FlatpakWatchMode::slotDocumentSaved);
+    m_watcher.addPath(m_manifestPath);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &FlatpakWatchMode::slotManifestChanged);
+}
+
+KDevelop::IProject* FlatpakWatchMode::project() const
+{
+    return m_project;
+}
+
+FlatpakWatchMode::State FlatpakWatchMode::state() const
+{
+    return m_state;
+}
+
+void FlatpakWatchMode::slotDocumentSaved(KDevelop::IDocument* document)
+{
+    const QString path = document->url().toLocalFile();
+    if (path.isEmpty() || !path.startsWith(m_projectDir + '/')) {
+        return;
+    }
+
+    const QString relative = path.mid(m_projectDir.size() + 1);
+    for (const QString& dir : IgnoredDirs) {
+        if (relative.startsWith(dir + '/')) {
+            return;
+        }
+    }
+
+    invalidate();
+}
+
+void FlatpakWatchMode::slotManifestChanged(const QString& path)
+{
+    // Edytory zapisujące przez zmianę nazwy usuwają plik z obserwowanych
+    if (QFileInfo::exists(path) && !m_watcher.files().contains(path)) {
+        m_watcher.addPath(path);
+    }
+    invalidate();
+}
+
+void FlatpakWatchMode::invalidate()
+{
+    m_pending = true;
+    m_settleTimer.start();
+
+    // Trwające budowanie nie zawiera tej zmiany; jego wynik zostanie odrzucony
+    if (m_job) {
+        qCDebug(KDEV_FLATPAKBUILDER) << "Watch mode: cancelling a build invalidated by a newer edit";
+        m_job->kill(KJob::EmitResult);
+    }
+    setState(Pending);
+}
+
+void FlatpakWatchMode::slotSettled()
+{
+    if (!m_pending || m_job || !m_project) {
+        return;
+    }
+
+    // Budowanie uruchomione ręcznie używa tego samego katalogu - czekamy na nie
+    if (foreignBuildRunning()) {
+        m_settleTimer.start();
+        return;
+    }
+
+    m_pending = false;
+    KJob* job = m_plugin->build(m_project->projectItem());
+    if (!job) {
+        setState(Failed);
+        return;
+    }
+
+    m_job = job;
+    connect(job, &KJob::result, this, &FlatpakWatchMode::slotBuildFinished);
+    KDevelop::ICore::self()->runController()->registerJob(job);
+    job->start();
+    setState(Building);
+}
+
+void FlatpakWatchMode::slotBuildFinished(KJob* job)
+{
+    m_job = nullptr;
+
+    // Zmiany nadeszły w trakcie budowania - następne rusza, gdy ucichną
+    if (m_pending) {
+        if (!m_settleTimer.isActive()) {
+            slotSettled();
+        }
+        return;
+    }
+
+    setState(job->error() == 0 ? Idle : Failed);
+}
+
+bool FlatpakWatchMode::foreignBuildRunning() const
+{
+    const QString buildDir = FlatpakBuilderJob::defaultBuildDir(m_project);
+    const auto jobs = KDevelop::ICore::self()->runController()->currentJobs();
+    for (KJob* running : jobs) {
+        auto* build = qobject_cast<FlatpakBuilderJob*>(running);
+        if (build && build != m_job && build->buildDir() == buildDir) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FlatpakWatchMode::setState(State state)
+{
+    if (m_state != state) {
+        m_state = state;
+        Q_EMIT stateChanged(state);
+    }
+}
@@ -0,0 +1,98 @@
+/**
+ * @file flatpakwatchmode.h
+ * @brief Automatyczne budowanie projektu po zapisaniu zmian
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKWATCHMODE_H
+#define FLATPAKWATCHMODE_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class FlatpakBuilderPlugin;
+class KJob;
+
+namespace KDevelop {
+    class IDocument;
+    class IProject;
+}
+
+/**
+ * @class FlatpakWatchMode
+ * @brief Buduje projekt, gdy zapisy plików projektu i manifestu ucichną
+ *
+ * Zapisy w IDE i zmiany manifestu na dysku uruchamiają odliczanie od nowa,
+ * więc seria zapisów kończy się jednym budowaniem. Działa co najwyżej jedno
+ * budowanie i czeka co najwyżej jedno kolejne: zmiana w trakcie budowania
+ * przerywa je, bo jego wynik i tak byłby nieaktualny. Budowanie korzysta
+ * z cache flatpak-builder, więc po zmianie w aplikacji kompilowany jest
+ * tylko jej moduł.
+ */
+class FlatpakWatchMode : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Stan pokazywany na pasku narzędzi
+     */
+    enum State {
+        Idle,       ///< Ostatnie budowanie się udało albo jeszcze go nie było
+        Pending,    ///< Czeka, aż zapisy ucichną
+        Building,   ///< Trwa budowanie
+        Failed      ///< Ostatnie budowanie się nie udało
+    };
+
+    /**
+     * Konstruktor
+     *
+     * @param plugin Wtyczka (budowanie i rodzic)
+     * @param project Obserwowany projekt
+     * @param manifestPath Manifest projektu
+     */
+    FlatpakWatchMode(FlatpakBuilderPlugin* plugin, KDevelop::IProject* project, const QString& manifestPath);
+
+    /**
+     * @brief Zwraca obserwowany projekt
+     */
+    KDevelop::IProject* project() const;
+
+    /**
+     * @brief Zwraca bieżący stan
+     */
+    State state() const;
+
+Q_SIGNALS:
+    /**
+     * @brief Emitowany przy każdej zmianie stanu
+     * @param state Nowy stan
+     */
+    void stateChanged(FlatpakWatchMode::State state);
+
+private Q_SLOTS:
+    void slotDocumentSaved(KDevelop::IDocument* document);
+    void slotManifestChanged(const QString& path);
+    void slotSettled();
+    void slotBuildFinished(KJob* job);
+
+private:
+    void invalidate();
+    bool foreignBuildRunning() const;
+    void setState(State state);
+
+    FlatpakBuilderPlugin* m_plugin;
+    QPointer<KDevelop::IProject> m_project;
+    QString m_projectDir;
+    QString m_manifestPath;
+    QFileSystemWatcher m_watcher;
+    QTimer m_settleTimer;
+    QPointer<KJob> m_job;
+    bool m_pending;
+    State m_state;
+};
+
+#endif // FLATPAKWATCHMODE_H
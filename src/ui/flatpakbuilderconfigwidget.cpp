@@ -9,6 +9,7 @@
 #include "ui_flatpakbuilderconfigwidget.h"
 #include "flatpakbuilderplugin.h"
 #include "flatpakbuilderconfig.h"
+#include "flatpakresourcelimits.h"
 
 #include <KLocalizedString>
 
@@ -33,6 +34,26 @@ FlatpakBuilderConfigWidget::FlatpakBuilderConfigWidget(FlatpakBuilderPlugin* plu
     connect(ui->btnBrowseBuildDir, &QPushButton::clicked, 
             this, &FlatpakBuilderConfigWidget::slotBrowseBuildDir);
     
+    connect(ui->btnBrowseLayerDir, &QPushButton::clicked, 
+            this, &FlatpakBuilderConfigWidget::slotBrowseLayerDir);
+    
+    connect(ui->btnBrowseSourceMirror, &QPushButton::clicked, 
+            this, &FlatpakBuilderConfigWidget::slotBrowseSourceMirror);
+    
+    connect(ui->chkDependencyLayer, &QCheckBox::toggled, ui->txtLayerDir, &QWidget::setEnabled);
+    connect(ui->chkDependencyLayer, &QCheckBox::toggled, ui->btnBrowseLayerDir, &QWidget::setEnabled);
+    connect(ui->chkMaintainRepo, &QCheckBox::toggled, ui->spnRepoRetention, &QWidget::setEnabled);
+    connect(ui->chkMaintainRepo, &QCheckBox::toggled, ui->spnRepoDeltas, &QWidget::setEnabled);
+    
+    // Limity pamięci i wagi IO działają tylko w zakresie systemd
+    if (FlatpakResourceLimits::systemdScopeAvailable()) {
+        ui->lblLimitMethod->setText(i18n("Builds run in a transient systemd user scope."));
+    } else {
+        ui->lblLimitMethod->setText(i18n("systemd user scopes are not available; builds run under nice and ionice and memory limits are ignored."));
+        ui->spnMemoryHigh->setEnabled(false);
+        ui->spnMemoryMax->setEnabled(false);
+    }
+    
     // Inicjalizuj widget
     load();
 }
@@ -48,6 +69,25 @@ void FlatpakBuilderConfigWidget::save()
     m_config->setFlatpakBuilderPath(ui->txtFlatpakBuilder->text());
     m_config->setFlatpakPath(ui->txtFlatpak->text());
     m_config->setDefaultBuildDir(ui->txtBuildDir->text());
+    m_config->setUseBuildDaemon(ui->chkUseDaemon->isChecked());
+    m_config->setMatrixParallelBuilds(ui->spnMatrixJobs->value());
+    m_config->setUseDependencyLayer(ui->chkDependencyLayer->isChecked());
+    m_config->setDependencyLayerDir(ui->txtLayerDir->text());
+    m_config->setManifestLto(ui->chkManifestLto->isChecked());
+    m_config->setMaintainExportRepo(ui->chkMaintainRepo->isChecked());
+    m_config->setExportRetention(ui->spnRepoRetention->value());
+    m_config->setExportDeltaDepth(ui->spnRepoDeltas->value());
+    m_config->setBuildSnapshots(ui->spnBuildSnapshots->value());
+    m_config->setSourceMirrorDir(ui->txtSourceMirror->text());
+    m_config->setFinishedLogs(ui->spnFinishedLogs->value());
+    m_config->setFinishedLogMemory(ui->spnFinishedLogMemory->value());
+    
+    // Zapisz ograniczenia zasobów
+    m_config->setLimitResources(ui->grpResourceLimits->isChecked());
+    m_config->setCpuWeight(ui->spnCpuWeight->value());
+    m_config->setIoWeight(ui->spnIoWeight->value());
+    m_config->setMemoryHighMiB(ui->spnMemoryHigh->value());
+    m_config->setMemoryMaxMiB(ui->spnMemoryMax->value());
     
     // Zapisz konfigurację
     m_config->save();
@@ -62,6 +102,27 @@ void FlatpakBuilderConfigWidget::load()
     ui->txtFlatpakBuilder->setText(m_config->flatpakBuilderPath());
     ui->txtFlatpak->setText(m_config->flatpakPath());
     ui->txtBuildDir->setText(m_config->defaultBuildDir());
+    ui->chkUseDaemon->setChecked(m_config->useBuildDaemon());
+    ui->spnMatrixJobs->setValue(m_config->matrixParallelBuilds());
+    ui->chkDependencyLayer->setChecked(m_config->useDependencyLayer());
+    ui->txtLayerDir->setText(m_config->dependencyLayerDir());
+    ui->txtLayerDir->setEnabled(m_config->useDependencyLayer());
+    ui->btnBrowseLayerDir->setEnabled(m_config->useDependencyLayer());
+    ui->chkManifestLto->setChecked(m_config->manifestLto());
+    ui->chkMaintainRepo->setChecked(m_config->maintainExportRepo());
+    ui->spnRepoRetention->setValue(m_config->exportRetention());
+    ui->spnRepoRetention->setEnabled(m_config->maintainExportRepo());
+    ui->spnRepoDeltas->setValue(m_config->exportDeltaDepth());
+    ui->spnRepoDeltas->setEnabled(m_config->maintainExportRepo());
+    ui->spnBuildSnapshots->setValue(m_config->buildSnapshots());
+    ui->txtSourceMirror->setText(m_config->sourceMirrorDir());
+    ui->spnFinishedLogs->setValue(m_config->finishedLogs());
+    ui->spnFinishedLogMemory->setValue(m_config->finishedLogMemory());
+    ui->grpResourceLimits->setChecked(m_config->limitResources());
+    ui->spnCpuWeight->setValue(m_config->cpuWeight());
+    ui->spnIoWeight->setValue(m_config->ioWeight());
+    ui->spnMemoryHigh->setValue(m_config->memoryHighMiB());
+    ui->spnMemoryMax->setValue(m_config->memoryMaxMiB());
 }
 
 void FlatpakBuilderConfigWidget::defaults()
@@ -70,6 +131,23 @@ void FlatpakBuilderConfigWidget::defaults()
     ui->txtFlatpakBuilder->setText(QStandardPaths::findExecutable("flatpak-builder"));
     ui->txtFlatpak->setText(QStandardPaths::findExecutable("flatpak"));
     ui->txtBuildDir->setText(QDir::homePath() + "/.cache/flatpak-builder");
+    ui->chkUseDaemon->setChecked(false);
+    ui->spnMatrixJobs->setValue(2);
+    ui->chkDependencyLayer->setChecked(false);
+    ui->txtLayerDir->setText(QDir::homePath() + "/.cache/kdev-flatpak/layers");
+    ui->chkManifestLto->setChecked(false);
+    ui->chkMaintainRepo->setChecked(true);
+    ui->spnRepoRetention->setValue(5);
+    ui->spnRepoDeltas->setValue(3);
+    ui->spnBuildSnapshots->setValue(3);
+    ui->txtSourceMirror->clear();
+    ui->spnFinishedLogs->setValue(10);
+    ui->spnFinishedLogMemory->setValue(64);
+    ui->grpResourceLimits->setChecked(false);
+    ui->spnCpuWeight->setValue(20);
+    ui->spnIoWeight->setValue(20);
+    ui->spnMemoryHigh->setValue(0);
+    ui->spnMemoryMax->setValue(0);
 }
 
 void FlatpakBuilderConfigWidget::slotBrowseFlatpakBuilder()
@@ -105,4 +183,26 @@ void FlatpakBuilderConfigWidget::slotBrowseBuildDir()
     if (!path.isEmpty()) {
         ui->txtBuildDir->setText(path);
     }
-}
\ No newline at end of file
+}
+
+void FlatpakBuilderConfigWidget::slotBrowseLayerDir()
+{
+    QString path = QFileDialog::getExistingDirectory(this, 
+                                                   i18n("Select dependency layer directory"),
+                                                   ui->txtLayerDir->text());
+    
+    if (!path.isEmpty()) {
+        ui->txtLayerDir->setText(path);
+    }
+}
+
+void FlatpakBuilderConfigWidget::slotBrowseSourceMirror()
+{
+    QString path = QFileDialog::getExistingDirectory(this, 
+                                                   i18n("Select source mirror directory"),
+                                                   ui->txtSourceMirror->text());
+    
+    if (!path.isEmpty()) {
+        ui->txtSourceMirror->setText(path);
+    }
+}
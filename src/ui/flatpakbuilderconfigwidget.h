@@ -72,6 +72,16 @@ private Q_SLOTS:
      * @brief Slot wywoływany po kliknięciu przycisku wyboru katalogu wyjściowego
      */
     void slotBrowseBuildDir();
+    
+    /**
+     * @brief Slot wywoływany po kliknięciu przycisku wyboru katalogu warstw zależności
+     */
+    void slotBrowseLayerDir();
+    
+    /**
+     * @brief Slot wywoływany po kliknięciu przycisku wyboru katalogu kopii źródeł
+     */
+    void slotBrowseSourceMirror();
 
 private:
     Ui::FlatpakBuilderConfigWidget* ui;
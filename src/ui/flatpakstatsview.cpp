@@ -0,0 +1,158 @@
+/**
+ * @file flatpakstatsview.cpp
+ * @brief Implementacja panelu statystyk zadania budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakstatsview.h"
+#include "flatpakbuilderplugin.h"
+#include "flatpakjobstats.h"
+
+#include <KLocalizedString>
+
+#include <QDateTime>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QJsonDocument>
+#include <QLabel>
+#include <QLocale>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace {
+    const int RefreshIntervalMs = 1000;
+}
+
+FlatpakStatsView::FlatpakStatsView(FlatpakBuilderPlugin* plugin, QWidget* parent)
+    : QWidget(parent)
+    , m_plugin(plugin)
+    , m_title(new QLabel(this))
+    , m_tree(new QTreeWidget(this))
+    , m_exportButton(new QPushButton(QIcon::fromTheme("document-export"), i18n("Export as JSON..."), this))
+{
+    setWindowTitle(i18n("Flatpak Build Stats"));
+    setWindowIcon(QIcon::fromTheme("flatpak-build"));
+
+    m_tree->setHeaderLabels({i18n("Metric"), i18n("Value")});
+    m_tree->setRootIsDecorated(false);
+    m_tree->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+
+    auto* header = new QHBoxLayout;
+    header->addWidget(m_title, 1);
+    header->addWidget(m_exportButton);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(header);
+    layout->addWidget(m_tree);
+
+    connect(m_exportButton, &QPushButton::clicked, this, &FlatpakStatsView::exportJson);
+
+    m_timer.setInterval(RefreshIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &FlatpakStatsView::refresh);
+}
+
+void FlatpakStatsView::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    m_timer.start();
+}
+
+void FlatpakStatsView::hideEvent(QHideEvent* event)
+{
+    m_timer.stop();
+    QWidget::hideEvent(event);
+}
+
+void FlatpakStatsView::refresh()
+{
+    const std::shared_ptr<FlatpakJobStats> stats = m_plugin->activeJobStats();
+    m_exportButton->setEnabled(stats != nullptr);
+    m_tree->clear();
+
+    if (!stats) {
+        m_title->setText(i18n("No Flatpak job has run in this session."));
+        return;
+    }
+
+    const FlatpakJobStats::Snapshot snapshot = stats->snapshot();
+    const QLocale locale;
+    m_title->setText(snapshot.finished ? i18n("%1 (finished)", m_plugin->activeJobName())
+                                       : i18n("%1 (running)", m_plugin->activeJobName()));
+
+    auto add = [this](const QString& metric, const QString& value) {
+        new QTreeWidgetItem(m_tree, {metric, value});
+    };
+    auto micros = [&locale](double nanos) {
+        return i18n("%1 µs", locale.toString(nanos / 1000.0, 'f', 2));
+    };
+
+    add(i18n("Elapsed"), i18n("%1 s", locale.toString(snapshot.elapsedMs / 1000.0, 'f', 1)));
+    add(i18n("Lines read"), locale.toString(snapshot.linesRead));
+    add(i18n("Lines per second"), locale.toString(snapshot.linesPerSecond(), 'f', 0));
+    add(i18n("Bytes read"), locale.formattedDataSize(snapshot.bytesRead));
+    add(i18n("Batches"), locale.toString(snapshot.batches));
+    add(i18n("Parse time per line"), micros(snapshot.parseNanosPerLine()));
+    add(i18n("Log model append time per line"), micros(snapshot.appendNanosPerLine()));
+    add(i18n("Parse time total"), i18n("%1 ms", locale.toString(snapshot.parseNanos / 1e6, 'f', 1)));
+    add(i18n("Log model append time total"), i18n("%1 ms", locale.toString(snapshot.appendNanos / 1e6, 'f', 1)));
+    add(i18n("Queue depth (current / peak)"), i18n("%1 / %2", snapshot.queueDepth, snapshot.maxQueueDepth));
+    add(i18n("Reader stalls on a full queue"), locale.toString(snapshot.stalls));
+    add(i18n("Error and warning lines"), locale.toString(snapshot.problemLines));
+    add(i18n("Problems emitted"), locale.toString(snapshot.problems));
+    add(i18n("Process CPU"), i18n("%1%", locale.toString(snapshot.cpuPercent, 'f', 0)));
+    add(i18n("Process memory"), locale.formattedDataSize(snapshot.memoryBytes));
+}
+
+void FlatpakStatsView::exportJson()
+{
+    const std::shared_ptr<FlatpakJobStats> stats = m_plugin->activeJobStats();
+    if (!stats) {
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(this, i18n("Export Build Stats"),
+                                                      QStringLiteral("flatpak-build-stats.json"),
+                                                      i18n("JSON files (*.json)"));
+    if (path.isEmpty()) {
+        return;
+    }
+
+    QJsonObject json = stats->snapshot().toJson();
+    json["job"] = m_plugin->activeJobName();
+    json["exportedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(json).toJson()) < 0
+        || !file.commit()) {
+        QMessageBox::warning(this, i18n("Export Build Stats"),
+                             i18n("Could not write %1: %2", path, file.errorString()));
+    }
+}
+
+FlatpakStatsViewFactory::FlatpakStatsViewFactory(FlatpakBuilderPlugin* plugin)
+    : m_plugin(plugin)
+{
+}
+
+QWidget* FlatpakStatsViewFactory::create(QWidget* parent)
+{
+    return new FlatpakStatsView(m_plugin, parent);
+}
+
+Qt::DockWidgetArea FlatpakStatsViewFactory::defaultPosition() const
+{
+    return Qt::BottomDockWidgetArea;
+}
+
+QString FlatpakStatsViewFactory::id() const
+{
+    return QStringLiteral("org.kdevelop.FlatpakBuildStats");
+}
@@ -0,0 +1,74 @@
+/**
+ * @file flatpakstatsview.h
+ * @brief Panel statystyk bieżącego zadania budowania
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKSTATSVIEW_H
+#define FLATPAKSTATSVIEW_H
+
+#include <interfaces/iuicontroller.h>
+
+#include <QTimer>
+#include <QWidget>
+
+class FlatpakBuilderPlugin;
+class QLabel;
+class QPushButton;
+class QTreeWidget;
+
+/**
+ * @class FlatpakStatsView
+ * @brief Pokazuje liczniki potoku wyjścia ostatnio uruchomionego zadania
+ *
+ * Liczniki są odczytywane raz na sekundę i tylko wtedy, gdy panel jest
+ * widoczny - zamknięty panel nie kosztuje nic poza samymi licznikami.
+ */
+class FlatpakStatsView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param plugin Wtyczka, od której pobierane są liczniki
+     * @param parent Widżet rodzica
+     */
+    explicit FlatpakStatsView(FlatpakBuilderPlugin* plugin, QWidget* parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private Q_SLOTS:
+    void refresh();
+    void exportJson();
+
+private:
+    FlatpakBuilderPlugin* m_plugin;
+    QLabel* m_title;
+    QTreeWidget* m_tree;
+    QPushButton* m_exportButton;
+    QTimer m_timer;
+};
+
+/**
+ * @class FlatpakStatsViewFactory
+ * @brief Tworzy panel statystyk w oknie KDevelop
+ */
+class FlatpakStatsViewFactory : public KDevelop::IToolViewFactory
+{
+public:
+    explicit FlatpakStatsViewFactory(FlatpakBuilderPlugin* plugin);
+
+    QWidget* create(QWidget* parent = nullptr) override;
+    Qt::DockWidgetArea defaultPosition() const override;
+    QString id() const override;
+
+private:
+    FlatpakBuilderPlugin* m_plugin;
+};
+
+#endif // FLATPAKSTATSVIEW_H
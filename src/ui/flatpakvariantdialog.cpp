@@ -0,0 +1,93 @@
+/**
+ * @file flatpakvariantdialog.cpp
+ * @brief Implementacja okna wyboru wariantów manifestu
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#include "flatpakvariantdialog.h"
+#include "flatpakmanifestscanner.h"
+
+#include <KLocalizedString>
+
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QListWidget>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QVBoxLayout>
+
+FlatpakVariantDialog::FlatpakVariantDialog(const QStringList& manifests, QWidget* parent)
+    : QDialog(parent)
+    , m_list(new QListWidget(this))
+    , m_parallel(new QSpinBox(this))
+{
+    setWindowTitle(i18n("Build Flatpak Variants"));
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(new QLabel(i18n("Manifests to build:"), this));
+
+    for (const QString& manifest : manifests) {
+        auto* item = new QListWidgetItem(FlatpakManifestScanner::variantName(manifest), m_list);
+        item->setToolTip(manifest);
+        item->setData(Qt::UserRole, manifest);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Checked);
+    }
+    layout->addWidget(m_list);
+
+    m_parallel->setRange(1, 16);
+    m_parallel->setToolTip(i18n("All variants share one flatpak-builder state directory, so common modules are cached once"));
+    auto* form = new QFormLayout();
+    form->addRow(i18n("Parallel builds:"), m_parallel);
+    layout->addLayout(form);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    buttons->button(QDialogButtonBox::Ok)->setText(i18n("Build"));
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    // Budowanie bez zaznaczonych wariantów nie ma sensu
+    connect(m_list, &QListWidget::itemChanged, this, [this, buttons]() {
+        buttons->button(QDialogButtonBox::Ok)->setEnabled(!selectedManifests().isEmpty());
+    });
+}
+
+void FlatpakVariantDialog::setSelectedManifests(const QStringList& manifests)
+{
+    // Zapamiętany wybór mógł dotyczyć manifestów, których już nie ma
+    bool known = false;
+    for (int i = 0; i < m_list->count(); ++i) {
+        known = known || manifests.contains(m_list->item(i)->data(Qt::UserRole).toString());
+    }
+
+    for (int i = 0; i < m_list->count(); ++i) {
+        QListWidgetItem* item = m_list->item(i);
+        const bool selected = !known || manifests.contains(item->data(Qt::UserRole).toString());
+        item->setCheckState(selected ? Qt::Checked : Qt::Unchecked);
+    }
+}
+
+QStringList FlatpakVariantDialog::selectedManifests() const
+{
+    QStringList manifests;
+    for (int i = 0; i < m_list->count(); ++i) {
+        const QListWidgetItem* item = m_list->item(i);
+        if (item->checkState() == Qt::Checked) {
+            manifests << item->data(Qt::UserRole).toString();
+        }
+    }
+    return manifests;
+}
+
+void FlatpakVariantDialog::setMaxParallel(int count)
+{
+    m_parallel->setValue(count);
+}
+
+int FlatpakVariantDialog::maxParallel() const
+{
+    return m_parallel->value();
+}
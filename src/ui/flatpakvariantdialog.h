@@ -0,0 +1,61 @@
+/**
+ * @file flatpakvariantdialog.h
+ * @brief Okno wyboru wariantów manifestu do budowania macierzowego
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ */
+
+#ifndef FLATPAKVARIANTDIALOG_H
+#define FLATPAKVARIANTDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+
+class QListWidget;
+class QSpinBox;
+
+/**
+ * @class FlatpakVariantDialog
+ * @brief Pozwala zaznaczyć manifesty do zbudowania i limit równoległości
+ */
+class FlatpakVariantDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Konstruktor
+     *
+     * @param manifests Manifesty znalezione w projekcie
+     * @param parent Okno rodzica
+     */
+    explicit FlatpakVariantDialog(const QStringList& manifests, QWidget* parent = nullptr);
+
+    /**
+     * @brief Zaznacza podane manifesty (pusta lista zaznacza wszystkie)
+     * @param manifests Bezwzględne ścieżki manifestów
+     */
+    void setSelectedManifests(const QStringList& manifests);
+
+    /**
+     * @brief Zwraca zaznaczone manifesty
+     */
+    QStringList selectedManifests() const;
+
+    /**
+     * @brief Ustawia limit równolegle budowanych wariantów
+     * @param count Liczba budowań
+     */
+    void setMaxParallel(int count);
+
+    /**
+     * @brief Zwraca limit równolegle budowanych wariantów
+     */
+    int maxParallel() const;
+
+private:
+    QListWidget* m_list;
+    QSpinBox* m_parallel;
+};
+
+#endif // FLATPAKVARIANTDIALOG_H
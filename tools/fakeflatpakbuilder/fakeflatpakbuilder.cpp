@@ -0,0 +1,306 @@
+/**
+ * @file fakeflatpakbuilder.cpp
+ * @brief Atrapa narzędzi flatpak-builder/flatpak do testów wydajnościowych wtyczki
+ * @author Twoje Imię <twój@email.com>
+ * @license GPL
+ *
+ * Program implementuje podzbiór linii poleceń, które wtyczka przekazuje do
+ * flatpak-builder i flatpak, i zamiast budować cokolwiek odtwarza nagrany log
+ * (albo generuje syntetyczny) z zadaną prędkością. Wystarczy ustawić
+ * FlatpakBuilderConfig::flatpakBuilderPath() oraz flatpakPath() na ten plik
+ * wykonywalny, aby FlatpakBuilderJob przeszło pełną ścieżkę przetwarzania wyjścia.
+ *
+ * Zachowanie sterowane jest zmiennymi środowiskowymi:
+ *   FAKE_FLATPAK_LOG           - plik z nagranym logiem do odtworzenia (surowe bajty, z \r)
+ *   FAKE_FLATPAK_RATE          - limit linii na sekundę (0 = bez limitu)
+ *   FAKE_FLATPAK_LINES         - liczba linii logu syntetycznego (gdy brak FAKE_FLATPAK_LOG)
+ *   FAKE_FLATPAK_MODULES       - liczba modułów w logu syntetycznym
+ *   FAKE_FLATPAK_ERROR_EVERY   - co ile linii wstawić serię błędów (0 = nigdy)
+ *   FAKE_FLATPAK_ERROR_BURST   - liczba linii w serii błędów
+ *   FAKE_FLATPAK_EXIT_CODE     - kod wyjścia
+ *   FAKE_FLATPAK_STATS         - jeśli ustawione, wypisuje statystyki na stderr
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Wyjście buforowane z ograniczeniem liczby linii na sekundę
+ *
+ * Linie trafiają do dużego bufora stdio, który jest opróżniany co kilka
+ * milisekund, dzięki czemu odbiorca widzi wyjście w porcjach podobnych
+ * do prawdziwego procesu, a program sam nie jest wąskim gardłem.
+ */
+class RateLimitedWriter
+{
+public:
+    explicit RateLimitedWriter(qint64 linesPerSecond)
+        : m_linesPerSecond(linesPerSecond)
+        , m_start(std::chrono::steady_clock::now())
+        , m_lastFlush(m_start)
+    {
+        std::setvbuf(stdout, nullptr, _IOFBF, 1 << 20);
+    }
+
+    void writeLine(FILE* stream, const QByteArray& line)
+    {
+        std::fwrite(line.constData(), 1, line.size(), stream);
+        ++m_lines;
+        m_bytes += line.size();
+
+        // Sprawdzamy zegar co 256 linii, żeby nie płacić za każde wywołanie
+        if ((m_lines & 0xff) == 0) {
+            throttle();
+        }
+    }
+
+    void finish()
+    {
+        std::fflush(stdout);
+        std::fflush(stderr);
+    }
+
+    qint64 lines() const { return m_lines; }
+    qint64 bytes() const { return m_bytes; }
+
+    double elapsedSeconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    void throttle()
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        if (m_linesPerSecond > 0) {
+            const auto due = m_start + std::chrono::microseconds(m_lines * 1000000 / m_linesPerSecond);
+            if (due > now) {
+                std::fflush(stdout);
+                std::fflush(stderr);
+                m_lastFlush = due;
+                std::this_thread::sleep_until(due);
+                return;
+            }
+        }
+
+        if (now - m_lastFlush > std::chrono::milliseconds(5)) {
+            std::fflush(stdout);
+            std::fflush(stderr);
+            m_lastFlush = now;
+        }
+    }
+
+    qint64 m_linesPerSecond;
+    qint64 m_lines = 0;
+    qint64 m_bytes = 0;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_lastFlush;
+};
+
+int envInt(const char* name, int defaultValue)
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok ? value : defaultValue;
+}
+
+/**
+ * @brief Odtwarza nagrany log bajt w bajt, zachowując znaki \r
+ */
+void replayLog(const QString& path, RateLimitedWriter& writer)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "error: Cannot open recorded log %s\n", qPrintable(path));
+        return;
+    }
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        // Linie z błędami kierujemy na stderr, tak jak robi to flatpak-builder
+        FILE* stream = (line.contains("error:") || line.contains("Error:")) ? stderr : stdout;
+        writer.writeLine(stream, line);
+    }
+}
+
+/**
+ * @brief Generuje syntetyczny log podobny do prawdziwego budowania
+ *
+ * Log zawiera znaczniki "Building module", linie kompilacji ze ścieżkami
+ * z piaskownicy, postęp pobierania nadpisywany znakiem \r oraz serie błędów
+ * i ostrzeżeń kompilatora.
+ */
+void generateLog(RateLimitedWriter& writer)
+{
+    const qint64 totalLines = envInt("FAKE_FLATPAK_LINES", 10000);
+    const int modules = qMax(1, envInt("FAKE_FLATPAK_MODULES", 5));
+    const int errorEvery = envInt("FAKE_FLATPAK_ERROR_EVERY", 0);
+    const int errorBurst = envInt("FAKE_FLATPAK_ERROR_BURST", 20);
+    const qint64 linesPerModule = qMax<qint64>(1, totalLines / modules);
+
+    for (int i = 0; i < 20; ++i) {
+        writer.writeLine(stdout, QByteArray("Downloading sources ") + QByteArray::number(i + 1) + "/20\r");
+    }
+    writer.writeLine(stdout, "\n");
+
+    qint64 emitted = 0;
+    for (int module = 0; module < modules && emitted < totalLines; ++module) {
+        const QByteArray name = "module" + QByteArray::number(module);
+        writer.writeLine(stdout, "========================================================================\n");
+        writer.writeLine(stdout, "Building module " + name + " in /run/build/" + name + "\n");
+        writer.writeLine(stdout, "========================================================================\n");
+        emitted += 3;
+
+        for (qint64 n = 0; n < linesPerModule && emitted < totalLines; ++n, ++emitted) {
+            const QByteArray file = "src/file" + QByteArray::number(n % 97) + ".cpp";
+
+            if (errorEvery > 0 && n > 0 && (n % errorEvery) == 0) {
+                for (int e = 0; e < errorBurst; ++e) {
+                    writer.writeLine(stderr, "/run/build/" + name + "/" + file + ":" + QByteArray::number(10 + e % 5)
+                                     + ":7: warning: unused variable 'x' [-Wunused-variable]\n");
+                }
+                writer.writeLine(stderr, "/run/build/" + name + "/" + file + ":42:13: error: 'foo' was not declared in this scope\n");
+                emitted += errorBurst + 1;
+                continue;
+            }
+
+            writer.writeLine(stdout, "[" + QByteArray::number(n + 1) + "/" + QByteArray::number(linesPerModule)
+                             + "] Building CXX object CMakeFiles/" + name + ".dir/" + file + ".o\n");
+        }
+
+        writer.writeLine(stdout, "Installing " + name + "\n");
+    }
+}
+
+/**
+ * @brief Tworzy minimalną strukturę katalogu budowania
+ *
+ * Kolejne operacje (install, build-export) oczekują katalogu files/
+ * i pliku metadata, więc atrapa je zostawia.
+ */
+void createBuildDir(const QString& buildDir)
+{
+    if (buildDir.isEmpty()) {
+        return;
+    }
+
+    QDir dir(buildDir);
+    dir.mkpath("files/bin");
+
+    QFile metadata(dir.filePath("metadata"));
+    if (metadata.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        metadata.write("[Application]\nname=org.example.Fake\nruntime=org.kde.Platform/x86_64/5.15\n");
+    }
+}
+
+/**
+ * @brief Obsługuje polecenia w stylu flatpak-builder
+ */
+void runBuilder(const QStringList& args, RateLimitedWriter& writer)
+{
+    QStringList positional;
+    for (const QString& arg : args) {
+        if (!arg.startsWith("--")) {
+            positional << arg;
+        }
+    }
+
+    // flatpak-builder [opcje] KATALOG MANIFEST
+    const QString buildDir = positional.value(0);
+    const QString manifest = positional.value(1);
+
+    writer.writeLine(stdout, "Emitting: " + QFileInfo(manifest).fileName().toUtf8() + "\n");
+
+    const QString log = qEnvironmentVariable("FAKE_FLATPAK_LOG");
+    if (!log.isEmpty()) {
+        replayLog(log, writer);
+    } else {
+        generateLog(writer);
+    }
+
+    createBuildDir(buildDir);
+}
+
+/**
+ * @brief Obsługuje podpolecenia narzędzia flatpak
+ */
+void runFlatpak(const QStringList& args, RateLimitedWriter& writer)
+{
+    const QString command = args.value(0);
+
+    if (command == "install") {
+        writer.writeLine(stdout, "Installing app/org.example.Fake/x86_64/master\n");
+        for (int i = 0; i <= 100; i += 5) {
+            writer.writeLine(stdout, "Installing… " + QByteArray::number(i) + "%\r");
+        }
+        writer.writeLine(stdout, "\nInstallation complete.\n");
+    } else if (command == "build-export" || command == "build-bundle" || command == "build-update-repo") {
+        writer.writeLine(stdout, "Commit: 0000000000000000000000000000000000000000000000000000000000000000\n");
+        writer.writeLine(stdout, "Metadata Total: 1\nContent Total: 1\n");
+    } else if (command == "list") {
+        writer.writeLine(stdout, "org.kde.Platform\t5.15-23.08\norg.kde.Sdk\t5.15-23.08\n");
+    } else {
+        const QString log = qEnvironmentVariable("FAKE_FLATPAK_LOG");
+        if (!log.isEmpty()) {
+            replayLog(log, writer);
+        }
+    }
+}
+
+bool isFlatpakCommand(const QString& arg)
+{
+    static const QStringList commands = {
+        "install", "uninstall", "run", "list", "info",
+        "build", "build-export", "build-bundle", "build-update-repo", "build-finish"
+    };
+    return commands.contains(arg);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    const QString program = QFileInfo(args.takeFirst()).fileName();
+
+    if (args.contains("--version")) {
+        std::printf("%s 1.4.0\n", program.contains("builder") ? "flatpak-builder" : "Flatpak");
+        return 0;
+    }
+
+    RateLimitedWriter writer(envInt("FAKE_FLATPAK_RATE", 0));
+
+    if (program.endsWith("flatpak") || (!args.isEmpty() && isFlatpakCommand(args.first()))) {
+        runFlatpak(args, writer);
+    } else {
+        runBuilder(args, writer);
+    }
+
+    const int exitCode = envInt("FAKE_FLATPAK_EXIT_CODE", 0);
+    if (exitCode != 0) {
+        writer.writeLine(stderr, "error: Build failed (simulated exit code " + QByteArray::number(exitCode) + ")\n");
+    }
+
+    writer.finish();
+
+    if (qEnvironmentVariableIsSet("FAKE_FLATPAK_STATS")) {
+        const double seconds = writer.elapsedSeconds();
+        std::fprintf(stderr, "fake-flatpak-builder: %lld lines, %lld bytes in %.3f s (%.0f lines/s)\n",
+                     static_cast<long long>(writer.lines()), static_cast<long long>(writer.bytes()),
+                     seconds, seconds > 0 ? writer.lines() / seconds : 0.0);
+    }
+
+    return exitCode;
+}